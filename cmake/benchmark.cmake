@@ -0,0 +1,34 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+include_guard()
+
+include(cmake/utils.cmake)
+
+FetchContent_Declare(benchmark
+  GIT_REPOSITORY https://github.com/google/benchmark.git
+  GIT_TAG v1.8.3
+  GIT_SHALLOW TRUE
+)
+
+FetchContent_MakeAvailableWithArgs(benchmark
+  BENCHMARK_ENABLE_TESTING=OFF
+  BENCHMARK_ENABLE_GTEST_TESTS=OFF
+  BENCHMARK_ENABLE_INSTALL=OFF
+  BENCHMARK_ENABLE_WERROR=OFF
+  BENCHMARK_USE_BUNDLED_GTEST=OFF
+)
@@ -30,13 +30,17 @@
 #include <atomic>
 #include <csignal>
 #include <future>
+#include <set>
 #include <string>
 #include <thread>
 
+#include "compression_util.h"
+#include "encoding.h"
 #include "event_util.h"
 #include "fd_util.h"
 #include "fmt/format.h"
 #include "io_util.h"
+#include "parse_util.h"
 #include "rocksdb_crc32c.h"
 #include "server/redis_reply.h"
 #include "server/server.h"
@@ -82,46 +86,162 @@ void FeedSlaveThread::Join() {
   }
 }
 
+std::shared_ptr<const ReplBatchCache::Entry> ReplBatchCache::Get(rocksdb::SequenceNumber seq) {
+  std::lock_guard<std::mutex> lg(mu_);
+  auto iter = entries_.find(seq);
+  if (iter == entries_.end()) return nullptr;
+  return iter->second;
+}
+
+void ReplBatchCache::Put(std::shared_ptr<const Entry> entry) {
+  std::lock_guard<std::mutex> lg(mu_);
+  auto seq = entry->seq;
+  auto size = entry->bulk.size();
+  if (!entries_.emplace(seq, std::move(entry)).second) return;
+
+  total_bytes_ += size;
+  // Evict the oldest batches first, the feeders of lagging replicas would read them from WAL again
+  while (total_bytes_ > max_bytes_ && entries_.size() > 1) {
+    total_bytes_ -= entries_.begin()->second->bulk.size();
+    entries_.erase(entries_.begin());
+  }
+}
+
+void ReplBatchCache::Clear() {
+  std::lock_guard<std::mutex> lg(mu_);
+  entries_.clear();
+  total_bytes_ = 0;
+}
+
+void FetchChunkQueue::Push(FetchFileChunk chunk) {
+  std::lock_guard<std::mutex> lg(mu_);
+  chunks_.push_back(chunk);
+  cv_.notify_one();
+}
+
+std::optional<FetchFileChunk> FetchChunkQueue::Pop() {
+  std::unique_lock<std::mutex> lock(mu_);
+  // The fetching chunks may push more chunks, so wait for them before giving up
+  cv_.wait(lock, [this] { return aborted_ || !chunks_.empty() || fetching_ == 0; });
+  if (aborted_ || chunks_.empty()) return std::nullopt;
+
+  auto chunk = chunks_.front();
+  chunks_.pop_front();
+  fetching_++;
+  return chunk;
+}
+
+void FetchChunkQueue::Done() {
+  std::lock_guard<std::mutex> lg(mu_);
+  fetching_--;
+  if (fetching_ == 0 && chunks_.empty()) cv_.notify_all();
+}
+
+void FetchChunkQueue::Abort() {
+  std::lock_guard<std::mutex> lg(mu_);
+  aborted_ = true;
+  cv_.notify_all();
+}
+
 void FeedSlaveThread::checkLivenessIfNeed() {
-  if (++interval_ % 1000) return;
+  auto now_ms = util::GetTimeStampMS();
+  if (now_ms - last_liveness_check_ms_ < kLivenessCheckIntervalMs) return;
+  last_liveness_check_ms_ = now_ms;
+
   const auto ping_command = redis::BulkString("ping");
-  auto s = util::SockSend(conn_->GetFD(), ping_command);
+  auto s = sendBulks(ping_command);
   if (!s.IsOK()) {
     LOG(ERROR) << "Ping slave[" << conn_->GetAddr() << "] err: " << s.Msg() << ", would stop the thread";
     Stop();
   }
 }
 
+Status FeedSlaveThread::sendBulks(const std::string &bulks) {
+  if (compression_ == rocksdb::kNoCompression) {
+    return util::SockSend(conn_->GetFD(), bulks);
+  }
+
+  // The compressed bulks are wrapped into one bulk string, the replica would
+  // decompress it and apply the inner bulks one by one.
+  auto compressed = GET_OR_RET(util::CompressBlock(compression_, bulks));
+  return util::SockSend(conn_->GetFD(), redis::BulkString(compressed));
+}
+
+Status FeedSlaveThread::readBatch(rocksdb::SequenceNumber seq, std::shared_ptr<const ReplBatchCache::Entry> *entry) {
+  auto cache = srv_->GetReplBatchCache();
+  if (auto cached = cache->Get(seq)) {
+    *entry = std::move(cached);
+    return Status::OK();
+  }
+
+  // The iterator may fall behind when the previous batches were taken from the cache,
+  // skip the batches which were already sent instead of seeking the WAL again.
+  while (iter_ && iter_->Valid()) {
+    auto batch = iter_->GetBatch();
+    if (batch.sequence + batch.writeBatchPtr->Count() > seq) break;
+    iter_->Next();
+  }
+
+  if (!iter_ || !iter_->Valid() || iter_->GetBatch().sequence > seq) {
+    if (iter_) LOG(INFO) << "WAL was rotated, would reopen again";
+    iter_ = nullptr;
+    auto s = srv_->storage->GetWALIter(seq, &iter_);
+    if (!s.IsOK()) {
+      iter_ = nullptr;
+      return s;
+    }
+  }
+
+  // iter_ would be always valid here
+  auto batch = iter_->GetBatch();
+  if (batch.sequence != seq) {
+    return {Status::NotOK,
+            fmt::format("WAL iterator is discrete, some seq might be lost, sequence {} expected, but got {}", seq,
+                        batch.sequence)};
+  }
+
+  auto new_entry = std::make_shared<ReplBatchCache::Entry>();
+  new_entry->seq = batch.sequence;
+  new_entry->updates = batch.writeBatchPtr->Count();
+  new_entry->bulk = redis::BulkString(batch.writeBatchPtr->Data());
+  cache->Put(new_entry);
+  *entry = std::move(new_entry);
+  return Status::OK();
+}
+
 void FeedSlaveThread::loop() {
   // is_first_repl_batch was used to fix that replication may be stuck in a dead loop
   // when some seqs might be lost in the middle of the WAL log, so forced to replicate
   // first batch here to work around this issue instead of waiting for enough batch size.
   bool is_first_repl_batch = true;
-  uint32_t yield_microseconds = 2 * 1000;
   std::string batches_bulk;
   size_t updates_in_batches = 0;
   while (!IsStopped()) {
     auto curr_seq = next_repl_seq_.load();
 
-    if (!iter_ || !iter_->Valid()) {
-      if (iter_) LOG(INFO) << "WAL was rotated, would reopen again";
-      if (!srv_->storage->WALHasNewData(curr_seq) || !srv_->storage->GetWALIter(curr_seq, &iter_).IsOK()) {
-        iter_ = nullptr;
-        usleep(yield_microseconds);
-        checkLivenessIfNeed();
-        continue;
-      }
+    // Block until the new sequences were committed, the writers would wake us up
+    // immediately, and the timeout is only used to check the liveness of the replica.
+    if (!srv_->storage->WaitForWALNewData(curr_seq, kWaitNewDataTimeout)) {
+      checkLivenessIfNeed();
+      continue;
     }
-    // iter_ would be always valid here
-    auto batch = iter_->GetBatch();
-    if (batch.sequence != curr_seq) {
-      LOG(ERROR) << "Fatal error encountered, WAL iterator is discrete, some seq might be lost"
-                 << ", sequence " << curr_seq << " expectd, but got " << batch.sequence;
-      Stop();
-      return;
+
+    std::shared_ptr<const ReplBatchCache::Entry> batch;
+    auto s = readBatch(curr_seq, &batch);
+    if (!s.IsOK()) {
+      if (s.Is<Status::NotOK>()) {
+        LOG(ERROR) << "Fatal error encountered, " << s.Msg();
+        Stop();
+        return;
+      }
+      // The WAL may be not ready for reading yet, retry later
+      std::this_thread::sleep_for(kReadWALRetryInterval);
+      checkLivenessIfNeed();
+      continue;
     }
-    updates_in_batches += batch.writeBatchPtr->Count();
-    batches_bulk += redis::BulkString(batch.writeBatchPtr->Data());
+
+    updates_in_batches += batch->updates;
+    batches_bulk += batch->bulk;
     // 1. We must send the first replication batch, as said above.
     // 2. To avoid frequently calling 'write' system call to send replication stream,
     //    we pack multiple batches into one big bulk if possible, and only send once.
@@ -132,9 +252,9 @@ void FeedSlaveThread::loop() {
     //    batches strategy, we still send batches if current batch sequence is less
     //    kMaxDelayUpdates than latest sequence.
     if (is_first_repl_batch || batches_bulk.size() >= kMaxDelayBytes || updates_in_batches >= kMaxDelayUpdates ||
-        srv_->storage->LatestSeqNumber() - batch.sequence <= kMaxDelayUpdates) {
+        srv_->storage->LatestSeqNumber() - batch->seq <= kMaxDelayUpdates) {
       // Send entire bulk which contain multiple batches
-      auto s = util::SockSend(conn_->GetFD(), batches_bulk);
+      auto s = sendBulks(batches_bulk);
       if (!s.IsOK()) {
         LOG(ERROR) << "Write error while sending batch to slave: " << s.Msg() << ". batches: 0x"
                    << util::StringToHex(batches_bulk);
@@ -146,14 +266,28 @@ void FeedSlaveThread::loop() {
       if (batches_bulk.capacity() > kMaxDelayBytes * 2) batches_bulk.shrink_to_fit();
       updates_in_batches = 0;
     }
-    curr_seq = batch.sequence + batch.writeBatchPtr->Count();
-    next_repl_seq_.store(curr_seq);
-    while (!IsStopped() && !srv_->storage->WALHasNewData(curr_seq)) {
-      usleep(yield_microseconds);
-      checkLivenessIfNeed();
+    next_repl_seq_.store(batch->seq + batch->updates);
+    checkLivenessIfNeed();
+  }
+}
+
+// Iterate over the concatenated bulk strings, e.g. "$3\r\nfoo\r\n$3\r\nbar\r\n"
+Status ForEachBulkString(const std::string &bulks, const std::function<Status(const std::string &)> &fn) {
+  size_t pos = 0;
+  while (pos < bulks.size()) {
+    auto crlf = bulks.find(CRLF, pos);
+    if (bulks[pos] != '$' || crlf == std::string::npos) {
+      return {Status::NotOK, "invalid bulk string header in the replication stream"};
     }
-    iter_->Next();
+    auto len = ParseInt<size_t>(bulks.substr(pos + 1, crlf - pos - 1), 10);
+    if (!len || crlf + 2 + *len + 2 > bulks.size()) {
+      return {Status::NotOK, "invalid bulk string length in the replication stream"};
+    }
+    auto s = fn(bulks.substr(crlf + 2, *len));
+    if (!s.IsOK()) return s;
+    pos = crlf + 2 + *len + 2;
   }
+  return Status::OK();
 }
 
 void SendString(bufferevent *bev, const std::string &data) {
@@ -289,12 +423,140 @@ void ReplicationThread::CallbacksStateMachine::Stop() {
   }
 }
 
+Status ReplBatchApplier::Start(size_t group_size) {
+  std::lock_guard<std::mutex> lg(mu_);
+  if (running_) return Status::OK();
+
+  group_size_ = std::max<size_t>(group_size, 1);
+  stop_ = false;
+  error_ = Status::OK();
+  t_ = GET_OR_RET(util::CreateThread("repl-apply", [this] { loop(); }));
+  running_ = true;
+  return Status::OK();
+}
+
+void ReplBatchApplier::Stop() {
+  {
+    std::lock_guard<std::mutex> lg(mu_);
+    if (!running_) return;
+    stop_ = true;
+    cv_.notify_all();
+  }
+  if (auto s = util::ThreadJoin(t_); !s) {
+    LOG(WARNING) << "[replication] Failed to join the batch applying thread: " << s.Msg();
+  }
+
+  std::lock_guard<std::mutex> lg(mu_);
+  if (!error_.IsOK()) {
+    LOG(ERROR) << "[replication] CRITICAL - " << error_.Msg();
+  }
+  batches_.clear();
+  queued_bytes_ = 0;
+  running_ = false;
+}
+
+bool ReplBatchApplier::IsRunning() {
+  std::lock_guard<std::mutex> lg(mu_);
+  return running_;
+}
+
+Status ReplBatchApplier::Push(ReplBatch &&batch) {
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this] { return !error_.IsOK() || queued_bytes_ < kMaxQueuedBytes; });
+  if (!error_.IsOK()) return error_;
+
+  queued_bytes_ += batch.data.size();
+  batches_.emplace_back(std::move(batch));
+  cv_.notify_all();
+  return Status::OK();
+}
+
+Status ReplBatchApplier::GetError() {
+  std::lock_guard<std::mutex> lg(mu_);
+  return error_;
+}
+
+void ReplBatchApplier::loop() {
+  while (true) {
+    std::vector<ReplBatch> group;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      cv_.wait(lock, [this] { return stop_ || !batches_.empty(); });
+      if (batches_.empty()) break;
+
+      // Group the queued batches as many as possible, but don't make a huge write
+      size_t group_bytes = 0;
+      while (!batches_.empty() && group.size() < group_size_ &&
+             (group.empty() || group_bytes + batches_.front().data.size() <= kMaxGroupBytes)) {
+        group_bytes += batches_.front().data.size();
+        group.emplace_back(std::move(batches_.front()));
+        batches_.pop_front();
+        // the propagated command may create the column families which the following batches are written to
+        if (group.back().type == kBatchTypePropagate) break;
+      }
+      queued_bytes_ -= group_bytes;
+      cv_.notify_all();
+    }
+
+    auto s = apply(&group);
+    if (!s.IsOK()) {
+      std::lock_guard<std::mutex> lg(mu_);
+      error_ = std::move(s);
+      batches_.clear();
+      queued_bytes_ = 0;
+      cv_.notify_all();
+      break;
+    }
+  }
+}
+
+Status ReplBatchApplier::apply(std::vector<ReplBatch> *group) {
+  // The write batch begins with a header of 8-byte sequence and 4-byte count,
+  // and the records follow it, so the merged batch is the records of all batches
+  // with the total count.
+  static constexpr size_t kWriteBatchHeaderSize = 12;
+
+  std::string merged;
+  if (group->size() == 1) {
+    merged = group->front().data;
+  } else {
+    uint32_t count = 0;
+    for (const auto &batch : *group) {
+      if (batch.data.size() < kWriteBatchHeaderSize) {
+        return {Status::NotOK, fmt::format("malformed write batch 0x{}", util::StringToHex(batch.data))};
+      }
+      if (merged.empty()) {
+        merged.append(batch.data);
+      } else {
+        merged.append(batch.data, kWriteBatchHeaderSize);
+      }
+      count += DecodeFixed32(batch.data.data() + 8);
+    }
+    EncodeFixed32(merged.data() + 8, count);
+  }
+
+  auto s = storage_->ReplicaApplyWriteBatch(std::move(merged));
+  if (!s.IsOK()) {
+    if (group->size() == 1) {
+      return {Status::NotOK, fmt::format("Failed to write batch to local, {}. batch: 0x{}", s.Msg(),
+                                         util::StringToHex(group->front().data))};
+    }
+    return {Status::NotOK, fmt::format("Failed to write {} merged batches to local, {}", group->size(), s.Msg())};
+  }
+
+  for (const auto &batch : *group) {
+    GET_OR_RET(on_applied_(batch));
+  }
+  return Status::OK();
+}
+
 ReplicationThread::ReplicationThread(std::string host, uint32_t port, Server *srv)
     : host_(std::move(host)),
       port_(port),
       srv_(srv),
       storage_(srv->storage),
       repl_state_(kReplConnecting),
+      batch_applier_(srv->storage, [this](const ReplBatch &batch) { return handleBatchEffect(batch); }),
       psync_steps_(
           this,
           CallbacksStateMachine::CallbackList{
@@ -366,6 +628,7 @@ void ReplicationThread::run() {
   evtimer_add(timer, &tmo);
 
   event_base_dispatch(base_);
+  batch_applier_.Stop();
   event_free(timer);
   event_base_free(base_);
 }
@@ -433,6 +696,13 @@ ReplicationThread::CBState ReplicationThread::replConfWriteCB(bufferevent *bev,
     data_to_send.emplace_back("ip-address");
     data_to_send.emplace_back(config->replica_announce_ip);
   }
+  self->repl_compression_ = rocksdb::kNoCompression;
+  auto compression = static_cast<rocksdb::CompressionType>(config->replication_compression);
+  if (!self->next_try_without_compression_ && compression != rocksdb::kNoCompression) {
+    data_to_send.emplace_back("compression");
+    data_to_send.emplace_back(util::BlockCompressionTypeName(compression));
+    self->repl_compression_ = compression;
+  }
   SendString(bev, redis::MultiBulkString(data_to_send));
   self->repl_state_.store(kReplReplConf, std::memory_order_relaxed);
   LOG(INFO) << "[replication] replconf request was sent, waiting for response";
@@ -445,7 +715,16 @@ ReplicationThread::CBState ReplicationThread::replConfReadCB(bufferevent *bev, v
   UniqueEvbufReadln line(input, EVBUFFER_EOL_CRLF_STRICT);
   if (!line) return CBState::AGAIN;
 
-  // on unknown option: first try without announce ip, if it fails again - do nothing (to prevent infinite loop)
+  // on unknown option: first try without compression, then try without announce ip,
+  // if it fails again - do nothing (to prevent infinite loop)
+  if (isUnknownOption(line.get()) && self->repl_compression_ != rocksdb::kNoCompression) {
+    self->next_try_without_compression_ = true;
+    self->repl_compression_ = rocksdb::kNoCompression;
+    LOG(WARNING) << "The old version master, can't handle compression, "
+                 << "try without it again";
+    // Retry previous state, i.e. send replconf again
+    return CBState::PREV;
+  }
   if (isUnknownOption(line.get()) && !self->next_try_without_announce_ip_address_) {
     self->next_try_without_announce_ip_address_ = true;
     LOG(WARNING) << "The old version master, can't handle ip-address, "
@@ -460,15 +739,19 @@ ReplicationThread::CBState ReplicationThread::replConfReadCB(bufferevent *bev, v
   if (strncmp(line.get(), "+OK", 3) != 0) {
     LOG(WARNING) << "[replication] Failed to replconf: " << line.get() + 1;
     //  backward compatible with old version that doesn't support replconf cmd
+    self->repl_compression_ = rocksdb::kNoCompression;
     return CBState::NEXT;
   } else {
-    LOG(INFO) << "[replication] replconf is ok, start psync";
+    LOG(INFO) << "[replication] replconf is ok, replication stream compression: "
+              << util::BlockCompressionTypeName(self->repl_compression_) << ", start psync";
     return CBState::NEXT;
   }
 }
 
 ReplicationThread::CBState ReplicationThread::tryPSyncWriteCB(bufferevent *bev, void *ctx) {
   auto self = static_cast<ReplicationThread *>(ctx);
+  // Wait for the received batches to be applied, since psync continues from the latest sequence
+  self->batch_applier_.Stop();
   auto cur_seq = self->storage_->LatestSeqNumber();
   auto next_seq = cur_seq + 1;
   std::string replid;
@@ -515,7 +798,7 @@ ReplicationThread::CBState ReplicationThread::tryPSyncReadCB(bufferevent *bev, v
     return CBState::RESTART;
   }
 
-  if (line[0] == '-' && isWrongPsyncNum(line.get())) {
+  if (line[0] == '-' && isWrongNumOfArgs(line.get())) {
     self->next_try_old_psync_ = true;
     LOG(WARNING) << "The old version master, can't handle new PSYNC, "
                  << "try old PSYNC again";
@@ -540,6 +823,14 @@ ReplicationThread::CBState ReplicationThread::incrementBatchLoopCB(bufferevent *
   char *bulk_data = nullptr;
   auto self = static_cast<ReplicationThread *>(ctx);
   self->repl_state_.store(kReplConnected, std::memory_order_relaxed);
+  if (auto s = self->batch_applier_.Start(self->srv_->GetConfig()->slave_apply_group_size); !s.IsOK()) {
+    LOG(ERROR) << "[replication] Failed to start applying batches: " << s.Msg();
+    return CBState::RESTART;
+  }
+  // The error of applying batches is logged when the applier stops
+  if (!self->batch_applier_.GetError().IsOK()) {
+    return CBState::RESTART;
+  }
   auto input = bufferevent_get_input(bev);
   while (true) {
     switch (self->incr_state_) {
@@ -560,24 +851,26 @@ ReplicationThread::CBState ReplicationThread::incrementBatchLoopCB(bufferevent *
         if (self->incr_bulk_len_ + 2 <= evbuffer_get_length(input)) {  // We got enough data
           bulk_data = reinterpret_cast<char *>(evbuffer_pullup(input, static_cast<ssize_t>(self->incr_bulk_len_ + 2)));
           std::string bulk_string = std::string(bulk_data, self->incr_bulk_len_);
-          // master would send the ping heartbeat packet to check whether the slave was alive or not,
-          // don't write ping to db here.
-          if (bulk_string != "ping") {
-            auto s = self->storage_->ReplicaApplyWriteBatch(std::string(bulk_data, self->incr_bulk_len_));
+          evbuffer_drain(input, self->incr_bulk_len_ + 2);
+          if (self->repl_compression_ == rocksdb::kNoCompression) {
+            auto s = self->applyBulk(bulk_string);
             if (!s.IsOK()) {
-              LOG(ERROR) << "[replication] CRITICAL - Failed to write batch to local, " << s.Msg() << ". batch: 0x"
-                         << util::StringToHex(bulk_string);
+              LOG(ERROR) << "[replication] CRITICAL - " << s.Msg();
               return CBState::RESTART;
             }
-
-            s = self->parseWriteBatch(bulk_string);
+          } else {
+            // The compressed bulk string contains multiple bulks of batches
+            auto bulks = util::DecompressBlock(self->repl_compression_, bulk_string);
+            if (!bulks) {
+              LOG(ERROR) << "[replication] CRITICAL - failed to decompress the replication stream: " << bulks.Msg();
+              return CBState::RESTART;
+            }
+            auto s = ForEachBulkString(*bulks, [self](const std::string &bulk) { return self->applyBulk(bulk); });
             if (!s.IsOK()) {
-              LOG(ERROR) << "[replication] CRITICAL - failed to parse write batch 0x" << util::StringToHex(bulk_string)
-                         << ": " << s.Msg();
+              LOG(ERROR) << "[replication] CRITICAL - " << s.Msg();
               return CBState::RESTART;
             }
           }
-          evbuffer_drain(input, self->incr_bulk_len_ + 2);
           self->incr_state_ = Incr_batch_size;
         } else {
           return CBState::AGAIN;
@@ -727,8 +1020,327 @@ ReplicationThread::CBState ReplicationThread::fullSyncReadCB(bufferevent *bev, v
   return CBState::QUIT;
 }
 
+// Read a bulk string which is sent by master from the socket
+static StatusOr<std::string> ReadBulkString(int sock_fd, evbuffer *evbuf) {
+  size_t bulk_len = 0;
+  while (true) {
+    UniqueEvbufReadln line(evbuf, EVBUFFER_EOL_CRLF_STRICT);
+    if (!line) {
+      if (evbuffer_read(evbuf, sock_fd, -1) <= 0) {
+        return {Status::NotOK, fmt::format("read bulk size: {}", strerror(errno))};
+      }
+      continue;
+    }
+    if (line[0] == '-') {
+      return {Status::NotOK, std::string(line.get())};
+    }
+    if (line[0] != '$') {
+      return {Status::NotOK, "invalid bulk string header"};
+    }
+    bulk_len = GET_OR_RET(ParseInt<size_t>(std::string(line.get() + 1, line.length - 1), 10));
+    break;
+  }
+
+  while (evbuffer_get_length(evbuf) < bulk_len + 2) {
+    if (evbuffer_read(evbuf, sock_fd, -1) <= 0) {
+      return {Status::NotOK, fmt::format("read bulk data: {}", strerror(errno))};
+    }
+  }
+  std::string bulk(bulk_len, '\0');
+  evbuffer_remove(evbuf, bulk.data(), bulk_len);
+  evbuffer_drain(evbuf, 2);
+  return bulk;
+}
+
 Status ReplicationThread::parallelFetchFile(const std::string &dir,
                                             const std::vector<std::pair<std::string, uint32_t>> &files) {
+  // For master using old version, it uses the backup engine and doesn't support ranged fetching
+  if (srv_->GetConfig()->master_use_repl_port) {
+    return roundRobinFetchFiles(dir, files);
+  }
+
+  uint32_t skip_cnt = 0;
+  std::atomic<uint32_t> fetch_cnt = {0};
+  std::vector<std::string> fetch_files;
+  for (const auto &[f_name, f_crc] : files) {
+    // Don't fetch existing files
+    if (engine::Storage::ReplDataManager::FileExists(storage_, dir, f_name, f_crc)) {
+      skip_cnt++;
+      LOG(INFO) << "[skip] " << f_name << " " << f_crc << ", skip count: " << skip_cnt << ", progress: " << skip_cnt
+                << "/" << files.size();
+      continue;
+    }
+    fetch_files.push_back(f_name);
+  }
+  if (fetch_files.empty()) return Status::OK();
+
+  unsigned files_count = files.size();
+  FetchFileCallback fn = [&fetch_cnt, skip_cnt, files_count](const std::string &fetch_file, const uint32_t fetch_crc) {
+    uint32_t cur_fetch_cnt = fetch_cnt.fetch_add(1) + 1;
+    LOG(INFO) << "[fetch] "
+              << "Fetched " << fetch_file << ", skip count: " << skip_cnt << ", fetch count: " << cur_fetch_cnt
+              << ", progress: " << skip_cnt + cur_fetch_cnt << "/" << files_count;
+  };
+
+  bool unsupported = false;
+  auto s = fetchFileChunks(dir, fetch_files, fn, &unsupported);
+  if (unsupported) {
+    LOG(WARNING) << "[replication] The master doesn't support fetching files in chunks, fetch the whole files instead";
+    return roundRobinFetchFiles(dir, files);
+  }
+  return s;
+}
+
+namespace {
+
+// The fetching state of a data file whose chunks are fetched in parallel
+struct ChunkedFile {
+  std::string name;
+  UniqueFD tmp_fd;
+  bool size_known = false;
+  uint64_t size = 0;
+  // The number of chunks which are not fetched yet
+  size_t remaining_chunks = 0;
+};
+
+}  // namespace
+
+Status ReplicationThread::fetchFileChunks(const std::string &dir, const std::vector<std::string> &files,
+                                          const FetchFileCallback &fn, bool *unsupported) {
+  using ReplDataManager = engine::Storage::ReplDataManager;
+  const uint64_t chunk_size = static_cast<uint64_t>(srv_->GetConfig()->fullsync_fetch_chunk_mb) * MiB;
+
+  FetchChunkQueue queue;
+  std::mutex files_mu;
+  std::vector<ChunkedFile> chunked_files(files.size());
+
+  // Finish the file once all chunks were fetched, it's called with files_mu held
+  auto finish_file = [this, &dir, &fn](ChunkedFile *file) -> Status {
+    // The tmp file may be longer than the data file if it was written by a stale full sync
+    if (ftruncate(*file->tmp_fd, static_cast<off_t>(file->size)) != 0 || fsync(*file->tmp_fd) != 0) {
+      return Status::FromErrno("sync tmp file");
+    }
+    file->tmp_fd.Close();
+    GET_OR_RET(ReplDataManager::SwapTmpFile(storage_, dir, file->name));
+    fn(file->name, 0);
+    return Status::OK();
+  };
+
+  for (size_t i = 0; i < files.size(); i++) {
+    auto &file = chunked_files[i];
+    file.name = files[i];
+    file.tmp_fd = UniqueFD(ReplDataManager::OpenTmpFile(storage_, dir, file.name));
+    if (!file.tmp_fd) {
+      return {Status::NotOK, "unable to open tmp file " + file.name};
+    }
+
+    // Resume from the chunks fetched by the interrupted full sync
+    auto progress = ReplDataManager::LoadTmpFileProgress(storage_, dir, file.name);
+    if (!progress || progress->chunk_size != chunk_size || progress->chunks.empty()) {
+      queue.Push({i, 0, chunk_size});
+      file.remaining_chunks = 1;
+      continue;
+    }
+
+    // The tmp file may be left by the full sync of another checkpoint with the same file name, so
+    // the fetched chunks are verified against the checksums of master before being accepted
+    file.size_known = true;
+    file.size = progress->file_size;
+    std::set<uint64_t> fetched_offsets;
+    for (const auto &chunk : progress->chunks) {
+      if (!fetched_offsets.insert(chunk.offset).second) continue;
+      queue.Push({i, chunk.offset, chunk_size, true, chunk.crc});
+      file.remaining_chunks++;
+    }
+    for (uint64_t offset = 0; offset < file.size; offset += chunk_size) {
+      if (fetched_offsets.count(offset) > 0) continue;
+      queue.Push({i, offset, chunk_size});
+      file.remaining_chunks++;
+    }
+    LOG(INFO) << "[fetch] Resume fetching " << file.name << ", " << fetched_offsets.size() << " chunks were fetched";
+  }
+
+  // Record the fetched chunk, and push the remaining chunks of the file if it's the first chunk
+  auto on_chunk_fetched = [&](const FetchFileChunk &chunk, const ReplDataManager::ChunkInfo &info,
+                              uint64_t file_size) -> Status {
+    std::lock_guard<std::mutex> guard(files_mu);
+    auto &file = chunked_files[chunk.file_idx];
+    if (!file.size_known) {
+      file.size_known = true;
+      file.size = file_size;
+      GET_OR_RET(ReplDataManager::InitTmpFileProgress(storage_, dir, file.name, file_size, chunk_size));
+      for (uint64_t offset = chunk_size; offset < file_size; offset += chunk_size) {
+        queue.Push({chunk.file_idx, offset, chunk_size});
+        file.remaining_chunks++;
+      }
+    } else if (file.size != file_size) {
+      // The data file of master was changed, start over fetching it in the next full sync
+      ReplDataManager::RemoveTmpFile(storage_, dir, file.name);
+      return {Status::NotOK, fmt::format("the size of file {} was changed from {} to {}", file.name, file.size,
+                                         file_size)};
+    }
+    if (info.length != std::min(chunk.length, file_size - chunk.offset)) {
+      return {Status::NotOK, fmt::format("unexpected chunk length {} of file {}", info.length, file.name)};
+    }
+
+    if (chunk.resumed) {
+      if (info.crc != chunk.resumed_crc) {
+        // The chunk was fetched from another file with the same name, fetch it again
+        queue.Push({chunk.file_idx, chunk.offset, chunk.length});
+        return Status::OK();
+      }
+    } else {
+      GET_OR_RET(ReplDataManager::AppendTmpFileProgress(storage_, dir, file.name, info));
+    }
+    if (--file.remaining_chunks == 0) {
+      GET_OR_RET(finish_file(&file));
+    }
+    return Status::OK();
+  };
+
+  std::atomic<bool> ranged_fetch_unsupported = false;
+  std::vector<std::future<Status>> results;
+  for (int tid = 0; tid < srv_->GetConfig()->fullsync_fetch_concurrency; ++tid) {
+    results.push_back(std::async(std::launch::async, [&, this]() -> Status {
+      UniqueFD unique_fd;
+      UniqueEvbuf evbuf;
+      rocksdb::CompressionType compression = rocksdb::kNoCompression;
+      bool first_request = true;
+      while (auto chunk = queue.Pop()) {
+        auto s = [&]() -> Status {
+          if (this->stop_flag_) {
+            return {Status::NotOK, "replication thread was stopped"};
+          }
+          // Connect to master lazily, since the threads may be more than the chunks
+          if (!unique_fd) {
+            unique_fd.Reset(GET_OR_RET(util::SockConnect(host_, port_).Prefixed("connect the server err")));
+            GET_OR_RET(sendAuth(*unique_fd).Prefixed("send the auth command err"));
+            compression = GET_OR_RET(sendReplConfCompression(*unique_fd).Prefixed("send the replconf err"));
+          }
+
+          // The first request is a command, and the following ones are inline ranges which are served
+          // by the same feeding thread of master
+          const auto &file = chunked_files[chunk->file_idx];
+          auto offset = std::to_string(chunk->offset), length = std::to_string(chunk->length);
+          std::vector<std::string> args = {"_fetch_file", file.name, offset, length};
+          if (chunk->resumed) args.emplace_back("checksum");
+          std::string request;
+          if (first_request) {
+            request = redis::MultiBulkString(args);
+          } else {
+            for (size_t i = 1; i < args.size(); i++) {
+              request += (i == 1 ? "" : " ") + args[i];
+            }
+            request += CRLF;
+          }
+          ReplDataManager::ChunkInfo info{chunk->offset, 0, 0};
+          uint64_t file_size = 0;
+          auto s = fetchFileChunk(*unique_fd, evbuf.get(), request, *file.tmp_fd, compression, chunk->resumed, &info,
+                                  &file_size);
+          if (!s.IsOK()) {
+            if (first_request && isWrongNumOfArgs(s.Msg().c_str())) ranged_fetch_unsupported = true;
+            return s.Prefixed("fetch file " + file.name + " err");
+          }
+          first_request = false;
+          return on_chunk_fetched(*chunk, info, file_size);
+        }();
+        queue.Done();
+        if (!s.IsOK()) {
+          queue.Abort();
+          return s;
+        }
+
+        // Just for tests
+        if (srv_->GetConfig()->fullsync_recv_file_delay) {
+          sleep(srv_->GetConfig()->fullsync_recv_file_delay);
+        }
+      }
+      return Status::OK();
+    }));
+  }
+
+  // Wait til finish
+  Status result;
+  for (auto &f : results) {
+    Status s = f.get();
+    if (!s.IsOK() && result.IsOK()) result = std::move(s);
+  }
+  *unsupported = ranged_fetch_unsupported;
+  return result;
+}
+
+// Fetch a chunk of the file and write it to the tmp file, the chunk is replied
+// as "<length> <crc> <file size>\r\n" followed by the content, which isn't sent
+// if only the checksum is requested.
+Status ReplicationThread::fetchFileChunk(int sock_fd, evbuffer *evbuf, const std::string &request, int tmp_fd,
+                                         rocksdb::CompressionType compression, bool checksum_only,
+                                         engine::Storage::ReplDataManager::ChunkInfo *chunk, uint64_t *file_size) {
+  auto s = util::SockSend(sock_fd, request);
+  if (!s.IsOK()) return s.Prefixed("send fetch file request");
+
+  uint32_t expected_crc = 0;
+  while (true) {
+    UniqueEvbufReadln line(evbuf, EVBUFFER_EOL_CRLF_STRICT);
+    if (!line) {
+      if (evbuffer_read(evbuf, sock_fd, -1) <= 0) {
+        return {Status::NotOK, fmt::format("read chunk header: {}", strerror(errno))};
+      }
+      continue;
+    }
+    if (line[0] == '-') {
+      return {Status::NotOK, std::string(line.get())};
+    }
+    auto fields = util::Split(std::string(line.get(), line.length), " ");
+    if (fields.size() != 3) {
+      return {Status::NotOK, "invalid chunk header"};
+    }
+    chunk->length = GET_OR_RET(ParseInt<uint64_t>(fields[0], 10));
+    expected_crc = GET_OR_RET(ParseInt<uint32_t>(fields[1], 10));
+    *file_size = GET_OR_RET(ParseInt<uint64_t>(fields[2], 10));
+    break;
+  }
+  if (checksum_only) {
+    chunk->crc = expected_crc;
+    return Status::OK();
+  }
+
+  uint64_t remain = chunk->length;
+  auto offset = static_cast<off_t>(chunk->offset);
+  uint32_t crc = 0;
+  // The compressed chunk is sent as a series of compressed blocks
+  while (compression != rocksdb::kNoCompression && remain != 0) {
+    auto compressed_block = GET_OR_RET(ReadBulkString(sock_fd, evbuf));
+    auto block = GET_OR_RET(util::DecompressBlock(compression, compressed_block));
+    if (block.empty() || block.size() > remain) {
+      return {Status::NotOK, "invalid compressed block size of chunk"};
+    }
+    GET_OR_RET(util::Pwrite(tmp_fd, block, offset).Prefixed("write tmp file"));
+    crc = rocksdb::crc32c::Extend(crc, block.data(), block.size());
+    remain -= block.size();
+    offset += static_cast<off_t>(block.size());
+  }
+  std::string data;
+  while (remain != 0) {
+    if (evbuffer_get_length(evbuf) == 0 && evbuffer_read(evbuf, sock_fd, -1) <= 0) {
+      return {Status::NotOK, fmt::format("read chunk data: {}", strerror(errno))};
+    }
+    data.resize(std::min<uint64_t>({remain, evbuffer_get_length(evbuf), 1 * MiB}));
+    evbuffer_remove(evbuf, data.data(), data.size());
+    GET_OR_RET(util::Pwrite(tmp_fd, data, offset).Prefixed("write tmp file"));
+    crc = rocksdb::crc32c::Extend(crc, data.data(), data.size());
+    remain -= data.size();
+    offset += static_cast<off_t>(data.size());
+  }
+
+  if (crc != expected_crc) {
+    return {Status::NotOK, fmt::format("CRC mismatched, {} was expected but got {}", expected_crc, crc)};
+  }
+  chunk->crc = crc;
+  return Status::OK();
+}
+
+Status ReplicationThread::roundRobinFetchFiles(const std::string &dir,
+                                               const std::vector<std::pair<std::string, uint32_t>> &files) {
   size_t concurrency = 1;
   if (files.size() > 20) {
     // Use 4 threads to download files in parallel
@@ -749,6 +1361,7 @@ Status ReplicationThread::parallelFetchFile(const std::string &dir,
           if (!s.IsOK()) {
             return s.Prefixed("send the auth command err");
           }
+          auto compression = GET_OR_RET(this->sendReplConfCompression(sock_fd).Prefixed("send the replconf err"));
           std::vector<std::string> fetch_files;
           std::vector<uint32_t> crcs;
           for (auto f_idx = tid; f_idx < files.size(); f_idx += concurrency) {
@@ -785,12 +1398,12 @@ Status ReplicationThread::parallelFetchFile(const std::string &dir,
           // command, so we need to fetch all files by multiple command interactions.
           if (srv_->GetConfig()->master_use_repl_port) {
             for (unsigned i = 0; i < fetch_files.size(); i++) {
-              s = this->fetchFiles(sock_fd, dir, {fetch_files[i]}, {crcs[i]}, fn);
+              s = this->fetchFiles(sock_fd, dir, {fetch_files[i]}, {crcs[i]}, compression, fn);
               if (!s.IsOK()) break;
             }
           } else {
             if (!fetch_files.empty()) {
-              s = this->fetchFiles(sock_fd, dir, fetch_files, crcs, fn);
+              s = this->fetchFiles(sock_fd, dir, fetch_files, crcs, compression, fn);
             }
           }
           return s;
@@ -828,8 +1441,35 @@ Status ReplicationThread::sendAuth(int sock_fd) {
   return Status::OK();
 }
 
+StatusOr<rocksdb::CompressionType> ReplicationThread::sendReplConfCompression(int sock_fd) {
+  auto compression = static_cast<rocksdb::CompressionType>(srv_->GetConfig()->replication_compression);
+  if (compression == rocksdb::kNoCompression || next_try_without_compression_) {
+    return rocksdb::kNoCompression;
+  }
+
+  const auto replconf_command =
+      redis::MultiBulkString({"replconf", "compression", util::BlockCompressionTypeName(compression)});
+  auto s = util::SockSend(sock_fd, replconf_command);
+  if (!s.IsOK()) return s;
+
+  UniqueEvbuf evbuf;
+  while (true) {
+    if (evbuffer_read(evbuf.get(), sock_fd, -1) <= 0) {
+      return Status::FromErrno("read replconf response err");
+    }
+    UniqueEvbufReadln line(evbuf.get(), EVBUFFER_EOL_CRLF_STRICT);
+    if (!line) continue;
+    // The old version master doesn't support the compression, fetch files without it
+    if (strncmp(line.get(), "+OK", 3) != 0) {
+      LOG(WARNING) << "[replication] Failed to enable the compression of fetching files: " << line.get();
+      return rocksdb::kNoCompression;
+    }
+    return compression;
+  }
+}
+
 Status ReplicationThread::fetchFile(int sock_fd, evbuffer *evbuf, const std::string &dir, const std::string &file,
-                                    uint32_t crc, const FetchFileCallback &fn) {
+                                    uint32_t crc, rocksdb::CompressionType compression, const FetchFileCallback &fn) {
   size_t file_size = 0;
 
   // Read file size line
@@ -858,6 +1498,17 @@ Status ReplicationThread::fetchFile(int sock_fd, evbuffer *evbuf, const std::str
   size_t remain = file_size;
   uint32_t tmp_crc = 0;
   char data[16 * 1024];
+  // The compressed file is sent as a series of compressed chunks
+  while (compression != rocksdb::kNoCompression && remain != 0) {
+    auto compressed_chunk = GET_OR_RET(ReadBulkString(sock_fd, evbuf));
+    auto chunk = GET_OR_RET(util::DecompressBlock(compression, compressed_chunk));
+    if (chunk.empty() || chunk.size() > remain) {
+      return {Status::NotOK, "invalid compressed chunk size of sst file"};
+    }
+    tmp_file->Append(chunk);
+    tmp_crc = rocksdb::crc32c::Extend(tmp_crc, chunk.data(), chunk.size());
+    remain -= chunk.size();
+  }
   while (remain != 0) {
     if (evbuffer_get_length(evbuf) > 0) {
       auto data_len = evbuffer_remove(evbuf, data, remain > 16 * 1024 ? 16 * 1024 : remain);
@@ -888,7 +1539,8 @@ Status ReplicationThread::fetchFile(int sock_fd, evbuffer *evbuf, const std::str
 }
 
 Status ReplicationThread::fetchFiles(int sock_fd, const std::string &dir, const std::vector<std::string> &files,
-                                     const std::vector<uint32_t> &crcs, const FetchFileCallback &fn) {
+                                     const std::vector<uint32_t> &crcs, rocksdb::CompressionType compression,
+                                     const FetchFileCallback &fn) {
   std::string files_str;
   for (const auto &file : files) {
     files_str += file;
@@ -903,7 +1555,7 @@ Status ReplicationThread::fetchFiles(int sock_fd, const std::string &dir, const
   UniqueEvbuf evbuf;
   for (unsigned i = 0; i < files.size(); i++) {
     DLOG(INFO) << "[fetch] Start to fetch file " << files[i];
-    s = fetchFile(sock_fd, evbuf.get(), dir, files[i], crcs[i], fn);
+    s = fetchFile(sock_fd, evbuf.get(), dir, files[i], crcs[i], compression, fn);
     if (!s.IsOK()) {
       s = Status(Status::NotOK, "fetch file err: " + s.Msg());
       LOG(WARNING) << "[fetch] Fail to fetch file " << files[i] << ", err: " << s.Msg();
@@ -931,20 +1583,44 @@ void ReplicationThread::eventTimerCb(int, int16_t, void *ctx) {
   }
 }
 
-Status ReplicationThread::parseWriteBatch(const std::string &batch_string) {
+Status ReplicationThread::applyBulk(const std::string &bulk_string) {
+  // master would send the ping heartbeat packet to check whether the slave was alive or not,
+  // don't write ping to db here.
+  if (bulk_string == "ping") return Status::OK();
+
+  ReplBatch batch;
+  auto s = parseWriteBatch(bulk_string, &batch);
+  if (!s.IsOK()) {
+    return {Status::NotOK,
+            fmt::format("failed to parse write batch 0x{}: {}", util::StringToHex(bulk_string), s.Msg())};
+  }
+  return batch_applier_.Push(std::move(batch));
+}
+
+Status ReplicationThread::parseWriteBatch(const std::string &batch_string, ReplBatch *batch) {
   rocksdb::WriteBatch write_batch(batch_string);
   WriteBatchHandler write_batch_handler;
 
   auto db_status = write_batch.Iterate(&write_batch_handler);
   if (!db_status.ok()) return {Status::NotOK, "failed to iterate over write batch: " + db_status.ToString()};
 
-  switch (write_batch_handler.Type()) {
+  batch->data = batch_string;
+  batch->type = write_batch_handler.Type();
+  if (batch->type != kBatchTypeNone) {
+    batch->key = write_batch_handler.Key();
+    batch->value = write_batch_handler.Value();
+  }
+  return Status::OK();
+}
+
+Status ReplicationThread::handleBatchEffect(const ReplBatch &batch) {
+  switch (batch.type) {
     case kBatchTypePublish:
-      srv_->PublishMessage(write_batch_handler.Key(), write_batch_handler.Value());
+      srv_->PublishMessage(batch.key, batch.value);
       break;
     case kBatchTypePropagate:
-      if (write_batch_handler.Key() == engine::kPropagateScriptCommand) {
-        std::vector<std::string> tokens = util::TokenizeRedisProtocol(write_batch_handler.Value());
+      if (batch.key == engine::kPropagateScriptCommand || batch.key == engine::kPropagateNamespaceCommand) {
+        std::vector<std::string> tokens = util::TokenizeRedisProtocol(batch.value);
         if (!tokens.empty()) {
           auto s = srv_->ExecPropagatedCommand(tokens);
           if (!s.IsOK()) {
@@ -954,8 +1630,7 @@ Status ReplicationThread::parseWriteBatch(const std::string &batch_string) {
       }
       break;
     case kBatchTypeStream: {
-      auto key = write_batch_handler.Key();
-      InternalKey ikey(key, storage_->IsSlotIdEncoded());
+      InternalKey ikey(batch.key, storage_->IsSlotIdEncoded());
       Slice entry_id = ikey.GetSubKey();
       redis::StreamEntryID id;
       GetFixed64(&entry_id, &id.ms);
@@ -973,7 +1648,7 @@ bool ReplicationThread::isRestoringError(const char *err) {
   return std::string(err) == "-ERR restoring the db from backup";
 }
 
-bool ReplicationThread::isWrongPsyncNum(const char *err) {
+bool ReplicationThread::isWrongNumOfArgs(const char *err) {
   return std::string(err) == "-ERR wrong number of arguments";
 }
 
@@ -23,8 +23,14 @@
 #include <event2/bufferevent.h>
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <deque>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
 #include <tuple>
@@ -58,10 +64,66 @@ enum WriteBatchType {
 
 using FetchFileCallback = std::function<void(const std::string, const uint32_t)>;
 
+constexpr const size_t kReplBatchCacheMaxBytes = 32 * MiB;
+
+// ReplBatchCache keeps the recently serialized WAL batches, so that the replicas which
+// are feeding from the same position can share one WAL reading and serialization pass.
+class ReplBatchCache {
+ public:
+  struct Entry {
+    rocksdb::SequenceNumber seq;
+    size_t updates;
+    std::string bulk;
+  };
+
+  explicit ReplBatchCache(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+  std::shared_ptr<const Entry> Get(rocksdb::SequenceNumber seq);
+  void Put(std::shared_ptr<const Entry> entry);
+  void Clear();
+
+ private:
+  std::mutex mu_;
+  size_t max_bytes_;
+  size_t total_bytes_ = 0;
+  std::map<rocksdb::SequenceNumber, std::shared_ptr<const Entry>> entries_;
+};
+
+// A chunk of the data file which is fetched by a single ranged `_fetch_file` request
+struct FetchFileChunk {
+  size_t file_idx;
+  uint64_t offset;
+  uint64_t length;
+  // The chunk was fetched by the interrupted full sync, only its checksum is fetched to verify it
+  bool resumed = false;
+  uint32_t resumed_crc = 0;
+};
+
+// FetchChunkQueue is the work queue shared by the threads fetching files during the full sync,
+// threads pull chunks from it dynamically, so a huge file doesn't keep one thread busy while
+// the others are idle. Fetching a chunk may push more chunks, e.g. the remaining chunks of
+// a file are only known after the first chunk tells the file size.
+class FetchChunkQueue {
+ public:
+  void Push(FetchFileChunk chunk);
+  // Pop blocks until a chunk is available, and returns std::nullopt if all chunks were
+  // done or the fetching was aborted. Done must be called after the popped chunk was fetched.
+  std::optional<FetchFileChunk> Pop();
+  void Done();
+  void Abort();
+
+ private:
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<FetchFileChunk> chunks_;
+  size_t fetching_ = 0;
+  bool aborted_ = false;
+};
+
 class FeedSlaveThread {
  public:
   explicit FeedSlaveThread(Server *srv, redis::Connection *conn, rocksdb::SequenceNumber next_repl_seq)
-      : srv_(srv), conn_(conn), next_repl_seq_(next_repl_seq) {}
+      : srv_(srv), conn_(conn), next_repl_seq_(next_repl_seq), compression_(conn->GetReplCompression()) {}
   ~FeedSlaveThread() = default;
 
   Status Start();
@@ -75,19 +137,74 @@ class FeedSlaveThread {
   }
 
  private:
-  uint64_t interval_ = 0;
   std::atomic<bool> stop_ = false;
   Server *srv_ = nullptr;
   std::unique_ptr<redis::Connection> conn_ = nullptr;
   std::atomic<rocksdb::SequenceNumber> next_repl_seq_ = 0;
   std::thread t_;
   std::unique_ptr<rocksdb::TransactionLogIterator> iter_ = nullptr;
+  uint64_t last_liveness_check_ms_ = 0;
+  rocksdb::CompressionType compression_ = rocksdb::kNoCompression;
 
   static const size_t kMaxDelayUpdates = 16;
   static const size_t kMaxDelayBytes = 16 * 1024;
+  static const uint64_t kLivenessCheckIntervalMs = 2000;
+  static constexpr std::chrono::milliseconds kWaitNewDataTimeout{100};
+  static constexpr std::chrono::milliseconds kReadWALRetryInterval{2};
 
   void loop();
   void checkLivenessIfNeed();
+  Status sendBulks(const std::string &bulks);
+  Status readBatch(rocksdb::SequenceNumber seq, std::shared_ptr<const ReplBatchCache::Entry> *entry);
+};
+
+// A batch received from master, the side effect of it is parsed before it's applied
+struct ReplBatch {
+  std::string data;
+  WriteBatchType type = kBatchTypeNone;
+  std::string key;
+  std::string value;
+};
+
+// ReplBatchApplier applies the batches received from master in its own thread, so receiving,
+// decompressing and parsing the next batches on the replication thread are pipelined with
+// writing the previous ones. The batches queued meanwhile are merged into one write if the
+// group size is greater than 1, the merged batch takes the same sequence range as writing
+// them one by one.
+class ReplBatchApplier {
+ public:
+  using AppliedCallback = std::function<Status(const ReplBatch &)>;
+
+  ReplBatchApplier(engine::Storage *storage, AppliedCallback on_applied)
+      : storage_(storage), on_applied_(std::move(on_applied)) {}
+  ~ReplBatchApplier() { Stop(); }
+
+  Status Start(size_t group_size);
+  // Stop applies the queued batches unless an error occurred, and waits for the thread to exit
+  void Stop();
+  bool IsRunning();
+  // Push blocks if too many bytes were queued, it returns the error of applying the previous batches
+  Status Push(ReplBatch &&batch);
+  Status GetError();
+
+ private:
+  engine::Storage *storage_;
+  AppliedCallback on_applied_;
+  size_t group_size_ = 1;
+  std::thread t_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<ReplBatch> batches_;
+  size_t queued_bytes_ = 0;
+  bool running_ = false;
+  bool stop_ = false;
+  Status error_;
+
+  static constexpr size_t kMaxQueuedBytes = 64 * MiB;
+  static constexpr size_t kMaxGroupBytes = 4 * MiB;
+
+  void loop();
+  Status apply(std::vector<ReplBatch> *group);
 };
 
 class ReplicationThread {
@@ -151,6 +268,9 @@ class ReplicationThread {
   std::atomic<time_t> last_io_time_ = 0;
   bool next_try_old_psync_ = false;
   bool next_try_without_announce_ip_address_ = false;
+  bool next_try_without_compression_ = false;
+  // The compression type of the replication stream which was accepted by the master
+  rocksdb::CompressionType repl_compression_ = rocksdb::kNoCompression;
 
   std::function<void()> pre_fullsync_cb_;
   std::function<void()> post_fullsync_cb_;
@@ -164,6 +284,8 @@ class ReplicationThread {
   rocksdb::BackupID fullsync_meta_id_ = 0;
   size_t fullsync_filesize_ = 0;
 
+  ReplBatchApplier batch_applier_;
+
   // Internal states managed by IncrementBatchLoop procedure
   enum IncrementBatchLoopState {
     Incr_batch_size,
@@ -192,18 +314,28 @@ class ReplicationThread {
 
   // Synchronized-Blocking ops
   Status sendAuth(int sock_fd);
+  StatusOr<rocksdb::CompressionType> sendReplConfCompression(int sock_fd);
   Status fetchFile(int sock_fd, evbuffer *evbuf, const std::string &dir, const std::string &file, uint32_t crc,
-                   const FetchFileCallback &fn);
+                   rocksdb::CompressionType compression, const FetchFileCallback &fn);
   Status fetchFiles(int sock_fd, const std::string &dir, const std::vector<std::string> &files,
-                    const std::vector<uint32_t> &crcs, const FetchFileCallback &fn);
+                    const std::vector<uint32_t> &crcs, rocksdb::CompressionType compression,
+                    const FetchFileCallback &fn);
+  Status fetchFileChunk(int sock_fd, evbuffer *evbuf, const std::string &request, int tmp_fd,
+                        rocksdb::CompressionType compression, bool checksum_only,
+                        engine::Storage::ReplDataManager::ChunkInfo *chunk, uint64_t *file_size);
+  Status fetchFileChunks(const std::string &dir, const std::vector<std::string> &files, const FetchFileCallback &fn,
+                         bool *unsupported);
+  Status roundRobinFetchFiles(const std::string &dir, const std::vector<std::pair<std::string, uint32_t>> &files);
   Status parallelFetchFile(const std::string &dir, const std::vector<std::pair<std::string, uint32_t>> &files);
   static bool isRestoringError(const char *err);
-  static bool isWrongPsyncNum(const char *err);
+  static bool isWrongNumOfArgs(const char *err);
   static bool isUnknownOption(const char *err);
 
   static void eventTimerCb(int, int16_t, void *ctx);
 
-  Status parseWriteBatch(const std::string &batch_string);
+  static Status parseWriteBatch(const std::string &batch_string, ReplBatch *batch);
+  Status handleBatchEffect(const ReplBatch &batch);
+  Status applyBulk(const std::string &bulk_string);
 };
 
 /*
@@ -646,6 +646,7 @@ Status SlotMigrator::migrateComplexKey(const rocksdb::Slice &key, const Metadata
   std::vector<std::string> user_cmd = {cmd, key.ToString()};
   rocksdb::ReadOptions read_options;
   read_options.snapshot = slot_snapshot_;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
   // Should use th raw db iterator to avoid reading uncommitted writes in transaction mode
   auto iter = util::UniqueIterator(storage_->GetDB()->NewIterator(read_options));
@@ -653,7 +654,7 @@ Status SlotMigrator::migrateComplexKey(const rocksdb::Slice &key, const Metadata
   // Construct key prefix to iterate values of the complex type user key
   std::string slot_key, prefix_subkey;
   AppendNamespacePrefix(key, &slot_key);
-  InternalKey(slot_key, "", metadata.version, true).Encode(&prefix_subkey);
+  InternalKey(slot_key, "", metadata.version, true, metadata.IsKeyIdEncoded()).Encode(&prefix_subkey);
   int item_count = 0;
 
   for (iter->Seek(prefix_subkey); iter->Valid(); iter->Next()) {
@@ -748,6 +749,7 @@ Status SlotMigrator::migrateComplexKey(const rocksdb::Slice &key, const Metadata
 Status SlotMigrator::migrateStream(const Slice &key, const StreamMetadata &metadata, std::string *restore_cmds) {
   rocksdb::ReadOptions read_options;
   read_options.snapshot = slot_snapshot_;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
   // Should use th raw db iterator to avoid reading uncommitted writes in transaction mode
   auto iter = util::UniqueIterator(
@@ -757,7 +759,7 @@ Status SlotMigrator::migrateStream(const Slice &key, const StreamMetadata &metad
   AppendNamespacePrefix(key, &ns_key);
   // Construct key prefix to iterate values of the stream
   std::string prefix_key;
-  InternalKey(ns_key, "", metadata.version, true).Encode(&prefix_key);
+  InternalKey(ns_key, "", metadata.version, true, metadata.IsKeyIdEncoded()).Encode(&prefix_key);
 
   std::vector<std::string> user_cmd = {type_to_cmd[metadata.Type()], key.ToString()};
 
@@ -913,7 +915,7 @@ void SlotMigrator::applyMigrationSpeedLimit() const {
 
 Status SlotMigrator::generateCmdsFromBatch(rocksdb::BatchResult *batch, std::string *commands) {
   // Iterate batch to get keys and construct commands for keys
-  WriteBatchExtractor write_batch_extractor(storage_->IsSlotIdEncoded(), migrating_slot_, false);
+  WriteBatchExtractor write_batch_extractor(storage_->IsSlotIdEncoded(), migrating_slot_, false, storage_);
   rocksdb::Status status = batch->writeBatchPtr->Iterate(&write_batch_extractor);
   if (!status.ok()) {
     LOG(ERROR) << "[migrate] Failed to parse write batch, Err: " << status.ToString();
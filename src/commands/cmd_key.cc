@@ -235,16 +235,30 @@ class CommandPersist : public Commander {
 
 class CommandDel : public Commander {
  public:
+  CommandDel() = default;
+
   Status Execute(Server *svr, Connection *conn, std::string *output) override {
     int cnt = 0;
+    bool lazy = unlink_ || svr->GetConfig()->lazyfree_lazy_user_del;
     redis::Database redis(svr->storage, conn->GetNamespace());
     for (size_t i = 1; i < args_.size(); i++) {
-      auto s = redis.Del(args_[i]);
+      auto s = redis.Del(args_[i], lazy);
       if (s.ok()) cnt++;
     }
     *output = redis::Integer(cnt);
     return Status::OK();
   }
+
+ protected:
+  explicit CommandDel(bool unlink) : unlink_(unlink) {}
+
+ private:
+  bool unlink_ = false;
+};
+
+class CommandUnlink : public CommandDel {
+ public:
+  CommandUnlink() : CommandDel(true) {}
 };
 
 REDIS_REGISTER_COMMANDS(MakeCmdAttr<CommandTTL>("ttl", 2, "read-only", 1, 1, 1),
@@ -258,6 +272,6 @@ REDIS_REGISTER_COMMANDS(MakeCmdAttr<CommandTTL>("ttl", 2, "read-only", 1, 1, 1),
                         MakeCmdAttr<CommandExpireAt>("expireat", 3, "write", 1, 1, 1),
                         MakeCmdAttr<CommandPExpireAt>("pexpireat", 3, "write", 1, 1, 1),
                         MakeCmdAttr<CommandDel>("del", -2, "write", 1, -1, 1),
-                        MakeCmdAttr<CommandDel>("unlink", -2, "write", 1, -1, 1), )
+                        MakeCmdAttr<CommandUnlink>("unlink", -2, "write", 1, -1, 1), )
 
 }  // namespace redis
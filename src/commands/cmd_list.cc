@@ -229,7 +229,7 @@ class CommandBPop : public Commander {
       if (!last_key_ptr) {
         conn_->Reply(redis::MultiBulkString({"", ""}));
       } else {
-        conn_->GetServer()->UpdateWatchedKeysManually({*last_key_ptr});
+        conn_->GetServer()->UpdateWatchedKeysManually(conn_, {*last_key_ptr});
         conn_->Reply(redis::MultiBulkString({*last_key_ptr, std::move(elem)}));
       }
     } else if (!s.IsNotFound()) {
@@ -45,8 +45,9 @@ class CommandPublish : public Commander {
   }
 };
 
-void SubscribeCommandReply(std::string *output, const std::string &name, const std::string &sub_name, int num) {
-  output->append(redis::MultiLen(3));
+void SubscribeCommandReply(const Connection *conn, std::string *output, const std::string &name,
+                           const std::string &sub_name, int num) {
+  output->append(conn->HeaderOfPush(3));
   output->append(redis::BulkString(name));
   output->append(sub_name.empty() ? redis::NilString() : redis::BulkString(sub_name));
   output->append(redis::Integer(num));
@@ -57,7 +58,8 @@ class CommandSubscribe : public Commander {
   Status Execute(Server *svr, Connection *conn, std::string *output) override {
     for (unsigned i = 1; i < args_.size(); i++) {
       conn->SubscribeChannel(args_[i]);
-      SubscribeCommandReply(output, "subscribe", args_[i], conn->SubscriptionsCount() + conn->PSubscriptionsCount());
+      SubscribeCommandReply(conn, output, "subscribe", args_[i],
+                            conn->SubscriptionsCount() + conn->PSubscriptionsCount());
     }
     return Status::OK();
   }
@@ -67,13 +69,13 @@ class CommandUnSubscribe : public Commander {
  public:
   Status Execute(Server *svr, Connection *conn, std::string *output) override {
     if (args_.size() == 1) {
-      conn->UnsubscribeAll([output](const std::string &sub_name, int num) {
-        SubscribeCommandReply(output, "unsubscribe", sub_name, num);
+      conn->UnsubscribeAll([conn, output](const std::string &sub_name, int num) {
+        SubscribeCommandReply(conn, output, "unsubscribe", sub_name, num);
       });
     } else {
       for (size_t i = 1; i < args_.size(); i++) {
         conn->UnsubscribeChannel(args_[i]);
-        SubscribeCommandReply(output, "unsubscribe", args_[i],
+        SubscribeCommandReply(conn, output, "unsubscribe", args_[i],
                               conn->SubscriptionsCount() + conn->PSubscriptionsCount());
       }
     }
@@ -86,7 +88,8 @@ class CommandPSubscribe : public Commander {
   Status Execute(Server *svr, Connection *conn, std::string *output) override {
     for (size_t i = 1; i < args_.size(); i++) {
       conn->PSubscribeChannel(args_[i]);
-      SubscribeCommandReply(output, "psubscribe", args_[i], conn->SubscriptionsCount() + conn->PSubscriptionsCount());
+      SubscribeCommandReply(conn, output, "psubscribe", args_[i],
+                            conn->SubscriptionsCount() + conn->PSubscriptionsCount());
     }
     return Status::OK();
   }
@@ -96,13 +99,13 @@ class CommandPUnSubscribe : public Commander {
  public:
   Status Execute(Server *svr, Connection *conn, std::string *output) override {
     if (args_.size() == 1) {
-      conn->PUnsubscribeAll([output](const std::string &sub_name, int num) {
-        SubscribeCommandReply(output, "punsubscribe", sub_name, num);
+      conn->PUnsubscribeAll([conn, output](const std::string &sub_name, int num) {
+        SubscribeCommandReply(conn, output, "punsubscribe", sub_name, num);
       });
     } else {
       for (size_t i = 1; i < args_.size(); i++) {
         conn->PUnsubscribeChannel(args_[i]);
-        SubscribeCommandReply(output, "punsubscribe", args_[i],
+        SubscribeCommandReply(conn, output, "punsubscribe", args_[i],
                               conn->SubscriptionsCount() + conn->PSubscriptionsCount());
       }
     }
@@ -145,7 +148,7 @@ class CommandPubSub : public Commander {
       std::vector<ChannelSubscribeNum> channel_subscribe_nums;
       srv->ListChannelSubscribeNum(channels_, &channel_subscribe_nums);
 
-      output->append(redis::MultiLen(channel_subscribe_nums.size() * 2));
+      output->append(conn->HeaderOfMap(channel_subscribe_nums.size()));
       for (const auto &chan_subscribe_num : channel_subscribe_nums) {
         output->append(redis::BulkString(chan_subscribe_num.channel));
         output->append(redis::Integer(chan_subscribe_num.subscribe_num));
@@ -18,10 +18,18 @@
  *
  */
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <optional>
+
 #include "commander.h"
+#include "compression_util.h"
 #include "error_constants.h"
 #include "fd_util.h"
 #include "io_util.h"
+#include "parse_util.h"
+#include "rocksdb_crc32c.h"
 #include "scope_exit.h"
 #include "server/server.h"
 #include "thread_util.h"
@@ -178,6 +186,12 @@ class CommandReplConf : public Commander {
         return {Status::RedisParseErr, "ip-address should not be empty"};
       }
       ip_address_ = value;
+    } else if (option == "compression") {
+      auto compression = util::ParseBlockCompressionType(value);
+      if (!compression) {
+        return {Status::RedisParseErr, compression.Msg()};
+      }
+      compression_ = *compression;
     } else {
       return {Status::RedisParseErr, errUnknownOption};
     }
@@ -192,6 +206,9 @@ class CommandReplConf : public Commander {
     if (!ip_address_.empty()) {
       conn->SetAnnounceIP(ip_address_);
     }
+    if (compression_) {
+      conn->SetReplCompression(*compression_);
+    }
     *output = redis::SimpleString("OK");
     return Status::OK();
   }
@@ -199,6 +216,7 @@ class CommandReplConf : public Commander {
  private:
   int port_ = 0;
   std::string ip_address_;
+  std::optional<rocksdb::CompressionType> compression_;
 };
 
 class CommandFetchMeta : public Commander {
@@ -258,6 +276,12 @@ class CommandFetchFile : public Commander {
  public:
   Status Parse(const std::vector<std::string> &args) override {
     files_str_ = args[1];
+    // `_fetch_file <file> <offset> <length> [checksum]` fetches a range of the file
+    if (args.size() == 4 || args.size() == 5) {
+      range_ = GET_OR_RET(parseFileRange(std::vector<std::string>(args.begin() + 1, args.end())));
+    } else if (args.size() != 2) {
+      return {Status::RedisParseErr, errWrongNumOfArguments};
+    }
     return Status::OK();
   }
 
@@ -275,41 +299,16 @@ class CommandFetchFile : public Commander {
     conn->NeedNotFreeBufferEvent();  // Feed-replica-file thread will close the replica bufferevent
     conn->EnableFlag(redis::Connection::kCloseAsync);
 
-    auto t = GET_OR_RET(util::CreateThread("feed-repl-file", [svr, repl_fd, ip, files, bev = conn->GetBufferEvent()]() {
+    auto t = GET_OR_RET(util::CreateThread("feed-repl-file", [svr, repl_fd, ip, files, range = range_,
+                                                              bev = conn->GetBufferEvent(),
+                                                              compression = conn->GetReplCompression()]() {
       auto exit = MakeScopeExit([bev] { bufferevent_free(bev); });
       svr->IncrFetchFileThread();
 
-      for (const auto &file : files) {
-        if (svr->IsStopped()) break;
-
-        uint64_t file_size = 0, max_replication_bytes = 0;
-        if (svr->GetConfig()->max_replication_mb > 0) {
-          max_replication_bytes = (svr->GetConfig()->max_replication_mb * MiB) / svr->GetFetchFileThreadNum();
-        }
-        auto start = std::chrono::high_resolution_clock::now();
-        auto fd = UniqueFD(engine::Storage::ReplDataManager::OpenDataFile(svr->storage, file, &file_size));
-        if (!fd) break;
-
-        // Send file size and content
-        if (util::SockSend(repl_fd, std::to_string(file_size) + CRLF).IsOK() &&
-            util::SockSendFile(repl_fd, *fd, file_size).IsOK()) {
-          LOG(INFO) << "[replication] Succeed sending file " << file << " to " << ip;
-        } else {
-          LOG(WARNING) << "[replication] Fail to send file " << file << " to " << ip << ", error: " << strerror(errno);
-          break;
-        }
-        fd.Close();
-
-        // Sleep if the speed of sending file is more than replication speed limit
-        auto end = std::chrono::high_resolution_clock::now();
-        uint64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-        auto shortest = static_cast<uint64_t>(static_cast<double>(file_size) /
-                                              static_cast<double>(max_replication_bytes) * (1000 * 1000));
-        if (max_replication_bytes > 0 && duration < shortest) {
-          LOG(INFO) << "[replication] Need to sleep " << (shortest - duration) / 1000
-                    << " ms since of sending files too quickly";
-          usleep(shortest - duration);
-        }
+      if (range) {
+        sendFileRanges(svr, repl_fd, ip, *range, compression);
+      } else {
+        sendFiles(svr, repl_fd, ip, files, compression);
       }
       auto now = static_cast<time_t>(util::GetTimeStamp());
       svr->storage->SetCheckpointAccessTime(now);
@@ -324,7 +323,170 @@ class CommandFetchFile : public Commander {
   }
 
  private:
+  struct FileRange {
+    std::string file;
+    uint64_t offset;
+    uint64_t length;
+    // only the header is replied, it's used to verify the chunks fetched by the interrupted full sync
+    bool checksum_only = false;
+  };
+
   std::string files_str_;
+  std::optional<FileRange> range_;
+
+  static constexpr size_t kCompressedChunkSize = 1 * MiB;
+
+  // The range is "<file> <offset> <length> [checksum]"
+  static StatusOr<FileRange> parseFileRange(const std::vector<std::string> &args) {
+    if (args.size() != 3 && args.size() != 4) {
+      return {Status::RedisParseErr, errWrongNumOfArguments};
+    }
+    auto parse_offset = ParseInt<uint64_t>(args[1], 10);
+    auto parse_length = ParseInt<uint64_t>(args[2], 10);
+    if (!parse_offset || !parse_length) {
+      return {Status::RedisParseErr, errValueNotInteger};
+    }
+    bool checksum_only = args.size() == 4;
+    if (checksum_only && !util::EqualICase(args[3], "checksum")) {
+      return {Status::RedisParseErr, errInvalidSyntax};
+    }
+    return FileRange{args[0], *parse_offset, *parse_length, checksum_only};
+  }
+
+  static void sendFiles(Server *svr, int repl_fd, const std::string &ip, const std::vector<std::string> &files,
+                        rocksdb::CompressionType compression) {
+    for (const auto &file : files) {
+      if (svr->IsStopped()) break;
+
+      uint64_t file_size = 0;
+      auto start = std::chrono::high_resolution_clock::now();
+      auto fd = UniqueFD(engine::Storage::ReplDataManager::OpenDataFile(svr->storage, file, &file_size));
+      if (!fd) break;
+
+      // Send file size and content
+      auto s = util::SockSend(repl_fd, std::to_string(file_size) + CRLF);
+      if (s.IsOK()) {
+        s = compression == rocksdb::kNoCompression ? util::SockSendFile(repl_fd, *fd, file_size)
+                                                   : sendCompressedFile(repl_fd, *fd, file_size, 0, compression);
+      }
+      if (s.IsOK()) {
+        LOG(INFO) << "[replication] Succeed sending file " << file << " to " << ip;
+      } else {
+        LOG(WARNING) << "[replication] Fail to send file " << file << " to " << ip << ", error: " << s.Msg();
+        break;
+      }
+      fd.Close();
+
+      throttle(svr, file_size, start);
+    }
+  }
+
+  // Sleep if the speed of sending file is more than replication speed limit
+  static void throttle(Server *svr, uint64_t sent_bytes,
+                       std::chrono::time_point<std::chrono::high_resolution_clock> start) {
+    uint64_t max_replication_bytes = 0;
+    if (svr->GetConfig()->max_replication_mb > 0) {
+      max_replication_bytes = (svr->GetConfig()->max_replication_mb * MiB) / svr->GetFetchFileThreadNum();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    uint64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    auto shortest = static_cast<uint64_t>(static_cast<double>(sent_bytes) /
+                                          static_cast<double>(max_replication_bytes) * (1000 * 1000));
+    if (max_replication_bytes > 0 && duration < shortest) {
+      LOG(INFO) << "[replication] Need to sleep " << (shortest - duration) / 1000
+                << " ms since of sending files too quickly";
+      usleep(shortest - duration);
+    }
+  }
+
+  // Send the ranges of files until the replica closes the connection. The first range comes from
+  // the command arguments, and the following ones are sent as inline "<file> <offset> <length> [checksum]"
+  // lines after the replica received the previous range, so it can pull chunks from its work queue one by one.
+  static void sendFileRanges(Server *svr, int repl_fd, const std::string &ip, FileRange range,
+                             rocksdb::CompressionType compression) {
+    while (!svr->IsStopped()) {
+      auto s = sendFileRange(svr, repl_fd, range, compression);
+      if (!s.IsOK()) {
+        LOG(WARNING) << "[replication] Fail to send the range [" << range.offset << ", +" << range.length
+                     << ") of file " << range.file << " to " << ip << ", error: " << s.Msg();
+        return;
+      }
+
+      // The replica closes the connection after all chunks were fetched
+      auto line = util::SockReadLine(repl_fd);
+      if (!line) return;
+      auto next_range = parseFileRange(util::Split(*line, " "));
+      if (!next_range) {
+        (void)util::SockSend(repl_fd, "-ERR " + next_range.Msg() + CRLF);
+        return;
+      }
+      range = std::move(*next_range);
+    }
+  }
+
+  // The range is replied as "<length> <crc> <file size>\r\n" followed by the content, the length
+  // may be less than the requested one if the range exceeds the end of the file. The content isn't
+  // sent if only the checksum is requested.
+  static Status sendFileRange(Server *svr, int repl_fd, const FileRange &range, rocksdb::CompressionType compression) {
+    uint64_t file_size = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    auto fd = UniqueFD(engine::Storage::ReplDataManager::OpenDataFile(svr->storage, range.file, &file_size));
+    if (!fd || range.offset > file_size) {
+      (void)util::SockSend(repl_fd, "-ERR invalid file range" CRLF);
+      return {Status::NotOK, "invalid file range"};
+    }
+
+    uint64_t length = std::min(range.length, file_size - range.offset);
+    auto crc = GET_OR_RET(rangeCRC(*fd, range.offset, length));
+    auto s = util::SockSend(repl_fd, fmt::format("{} {} {}", length, crc, file_size) + CRLF);
+    if (!s.IsOK() || range.checksum_only) return s;
+
+    s = compression == rocksdb::kNoCompression ? util::SockSendFile(repl_fd, *fd, length, range.offset)
+                                               : sendCompressedFile(repl_fd, *fd, length, range.offset, compression);
+    if (!s.IsOK()) return s;
+
+    throttle(svr, length, start);
+    return Status::OK();
+  }
+
+  static StatusOr<uint32_t> rangeCRC(int fd, off_t offset, size_t size) {
+    std::string buf(kCompressedChunkSize, '\0');
+    uint32_t crc = 0;
+    while (size != 0) {
+      ssize_t nread = pread(fd, buf.data(), std::min(size, kCompressedChunkSize), offset);
+      if (nread == -1) {
+        if (errno == EINTR) continue;
+        return Status::FromErrno("read file");
+      }
+      if (nread == 0) return {Status::NotOK, "unexpected end of file"};
+
+      crc = rocksdb::crc32c::Extend(crc, buf.data(), nread);
+      size -= nread;
+      offset += nread;
+    }
+    return crc;
+  }
+
+  // Send the file content as a series of compressed chunks, each of them is a bulk string,
+  // the replica would keep reading chunks until the file size was reached.
+  static Status sendCompressedFile(int out_fd, int in_fd, size_t size, off_t offset, rocksdb::CompressionType type) {
+    std::string buf(kCompressedChunkSize, '\0');
+    while (size != 0) {
+      ssize_t nread = pread(in_fd, buf.data(), std::min(size, kCompressedChunkSize), offset);
+      if (nread == -1) {
+        if (errno == EINTR) continue;
+        return Status::FromErrno("read file");
+      }
+      if (nread == 0) return {Status::NotOK, "unexpected end of file"};
+
+      auto chunk = GET_OR_RET(util::CompressBlock(type, std::string_view(buf.data(), nread)));
+      auto s = util::SockSend(out_fd, redis::BulkString(chunk));
+      if (!s.IsOK()) return s;
+      size -= nread;
+      offset += nread;
+    }
+    return Status::OK();
+  }
 };
 
 class CommandDBName : public Commander {
@@ -341,7 +503,7 @@ REDIS_REGISTER_COMMANDS(MakeCmdAttr<CommandReplConf>("replconf", -3, "read-only
                         MakeCmdAttr<CommandPSync>("psync", -2, "read-only replication no-multi no-script", 0, 0, 0),
                         MakeCmdAttr<CommandFetchMeta>("_fetch_meta", 1, "read-only replication no-multi no-script", 0,
                                                       0, 0),
-                        MakeCmdAttr<CommandFetchFile>("_fetch_file", 2, "read-only replication no-multi no-script", 0,
+                        MakeCmdAttr<CommandFetchFile>("_fetch_file", -2, "read-only replication no-multi no-script", 0,
                                                       0, 0),
                         MakeCmdAttr<CommandDBName>("_db_name", 1, "read-only replication no-multi", 0, 0, 0), )
 
@@ -94,6 +94,7 @@ class CommandScript : public Commander {
       if (!s.IsOK()) {
         return s;
       }
+      svr->ScriptPrewarm(sha);
 
       *output = redis::BulkString(sha);
     } else {
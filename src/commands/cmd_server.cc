@@ -19,6 +19,7 @@
  */
 
 #include "commander.h"
+#include "commands/command_parser.h"
 #include "commands/scan_base.h"
 #include "config/config.h"
 #include "error_constants.h"
@@ -114,12 +115,12 @@ class CommandNamespace : public Commander {
       LOG(WARNING) << "Updated namespace: " << args_[2] << " with token: " << args_[3] << ", addr: " << conn->GetAddr()
                    << ", result: " << s.Msg();
     } else if (args_.size() == 4 && sub_command == "add") {
-      Status s = config->AddNamespace(args_[2], args_[3]);
+      Status s = svr->AddNamespace(args_[2], args_[3]);
       *output = s.IsOK() ? redis::SimpleString("OK") : redis::Error(s.Msg());
       LOG(WARNING) << "New namespace: " << args_[2] << " with token: " << args_[3] << ", addr: " << conn->GetAddr()
                    << ", result: " << s.Msg();
     } else if (args_.size() == 3 && sub_command == "del") {
-      Status s = config->DelNamespace(args_[2]);
+      Status s = svr->DelNamespace(args_[2]);
       *output = s.IsOK() ? redis::SimpleString("OK") : redis::Error(s.Msg());
       LOG(WARNING) << "Deleted namespace: " << args_[2] << ", addr: " << conn->GetAddr() << ", result: " << s.Msg();
     } else {
@@ -245,7 +246,11 @@ class CommandConfig : public Commander {
     } else if (args_.size() == 3 && sub_command == "get") {
       std::vector<std::string> values;
       config->Get(args_[2], &values);
-      *output = redis::MultiBulkString(values);
+      if (conn->GetReplyProtocol() == redis::RESP::v3) {
+        *output = conn->MapOfBulkStrings(values);
+      } else {
+        *output = redis::MultiBulkString(values);
+      }
     } else if (args_.size() == 4 && sub_command == "set") {
       Status s = config->Set(svr, args_[2], args_[3]);
       if (!s.IsOK()) {
@@ -333,8 +338,8 @@ class CommandPerfLog : public Commander {
  public:
   Status Parse(const std::vector<std::string> &args) override {
     subcommand_ = util::ToLower(args[1]);
-    if (subcommand_ != "reset" && subcommand_ != "get" && subcommand_ != "len") {
-      return {Status::NotOK, "PERFLOG subcommand must be one of RESET, LEN, GET"};
+    if (subcommand_ != "reset" && subcommand_ != "get" && subcommand_ != "len" && subcommand_ != "metrics") {
+      return {Status::NotOK, "PERFLOG subcommand must be one of RESET, LEN, GET, METRICS"};
     }
 
     if (subcommand_ == "get" && args.size() >= 3) {
@@ -354,9 +359,12 @@ class CommandPerfLog : public Commander {
       *output = redis::Integer(static_cast<int64_t>(perf_log->Size()));
     } else if (subcommand_ == "reset") {
       perf_log->Reset();
+      srv->stats.ResetPerfStats();
       *output = redis::SimpleString("OK");
     } else if (subcommand_ == "get") {
       *output = perf_log->GetLatestEntries(cnt_);
+    } else if (subcommand_ == "metrics") {
+      *output = redis::BulkString(srv->GetPerfStatsMetrics());
     }
     return Status::OK();
   }
@@ -406,16 +414,94 @@ class CommandSlowlog : public Commander {
   int64_t cnt_ = 10;
 };
 
+class CommandHotKeys : public Commander {
+ public:
+  Status Parse(const std::vector<std::string> &args) override {
+    CommandParser parser(args, 1);
+    while (parser.Good()) {
+      if (parser.EatEqICase("RESET")) {
+        reset_ = true;
+      } else if (parser.EatEqICase("COUNT")) {
+        count_ = GET_OR_RET(parser.TakeInt<size_t>());
+      } else {
+        return parser.InvalidSyntax();
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Execute(Server *srv, Connection *conn, std::string *output) override {
+    if (reset_) {
+      srv->GetHotKeys()->Reset();
+      *output = redis::SimpleString("OK");
+      return Status::OK();
+    }
+
+    auto hot_keys = srv->GetHotKeys()->GetTop(conn->GetNamespace(), count_);
+    *output = conn->HeaderOfMap(hot_keys.size());
+    for (const auto &hot_key : hot_keys) {
+      *output += redis::BulkString(hot_key.key) + redis::Integer(hot_key.count);
+    }
+    return Status::OK();
+  }
+
+ private:
+  bool reset_ = false;
+  size_t count_ = 10;
+};
+
+class CommandBigKeys : public Commander {
+ public:
+  Status Parse(const std::vector<std::string> &args) override {
+    CommandParser parser(args, 1);
+    while (parser.Good()) {
+      if (parser.EatEqICase("RESET")) {
+        reset_ = true;
+      } else if (parser.EatEqICase("COUNT")) {
+        count_ = GET_OR_RET(parser.TakeInt<size_t>());
+      } else {
+        return parser.InvalidSyntax();
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Execute(Server *srv, Connection *conn, std::string *output) override {
+    if (reset_) {
+      srv->GetBigKeys()->Reset();
+      *output = redis::SimpleString("OK");
+      return Status::OK();
+    }
+
+    auto big_keys = srv->GetBigKeys()->GetTop(conn->GetNamespace(), count_);
+    *output = redis::MultiLen(big_keys.size());
+    for (const auto &big_key : big_keys) {
+      *output += redis::MultiLen(3) + redis::BulkString(big_key.key) + redis::BulkString(big_key.type) +
+                 redis::Integer(big_key.size);
+    }
+    return Status::OK();
+  }
+
+ private:
+  bool reset_ = false;
+  size_t count_ = 10;
+};
+
 class CommandClient : public Commander {
  public:
   Status Parse(const std::vector<std::string> &args) override {
     subcommand_ = util::ToLower(args[1]);
-    // subcommand: getname id kill list info setname
-    if ((subcommand_ == "id" || subcommand_ == "getname" || subcommand_ == "list" || subcommand_ == "info") &&
+    // subcommand: getname id kill list info setname tracking getredir
+    if ((subcommand_ == "id" || subcommand_ == "getname" || subcommand_ == "list" || subcommand_ == "info" ||
+         subcommand_ == "getredir") &&
         args.size() == 2) {
       return Status::OK();
     }
 
+    if (subcommand_ == "tracking" && args.size() >= 3) {
+      return parseTracking(args);
+    }
+
     if ((subcommand_ == "setname") && args.size() == 3) {
       // Check if the charset is ok. We need to do this otherwise
       // CLIENT LIST or CLIENT INFO format will break. You should always be able to
@@ -482,7 +568,8 @@ class CommandClient : public Commander {
       }
       return Status::OK();
     }
-    return {Status::RedisInvalidCmd, "Syntax error, try CLIENT LIST|INFO|KILL ip:port|GETNAME|SETNAME"};
+    return {Status::RedisInvalidCmd,
+            "Syntax error, try CLIENT LIST|INFO|KILL ip:port|GETNAME|SETNAME|TRACKING|GETREDIR"};
   }
 
   Status Execute(Server *srv, Connection *conn, std::string *output) override {
@@ -515,9 +602,16 @@ class CommandClient : public Commander {
           *output = redis::SimpleString("OK");
       }
       return Status::OK();
+    } else if (subcommand_ == "tracking") {
+      return executeTracking(srv, conn, output);
+    } else if (subcommand_ == "getredir") {
+      // -1 means the tracking is disabled, 0 means it's enabled without redirection
+      *output = conn->tracking ? redis::Integer(conn->tracking->redirect_id) : redis::Integer(-1);
+      return Status::OK();
     }
 
-    return {Status::RedisInvalidCmd, "Syntax error, try CLIENT LIST|INFO|KILL ip:port|GETNAME|SETNAME"};
+    return {Status::RedisInvalidCmd,
+            "Syntax error, try CLIENT LIST|INFO|KILL ip:port|GETNAME|SETNAME|TRACKING|GETREDIR"};
   }
 
  private:
@@ -528,6 +622,81 @@ class CommandClient : public Commander {
   int64_t kill_type_ = 0;
   uint64_t id_ = 0;
   bool new_format_ = true;
+
+  bool tracking_on_ = false;
+  bool tracking_bcast_ = false;
+  bool tracking_noloop_ = false;
+  uint64_t tracking_redirect_ = 0;
+  std::vector<std::string> tracking_prefixes_;
+
+  Status parseTracking(const std::vector<std::string> &args) {
+    if (!strcasecmp(args[2].c_str(), "on")) {
+      tracking_on_ = true;
+    } else if (!strcasecmp(args[2].c_str(), "off")) {
+      tracking_on_ = false;
+    } else {
+      return {Status::RedisParseErr, errInvalidSyntax};
+    }
+
+    for (size_t i = 3; i < args.size(); i++) {
+      bool more_args = i + 1 < args.size();
+      if (!strcasecmp(args[i].c_str(), "redirect") && more_args) {
+        auto parse_result = ParseInt<uint64_t>(args[++i], 10);
+        if (!parse_result) {
+          return {Status::RedisParseErr, errValueNotInteger};
+        }
+        tracking_redirect_ = *parse_result;
+      } else if (!strcasecmp(args[i].c_str(), "prefix") && more_args) {
+        tracking_prefixes_.emplace_back(args[++i]);
+      } else if (!strcasecmp(args[i].c_str(), "bcast")) {
+        tracking_bcast_ = true;
+      } else if (!strcasecmp(args[i].c_str(), "noloop")) {
+        tracking_noloop_ = true;
+      } else if (!strcasecmp(args[i].c_str(), "optin") || !strcasecmp(args[i].c_str(), "optout")) {
+        return {Status::RedisParseErr, "OPTIN and OPTOUT tracking modes are not supported"};
+      } else {
+        return {Status::RedisParseErr, errInvalidSyntax};
+      }
+    }
+
+    if (!tracking_prefixes_.empty() && !tracking_bcast_) {
+      return {Status::RedisParseErr, "PREFIX option requires BCAST mode to be enabled"};
+    }
+    return Status::OK();
+  }
+
+  Status executeTracking(Server *srv, Connection *conn, std::string *output) {
+    if (!tracking_on_) {
+      srv->DisableTracking(conn);
+      *output = redis::SimpleString("OK");
+      return Status::OK();
+    }
+
+    if (conn->tracking) {
+      *output = redis::Error("ERR Tracking is already enabled, turn it off before changing the options");
+      return Status::OK();
+    }
+    if (tracking_redirect_ == 0 && conn->GetProtocolVersion() != redis::RESP::v3) {
+      *output = redis::Error("ERR REDIRECT is required to receive the invalidation messages in RESP2");
+      return Status::OK();
+    }
+
+    auto client = std::make_shared<TrackingClient>();
+    client->owner = conn->Owner();
+    client->fd = conn->GetFD();
+    client->id = conn->GetID();
+    client->ns = conn->GetNamespace();
+    client->bcast = tracking_bcast_;
+    client->noloop = tracking_noloop_;
+    client->prefixes = tracking_prefixes_;
+    if (auto s = srv->EnableTracking(conn, client, tracking_redirect_); !s.IsOK()) {
+      *output = redis::Error("ERR " + s.Msg());
+      return Status::OK();
+    }
+
+    *output = redis::SimpleString("OK");
+    return Status::OK();
+  }
 };
 
 class CommandMonitor : public Commander {
@@ -662,6 +831,8 @@ class CommandHello final : public Commander {
  public:
   Status Execute(Server *svr, Connection *conn, std::string *output) override {
     size_t next_arg = 1;
+    // the protocol is left unchanged if the version wasn't specified
+    int64_t protocol = conn->GetProtocolVersion() == redis::RESP::v3 ? 3 : 2;
     if (args_.size() >= 2) {
       auto parse_result = ParseInt<int64_t>(args_[next_arg], 10);
       ++next_arg;
@@ -669,11 +840,7 @@ class CommandHello final : public Commander {
         return {Status::NotOK, "Protocol version is not an integer or out of range"};
       }
 
-      int64_t protocol = *parse_result;
-
-      // In redis, it will check protocol < 2 or protocol > 3,
-      // kvrocks only supports REPL2 by now, but for supporting some
-      // `hello 3`, it will not report error when using 3.
+      protocol = *parse_result;
       if (protocol < 2 || protocol > 3) {
         return {Status::NotOK, "-NOPROTO unsupported protocol version"};
       }
@@ -705,20 +872,22 @@ class CommandHello final : public Commander {
       }
     }
 
-    std::vector<std::string> output_list;
-    output_list.push_back(redis::BulkString("server"));
-    output_list.push_back(redis::BulkString("redis"));
-    output_list.push_back(redis::BulkString("proto"));
-    output_list.push_back(redis::Integer(2));
+    // the reply should be sent in the negotiated protocol
+    conn->SetProtocolVersion(protocol == 3 ? redis::RESP::v3 : redis::RESP::v2);
+
+    *output = conn->HeaderOfMap(3);
+    *output += redis::BulkString("server");
+    *output += redis::BulkString("redis");
+    *output += redis::BulkString("proto");
+    *output += redis::Integer(protocol);
 
-    output_list.push_back(redis::BulkString("mode"));
+    *output += redis::BulkString("mode");
     // Note: sentinel is not supported in kvrocks.
     if (svr->GetConfig()->cluster_enabled) {
-      output_list.push_back(redis::BulkString("cluster"));
+      *output += redis::BulkString("cluster");
     } else {
-      output_list.push_back(redis::BulkString("standalone"));
+      *output += redis::BulkString("standalone");
     }
-    *output = redis::Array(output_list);
     return Status::OK();
   }
 };
@@ -948,6 +1117,8 @@ REDIS_REGISTER_COMMANDS(MakeCmdAttr<CommandAuth>("auth", 2, "read-only ok-loadin
                         MakeCmdAttr<CommandDBSize>("dbsize", -1, "read-only", 0, 0, 0),
                         MakeCmdAttr<CommandSlowlog>("slowlog", -2, "read-only", 0, 0, 0),
                         MakeCmdAttr<CommandPerfLog>("perflog", -2, "read-only", 0, 0, 0),
+                        MakeCmdAttr<CommandHotKeys>("hotkeys", -1, "read-only", 0, 0, 0),
+                        MakeCmdAttr<CommandBigKeys>("bigkeys", -1, "read-only", 0, 0, 0),
                         MakeCmdAttr<CommandClient>("client", -2, "read-only", 0, 0, 0),
                         MakeCmdAttr<CommandMonitor>("monitor", 1, "read-only no-multi", 0, 0, 0),
                         MakeCmdAttr<CommandShutdown>("shutdown", 1, "read-only", 0, 0, 0),
@@ -91,7 +91,7 @@ class CommandSMembers : public Commander {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    *output = redis::MultiBulkString(members, false);
+    *output = conn->SetOfBulkStrings(members);
     return Status::OK();
   }
 };
@@ -238,7 +238,7 @@ class CommandSDiff : public Commander {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    *output = redis::MultiBulkString(members, false);
+    *output = conn->SetOfBulkStrings(members);
     return Status::OK();
   }
 };
@@ -258,7 +258,7 @@ class CommandSUnion : public Commander {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    *output = redis::MultiBulkString(members, false);
+    *output = conn->SetOfBulkStrings(members);
     return Status::OK();
   }
 };
@@ -278,7 +278,7 @@ class CommandSInter : public Commander {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    *output = redis::MultiBulkString(members, false);
+    *output = conn->SetOfBulkStrings(members);
     return Status::OK();
   }
 };
@@ -73,11 +73,11 @@ class CommandZAdd : public Commander {
       auto new_score = member_scores_[0].score;
       if ((flags_.HasNX() || flags_.HasXX() || flags_.HasLT() || flags_.HasGT()) && old_score == new_score &&
           ret == 0) {  // not the first time using incr && score not changed
-        *output = redis::NilString();
+        *output = conn->NilString();
         return Status::OK();
       }
 
-      *output = redis::BulkString(util::Float2String(new_score));
+      *output = conn->Double(new_score);
     } else {
       *output = redis::Integer(ret);
     }
@@ -182,7 +182,7 @@ class CommandZIncrBy : public Commander {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    *output = redis::BulkString(util::Float2String(score));
+    *output = conn->Double(score);
     return Status::OK();
   }
 
@@ -244,7 +244,7 @@ class CommandZPop : public Commander {
     output->append(redis::MultiLen(member_scores.size() * 2));
     for (const auto &ms : member_scores) {
       output->append(redis::BulkString(ms.member));
-      output->append(redis::BulkString(util::Float2String(ms.score)));
+      output->append(conn->Double(ms.score));
     }
 
     return Status::OK();
@@ -294,15 +294,18 @@ class CommandZRange : public Commander {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    if (!with_scores_) {
+    // the member and score are paired in RESP3, but flattened in RESP2
+    bool nested = with_scores_ && conn->GetReplyProtocol() == redis::RESP::v3;
+    if (!with_scores_ || nested) {
       output->append(redis::MultiLen(member_scores.size()));
     } else {
       output->append(redis::MultiLen(member_scores.size() * 2));
     }
 
     for (const auto &ms : member_scores) {
+      if (nested) output->append(redis::MultiLen(2));
       output->append(redis::BulkString(ms.member));
-      if (with_scores_) output->append(redis::BulkString(util::Float2String(ms.score)));
+      if (with_scores_) output->append(conn->Double(ms.score));
     }
 
     return Status::OK();
@@ -412,15 +415,18 @@ class CommandZRangeByScore : public Commander {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    if (!with_scores_) {
+    // the member and score are paired in RESP3, but flattened in RESP2
+    bool nested = with_scores_ && conn->GetReplyProtocol() == redis::RESP::v3;
+    if (!with_scores_ || nested) {
       output->append(redis::MultiLen(member_scores.size()));
     } else {
       output->append(redis::MultiLen(member_scores.size() * 2));
     }
 
     for (const auto &ms : member_scores) {
+      if (nested) output->append(redis::MultiLen(2));
       output->append(redis::BulkString(ms.member));
-      if (with_scores_) output->append(redis::BulkString(util::Float2String(ms.score)));
+      if (with_scores_) output->append(conn->Double(ms.score));
     }
 
     return Status::OK();
@@ -584,9 +590,9 @@ class CommandZScore : public Commander {
     }
 
     if (s.IsNotFound()) {
-      *output = redis::NilString();
+      *output = conn->NilString();
     } else {
-      *output = redis::BulkString(util::Float2String(score));
+      *output = conn->Double(score);
     }
     return Status::OK();
   }
@@ -606,20 +612,15 @@ class CommandZMScore : public Commander {
       return {Status::RedisExecErr, s.ToString()};
     }
 
-    std::vector<std::string> values;
-    if (s.IsNotFound()) {
-      values.resize(members.size(), "");
-    } else {
-      for (const auto &member : members) {
-        auto iter = mscores.find(member.ToString());
-        if (iter == mscores.end()) {
-          values.emplace_back("");
-        } else {
-          values.emplace_back(util::Float2String(iter->second));
-        }
+    output->append(redis::MultiLen(members.size()));
+    for (const auto &member : members) {
+      auto iter = mscores.find(member.ToString());
+      if (s.IsNotFound() || iter == mscores.end()) {
+        output->append(conn->NilString());
+      } else {
+        output->append(conn->Double(iter->second));
       }
     }
-    *output = redis::MultiBulkString(values);
     return Status::OK();
   }
 };
@@ -25,6 +25,7 @@ namespace redis {
 RegisterToCommandTable::RegisterToCommandTable(std::initializer_list<CommandAttributes> list) {
   for (const auto &attr : list) {
     command_details::redis_command_table.emplace_back(attr);
+    command_details::redis_command_table.back().id = static_cast<int>(command_details::redis_command_table.size() - 1);
     command_details::original_commands[attr.name] = &command_details::redis_command_table.back();
     command_details::commands[attr.name] = &command_details::redis_command_table.back();
   }
@@ -34,9 +35,12 @@ int GetCommandNum() { return (int)command_details::redis_command_table.size(); }
 
 const CommandMap *GetOriginalCommands() { return &command_details::original_commands; }
 
-CommandMap *GetCommands() { return &command_details::commands; }
+CommandLookupMap *GetCommands() { return &command_details::commands; }
 
-void ResetCommands() { command_details::commands = command_details::original_commands; }
+void ResetCommands() {
+  command_details::commands =
+      CommandLookupMap(command_details::original_commands.begin(), command_details::original_commands.end());
+}
 
 std::string GetCommandInfo(const CommandAttributes *command_attributes) {
   std::string command, command_flags;
@@ -25,7 +25,9 @@
 #include <glog/logging.h>
 #include <rocksdb/types.h>
 #include <rocksdb/utilities/backup_engine.h>
+#include <strings.h>
 
+#include <cctype>
 #include <deque>
 #include <initializer_list>
 #include <iostream>
@@ -34,6 +36,7 @@
 #include <memory>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -124,6 +127,9 @@ struct CommandAttributes {
 
   CommanderFactory factory;
 
+  // dense id assigned on registration, used to index per-command states like stats
+  int id = -1;
+
   bool IsWrite() const { return (flags & kCmdWrite) != 0; }
   bool IsOkLoading() const { return (flags & kCmdLoading) != 0; }
   bool IsExclusive() const { return (flags & kCmdExclusive) != 0; }
@@ -133,6 +139,27 @@ struct CommandAttributes {
 
 using CommandMap = std::map<std::string, const CommandAttributes *>;
 
+// command names are case insensitive, so hash and compare them without lowercasing
+struct CommandNameHash {
+  size_t operator()(const std::string &name) const {
+    // FNV-1a over the lowercase characters
+    size_t hash = 14695981039346656037ULL;
+    for (auto c : name) {
+      hash ^= static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(c)));
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+};
+
+struct CommandNameEqual {
+  bool operator()(const std::string &lhs, const std::string &rhs) const {
+    return lhs.size() == rhs.size() && strncasecmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+  }
+};
+
+using CommandLookupMap = std::unordered_map<std::string, const CommandAttributes *, CommandNameHash, CommandNameEqual>;
+
 inline uint64_t ParseCommandFlags(const std::string &description, const std::string &cmd_name) {
   uint64_t flags = 0;
 
@@ -213,8 +240,8 @@ inline std::deque<CommandAttributes> redis_command_table;
 // Original Command table before rename-command directive
 inline CommandMap original_commands;
 
-// Command table after rename-command directive
-inline CommandMap commands;
+// Command table after rename-command directive, it's looked up for every command
+inline CommandLookupMap commands;
 }  // namespace command_details
 
 #define KVROCKS_CONCAT(a, b) a##b                   // NOLINT
@@ -225,7 +252,7 @@ inline CommandMap commands;
   static RegisterToCommandTable KVROCKS_CONCAT2(register_to_command_table_, __LINE__){__VA_ARGS__};
 
 int GetCommandNum();
-CommandMap *GetCommands();
+CommandLookupMap *GetCommands();
 void ResetCommands();
 const CommandMap *GetOriginalCommands();
 void GetAllCommandsInfo(std::string *info);
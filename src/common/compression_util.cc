@@ -0,0 +1,129 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "compression_util.h"
+
+#include <lz4.h>
+#include <zstd.h>
+
+#include <utility>
+
+#include "encoding.h"
+#include "fmt/format.h"
+#include "string_util.h"
+
+namespace util {
+
+// Prefer the compression speed to the ratio since the data is compressed on the fly
+constexpr int kZSTDCompressionLevel = 1;
+
+static_assert(kMaxBlockSize == LZ4_MAX_INPUT_SIZE);
+
+bool IsBlockCompressionSupported(rocksdb::CompressionType type) {
+  return type == rocksdb::kLZ4Compression || type == rocksdb::kZSTD;
+}
+
+StatusOr<rocksdb::CompressionType> ParseBlockCompressionType(const std::string &name) {
+  auto lower_name = ToLower(name);
+  if (lower_name == "no") return rocksdb::kNoCompression;
+  if (lower_name == "lz4") return rocksdb::kLZ4Compression;
+  if (lower_name == "zstd") return rocksdb::kZSTD;
+  return {Status::NotOK, "unsupported compression type"};
+}
+
+std::string BlockCompressionTypeName(rocksdb::CompressionType type) {
+  switch (type) {
+    case rocksdb::kLZ4Compression:
+      return "lz4";
+    case rocksdb::kZSTD:
+      return "zstd";
+    default:
+      return "no";
+  }
+}
+
+StatusOr<std::string> CompressBlock(rocksdb::CompressionType type, std::string_view input) {
+  if (input.size() > kMaxBlockSize) {
+    return {Status::NotOK, "the block is too large to compress"};
+  }
+
+  std::string output;
+  PutFixed32(&output, static_cast<uint32_t>(input.size()));
+  size_t header_size = output.size();
+  switch (type) {
+    case rocksdb::kLZ4Compression: {
+      output.resize(header_size + LZ4_compressBound(static_cast<int>(input.size())));
+      int n = LZ4_compress_default(input.data(), output.data() + header_size, static_cast<int>(input.size()),
+                                   static_cast<int>(output.size() - header_size));
+      if (n <= 0) return {Status::NotOK, "failed to compress the block with lz4"};
+      output.resize(header_size + n);
+      break;
+    }
+    case rocksdb::kZSTD: {
+      output.resize(header_size + ZSTD_compressBound(input.size()));
+      size_t n = ZSTD_compress(output.data() + header_size, output.size() - header_size, input.data(), input.size(),
+                               kZSTDCompressionLevel);
+      if (ZSTD_isError(n)) {
+        return {Status::NotOK, fmt::format("failed to compress the block with zstd: {}", ZSTD_getErrorName(n))};
+      }
+      output.resize(header_size + n);
+      break;
+    }
+    default:
+      return {Status::NotOK, "unsupported compression type"};
+  }
+  return std::move(output);
+}
+
+StatusOr<std::string> DecompressBlock(rocksdb::CompressionType type, std::string_view input) {
+  rocksdb::Slice slice(input.data(), input.size());
+  uint32_t raw_size = 0;
+  if (!GetFixed32(&slice, &raw_size)) {
+    return {Status::NotOK, "the compressed block is truncated"};
+  }
+  if (raw_size > kMaxBlockSize) {
+    return {Status::NotOK, fmt::format("the block size {} exceeds the limit {}", raw_size, kMaxBlockSize)};
+  }
+
+  std::string output(raw_size, '\0');
+  switch (type) {
+    case rocksdb::kLZ4Compression: {
+      int n = LZ4_decompress_safe(slice.data(), output.data(), static_cast<int>(slice.size()),
+                                  static_cast<int>(raw_size));
+      if (n < 0 || static_cast<uint32_t>(n) != raw_size) {
+        return {Status::NotOK, "failed to decompress the block with lz4"};
+      }
+      break;
+    }
+    case rocksdb::kZSTD: {
+      size_t n = ZSTD_decompress(output.data(), output.size(), slice.data(), slice.size());
+      if (ZSTD_isError(n)) {
+        return {Status::NotOK, fmt::format("failed to decompress the block with zstd: {}", ZSTD_getErrorName(n))};
+      }
+      if (n != raw_size) return {Status::NotOK, "the decompressed size of the block was mismatched"};
+      break;
+    }
+    default:
+      return {Status::NotOK, "unsupported compression type"};
+  }
+  return std::move(output);
+}
+
+}  // namespace util
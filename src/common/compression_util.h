@@ -0,0 +1,44 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <rocksdb/compression_type.h>
+
+#include <string>
+#include <string_view>
+
+#include "status.h"
+
+namespace util {
+
+// A compressed block is encoded as [fixed32 uncompressed size][compressed data],
+// only lz4 and zstd are supported since both of them are always built with kvrocks.
+// The uncompressed size of a block is limited by the max input size of lz4, the size
+// comes from the network so it must be checked before allocating the output.
+constexpr size_t kMaxBlockSize = 0x7E000000;
+
+bool IsBlockCompressionSupported(rocksdb::CompressionType type);
+StatusOr<rocksdb::CompressionType> ParseBlockCompressionType(const std::string &name);
+std::string BlockCompressionTypeName(rocksdb::CompressionType type);
+StatusOr<std::string> CompressBlock(rocksdb::CompressionType type, std::string_view input);
+StatusOr<std::string> DecompressBlock(rocksdb::CompressionType type, std::string_view input);
+
+}  // namespace util
@@ -193,8 +193,8 @@ ssize_t SockSendFileCore(int out_fd, int in_fd, off_t offset, size_t count) {
 
 // Send file by sendfile actually according to different operation systems,
 // please note that, the out socket fd should be in blocking mode.
-Status SockSendFile(int out_fd, int in_fd, size_t size) {
-  off_t offset = 0;
+// The range [offset, offset + size) of the file would be sent.
+Status SockSendFile(int out_fd, int in_fd, size_t size, off_t offset) {
   while (size != 0) {
     size_t n = size <= 16 * 1024 ? size : 16 * 1024;
     ssize_t nwritten = SockSendFileCore(out_fd, in_fd, offset, n);
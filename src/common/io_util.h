@@ -32,7 +32,7 @@ Status SockSetTcpNoDelay(int fd, int val);
 Status SockSetTcpKeepalive(int fd, int interval);
 Status SockSend(int fd, const std::string &data);
 StatusOr<std::string> SockReadLine(int fd);
-Status SockSendFile(int out_fd, int in_fd, size_t size);
+Status SockSendFile(int out_fd, int in_fd, size_t size, off_t offset = 0);
 Status SockSetBlocking(int fd, int blocking);
 int GetPeerAddr(int fd, std::string *addr, uint32_t *port);
 int GetLocalPort(int fd);
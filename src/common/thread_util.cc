@@ -22,6 +22,9 @@
 
 #include <fmt/std.h>
 #include <pthread.h>
+#include <sched.h>
+
+#include <cstring>
 
 namespace util {
 
@@ -33,6 +36,20 @@ void ThreadSetName(const char *name) {
 #endif
 }
 
+Status ThreadSetAffinity(int cpu) {
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  if (int err = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set); err != 0) {
+    return {Status::NotOK, strerror(err)};
+  }
+  return Status::OK();
+#else
+  return {Status::NotOK, "thread affinity is not supported on this platform"};
+#endif
+}
+
 template <void (std::thread::*F)(), typename... Args>
 Status ThreadOperationImpl(std::thread &t, const char *op, Args &&...args) {
   try {
@@ -29,6 +29,8 @@
 namespace util {
 
 void ThreadSetName(const char *name);
+// ThreadSetAffinity pins the calling thread to the given cpu core
+Status ThreadSetAffinity(int cpu);
 
 template <typename F>
 StatusOr<std::thread> CreateThread(const char *name, F f) {
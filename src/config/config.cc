@@ -24,6 +24,7 @@
 #include <rocksdb/env.h>
 #include <strings.h>
 
+#include <cctype>
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -41,6 +42,8 @@
 
 constexpr const char *kDefaultBindAddress = "127.0.0.1";
 
+constexpr const char *kDefaultClientOutputBufferLimit = "normal 0 0 0 replica 256mb 64mb 60 pubsub 32mb 8mb 60";
+
 constexpr const char *errBlobDbNotEnabled = "Must set rocksdb.enable_blob_files to yes first.";
 constexpr const char *errLevelCompactionDynamicLevelBytesNotSet =
     "Must set rocksdb.level_compaction_dynamic_level_bytes yes first.";
@@ -50,6 +53,11 @@ ConfigEnum compression_types[] = {
     {"lz4", rocksdb::CompressionType::kLZ4Compression},   {"zstd", rocksdb::CompressionType::kZSTD},
     {"zlib", rocksdb::CompressionType::kZlibCompression}, {nullptr, 0}};
 
+ConfigEnum repl_compression_types[] = {{"no", rocksdb::CompressionType::kNoCompression},
+                                       {"lz4", rocksdb::CompressionType::kLZ4Compression},
+                                       {"zstd", rocksdb::CompressionType::kZSTD},
+                                       {nullptr, 0}};
+
 ConfigEnum supervised_modes[] = {{"no", kSupervisedNone},
                                  {"auto", kSupervisedAutoDetect},
                                  {"upstart", kSupervisedUpStart},
@@ -75,6 +83,46 @@ int ConfigEnumGetValue(ConfigEnum *ce, const char *name) {
   return INT_MIN;
 }
 
+// Parses the redis style "<class> <hard limit> <soft limit> <soft seconds> [...]" value,
+// classes which are not mentioned fall back to their defaults.
+StatusOr<std::array<ClientOutputBufferLimit, kClientOutputBufferClasses>> ParseClientOutputBufferLimits(
+    const std::string &v) {
+  std::vector<std::string> args = util::Split(kDefaultClientOutputBufferLimit, " ");
+  std::vector<std::string> overrides = util::Split(v, " \t");
+  if (overrides.size() % 4 != 0) {
+    return {Status::NotOK, "the format should be: <class> <hard limit> <soft limit> <soft seconds> [...]"};
+  }
+  args.insert(args.end(), overrides.begin(), overrides.end());
+
+  auto parse_size = [](std::string size) -> StatusOr<uint64_t> {
+    // accept the redis style units like 'mb' as well as 'm'
+    if (size.size() > 2 && (size.back() == 'b' || size.back() == 'B') && std::isalpha(size[size.size() - 2])) {
+      size.pop_back();
+    }
+    return ParseSizeAndUnit(size);
+  };
+
+  std::array<ClientOutputBufferLimit, kClientOutputBufferClasses> limits;
+  for (size_t i = 0; i < args.size(); i += 4) {
+    int klass = 0;
+    auto class_name = util::ToLower(args[i]);
+    if (class_name == "normal") {
+      klass = kClientOutputBufferNormal;
+    } else if (class_name == "pubsub") {
+      klass = kClientOutputBufferPubsub;
+    } else if (class_name == "replica" || class_name == "slave") {
+      klass = kClientOutputBufferReplica;
+    } else {
+      return {Status::NotOK, "unknown client class: " + args[i]};
+    }
+    limits[klass].hard_limit_bytes = GET_OR_RET(parse_size(args[i + 1]).Prefixed("invalid hard limit"));
+    limits[klass].soft_limit_bytes = GET_OR_RET(parse_size(args[i + 2]).Prefixed("invalid soft limit"));
+    limits[klass].soft_limit_seconds =
+        GET_OR_RET(ParseInt<int>(args[i + 3], {0, INT_MAX}, 10).Prefixed("invalid soft seconds"));
+  }
+  return limits;
+}
+
 const char *ConfigEnumGetName(ConfigEnum *ce, int val) {
   while (ce->name != nullptr) {
     if (ce->val == val) return ce->name;
@@ -113,9 +161,15 @@ Config::Config() {
       {"tls-session-cache-timeout", false, new IntField(&tls_session_cache_timeout, 300, 0, INT_MAX)},
 #endif
       {"workers", true, new IntField(&workers, 8, 1, 256)},
+      {"io-epoll-changelist", true, new YesNoField(&io_epoll_changelist, false)},
+      {"worker-cpu-affinity", true, new YesNoField(&worker_cpu_affinity, false)},
+      {"io-max-single-rw-kb", false, new IntField(&io_max_single_rw_kb, 16, 4, 1024)},
       {"timeout", false, new IntField(&timeout, 0, 0, INT_MAX)},
       {"tcp-backlog", true, new IntField(&backlog, 511, 0, INT_MAX)},
       {"maxclients", false, new IntField(&maxclients, 10240, 0, INT_MAX)},
+      {"client-output-buffer-limit", false,
+       new StringField(&client_output_buffer_limit_str_, kDefaultClientOutputBufferLimit)},
+      {"tracking-table-max-keys", false, new IntField(&tracking_table_max_keys, 1000000, 0, INT_MAX)},
       {"max-backup-to-keep", false, new IntField(&max_backup_to_keep, 1, 0, 1)},
       {"max-backup-keep-hours", false, new IntField(&max_backup_keep_hours, 0, 0, INT_MAX)},
       {"master-use-repl-port", false, new YesNoField(&master_use_repl_port, false)},
@@ -130,6 +184,7 @@ Config::Config() {
       {"force-compact-file-age", false, new Int64Field(&force_compact_file_age, 2 * 24 * 3600, 60, INT64_MAX)},
       {"force-compact-file-min-deleted-percentage", false,
        new IntField(&force_compact_file_min_deleted_percentage, 10, 1, 100)},
+      {"compaction-checker-concurrency", false, new IntField(&compaction_checker_concurrency, 2, 1, 64)},
       {"db-name", true, new StringField(&db_name, "change.me.db")},
       {"dir", true, new StringField(&dir, "/tmp/kvrocks")},
       {"backup-dir", false, new StringField(&backup_dir, "")},
@@ -137,25 +192,39 @@ Config::Config() {
       {"log-level", true, new EnumField(&log_level, log_levels, google::INFO)},
       {"pidfile", true, new StringField(&pidfile, "")},
       {"max-io-mb", false, new IntField(&max_io_mb, 500, 0, INT_MAX)},
+      {"metadata-cache-size", false, new IntField(&metadata_cache_size, 0, 0, INT_MAX)},
       {"max-bitmap-to-string-mb", false, new IntField(&max_bitmap_to_string_mb, 16, 0, INT_MAX)},
       {"max-db-size", false, new IntField(&max_db_size, 0, 0, INT_MAX)},
       {"max-replication-mb", false, new IntField(&max_replication_mb, 0, 0, INT_MAX)},
+      {"replication-compression", false,
+       new EnumField(&replication_compression, repl_compression_types, rocksdb::CompressionType::kNoCompression)},
+      {"fullsync-fetch-concurrency", false, new IntField(&fullsync_fetch_concurrency, 4, 1, 64)},
+      {"fullsync-fetch-chunk-mb", false, new IntField(&fullsync_fetch_chunk_mb, 64, 1, 1024)},
       {"supervised", true, new EnumField(&supervised_mode, supervised_modes, kSupervisedNone)},
       {"slave-serve-stale-data", false, new YesNoField(&slave_serve_stale_data, true)},
       {"slave-empty-db-before-fullsync", false, new YesNoField(&slave_empty_db_before_fullsync, false)},
       {"slave-priority", false, new IntField(&slave_priority, 100, 0, INT_MAX)},
+      {"slave-apply-group-size", false, new IntField(&slave_apply_group_size, 1, 1, 1024)},
       {"slave-read-only", false, new YesNoField(&slave_readonly, true)},
       {"use-rsid-psync", true, new YesNoField(&use_rsid_psync, false)},
       {"profiling-sample-ratio", false, new IntField(&profiling_sample_ratio, 0, 0, 100)},
       {"profiling-sample-record-max-len", false, new IntField(&profiling_sample_record_max_len, 256, 0, INT_MAX)},
       {"profiling-sample-record-threshold-ms", false,
        new IntField(&profiling_sample_record_threshold_ms, 100, 0, INT_MAX)},
+      {"key-stats-sample-ratio", false, new IntField(&key_stats_sample_ratio, 0, 0, 100)},
       {"slowlog-log-slower-than", false, new IntField(&slowlog_log_slower_than, 200000, -1, INT_MAX)},
       {"profiling-sample-commands", false, new StringField(&profiling_sample_commands_str_, "")},
       {"slowlog-max-len", false, new IntField(&slowlog_max_len, 128, 0, INT_MAX)},
       {"purge-backup-on-fullsync", false, new YesNoField(&purge_backup_on_fullsync, false)},
       {"rename-command", true, new MultiStringField(&rename_command_, std::vector<std::string>{})},
       {"auto-resize-block-and-sst", false, new YesNoField(&auto_resize_block_and_sst, true)},
+      {"lazyfree-lazy-user-del", false, new YesNoField(&lazyfree_lazy_user_del, false)},
+      {"auto-tune-enabled", false, new YesNoField(&auto_tune_enabled, false)},
+      {"auto-tune-max-write-buffer-size", false, new IntField(&auto_tune_max_write_buffer_size, 256, 0, 4096)},
+      {"auto-tune-max-background-jobs", false, new IntField(&auto_tune_max_background_jobs, 8, 1, 32)},
+      {"namespace-column-families", false, new YesNoField(&namespace_column_families, false)},
+      {"namespace-block-cache-size", false, new IntField(&namespace_block_cache_size, 0, 0, INT_MAX)},
+      {"namespace-write-buffer-size", false, new IntField(&namespace_write_buffer_size, 0, 0, 4096)},
       {"fullsync-recv-file-delay", false, new IntField(&fullsync_recv_file_delay, 0, 0, INT_MAX)},
       {"cluster-enabled", true, new YesNoField(&cluster_enabled, false)},
       {"migrate-speed", false, new IntField(&migrate_speed, 4096, 0, INT_MAX)},
@@ -280,6 +349,10 @@ void Config::initFieldValidator() {
          compaction_checker_range.stop = stop;
          return Status::OK();
        }},
+      {"client-output-buffer-limit",
+       [](const std::string &k, const std::string &v) -> Status {
+         return ParseClientOutputBufferLimits(v).ToStatus();
+       }},
       {"rename-command",
        [](const std::string &k, const std::string &v) -> Status {
          std::vector<std::string> all_args = util::Split(v, "\n");
@@ -422,6 +495,17 @@ void Config::initFieldCallback() {
          }
          return Status::OK();
        }},
+      {"client-output-buffer-limit",
+       [this](Server *srv, const std::string &k, const std::string &v) -> Status {
+         client_output_buffer_limits = GET_OR_RET(ParseClientOutputBufferLimits(v));
+         return Status::OK();
+       }},
+      {"tracking-table-max-keys",
+       [this](Server *srv, const std::string &k, const std::string &v) -> Status {
+         if (!srv) return Status::OK();
+         srv->GetTrackingTable()->SetMaxKeys(tracking_table_max_keys);
+         return Status::OK();
+       }},
       {"slowlog-max-len",
        [this](Server *srv, const std::string &k, const std::string &v) -> Status {
          if (!srv) return Status::OK();
@@ -440,6 +524,12 @@ void Config::initFieldCallback() {
          srv->storage->SetIORateLimit(max_io_mb);
          return Status::OK();
        }},
+      {"metadata-cache-size",
+       [this](Server *srv, const std::string &k, const std::string &v) -> Status {
+         if (!srv) return Status::OK();
+         srv->storage->GetMetadataCache()->SetCapacity(static_cast<size_t>(metadata_cache_size) * MiB);
+         return Status::OK();
+       }},
       {"profiling-sample-record-max-len",
        [this](Server *srv, const std::string &k, const std::string &v) -> Status {
          if (!srv) return Status::OK();
@@ -489,6 +579,12 @@ void Config::initFieldCallback() {
          remove(nodes_file_path.data());
          return Status::OK();
        }},
+      {"auto-tune-enabled",
+       [this](Server *srv, const std::string &k, const std::string &v) -> Status {
+         if (!srv || auto_tune_enabled) return Status::OK();
+         // restore the configured options once the auto tuning was disabled
+         return srv->storage->ResetAutoTune();
+       }},
       {"rocksdb.target_file_size_base",
        [this](Server *srv, const std::string &k, const std::string &v) -> Status {
          if (!srv) return Status::OK();
@@ -23,6 +23,7 @@
 #include <rocksdb/options.h>
 #include <sys/resource.h>
 
+#include <array>
 #include <map>
 #include <memory>
 #include <set>
@@ -53,6 +54,21 @@ constexpr const uint32_t kDefaultPort = 6666;
 
 constexpr const char *kDefaultNamespace = "__namespace";
 
+enum ClientOutputBufferClass {
+  kClientOutputBufferNormal = 0,
+  kClientOutputBufferPubsub,
+  kClientOutputBufferReplica,
+  kClientOutputBufferClasses
+};
+
+struct ClientOutputBufferLimit {
+  uint64_t hard_limit_bytes = 0;
+  uint64_t soft_limit_bytes = 0;
+  int soft_limit_seconds = 0;
+
+  bool Enabled() const { return hard_limit_bytes != 0 || soft_limit_bytes != 0; }
+};
+
 struct CompactionCheckerRange {
  public:
   int start;
@@ -89,10 +105,15 @@ struct Config {
   int tls_session_cache_size = 1024 * 20;
   int tls_session_cache_timeout = 300;
   int workers = 0;
+  bool io_epoll_changelist = false;
+  bool worker_cpu_affinity = false;
+  int io_max_single_rw_kb = 16;
   int timeout = 0;
   int log_level = 0;
   int backlog = 511;
   int maxclients = 10000;
+  std::array<ClientOutputBufferLimit, kClientOutputBufferClasses> client_output_buffer_limits;
+  int tracking_table_max_keys = 1000000;
   int max_backup_to_keep = 1;
   int max_backup_keep_hours = 24;
   int slowlog_log_slower_than = 100000;
@@ -103,13 +124,25 @@ struct Config {
   bool slave_serve_stale_data = true;
   bool slave_empty_db_before_fullsync = false;
   int slave_priority = 100;
+  int slave_apply_group_size = 1;
   int max_db_size = 0;
   int max_replication_mb = 0;
+  int replication_compression = 0;
+  int fullsync_fetch_concurrency = 4;
+  int fullsync_fetch_chunk_mb = 64;
   int max_io_mb = 0;
+  int metadata_cache_size = 0;
   int max_bitmap_to_string_mb = 16;
   bool master_use_repl_port = false;
   bool purge_backup_on_fullsync = false;
   bool auto_resize_block_and_sst = true;
+  bool lazyfree_lazy_user_del = false;
+  bool auto_tune_enabled = false;
+  int auto_tune_max_write_buffer_size = 256;
+  int auto_tune_max_background_jobs = 8;
+  bool namespace_column_families = false;
+  int namespace_block_cache_size = 0;
+  int namespace_write_buffer_size = 0;
   int fullsync_recv_file_delay = 0;
   bool use_rsid_psync = false;
   std::vector<std::string> binds;
@@ -133,6 +166,7 @@ struct Config {
   CompactionCheckerRange compaction_checker_range{-1, -1};
   int64_t force_compact_file_age;
   int force_compact_file_min_deleted_percentage;
+  int compaction_checker_concurrency = 2;
   std::map<std::string, std::string> tokens;
   std::string replica_announce_ip;
   uint32_t replica_announce_port = 0;
@@ -152,6 +186,8 @@ struct Config {
   std::set<std::string> profiling_sample_commands;
   bool profiling_sample_all_commands = false;
 
+  int key_stats_sample_ratio = 0;
+
   struct RocksDB {
     int block_size;
     bool cache_index_and_filter_blocks;
@@ -222,6 +258,7 @@ struct Config {
   std::string compact_cron_str_;
   std::string bgsave_cron_str_;
   std::string compaction_checker_range_str_;
+  std::string client_output_buffer_limit_str_;
   std::string profiling_sample_commands_str_;
   std::map<std::string, std::unique_ptr<ConfigField>> fields_;
   std::vector<std::string> rename_command_;
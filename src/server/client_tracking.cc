@@ -0,0 +1,175 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "client_tracking.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <string_view>
+
+bool TrackingClient::MatchPrefix(const std::string &key) const {
+  if (prefixes.empty()) return true;
+
+  return std::any_of(prefixes.begin(), prefixes.end(),
+                     [&key](const std::string &prefix) { return key.compare(0, prefix.size(), prefix) == 0; });
+}
+
+uint64_t ClientTrackingTable::keyHash(const std::string &ns, const std::string &key) {
+  uint64_t ns_hash = std::hash<std::string_view>{}(ns);
+  uint64_t key_hash = std::hash<std::string_view>{}(key);
+  return key_hash ^ (ns_hash + 0x9e3779b97f4a7c15ULL + (key_hash << 6) + (key_hash >> 2));
+}
+
+void ClientTrackingTable::AddClient(const std::shared_ptr<TrackingClient> &client) {
+  std::lock_guard<std::mutex> guard(clients_mu_);
+  if (!clients_.emplace(client->id, client).second) return;
+
+  if (client->bcast) bcast_clients_.emplace_back(client);
+  num_clients_.store(clients_.size(), std::memory_order_relaxed);
+}
+
+void ClientTrackingTable::RemoveClient(const std::shared_ptr<TrackingClient> &client) {
+  // the keys tracked by this client are removed lazily, they're skipped
+  // while being invalidated since the client was disabled
+  client->enabled = false;
+
+  std::lock_guard<std::mutex> guard(clients_mu_);
+  auto iter = clients_.find(client->id);
+  if (iter == clients_.end() || iter->second != client) return;
+
+  clients_.erase(iter);
+  if (client->bcast) {
+    bcast_clients_.erase(std::remove(bcast_clients_.begin(), bcast_clients_.end(), client), bcast_clients_.end());
+  }
+  num_clients_.store(clients_.size(), std::memory_order_relaxed);
+}
+
+std::vector<TrackingInvalidation> ClientTrackingTable::TrackKey(const std::shared_ptr<TrackingClient> &client,
+                                                                const std::string &ns, const std::string &key) {
+  std::vector<TrackingInvalidation> invalidations;
+  uint64_t hash = keyHash(ns, key);
+  auto &shard = getShard(hash);
+
+  std::lock_guard<std::mutex> guard(shard.mu);
+  auto iter = shard.keys.find(hash);
+  if (iter != shard.keys.end() && (iter->second.ns != ns || iter->second.key != key)) {
+    // hash collision, the old key must be invalidated before it's forgotten
+    removeKey(&shard, iter, 0, &invalidations);
+    iter = shard.keys.end();
+  }
+
+  if (iter == shard.keys.end()) {
+    shard.lru.emplace_back(hash);
+    iter = shard.keys.emplace(hash, TrackedKey{ns, key, {}, std::prev(shard.lru.end())}).first;
+    num_keys_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    shard.lru.splice(shard.lru.end(), shard.lru, iter->second.lru_iter);
+  }
+
+  auto &clients = iter->second.clients;
+  if (std::find(clients.begin(), clients.end(), client) == clients.end()) {
+    clients.emplace_back(client);
+  }
+
+  evictIfNeeded(&shard, &invalidations);
+  return invalidations;
+}
+
+std::vector<TrackingInvalidation> ClientTrackingTable::InvalidateKey(const std::string &ns, const std::string &key,
+                                                                     uint64_t writer_id) {
+  std::vector<TrackingInvalidation> invalidations;
+
+  if (num_keys_.load(std::memory_order_relaxed) > 0) {
+    uint64_t hash = keyHash(ns, key);
+    auto &shard = getShard(hash);
+
+    std::lock_guard<std::mutex> guard(shard.mu);
+    if (auto iter = shard.keys.find(hash); iter != shard.keys.end()) {
+      removeKey(&shard, iter, writer_id, &invalidations);
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(clients_mu_);
+  for (const auto &client : bcast_clients_) {
+    if (client->noloop && client->id == writer_id) continue;
+    if (client->ns != ns || !client->MatchPrefix(key)) continue;
+
+    invalidations.emplace_back(TrackingInvalidation{client, false, {key}});
+  }
+  return invalidations;
+}
+
+std::vector<TrackingInvalidation> ClientTrackingTable::InvalidateAll() {
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.mu);
+    num_keys_.fetch_sub(shard.keys.size(), std::memory_order_relaxed);
+    shard.keys.clear();
+    shard.lru.clear();
+  }
+
+  std::vector<TrackingInvalidation> invalidations;
+  std::lock_guard<std::mutex> guard(clients_mu_);
+  invalidations.reserve(clients_.size());
+  for (const auto &iter : clients_) {
+    invalidations.emplace_back(TrackingInvalidation{iter.second, true, {}});
+  }
+  return invalidations;
+}
+
+void ClientTrackingTable::SetMaxKeys(size_t max_keys) {
+  // the shards which are over the new limit would be shrunk while tracking new keys
+  max_keys_.store(max_keys, std::memory_order_relaxed);
+}
+
+size_t ClientTrackingTable::NumPrefixes() {
+  std::lock_guard<std::mutex> guard(clients_mu_);
+  size_t num = 0;
+  for (const auto &client : bcast_clients_) {
+    num += std::max<size_t>(client->prefixes.size(), 1);
+  }
+  return num;
+}
+
+void ClientTrackingTable::evictIfNeeded(Shard *shard, std::vector<TrackingInvalidation> *invalidations) {
+  size_t max_keys = max_keys_.load(std::memory_order_relaxed);
+  if (max_keys == 0) return;  // no limit
+
+  size_t max_keys_per_shard = std::max<size_t>(max_keys / kShards, 1);
+  while (shard->keys.size() > max_keys_per_shard) {
+    auto iter = shard->keys.find(shard->lru.front());
+    removeKey(shard, iter, 0, invalidations);
+  }
+}
+
+void ClientTrackingTable::removeKey(Shard *shard, std::unordered_map<uint64_t, TrackedKey>::iterator iter,
+                                    uint64_t writer_id, std::vector<TrackingInvalidation> *invalidations) {
+  auto &tracked = iter->second;
+  for (auto &client : tracked.clients) {
+    if (!client->enabled) continue;
+    if (client->noloop && client->id == writer_id) continue;
+
+    invalidations->emplace_back(TrackingInvalidation{std::move(client), false, {tracked.key}});
+  }
+
+  shard->lru.erase(tracked.lru_iter);
+  shard->keys.erase(iter);
+  num_keys_.fetch_sub(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Worker;
+
+// the RESP2 clients receive the invalidation messages as if they subscribed this channel
+constexpr const char *kTrackingInvalidateChannel = "__redis__:invalidate";
+
+// TrackingClient is the state of a connection which enabled CLIENT TRACKING, it's shared
+// by the tracking table, so that the invalidation messages can be delivered without
+// touching the connection from other threads.
+struct TrackingClient {
+  Worker *owner = nullptr;
+  int fd = -1;
+  uint64_t id = 0;
+  std::string ns;
+  bool bcast = false;
+  bool noloop = false;
+  std::vector<std::string> prefixes;
+  // the invalidation messages are sent to the redirect client if it's set
+  Worker *redirect_owner = nullptr;
+  int redirect_fd = -1;
+  uint64_t redirect_id = 0;
+  std::atomic<bool> enabled = true;
+
+  bool MatchPrefix(const std::string &key) const;
+};
+
+struct TrackingInvalidation {
+  std::shared_ptr<TrackingClient> client;
+  // all keys should be invalidated if the flush_all is true, e.g. FLUSHALL
+  bool flush_all = false;
+  std::vector<std::string> keys;
+};
+
+// ClientTrackingTable remembers which clients read which keys, it's keyed by the hash of
+// the namespace and key. Only the hash is trusted to locate the entry, a different key
+// with the same hash takes over the entry after the old key was invalidated. The number
+// of tracked keys is bounded and the least recently read keys are evicted first, their
+// clients would receive the invalidation messages as if the keys were modified.
+class ClientTrackingTable {
+ public:
+  explicit ClientTrackingTable(size_t max_keys) : max_keys_(max_keys) {}
+
+  void AddClient(const std::shared_ptr<TrackingClient> &client);
+  void RemoveClient(const std::shared_ptr<TrackingClient> &client);
+
+  // TrackKey would be called after a tracking client read the key
+  std::vector<TrackingInvalidation> TrackKey(const std::shared_ptr<TrackingClient> &client, const std::string &ns,
+                                             const std::string &key);
+  // InvalidateKey would be called after the key was modified by the client with writer_id
+  std::vector<TrackingInvalidation> InvalidateKey(const std::string &ns, const std::string &key, uint64_t writer_id);
+  std::vector<TrackingInvalidation> InvalidateAll();
+
+  void SetMaxKeys(size_t max_keys);
+  bool Empty() const { return num_clients_.load(std::memory_order_relaxed) == 0; }
+  size_t NumClients() const { return num_clients_.load(std::memory_order_relaxed); }
+  size_t NumKeys() const { return num_keys_.load(std::memory_order_relaxed); }
+  size_t NumPrefixes();
+
+ private:
+  static constexpr size_t kShards = 16;
+
+  struct TrackedKey {
+    std::string ns;
+    std::string key;
+    std::vector<std::shared_ptr<TrackingClient>> clients;
+    std::list<uint64_t>::iterator lru_iter;
+  };
+
+  struct Shard {
+    std::mutex mu;
+    std::unordered_map<uint64_t, TrackedKey> keys;
+    // the least recently read key is at the front
+    std::list<uint64_t> lru;
+  };
+
+  std::atomic<size_t> max_keys_;
+  std::atomic<size_t> num_keys_ = 0;
+  std::atomic<size_t> num_clients_ = 0;
+  std::array<Shard, kShards> shards_;
+
+  std::mutex clients_mu_;
+  std::map<uint64_t, std::shared_ptr<TrackingClient>> clients_;
+  std::vector<std::shared_ptr<TrackingClient>> bcast_clients_;
+
+  static uint64_t keyHash(const std::string &ns, const std::string &key);
+  Shard &getShard(uint64_t hash) { return shards_[hash % kShards]; }
+  void evictIfNeeded(Shard *shard, std::vector<TrackingInvalidation> *invalidations);
+  void removeKey(Shard *shard, std::unordered_map<uint64_t, TrackedKey>::iterator iter, uint64_t writer_id,
+                 std::vector<TrackingInvalidation> *invalidations);
+};
@@ -23,6 +23,8 @@
 #include <rocksdb/perf_context.h>
 
 #include <mutex>
+#include <optional>
+#include <random>
 #include <shared_mutex>
 
 #include "commands/commander.h"
@@ -58,6 +60,7 @@ Connection::~Connection() {
   // unsubscribe all channels and patterns if exists
   UnsubscribeAll();
   PUnsubscribeAll();
+  svr_->DisableTracking(this);
 }
 
 std::string Connection::ToString() {
@@ -96,7 +99,10 @@ void Connection::OnWrite(struct bufferevent *bev, void *ctx) {
   auto conn = static_cast<Connection *>(ctx);
   if (conn->IsFlagEnabled(kCloseAfterReply) || conn->IsFlagEnabled(kCloseAsync)) {
     conn->Close();
+    return;
   }
+  // the output buffer was drained, so it's safe to accept new commands again
+  conn->resumeReading();
 }
 
 void Connection::OnEvent(bufferevent *bev, int16_t events, void *ctx) {
@@ -127,6 +133,70 @@ void Connection::OnEvent(bufferevent *bev, int16_t events, void *ctx) {
 void Connection::Reply(const std::string &msg) {
   owner_->svr->stats.IncrOutbondBytes(msg.size());
   redis::Reply(bufferevent_get_output(bev_), msg);
+  CheckOutputBufferLimits();
+}
+
+void Connection::CheckOutputBufferLimits() {
+  if (IsFlagEnabled(kCloseAfterReply) || IsFlagEnabled(kCloseAsync)) return;
+
+  int klass = kClientOutputBufferNormal;
+  auto type = GetClientType();
+  if (type == kTypeSlave) {
+    klass = kClientOutputBufferReplica;
+  } else if (type == kTypePubsub) {
+    klass = kClientOutputBufferPubsub;
+  }
+  const auto &limit = svr_->GetConfig()->client_output_buffer_limits[klass];
+  if (!limit.Enabled()) return;
+
+  size_t obuf_len = evbuffer_get_length(Output());
+  if (limit.hard_limit_bytes > 0 && obuf_len >= limit.hard_limit_bytes) {
+    closeOnOutputBufferOverflow(obuf_len);
+    return;
+  }
+  if (limit.soft_limit_bytes == 0 || obuf_len < limit.soft_limit_bytes) {
+    output_soft_limit_since_ = 0;
+    return;
+  }
+
+  int64_t now = util::GetTimeStamp();
+  int64_t since = 0;
+  if (output_soft_limit_since_.compare_exchange_strong(since, now)) {
+    pauseReading();
+  } else if (limit.soft_limit_seconds > 0 && now - since >= limit.soft_limit_seconds) {
+    closeOnOutputBufferOverflow(obuf_len);
+  }
+}
+
+void Connection::closeOnOutputBufferOverflow(size_t obuf_len) {
+  LOG(WARNING) << "[connection] Going to close the client: " << GetAddr()
+               << ", while its output buffer overcame the limits, obuf=" << obuf_len;
+  svr_->stats.IncrOutputBufferLimitDisconnections();
+  EnableFlag(kCloseAfterReply);
+  if (IsFlagEnabled(kSlave)) return;  // don't enable any event in slave connection
+
+  // the pending replies won't be read by the client anyway, drop them to release
+  // the memory right now and let the write event close the connection ASAP
+  auto output = Output();
+  evbuffer_drain(output, evbuffer_get_length(output));
+  bufferevent_enable(bev_, EV_WRITE);
+  // nothing is left to write, so the write callback must be triggered manually
+  bufferevent_trigger(bev_, EV_WRITE, BEV_TRIG_IGNORE_WATERMARKS | BEV_TRIG_DEFER_CALLBACKS);
+}
+
+void Connection::pauseReading() {
+  if (IsFlagEnabled(kSlave) || input_paused_.exchange(true)) return;
+  bufferevent_disable(bev_, EV_READ);
+}
+
+void Connection::resumeReading() {
+  if (!input_paused_.exchange(false)) return;
+  output_soft_limit_since_ = 0;
+  bufferevent_enable(bev_, EV_READ);
+  // commands may have been buffered before the reading was paused
+  if (evbuffer_get_length(Input()) > 0) {
+    bufferevent_trigger(bev_, EV_READ, BEV_TRIG_DEFER_CALLBACKS);
+  }
 }
 
 void Connection::SendFile(int fd) {
@@ -253,6 +323,12 @@ void Connection::PUnsubscribeAll(const UnsubscribeCallback &reply) {
 
 int Connection::PSubscriptionsCount() { return static_cast<int>(subscribe_patterns_.size()); }
 
+// std::rand() takes a global lock, so the workers sample with their own generators
+static bool IsSampled(int ratio) {
+  thread_local std::minstd_rand gen(std::random_device{}());
+  return static_cast<int>(gen() % 100) < ratio;
+}
+
 bool Connection::IsProfilingEnabled(const std::string &cmd) {
   auto config = svr_->GetConfig();
   if (config->profiling_sample_ratio == 0) return false;
@@ -262,7 +338,7 @@ bool Connection::IsProfilingEnabled(const std::string &cmd) {
     return false;
   }
 
-  if (config->profiling_sample_ratio == 100 || std::rand() % 100 <= config->profiling_sample_ratio) {
+  if (config->profiling_sample_ratio == 100 || IsSampled(config->profiling_sample_ratio)) {
     rocksdb::SetPerfLevel(rocksdb::PerfLevel::kEnableTimeExceptForMutex);
     rocksdb::get_perf_context()->Reset();
     rocksdb::get_iostats_context()->Reset();
@@ -272,7 +348,16 @@ bool Connection::IsProfilingEnabled(const std::string &cmd) {
   return false;
 }
 
-void Connection::RecordProfilingSampleIfNeed(const std::string &cmd, uint64_t duration) {
+void Connection::RecordProfilingSampleIfNeed(const std::string &cmd, int cmd_id, uint64_t duration) {
+  // all samples are aggregated into the command stats, while only the slow ones are recorded
+  auto perf = rocksdb::get_perf_context();
+  auto iostats = rocksdb::get_iostats_context();
+  svr_->stats.IncrPerfStats({perf->block_cache_hit_count, perf->block_read_count, perf->block_read_byte,
+                             perf->bloom_sst_miss_count, perf->get_from_memtable_count, perf->iter_seek_count,
+                             perf->iter_next_count + perf->iter_prev_count, perf->internal_key_skipped_count,
+                             perf->internal_delete_skipped_count, iostats->bytes_read},
+                            cmd_id);
+
   int threshold = svr_->GetConfig()->profiling_sample_record_threshold_ms;
   if (threshold > 0 && static_cast<int>(duration / 1000) < threshold) {
     rocksdb::SetPerfLevel(rocksdb::PerfLevel::kDisable);
@@ -284,7 +369,7 @@ void Connection::RecordProfilingSampleIfNeed(const std::string &cmd, uint64_t du
   rocksdb::SetPerfLevel(rocksdb::PerfLevel::kDisable);
   if (perf_context.empty()) return;  // request without db operation
 
-  auto entry = std::unique_ptr<PerfEntry>();
+  auto entry = std::make_unique<PerfEntry>();
   entry->cmd_name = cmd;
   entry->duration = duration;
   entry->iostats_context = std::move(iostats_context);
@@ -297,7 +382,7 @@ void Connection::ExecuteCommands(std::deque<CommandTokens> *to_process_cmds) {
   std::string reply, password = config->requirepass;
 
   while (!to_process_cmds->empty()) {
-    auto cmd_tokens = to_process_cmds->front();
+    auto cmd_tokens = std::move(to_process_cmds->front());
     to_process_cmds->pop_front();
 
     if (IsFlagEnabled(redis::Connection::kCloseAfterReply) && !IsFlagEnabled(Connection::kMultiExec)) break;
@@ -309,9 +394,11 @@ void Connection::ExecuteCommands(std::deque<CommandTokens> *to_process_cmds) {
       continue;
     }
 
+    const auto attributes = current_cmd->GetAttributes();
+    const auto &cmd_name = attributes->name;
+
     if (GetNamespace().empty()) {
-      if (!password.empty() && util::ToLower(cmd_tokens.front()) != "auth" &&
-          util::ToLower(cmd_tokens.front()) != "hello") {
+      if (!password.empty() && cmd_name != "auth" && cmd_name != "hello") {
         Reply(redis::Error("NOAUTH Authentication required."));
         continue;
       }
@@ -322,9 +409,6 @@ void Connection::ExecuteCommands(std::deque<CommandTokens> *to_process_cmds) {
       }
     }
 
-    const auto attributes = current_cmd->GetAttributes();
-    auto cmd_name = attributes->name;
-
     std::shared_lock<std::shared_mutex> concurrency;  // Allow concurrency
     std::unique_lock<std::shared_mutex> exclusivity;  // Need exclusivity
     // If the command needs to process exclusively, we need to get 'ExclusivityGuard'
@@ -410,17 +494,26 @@ void Connection::ExecuteCommands(std::deque<CommandTokens> *to_process_cmds) {
     }
 
     SetLastCmd(cmd_name);
-    svr_->stats.IncrCalls(cmd_name);
+    svr_->stats.IncrCalls(attributes->id);
+
+    // The keys are tracked before being read, or the write from other workers in between
+    // wouldn't invalidate them and the client would keep the stale values
+    if (tracking) svr_->TrackKeysFromArgs(this, cmd_tokens, *attributes);
+
+    // the sampled write commands record the metadata they write, which gives the sizes of the keys
+    bool is_key_stats_sampled = config->key_stats_sample_ratio > 0 && IsSampled(config->key_stats_sample_ratio);
+    std::optional<engine::WrittenMetadataRecorder> written_metadata;
+    if (is_key_stats_sampled && attributes->IsWrite()) written_metadata.emplace();
 
     auto start = std::chrono::high_resolution_clock::now();
     bool is_profiling = IsProfilingEnabled(cmd_name);
     s = current_cmd->Execute(svr_, this, &reply);
     auto end = std::chrono::high_resolution_clock::now();
     uint64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-    if (is_profiling) RecordProfilingSampleIfNeed(cmd_name, duration);
+    if (is_profiling) RecordProfilingSampleIfNeed(cmd_name, attributes->id, duration);
 
     svr_->SlowlogPushEntryIfNeeded(&cmd_tokens, duration);
-    svr_->stats.IncrLatency(static_cast<uint64_t>(duration), cmd_name);
+    svr_->stats.IncrLatency(static_cast<uint64_t>(duration), attributes->id);
     svr_->FeedMonitorConns(this, cmd_tokens);
 
     // Break the execution loop when occurring the blocking command like BLPOP or BRPOP,
@@ -435,7 +528,10 @@ void Connection::ExecuteCommands(std::deque<CommandTokens> *to_process_cmds) {
       continue;
     }
 
-    svr_->UpdateWatchedKeysFromArgs(cmd_tokens, *attributes);
+    svr_->UpdateWatchedKeysFromArgs(this, cmd_tokens, *attributes);
+    if (is_key_stats_sampled) {
+      svr_->RecordKeyStatsFromArgs(this, cmd_tokens, *attributes, written_metadata ? &*written_metadata : nullptr);
+    }
 
     if (!reply.empty()) Reply(reply);
     reply.clear();
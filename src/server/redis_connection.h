@@ -33,6 +33,7 @@
 #include "redis_request.h"
 
 class Worker;
+struct TrackingClient;
 
 namespace redis {
 
@@ -59,6 +60,28 @@ class Connection {
   static void OnEvent(bufferevent *bev, int16_t events, void *ctx);
   void Reply(const std::string &msg);
   void SendFile(int fd);
+  // close the client if its output buffer overcame the hard limit, or stayed over
+  // the soft limit for too long, the reading is paused while over the soft limit
+  void CheckOutputBufferLimits();
+
+  RESP GetProtocolVersion() const { return protocol_version_; }
+  void SetProtocolVersion(RESP version) { protocol_version_ = version; }
+  // the commands called by scripts always reply in RESP2 as Redis does, while the
+  // messages pushed to the connection still follow the protocol of the connection
+  RESP GetReplyProtocol() const { return in_script_call_ ? RESP::v2 : GetProtocolVersion(); }
+  void SetInScriptCall(bool in_script_call) { in_script_call_ = in_script_call; }
+  std::string NilString() const { return redis::NilString(GetReplyProtocol()); }
+  std::string Double(double d) const { return redis::Double(GetReplyProtocol(), d); }
+  std::string Bool(bool b) const { return redis::Bool(GetReplyProtocol(), b); }
+  std::string HeaderOfMap(size_t len) const { return redis::HeaderOfMap(GetReplyProtocol(), len); }
+  std::string HeaderOfSet(size_t len) const { return redis::HeaderOfSet(GetReplyProtocol(), len); }
+  std::string HeaderOfPush(size_t len) const { return redis::HeaderOfPush(GetReplyProtocol(), len); }
+  std::string MapOfBulkStrings(const std::vector<std::string> &elems) const {
+    return redis::MapOfBulkStrings(GetReplyProtocol(), elems);
+  }
+  std::string SetOfBulkStrings(const std::vector<std::string> &elems) const {
+    return redis::SetOfBulkStrings(GetReplyProtocol(), elems);
+  }
   std::string ToString();
 
   using UnsubscribeCallback = std::function<void(std::string, int)>;
@@ -93,6 +116,8 @@ class Connection {
   void SetAnnounceIP(std::string ip) { announce_ip_ = std::move(ip); }
   std::string GetAnnounceIP() { return !announce_ip_.empty() ? announce_ip_ : ip_; }
   std::string GetAnnounceAddr() { return GetAnnounceIP() + ":" + std::to_string(listening_port_); }
+  void SetReplCompression(rocksdb::CompressionType type) { repl_compression_ = type; }
+  rocksdb::CompressionType GetReplCompression() const { return repl_compression_; }
   uint64_t GetClientType();
   Server *GetServer() { return svr_; }
 
@@ -113,7 +138,7 @@ class Connection {
   bufferevent *GetBufferEvent() { return bev_; }
   void ExecuteCommands(std::deque<CommandTokens> *to_process_cmds);
   bool IsProfilingEnabled(const std::string &cmd);
-  void RecordProfilingSampleIfNeed(const std::string &cmd, uint64_t duration);
+  void RecordProfilingSampleIfNeed(const std::string &cmd, int cmd_id, uint64_t duration);
   void SetImporting() { importing_ = true; }
   bool IsImporting() const { return importing_; }
 
@@ -130,9 +155,16 @@ class Connection {
   std::set<std::string> watched_keys;
   std::atomic<bool> watched_keys_modified = false;
 
+  // it's set if the client side caching was enabled by CLIENT TRACKING
+  std::shared_ptr<TrackingClient> tracking;
+
  private:
   uint64_t id_ = 0;
   std::atomic<int> flags_ = 0;
+  // it may be read by other workers while delivering the push messages
+  std::atomic<RESP> protocol_version_ = RESP::v2;
+  // only touched by the thread executing the commands of the connection
+  bool in_script_call_ = false;
   std::string ns_;
   std::string name_;
   std::string ip_;
@@ -140,6 +172,7 @@ class Connection {
   uint32_t port_ = 0;
   std::string addr_;
   int listening_port_ = 0;
+  rocksdb::CompressionType repl_compression_ = rocksdb::kNoCompression;
   bool is_admin_ = false;
   bool need_free_bev_ = true;
   std::string last_cmd_;
@@ -158,6 +191,15 @@ class Connection {
   std::deque<redis::CommandTokens> multi_cmds_;
 
   bool importing_ = false;
+
+  // replies may be appended by other workers (e.g. PUBLISH), so the output
+  // buffer limit state must be safe to touch from any thread
+  std::atomic<int64_t> output_soft_limit_since_ = 0;
+  std::atomic<bool> input_paused_ = false;
+
+  void closeOnOutputBufferOverflow(size_t obuf_len);
+  void pauseReading();
+  void resumeReading();
 };
 
 }  // namespace redis
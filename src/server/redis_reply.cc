@@ -22,6 +22,8 @@
 
 #include <numeric>
 
+#include "string_util.h"
+
 namespace redis {
 
 void Reply(evbuffer *output, const std::string &data) { evbuffer_add(output, data.c_str(), data.length()); }
@@ -34,6 +36,30 @@ std::string BulkString(const std::string &data) { return "$" + std::to_string(da
 
 std::string NilString() { return "$-1" CRLF; }
 
+std::string NilString(RESP ver) { return ver == RESP::v3 ? "_" CRLF : NilString(); }
+
+std::string Double(RESP ver, double d) {
+  if (ver == RESP::v3) return "," + util::Float2String(d) + CRLF;
+  return BulkString(util::Float2String(d));
+}
+
+std::string Bool(RESP ver, bool b) {
+  if (ver == RESP::v3) return b ? "#t" CRLF : "#f" CRLF;
+  return Integer(b ? 1 : 0);
+}
+
+std::string HeaderOfMap(RESP ver, size_t len) {
+  return ver == RESP::v3 ? "%" + std::to_string(len) + CRLF : MultiLen(len * 2);
+}
+
+std::string HeaderOfSet(RESP ver, size_t len) {
+  return ver == RESP::v3 ? "~" + std::to_string(len) + CRLF : MultiLen(len);
+}
+
+std::string HeaderOfPush(RESP ver, size_t len) {
+  return ver == RESP::v3 ? ">" + std::to_string(len) + CRLF : MultiLen(len);
+}
+
 std::string MultiBulkString(const std::vector<std::string> &values, bool output_nil_for_empty_string) {
   std::string result = "*" + std::to_string(values.size()) + CRLF;
   for (const auto &value : values) {
@@ -67,6 +93,22 @@ std::string Array(const std::vector<std::string> &list) {
   return result;
 }
 
+std::string MapOfBulkStrings(RESP ver, const std::vector<std::string> &elems) {
+  std::string result = HeaderOfMap(ver, elems.size() / 2);
+  for (const auto &elem : elems) {
+    result += BulkString(elem);
+  }
+  return result;
+}
+
+std::string SetOfBulkStrings(RESP ver, const std::vector<std::string> &elems) {
+  std::string result = HeaderOfSet(ver, elems.size());
+  for (const auto &elem : elems) {
+    result += BulkString(elem);
+  }
+  return result;
+}
+
 std::string Command2RESP(const std::vector<std::string> &cmd_args) { return MultiBulkString(cmd_args, false); }
 
 }  // namespace redis
@@ -31,6 +31,9 @@
 
 namespace redis {
 
+// the protocol version negotiated by HELLO, it's RESP2 by default
+enum class RESP { v2, v3 };
+
 void Reply(evbuffer *output, const std::string &data);
 std::string SimpleString(const std::string &data);
 std::string Error(const std::string &err);
@@ -42,15 +45,27 @@ std::string Integer(T data) {
 
 std::string BulkString(const std::string &data);
 std::string NilString();
+std::string NilString(RESP ver);
+std::string Double(RESP ver, double d);
+std::string Bool(RESP ver, bool b);
 
 template <typename IntegerType>
 std::string MultiLen(IntegerType len) {
   return "*" + std::to_string(len) + CRLF;
 }
 
+// the RESP3 aggregate types fall back to the multi bulk in RESP2, a map with
+// len pairs is flattened to a multi bulk with 2 * len elements
+std::string HeaderOfMap(RESP ver, size_t len);
+std::string HeaderOfSet(RESP ver, size_t len);
+std::string HeaderOfPush(RESP ver, size_t len);
+
 std::string Array(const std::vector<std::string> &list);
 std::string MultiBulkString(const std::vector<std::string> &values, bool output_nil_for_empty_string = true);
 std::string MultiBulkString(const std::vector<std::string> &values, const std::vector<rocksdb::Status> &statuses);
+// the elems of map are the keys and values one after another
+std::string MapOfBulkStrings(RESP ver, const std::vector<std::string> &elems);
+std::string SetOfBulkStrings(RESP ver, const std::vector<std::string> &elems);
 std::string Command2RESP(const std::vector<std::string> &cmd_args);
 
 }  // namespace redis
@@ -28,8 +28,10 @@
 #include <sys/statvfs.h>
 #include <sys/utsname.h>
 
+#include <algorithm>
 #include <atomic>
 #include <iomanip>
+#include <iterator>
 #include <jsoncons/json.hpp>
 #include <memory>
 #include <mutex>
@@ -55,13 +57,12 @@
 constexpr const char *REDIS_VERSION = "4.0.0";
 
 Server::Server(engine::Storage *storage, Config *config)
-    : storage(storage), start_time_(util::GetTimeStamp()), config_(config) {
+    : storage(storage),
+      start_time_(util::GetTimeStamp()),
+      config_(config),
+      tracking_table_(config->tracking_table_max_keys) {
   // init commands stats here to prevent concurrent insert, and cause core
-  auto commands = redis::GetOriginalCommands();
-  for (const auto &iter : *commands) {
-    stats.commands_stats[iter.first].calls = 0;
-    stats.commands_stats[iter.first].latency = 0;
-  }
+  stats.InitCommandStats(redis::GetCommandNum());
 
 #ifdef ENABLE_OPENSSL
   // init ssl context
@@ -76,8 +77,10 @@ Server::Server(engine::Storage *storage, Config *config)
   // Init cluster
   cluster = std::make_unique<Cluster>(this, config_->binds, config_->port);
 
+  int num_cpus = static_cast<int>(std::thread::hardware_concurrency());
   for (int i = 0; i < config->workers; i++) {
-    auto worker = std::make_unique<Worker>(this, config);
+    int cpu = (config->worker_cpu_affinity && num_cpus > 0) ? i % num_cpus : -1;
+    auto worker = std::make_unique<Worker>(this, config, cpu);
     // multiple workers can't listen to the same unix socket, so
     // listen unix socket only from a single worker - the first one
     if (!config->unixsocket.empty() && i == 0) {
@@ -207,6 +210,31 @@ Status Server::Start() {
     }
   }));
 
+  lazyfree_thread_ = GET_OR_RET(util::CreateThread("lazyfree", [this] {
+    constexpr size_t kMaxReclaimEntries = 128;
+    bool drained = true;
+
+    while (!stop_) {
+      // Sleep while there's nothing left to reclaim
+      if (drained) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      // the replicas reclaim the subkeys by the range deletions replicated from the master
+      drained = true;
+      if (is_loading_ || IsSlave()) continue;
+
+      // To guarantee accessing DB safely
+      auto guard = storage->ReadLockGuard();
+      if (storage->IsClosing()) continue;
+
+      auto reclaimed = storage->ReclaimDeletedSubKeys(kMaxReclaimEntries);
+      if (!reclaimed) {
+        LOG(WARNING) << "[lazyfree] Failed to reclaim the subkeys of the deleted keys: " << reclaimed.Msg();
+        continue;
+      }
+      drained = *reclaimed < kMaxReclaimEntries;
+    }
+  }));
+
   memory_startup_use_.store(Stats::GetMemoryRSS(), std::memory_order_relaxed);
   LOG(INFO) << "[server] Ready to accept connections";
 
@@ -242,6 +270,9 @@ void Server::Join() {
   if (auto s = util::ThreadJoin(compaction_checker_thread_); !s) {
     LOG(WARNING) << "Compaction checker thread operation failed: " << s.Msg();
   }
+  if (auto s = util::ThreadJoin(lazyfree_thread_); !s) {
+    LOG(WARNING) << "Lazyfree thread operation failed: " << s.Msg();
+  }
 }
 
 Status Server::AddMaster(const std::string &host, uint32_t port, bool force_reconnect) {
@@ -321,6 +352,9 @@ void Server::DisconnectSlaves() {
     slave_threads_.pop_front();
     slave_thread->Join();
   }
+
+  // The sequences may be reused after the DB was restored, so drop the cached batches
+  repl_batch_cache_.Clear();
 }
 
 void Server::CleanupExitedSlaves() {
@@ -373,12 +407,13 @@ int Server::PublishMessage(const std::string &channel, const std::string &msg) {
   pubsub_channels_mu_.unlock();
 
   std::string channel_reply;
-  channel_reply.append(redis::MultiLen(3));
   channel_reply.append(redis::BulkString("message"));
   channel_reply.append(redis::BulkString(channel));
   channel_reply.append(redis::BulkString(msg));
+  std::string channel_push = redis::HeaderOfPush(redis::RESP::v3, 3) + channel_reply;
+  channel_reply = redis::MultiLen(3) + channel_reply;
   for (const auto &conn_ctx : to_publish_conn_ctxs) {
-    auto s = conn_ctx.owner->Reply(conn_ctx.fd, channel_reply);
+    auto s = conn_ctx.owner->Push(conn_ctx.fd, channel_reply, channel_push);
     if (s.IsOK()) {
       cnt++;
     }
@@ -387,12 +422,12 @@ int Server::PublishMessage(const std::string &channel, const std::string &msg) {
   // We should publish corresponding pattern and message for connections
   for (const auto &conn_ctx : to_publish_patterns_conn_ctxs) {
     std::string pattern_reply;
-    pattern_reply.append(redis::MultiLen(4));
     pattern_reply.append(redis::BulkString("pmessage"));
     pattern_reply.append(redis::BulkString(patterns[index++]));
     pattern_reply.append(redis::BulkString(channel));
     pattern_reply.append(redis::BulkString(msg));
-    auto s = conn_ctx.owner->Reply(conn_ctx.fd, pattern_reply);
+    auto s = conn_ctx.owner->Push(conn_ctx.fd, redis::MultiLen(4) + pattern_reply,
+                                  redis::HeaderOfPush(redis::RESP::v3, 4) + pattern_reply);
     if (s.IsOK()) {
       cnt++;
     }
@@ -491,34 +526,32 @@ void Server::PUnsubscribeChannel(const std::string &pattern, redis::Connection *
 }
 
 void Server::BlockOnKey(const std::string &key, redis::Connection *conn) {
-  std::lock_guard<std::mutex> guard(blocking_keys_mu_);
-
-  auto conn_ctx = new ConnContext(conn->Owner(), conn->GetFD());
-  conn_ctxs_[conn_ctx] = true;
-
-  if (auto iter = blocking_keys_.find(key); iter == blocking_keys_.end()) {
-    blocking_keys_.emplace(key, std::list<ConnContext *>{conn_ctx});
-  } else {
-    iter->second.emplace_back(conn_ctx);
+  auto &shard = blockingShard(key);
+  {
+    std::lock_guard<std::mutex> guard(shard.mu);
+    blocking_key_waiters_++;
+    shard.keys[key].emplace_back(conn->Owner(), conn->GetFD());
   }
 
   IncrBlockedClientNum();
 }
 
 void Server::UnblockOnKey(const std::string &key, redis::Connection *conn) {
-  std::lock_guard<std::mutex> guard(blocking_keys_mu_);
+  auto &shard = blockingShard(key);
+  std::lock_guard<std::mutex> guard(shard.mu);
 
-  auto iter = blocking_keys_.find(key);
-  if (iter == blocking_keys_.end()) {
+  auto iter = shard.keys.find(key);
+  if (iter == shard.keys.end()) {
     return;
   }
 
-  for (const auto &conn_ctx : iter->second) {
-    if (conn->GetFD() == conn_ctx->fd && conn->Owner() == conn_ctx->owner) {
-      delConnContext(conn_ctx);
-      iter->second.remove(conn_ctx);
-      if (iter->second.empty()) {
-        blocking_keys_.erase(iter);
+  auto &conn_ctxs = iter->second;
+  for (auto it = conn_ctxs.begin(); it != conn_ctxs.end(); ++it) {
+    if (conn->GetFD() == it->fd && conn->Owner() == it->owner) {
+      conn_ctxs.erase(it);
+      blocking_key_waiters_--;
+      if (conn_ctxs.empty()) {
+        shard.keys.erase(iter);
       }
       break;
     }
@@ -529,71 +562,76 @@ void Server::UnblockOnKey(const std::string &key, redis::Connection *conn) {
 
 void Server::BlockOnStreams(const std::vector<std::string> &keys, const std::vector<redis::StreamEntryID> &entry_ids,
                             redis::Connection *conn) {
-  std::lock_guard<std::mutex> guard(blocking_keys_mu_);
-
   IncrBlockedClientNum();
 
   for (size_t i = 0; i < keys.size(); ++i) {
     auto consumer = std::make_shared<StreamConsumer>(conn->Owner(), conn->GetFD(), conn->GetNamespace(), entry_ids[i]);
-    if (auto iter = blocked_stream_consumers_.find(keys[i]); iter == blocked_stream_consumers_.end()) {
-      std::set<std::shared_ptr<StreamConsumer>> consumers;
-      consumers.insert(consumer);
-      blocked_stream_consumers_.emplace(keys[i], consumers);
-    } else {
-      iter->second.insert(consumer);
-    }
+    auto &shard = blockingShard(keys[i]);
+    std::lock_guard<std::mutex> guard(shard.mu);
+    blocked_stream_waiters_++;
+    shard.stream_consumers[keys[i]].insert(consumer);
   }
 }
 
 void Server::UnblockOnStreams(const std::vector<std::string> &keys, redis::Connection *conn) {
-  std::lock_guard<std::mutex> guard(blocking_keys_mu_);
-
   DecrBlockedClientNum();
 
   for (const auto &key : keys) {
-    auto iter = blocked_stream_consumers_.find(key);
-    if (iter == blocked_stream_consumers_.end()) {
+    auto &shard = blockingShard(key);
+    std::lock_guard<std::mutex> guard(shard.mu);
+    auto iter = shard.stream_consumers.find(key);
+    if (iter == shard.stream_consumers.end()) {
       continue;
     }
 
-    for (auto it = iter->second.begin(); it != iter->second.end();) {
+    for (auto it = iter->second.begin(); it != iter->second.end(); ++it) {
       const auto &consumer = *it;
       if (conn->GetFD() == consumer->fd && conn->Owner() == consumer->owner) {
         iter->second.erase(it);
+        blocked_stream_waiters_--;
         if (iter->second.empty()) {
-          blocked_stream_consumers_.erase(iter);
+          shard.stream_consumers.erase(iter);
         }
         break;
       }
-      ++it;
     }
   }
 }
 
 void Server::WakeupBlockingConns(const std::string &key, size_t n_conns) {
-  std::lock_guard<std::mutex> guard(blocking_keys_mu_);
+  // fast path for the most common case that no client is blocking on any key
+  if (blocking_key_waiters_ == 0) return;
 
-  auto iter = blocking_keys_.find(key);
-  if (iter == blocking_keys_.end() || iter->second.empty()) {
+  auto &shard = blockingShard(key);
+  std::lock_guard<std::mutex> guard(shard.mu);
+
+  auto iter = shard.keys.find(key);
+  if (iter == shard.keys.end() || iter->second.empty()) {
     return;
   }
 
   while (n_conns-- && !iter->second.empty()) {
-    auto conn_ctx = iter->second.front();
-    auto s = conn_ctx->owner->EnableWriteEvent(conn_ctx->fd);
+    const auto &conn_ctx = iter->second.front();
+    auto s = conn_ctx.owner->EnableWriteEvent(conn_ctx.fd);
     if (!s.IsOK()) {
-      LOG(ERROR) << "[server] Failed to enable write event on blocked client " << conn_ctx->fd << ": " << s.Msg();
+      LOG(ERROR) << "[server] Failed to enable write event on blocked client " << conn_ctx.fd << ": " << s.Msg();
     }
-    delConnContext(conn_ctx);
     iter->second.pop_front();
+    blocking_key_waiters_--;
+  }
+  if (iter->second.empty()) {
+    shard.keys.erase(iter);
   }
 }
 
 void Server::OnEntryAddedToStream(const std::string &ns, const std::string &key, const redis::StreamEntryID &entry_id) {
-  std::lock_guard<std::mutex> guard(blocking_keys_mu_);
+  if (blocked_stream_waiters_ == 0) return;
 
-  auto iter = blocked_stream_consumers_.find(key);
-  if (iter == blocked_stream_consumers_.end() || iter->second.empty()) {
+  auto &shard = blockingShard(key);
+  std::lock_guard<std::mutex> guard(shard.mu);
+
+  auto iter = shard.stream_consumers.find(key);
+  if (iter == shard.stream_consumers.end() || iter->second.empty()) {
     return;
   }
 
@@ -606,10 +644,14 @@ void Server::OnEntryAddedToStream(const std::string &ns, const std::string &key,
                    << s.Msg();
       }
       it = iter->second.erase(it);
+      blocked_stream_waiters_--;
     } else {
       ++it;
     }
   }
+  if (iter->second.empty()) {
+    shard.stream_consumers.erase(iter);
+  }
 }
 
 void Server::delConnContext(ConnContext *c) {
@@ -746,6 +788,17 @@ void Server::cron() {
       storage->SetDBInRetryableIOError(false);
     }
 
+    // tune the rocksdb options every 30s
+    if (counter != 0 && counter % 300 == 0 && config_->auto_tune_enabled) {
+      auto s = storage->AutoTune();
+      if (!s.IsOK()) LOG(WARNING) << "[server] Failed to auto tune the rocksdb options: " << s.Msg();
+    }
+
+    // decay the hot keys every minute, so the keys which are no longer hot would fade out
+    if (counter != 0 && counter % 600 == 0) {
+      hot_keys_.Decay();
+    }
+
     CleanupExitedSlaves();
     recordInstantaneousMetrics();
   }
@@ -772,7 +825,15 @@ void Server::GetRocksDBInfo(std::string *info) {
   db->GetAggregatedIntProperty("rocksdb.num-live-versions", &num_live_versions);
 
   string_stream << "# RocksDB\r\n";
-  for (const auto &cf_handle : *storage->GetCFHandles()) {
+  // the column families of the isolated namespaces are reported as the shared ones
+  auto cf_handles = *storage->GetCFHandles();
+  auto ns_cfs = storage->GetNamespaceColumnFamilies();
+  for (const auto &iter : ns_cfs) {
+    for (auto cf_handle : iter.second.handles) {
+      if (cf_handle) cf_handles.emplace_back(cf_handle);
+    }
+  }
+  for (const auto &cf_handle : cf_handles) {
     uint64_t estimate_keys = 0, block_cache_usage = 0, block_cache_pinned_usage = 0, index_and_filter_cache_usage = 0;
     std::map<std::string, std::string> cf_stats_map;
     db->GetIntProperty(cf_handle, "rocksdb.estimate-num-keys", &estimate_keys);
@@ -798,6 +859,11 @@ void Server::GetRocksDBInfo(std::string *info) {
     string_stream << "memtable_count_limit_stop[" << cf_handle->GetName()
                   << "]:" << cf_stats_map["io_stalls.memtable_compaction"] << "\r\n";
   }
+  for (const auto &iter : ns_cfs) {
+    if (!iter.second.block_cache) continue;
+    string_stream << "namespace_block_cache_usage[" << iter.first << "]:" << iter.second.block_cache->GetUsage()
+                  << "\r\n";
+  }
   string_stream << "all_mem_tables:" << memtable_sizes << "\r\n";
   string_stream << "cur_mem_tables:" << cur_memtable_sizes << "\r\n";
   string_stream << "snapshots:" << num_snapshots << "\r\n";
@@ -809,6 +875,28 @@ void Server::GetRocksDBInfo(std::string *info) {
   string_stream << "num_live_versions:" << num_live_versions << "\r\n";
   string_stream << "num_super_version:" << num_super_version << "\r\n";
   string_stream << "num_background_errors:" << num_background_errors << "\r\n";
+  auto metadata_cache = storage->GetMetadataCache();
+  string_stream << "metadata_cache_capacity:" << metadata_cache->GetCapacity() << "\r\n";
+  string_stream << "metadata_cache_usage:" << metadata_cache->GetUsage() << "\r\n";
+  string_stream << "metadata_cache_hits:" << metadata_cache->GetHits() << "\r\n";
+  string_stream << "metadata_cache_misses:" << metadata_cache->GetMisses() << "\r\n";
+  string_stream << "metadata_cache_rejects:" << metadata_cache->GetRejects() << "\r\n";
+  auto deletion_log = storage->GetDeletionLog();
+  string_stream << "lazyfree_pending_keys:" << deletion_log->GetPending() << "\r\n";
+  string_stream << "lazyfree_reclaimed_keys:" << deletion_log->GetReclaimed() << "\r\n";
+  string_stream << "lazyfree_filter_hits:" << deletion_log->GetFilterHits() << "\r\n";
+  auto filter_stats = storage->GetSubKeyFilterStats();
+  string_stream << "subkey_filter_metadata_gets:" << filter_stats->metadata_gets << "\r\n";
+  string_stream << "subkey_filter_metadata_prefetches:" << filter_stats->metadata_prefetches << "\r\n";
+  string_stream << "subkey_filter_metadata_cache_hits:" << filter_stats->metadata_cache_hits << "\r\n";
+  string_stream << "subkey_filter_dropped_subkeys:" << filter_stats->dropped_subkeys << "\r\n";
+  auto auto_tuner = storage->GetAutoTuner();
+  auto tuned_settings = auto_tuner->GetSettings();
+  string_stream << "auto_tune_metadata_block_cache_size:" << tuned_settings.metadata_block_cache << "\r\n";
+  string_stream << "auto_tune_subkey_block_cache_size:" << tuned_settings.subkey_block_cache << "\r\n";
+  string_stream << "auto_tune_write_buffer_size:" << tuned_settings.write_buffer << "\r\n";
+  string_stream << "auto_tune_background_jobs:" << tuned_settings.background_jobs << "\r\n";
+  string_stream << "write_stall_count:" << auto_tuner->GetWriteStalls() << "\r\n";
   string_stream << "flush_count:" << storage->GetFlushCount() << "\r\n";
   string_stream << "compaction_count:" << storage->GetCompactionCount() << "\r\n";
   string_stream << "put_per_sec:" << stats.GetInstantaneousMetric(STATS_METRIC_ROCKSDB_PUT) << "\r\n";
@@ -867,6 +955,7 @@ void Server::GetClientsInfo(std::string *info) {
   string_stream << "connected_clients:" << connected_clients_ << "\r\n";
   string_stream << "monitor_clients:" << monitor_clients_ << "\r\n";
   string_stream << "blocked_clients:" << blocked_clients_ << "\r\n";
+  string_stream << "tracking_clients:" << tracking_table_.NumClients() << "\r\n";
   *info = string_stream.str();
 }
 
@@ -1003,6 +1092,11 @@ void Server::GetStatsInfo(std::string *info) {
   string_stream << "sync_full:" << stats.fullsync_counter << "\r\n";
   string_stream << "sync_partial_ok:" << stats.psync_ok_counter << "\r\n";
   string_stream << "sync_partial_err:" << stats.psync_err_counter << "\r\n";
+  string_stream << "tracking_total_keys:" << tracking_table_.NumKeys() << "\r\n";
+  string_stream << "tracking_total_prefixes:" << tracking_table_.NumPrefixes() << "\r\n";
+  string_stream << "hotkeys_tracked:" << hot_keys_.Size() << "\r\n";
+  string_stream << "bigkeys_tracked:" << big_keys_.Size() << "\r\n";
+  string_stream << "client_output_buffer_limit_disconnections:" << stats.output_buffer_limit_disconnections << "\r\n";
   {
     std::lock_guard<std::mutex> lg(pubsub_channels_mu_);
     string_stream << "pubsub_channels:" << pubsub_channels_.size() << "\r\n";
@@ -1016,18 +1110,62 @@ void Server::GetCommandsStatsInfo(std::string *info) {
   std::ostringstream string_stream;
   string_stream << "# Commandstats\r\n";
 
-  for (const auto &cmd_stat : stats.commands_stats) {
-    auto calls = cmd_stat.second.calls.load();
+  for (const auto &[name, attributes] : *redis::GetOriginalCommands()) {
+    const auto &cmd_stat = stats.commands_stats[attributes->id];
+    auto calls = cmd_stat.calls.load();
     if (calls == 0) continue;
 
-    auto latency = cmd_stat.second.latency.load();
-    string_stream << "cmdstat_" << cmd_stat.first << ":calls=" << calls << ",usec=" << latency
+    auto latency = cmd_stat.latency.load();
+    string_stream << "cmdstat_" << name << ":calls=" << calls << ",usec=" << latency
                   << ",usec_per_call=" << ((calls == 0) ? 0 : static_cast<float>(latency / calls)) << "\r\n";
   }
 
   *info = string_stream.str();
 }
 
+void Server::GetPerfStatsInfo(std::string *info) {
+  std::ostringstream string_stream;
+  string_stream << "# Perfstats\r\n";
+
+  for (const auto &[name, attributes] : *redis::GetOriginalCommands()) {
+    const auto &cmd_stat = stats.commands_stats[attributes->id];
+    auto samples = cmd_stat.perf_samples.load();
+    if (samples == 0) continue;
+
+    string_stream << "perfstat_" << name << ":samples=" << samples;
+    for (int i = 0; i < PERF_METRIC_COUNT; i++) {
+      string_stream << "," << PerfStatsMetricNames[i] << "=" << cmd_stat.perf_metrics[i].load();
+    }
+    string_stream << "\r\n";
+  }
+
+  *info = string_stream.str();
+}
+
+// GetPerfStatsMetrics returns the per-command perf stats in the Prometheus text exposition format
+std::string Server::GetPerfStatsMetrics() {
+  std::vector<std::pair<std::string, const CommandStat *>> sampled;
+  for (const auto &[name, attributes] : *redis::GetOriginalCommands()) {
+    const auto &cmd_stat = stats.commands_stats[attributes->id];
+    if (cmd_stat.perf_samples.load() > 0) sampled.emplace_back(name, &cmd_stat);
+  }
+
+  std::ostringstream string_stream;
+  string_stream << "# TYPE kvrocks_command_perf_samples_total counter\n";
+  for (const auto &[name, cmd_stat] : sampled) {
+    string_stream << "kvrocks_command_perf_samples_total{cmd=\"" << name << "\"} " << cmd_stat->perf_samples.load()
+                  << "\n";
+  }
+  for (int i = 0; i < PERF_METRIC_COUNT; i++) {
+    std::string metric = fmt::format("kvrocks_command_perf_{}_total", PerfStatsMetricNames[i]);
+    string_stream << "# TYPE " << metric << " counter\n";
+    for (const auto &[name, cmd_stat] : sampled) {
+      string_stream << metric << "{cmd=\"" << name << "\"} " << cmd_stat->perf_metrics[i].load() << "\n";
+    }
+  }
+  return string_stream.str();
+}
+
 void Server::GetClusterInfo(std::string *info) {
   std::ostringstream string_stream;
 
@@ -1118,6 +1256,13 @@ void Server::GetInfo(const std::string &ns, const std::string &section, std::str
     string_stream << commands_stats_info;
   }
 
+  if (all || section == "perfstats") {
+    std::string perf_stats_info;
+    GetPerfStatsInfo(&perf_stats_info);
+    if (section_cnt++) string_stream << "\r\n";
+    string_stream << perf_stats_info;
+  }
+
   if (all || section == "cluster") {
     std::string cluster_info;
     GetClusterInfo(&cluster_info);
@@ -1492,7 +1637,7 @@ Status Server::LookupAndCreateCommand(const std::string &cmd_name, std::unique_p
   if (cmd_name.empty()) return {Status::RedisUnknownCmd};
 
   auto commands = redis::GetCommands();
-  auto cmd_iter = commands->find(util::ToLower(cmd_name));
+  auto cmd_iter = commands->find(cmd_name);
   if (cmd_iter == commands->end()) {
     return {Status::RedisUnknownCmd};
   }
@@ -1511,6 +1656,10 @@ Status Server::ScriptExists(const std::string &sha) {
   }
   lua_pop(lua_, 1);
 
+  if (script_cache_.Exists(sha)) {
+    return Status::OK();
+  }
+
   std::string body;
   return ScriptGet(sha, &body);
 }
@@ -1531,10 +1680,19 @@ Status Server::ScriptSet(const std::string &sha, const std::string &body) const
 }
 
 void Server::ScriptReset() {
+  script_cache_.Clear();
   auto lua = lua_.exchange(lua::CreateState());
   lua::DestroyState(lua);
 }
 
+// ScriptPrewarm loads the compiled script into the Lua states of all workers in the
+// background, so that the first EVALSHA_RO on each worker needn't load it.
+void Server::ScriptPrewarm(const std::string &sha) {
+  for (const auto &worker_thread : worker_threads_) {
+    worker_thread->GetWorker()->PrewarmScript(sha);
+  }
+}
+
 void Server::ScriptFlush() {
   auto cf = storage->GetCFHandle(engine::kPropagateColumnFamilyName);
   storage->FlushScripts(storage->DefaultWriteOptions(), cf);
@@ -1569,10 +1727,73 @@ Status Server::ExecPropagatedCommand(const std::vector<std::string> &tokens) {
   if (command == "script" && tokens.size() >= 2) {
     return ExecPropagateScriptCommand(tokens);
   }
+  if (command == engine::kPropagateNamespaceCommand && tokens.size() >= 3) {
+    return ExecPropagateNamespaceCommand(tokens);
+  }
 
   return Status::OK();
 }
 
+Status Server::ExecPropagateNamespaceCommand(const std::vector<std::string> &tokens) {
+  auto subcommand = util::ToLower(tokens[1]);
+  const auto &ns = tokens[2];
+  if (subcommand == "add") {
+    if (storage->IsNamespaceIsolated(ns)) return Status::OK();
+
+    std::vector<uint32_t> cf_ids;
+    GET_OR_RET(storage->CreateNamespaceColumnFamilies(ns, &cf_ids));
+    // the writes are replicated with the column family ids, so they must be the same as master's
+    for (size_t i = 0; i < cf_ids.size(); i++) {
+      if (i + 3 >= tokens.size() || std::to_string(cf_ids[i]) != tokens[i + 3]) {
+        return {Status::NotOK, fmt::format("the column family ids of the namespace {} mismatch with master", ns)};
+      }
+    }
+  } else if (subcommand == "del") {
+    auto s = storage->DropNamespaceColumnFamilies(ns);
+    if (!s.IsOK() && !s.Is<Status::NotFound>()) return s;
+  }
+  return Status::OK();
+}
+
+Status Server::AddNamespace(const std::string &ns, const std::string &token) {
+  // the column families of the replicas are always created by master
+  if (!config_->namespace_column_families || IsSlave()) return config_->AddNamespace(ns, token);
+
+  // the column families must be created before the token is valid, or the clients which authenticated
+  // in between would write into the shared column families
+  std::vector<uint32_t> cf_ids;
+  auto s = storage->CreateNamespaceColumnFamilies(ns, &cf_ids);
+  if (!s.IsOK()) return s.Prefixed("failed to create the column families of the namespace");
+
+  // the replicas must create the same column families before any write to them was replicated,
+  // so it's propagated before the token is valid as well
+  std::vector<std::string> tokens = {engine::kPropagateNamespaceCommand, "add", ns};
+  for (auto cf_id : cf_ids) {
+    tokens.emplace_back(std::to_string(cf_id));
+  }
+  s = Propagate(engine::kPropagateNamespaceCommand, tokens);
+  if (s.IsOK()) s = config_->AddNamespace(ns, token);
+  if (s.IsOK()) return Status::OK();
+
+  auto drop_s = storage->DropNamespaceColumnFamilies(ns);
+  if (drop_s.IsOK()) {
+    drop_s = Propagate(engine::kPropagateNamespaceCommand, {engine::kPropagateNamespaceCommand, "del", ns});
+  }
+  if (!drop_s.IsOK()) {
+    LOG(WARNING) << "[server] Failed to drop the column families of the namespace " << ns << ": " << drop_s.Msg();
+  }
+  return s;
+}
+
+Status Server::DelNamespace(const std::string &ns) {
+  GET_OR_RET(config_->DelNamespace(ns));
+  if (!storage->IsNamespaceIsolated(ns) || IsSlave()) return Status::OK();
+
+  auto s = storage->DropNamespaceColumnFamilies(ns);
+  if (!s.IsOK()) return s.Prefixed("failed to drop the column families of the namespace");
+  return Propagate(engine::kPropagateNamespaceCommand, {engine::kPropagateNamespaceCommand, "del", ns});
+}
+
 // AdjustOpenFilesLimit only try best to raise the max open files according to
 // the max clients and RocksDB open file configuration. It also reserves a number
 // of file descriptors(128) for extra operations of persistence, listening sockets,
@@ -1677,24 +1898,41 @@ void Server::updateAllWatchedKeys() {
   }
 }
 
-void Server::UpdateWatchedKeysFromArgs(const std::vector<std::string> &args, const redis::CommandAttributes &attr) {
-  if (attr.IsWrite() && watched_key_size_ > 0) {
-    if (attr.key_range.first_key > 0) {
-      updateWatchedKeysFromRange(args, attr.key_range);
-    } else if (attr.key_range.first_key < 0) {
-      redis::CommandKeyRange range = attr.key_range_gen(args);
+void Server::UpdateWatchedKeysFromArgs(redis::Connection *conn, const std::vector<std::string> &args,
+                                       const redis::CommandAttributes &attr) {
+  if (!attr.IsWrite()) return;
 
-      if (range.first_key > 0) {
-        updateWatchedKeysFromRange(args, range);
-      }
-    } else {
-      // support commands like flushdb (write flag && key range {0,0,0})
-      updateAllWatchedKeys();
+  bool has_watched_keys = watched_key_size_ > 0;
+  bool has_tracking_clients = !tracking_table_.Empty();
+  if (!has_watched_keys && !has_tracking_clients) return;
+
+  if (attr.key_range.first_key > 0) {
+    if (has_watched_keys) updateWatchedKeysFromRange(args, attr.key_range);
+    if (has_tracking_clients) invalidateTrackedKeysFromRange(conn, args, attr.key_range);
+  } else if (attr.key_range.first_key < 0) {
+    redis::CommandKeyRange range = attr.key_range_gen(args);
+
+    if (range.first_key > 0) {
+      if (has_watched_keys) updateWatchedKeysFromRange(args, range);
+      if (has_tracking_clients) invalidateTrackedKeysFromRange(conn, args, range);
     }
+  } else {
+    // support commands like flushdb (write flag && key range {0,0,0})
+    if (has_watched_keys) updateAllWatchedKeys();
+    if (has_tracking_clients) sendTrackingInvalidations(tracking_table_.InvalidateAll());
   }
 }
 
-void Server::UpdateWatchedKeysManually(const std::vector<std::string> &keys) {
+void Server::UpdateWatchedKeysManually(redis::Connection *conn, const std::vector<std::string> &keys) {
+  if (!tracking_table_.Empty()) {
+    std::vector<TrackingInvalidation> invalidations;
+    for (const auto &key : keys) {
+      auto key_invalidations = tracking_table_.InvalidateKey(conn->GetNamespace(), key, conn->GetID());
+      std::move(key_invalidations.begin(), key_invalidations.end(), std::back_inserter(invalidations));
+    }
+    sendTrackingInvalidations(invalidations);
+  }
+
   std::shared_lock lock(watched_key_mutex_);
 
   for (const auto &key : keys) {
@@ -1743,3 +1981,127 @@ void Server::ResetWatchedKeys(redis::Connection *conn) {
     watched_key_size_ = watched_key_map_.size();
   }
 }
+
+Status Server::EnableTracking(redis::Connection *conn, const std::shared_ptr<TrackingClient> &client,
+                              uint64_t redirect_id) {
+  if (redirect_id != 0) {
+    for (const auto &t : worker_threads_) {
+      auto worker = t->GetWorker();
+      if (int fd = worker->LookupClientFD(redirect_id); fd != -1) {
+        client->redirect_owner = worker;
+        client->redirect_fd = fd;
+        client->redirect_id = redirect_id;
+        break;
+      }
+    }
+    if (!client->redirect_owner) {
+      return {Status::NotOK, "The client ID you want redirect to does not exist"};
+    }
+  }
+
+  conn->tracking = client;
+  tracking_table_.AddClient(client);
+  return Status::OK();
+}
+
+void Server::DisableTracking(redis::Connection *conn) {
+  if (!conn->tracking) return;
+
+  tracking_table_.RemoveClient(conn->tracking);
+  conn->tracking = nullptr;
+}
+
+void Server::TrackKeysFromArgs(redis::Connection *conn, const std::vector<std::string> &args,
+                               const redis::CommandAttributes &attr) {
+  // only the keys read by the clients in default mode are remembered,
+  // the clients in broadcasting mode are notified by prefixes
+  const auto &client = conn->tracking;
+  if (!client || client->bcast || !(attr.flags & redis::kCmdReadOnly)) return;
+
+  redis::CommandKeyRange range = attr.key_range;
+  if (range.first_key < 0) range = attr.key_range_gen(args);
+  if (range.first_key <= 0) return;
+
+  std::vector<TrackingInvalidation> invalidations;
+  for (size_t i = range.first_key; range.last_key > 0 ? i <= size_t(range.last_key) : i <= args.size() + range.last_key;
+       i += range.key_step) {
+    auto evicted = tracking_table_.TrackKey(client, conn->GetNamespace(), args[i]);
+    std::move(evicted.begin(), evicted.end(), std::back_inserter(invalidations));
+  }
+  sendTrackingInvalidations(invalidations);
+}
+
+void Server::RecordKeyStatsFromArgs(redis::Connection *conn, const std::vector<std::string> &args,
+                                    const redis::CommandAttributes &attr,
+                                    const engine::WrittenMetadataRecorder *written) {
+  redis::CommandKeyRange range = attr.key_range;
+  if (range.first_key < 0) range = attr.key_range_gen(args);
+  if (range.first_key <= 0) return;
+
+  const auto &ns = conn->GetNamespace();
+  for (size_t i = range.first_key; range.last_key > 0 ? i <= size_t(range.last_key) : i <= args.size() + range.last_key;
+       i += range.key_step) {
+    hot_keys_.Add(ns, args[i]);
+    if (!written) continue;
+
+    // the key is skipped if its metadata wasn't written, e.g. nothing was changed
+    // or the batch was not committed yet in a transaction
+    std::string ns_key;
+    ComposeNamespaceKey(ns, args[i], &ns_key, storage->IsSlotIdEncoded());
+    auto bytes = written->Find(ns_key);
+    if (!bytes) continue;
+
+    Metadata metadata(kRedisNone, false);
+    if (bytes->has_value()) metadata.Decode(**bytes);
+    if (!bytes->has_value() || metadata.Expired()) {
+      big_keys_.Remove(ns, args[i]);
+      continue;
+    }
+
+    uint64_t size = metadata.size;
+    if (metadata.Type() == kRedisString) {
+      size = (*bytes)->size() - Metadata::GetOffsetAfterExpire(static_cast<uint8_t>((**bytes)[0]));
+    }
+    big_keys_.Update(ns, args[i], RedisTypeNames[metadata.Type()], size);
+  }
+}
+
+void Server::invalidateTrackedKeysFromRange(redis::Connection *conn, const std::vector<std::string> &args,
+                                            const redis::CommandKeyRange &range) {
+  std::vector<TrackingInvalidation> invalidations;
+  for (size_t i = range.first_key; range.last_key > 0 ? i <= size_t(range.last_key) : i <= args.size() + range.last_key;
+       i += range.key_step) {
+    auto keys = tracking_table_.InvalidateKey(conn->GetNamespace(), args[i], conn->GetID());
+    std::move(keys.begin(), keys.end(), std::back_inserter(invalidations));
+  }
+  sendTrackingInvalidations(invalidations);
+}
+
+void Server::sendTrackingInvalidations(const std::vector<TrackingInvalidation> &invalidations) {
+  for (const auto &invalidation : invalidations) {
+    const auto &client = invalidation.client;
+    if (!client->enabled) continue;
+
+    // RESP2 clients can only receive the invalidation messages through the redirect client
+    // which subscribed the invalidation channel, RESP3 clients receive the push messages
+    std::string resp2_msg, resp3_msg = redis::HeaderOfPush(redis::RESP::v3, 2) + redis::BulkString("invalidate");
+    if (invalidation.flush_all) {
+      resp3_msg += redis::NilString(redis::RESP::v3);
+    } else {
+      resp3_msg += redis::MultiBulkString(invalidation.keys);
+    }
+
+    Status s;
+    if (client->redirect_owner) {
+      resp2_msg = redis::MultiLen(3) + redis::BulkString("message") + redis::BulkString(kTrackingInvalidateChannel);
+      resp2_msg += invalidation.flush_all ? redis::NilString() : redis::MultiBulkString(invalidation.keys);
+      s = client->redirect_owner->Push(client->redirect_fd, client->redirect_id, resp2_msg, resp3_msg);
+    } else {
+      s = client->owner->Push(client->fd, client->id, resp2_msg, resp3_msg);
+    }
+    // it's fine to drop the message if the client was gone
+    if (!s.IsOK()) {
+      DLOG(INFO) << "[server] Failed to send the invalidation message to client " << client->id << ": " << s.Msg();
+    }
+  }
+}
@@ -22,6 +22,7 @@
 
 #include <inttypes.h>
 
+#include <array>
 #include <list>
 #include <map>
 #include <memory>
@@ -38,10 +39,13 @@
 #include "cluster/slot_migrate.h"
 #include "commands/commander.h"
 #include "lua.hpp"
+#include "server/client_tracking.h"
 #include "server/redis_connection.h"
+#include "stats/key_stats.h"
 #include "stats/log_collector.h"
 #include "stats/stats.h"
 #include "storage/redis_metadata.h"
+#include "storage/script_cache.h"
 #include "storage/storage.h"
 #include "task_runner.h"
 #include "tls_util.h"
@@ -85,6 +89,8 @@ enum ClientType {
   kTypeSlave = (1ULL << 3),   // slave client
 };
 
+constexpr const size_t kScriptCacheMaxBytes = 64 * MiB;
+
 enum ServerLogType { kServerLogNone, kReplIdLog };
 
 class ServerLogData {
@@ -140,6 +146,7 @@ class Server {
   void IncrFetchFileThread() { fetch_file_threads_num_++; }
   void DecrFetchFileThread() { fetch_file_threads_num_--; }
   int GetFetchFileThreadNum() { return fetch_file_threads_num_; }
+  ReplBatchCache *GetReplBatchCache() { return &repl_batch_cache_; }
 
   int PublishMessage(const std::string &channel, const std::string &msg);
   void SubscribeChannel(const std::string &channel, redis::Connection *conn);
@@ -171,6 +178,8 @@ class Server {
   void GetReplicationInfo(std::string *info);
   void GetRoleInfo(std::string *info);
   void GetCommandsStatsInfo(std::string *info);
+  void GetPerfStatsInfo(std::string *info);
+  std::string GetPerfStatsMetrics();
   void GetClusterInfo(std::string *info);
   void GetInfo(const std::string &ns, const std::string &section, std::string *info);
   std::string GetRocksDBStatsJson() const;
@@ -202,10 +211,16 @@ class Server {
   Status ScriptSet(const std::string &sha, const std::string &body) const;
   void ScriptReset();
   void ScriptFlush();
+  void ScriptPrewarm(const std::string &sha);
+  lua::ScriptCache *GetScriptCache() { return &script_cache_; }
 
   Status Propagate(const std::string &channel, const std::vector<std::string> &tokens) const;
   Status ExecPropagatedCommand(const std::vector<std::string> &tokens);
   Status ExecPropagateScriptCommand(const std::vector<std::string> &tokens);
+  Status ExecPropagateNamespaceCommand(const std::vector<std::string> &tokens);
+
+  Status AddNamespace(const std::string &ns, const std::string &token);
+  Status DelNamespace(const std::string &ns);
 
   void SetCurrentConnection(redis::Connection *conn) { curr_connection_ = conn; }
   redis::Connection *GetCurrentConnection() { return curr_connection_; }
@@ -224,12 +239,27 @@ class Server {
   std::unique_ptr<SlotMigrator> slot_migrator;
   std::unique_ptr<SlotImport> slot_import;
 
-  void UpdateWatchedKeysFromArgs(const std::vector<std::string> &args, const redis::CommandAttributes &attr);
-  void UpdateWatchedKeysManually(const std::vector<std::string> &keys);
+  void UpdateWatchedKeysFromArgs(redis::Connection *conn, const std::vector<std::string> &args,
+                                 const redis::CommandAttributes &attr);
+  // UpdateWatchedKeysManually is called for the keys written out of the command execution, e.g. by the
+  // blocking commands which were woken up, the tracked keys are invalidated as well
+  void UpdateWatchedKeysManually(redis::Connection *conn, const std::vector<std::string> &keys);
   void WatchKey(redis::Connection *conn, const std::vector<std::string> &keys);
   static bool IsWatchedKeysModified(redis::Connection *conn);
   void ResetWatchedKeys(redis::Connection *conn);
 
+  Status EnableTracking(redis::Connection *conn, const std::shared_ptr<TrackingClient> &client, uint64_t redirect_id);
+  void DisableTracking(redis::Connection *conn);
+  void TrackKeysFromArgs(redis::Connection *conn, const std::vector<std::string> &args,
+                         const redis::CommandAttributes &attr);
+  ClientTrackingTable *GetTrackingTable() { return &tracking_table_; }
+
+  // the sizes of the written keys are taken from the metadata recorded while executing the command
+  void RecordKeyStatsFromArgs(redis::Connection *conn, const std::vector<std::string> &args,
+                              const redis::CommandAttributes &attr, const engine::WrittenMetadataRecorder *written);
+  HotKeys *GetHotKeys() { return &hot_keys_; }
+  BigKeys *GetBigKeys() { return &big_keys_; }
+
 #ifdef ENABLE_OPENSSL
   UniqueSSLContext ssl_ctx;
 #endif
@@ -242,6 +272,9 @@ class Server {
   Status autoResizeBlockAndSST();
   void updateWatchedKeysFromRange(const std::vector<std::string> &args, const redis::CommandKeyRange &range);
   void updateAllWatchedKeys();
+  void invalidateTrackedKeysFromRange(redis::Connection *conn, const std::vector<std::string> &args,
+                                      const redis::CommandKeyRange &range);
+  void sendTrackingInvalidations(const std::vector<TrackingInvalidation> &invalidations);
 
   std::atomic<bool> stop_ = false;
   std::atomic<bool> is_loading_ = false;
@@ -254,6 +287,7 @@ class Server {
   std::mutex last_random_key_cursor_mu_;
 
   std::atomic<lua_State *> lua_;
+  lua::ScriptCache script_cache_{kScriptCacheMaxBytes};
 
   redis::Connection *curr_connection_ = nullptr;
 
@@ -266,6 +300,7 @@ class Server {
   // slave
   std::mutex slave_threads_mu_;
   std::list<std::unique_ptr<FeedSlaveThread>> slave_threads_;
+  ReplBatchCache repl_batch_cache_{kReplBatchCacheMaxBytes};
   std::atomic<int> fetch_file_threads_num_ = 0;
 
   // Some jobs to operate DB should be unique
@@ -285,15 +320,29 @@ class Server {
   std::map<std::string, std::list<ConnContext *>> pubsub_channels_;
   std::map<std::string, std::list<ConnContext *>> pubsub_patterns_;
   std::mutex pubsub_channels_mu_;
-  std::map<std::string, std::list<ConnContext *>> blocking_keys_;
-  std::mutex blocking_keys_mu_;
   std::atomic<int> blocked_clients_{0};
-  std::map<std::string, std::set<std::shared_ptr<StreamConsumer>>> blocked_stream_consumers_;
+
+  // The blocked clients are sharded by the hash of keys, so workers blocking on or
+  // waking up different keys don't contend on the same lock. The waiter counters
+  // let writers skip the lookup entirely when no one is blocked.
+  struct BlockingShard {
+    std::mutex mu;
+    std::map<std::string, std::list<ConnContext>> keys;
+    std::map<std::string, std::set<std::shared_ptr<StreamConsumer>>> stream_consumers;
+  };
+  static constexpr size_t kBlockingShards = 32;
+  std::array<BlockingShard, kBlockingShards> blocking_shards_;
+  std::atomic<size_t> blocking_key_waiters_{0};
+  std::atomic<size_t> blocked_stream_waiters_{0};
+  BlockingShard &blockingShard(const std::string &key) {
+    return blocking_shards_[std::hash<std::string>{}(key) % kBlockingShards];
+  }
 
   // threads
   std::shared_mutex works_concurrency_rw_lock_;
   std::thread cron_thread_;
   std::thread compaction_checker_thread_;
+  std::thread lazyfree_thread_;
   TaskRunner task_runner_;
   std::vector<std::unique_ptr<WorkerThread>> worker_threads_;
   std::unique_ptr<ReplicationThread> replication_thread_;
@@ -305,6 +354,13 @@ class Server {
   std::atomic<size_t> watched_key_size_ = 0;
   std::map<std::string, std::set<redis::Connection *>> watched_key_map_;
   std::shared_mutex watched_key_mutex_;
+
+  // client side caching
+  ClientTrackingTable tracking_table_;
+
+  // key stats
+  HotKeys hot_keys_{1024};
+  BigKeys big_keys_{1024};
 };
 
 Server *GetServer();
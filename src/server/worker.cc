@@ -52,13 +52,15 @@
 #include "server.h"
 #include "storage/scripting.h"
 
-Worker::Worker(Server *svr, Config *config) : svr(svr), base_(event_base_new()) {
+Worker::Worker(Server *svr, Config *config, int cpu) : svr(svr), base_(newEventBase(config)), cpu_(cpu) {
   if (!base_) throw std::runtime_error{"event base failed to be created"};
 
   timer_ = event_new(base_, -1, EV_PERSIST, timerCb, this);
   timeval tm = {10, 0};
   evtimer_add(timer_, &tm);
 
+  prewarm_event_ = event_new(base_, -1, 0, prewarmScriptsCb, this);
+
   uint32_t ports[3] = {config->port, config->tls_port, 0};
   auto binds = config->binds;
 
@@ -77,10 +79,10 @@ Worker::Worker(Server *svr, Config *config) : svr(svr), base_(event_base_new())
 
 Worker::~Worker() {
   std::vector<redis::Connection *> conns;
-  conns.reserve(conns_.size() + monitor_conns_.size());
+  conns.reserve(num_conns_ + monitor_conns_.size());
 
-  for (const auto &iter : conns_) {
-    conns.emplace_back(iter.second);
+  for (const auto &conn : conns_) {
+    if (conn) conns.emplace_back(conn);
   }
   for (const auto &iter : monitor_conns_) {
     conns.emplace_back(iter.second);
@@ -90,6 +92,7 @@ Worker::~Worker() {
   }
 
   event_free(timer_);
+  event_free(prewarm_event_);
   if (rate_limit_group_) {
     bufferevent_rate_limit_group_free(rate_limit_group_);
   }
@@ -100,13 +103,58 @@ Worker::~Worker() {
   lua::DestroyState(lua_);
 }
 
+event_base *Worker::newEventBase(const Config *config) {
+  event_config *cfg = event_config_new();
+  if (!cfg) return nullptr;
+
+  if (config->io_epoll_changelist) {
+    event_config_set_flag(cfg, EVENT_BASE_FLAG_EPOLL_USE_CHANGELIST);
+  }
+  event_base *base = event_base_new_with_config(cfg);
+  event_config_free(cfg);
+  return base;
+}
+
+void Worker::setupBufferevent(bufferevent *bev) {
+  auto max_single_rw = static_cast<ev_ssize_t>(svr->GetConfig()->io_max_single_rw_kb) * KiB;
+  bufferevent_set_max_single_read(bev, max_single_rw);
+  bufferevent_set_max_single_write(bev, max_single_rw);
+}
+
 void Worker::timerCb(int, int16_t events, void *ctx) {
   auto worker = static_cast<Worker *>(ctx);
   auto config = worker->svr->GetConfig();
+  // the clients whose reading was paused get no more replies, so the soft limit
+  // of their output buffer must be checked periodically as well
+  worker->CheckOutputBufferLimits();
   if (config->timeout == 0) return;
   worker->KickoutIdleClients(config->timeout);
 }
 
+void Worker::PrewarmScript(const std::string &sha) {
+  {
+    std::lock_guard<std::mutex> guard(prewarm_mu_);
+    prewarm_scripts_.emplace_back(sha);
+  }
+  event_active(prewarm_event_, 0, 0);
+}
+
+void Worker::prewarmScriptsCb(int, int16_t events, void *ctx) {
+  auto worker = static_cast<Worker *>(ctx);
+  std::vector<std::string> scripts;
+  {
+    std::lock_guard<std::mutex> guard(worker->prewarm_mu_);
+    scripts.swap(worker->prewarm_scripts_);
+  }
+
+  for (const auto &sha : scripts) {
+    auto s = lua::PrewarmFunction(worker->svr, worker->lua_, sha);
+    if (!s.IsOK() && !s.Is<Status::NotFound>()) {
+      LOG(WARNING) << "[worker] Failed to prewarm the script " << sha << ": " << s.Msg();
+    }
+  }
+}
+
 void Worker::newTCPConnection(evconnlistener *listener, evutil_socket_t fd, sockaddr *address, int socklen, void *ctx) {
   auto worker = static_cast<Worker *>(ctx);
   int local_port = util::GetLocalPort(fd);  // NOLINT
@@ -163,6 +211,7 @@ void Worker::newTCPConnection(evconnlistener *listener, evutil_socket_t fd, sock
     bufferevent_openssl_set_allow_dirty_shutdown(bev, 1);
   }
 #endif
+  worker->setupBufferevent(bev);
   auto conn = new redis::Connection(bev, worker);
   bufferevent_setcb(bev, redis::Connection::OnRead, redis::Connection::OnWrite, redis::Connection::OnEvent, conn);
   bufferevent_enable(bev, EV_READ);
@@ -198,6 +247,7 @@ void Worker::newUnixSocketConnection(evconnlistener *listener, evutil_socket_t f
   auto ev_thread_safe_flags =
       BEV_OPT_THREADSAFE | BEV_OPT_DEFER_CALLBACKS | BEV_OPT_UNLOCK_CALLBACKS | BEV_OPT_CLOSE_ON_FREE;
   bufferevent *bev = bufferevent_socket_new(base, fd, ev_thread_safe_flags);
+  worker->setupBufferevent(bev);
 
   auto conn = new redis::Connection(bev, worker);
   bufferevent_setcb(bev, redis::Connection::OnRead, redis::Connection::OnWrite, redis::Connection::OnEvent, conn);
@@ -252,6 +302,14 @@ Status Worker::listenTCP(const std::string &host, uint32_t port, int backlog) {
       return {Status::NotOK, evutil_socket_error_to_string(EVUTIL_SOCKET_ERROR())};
     }
 
+#ifdef SO_INCOMING_CPU
+    // prefer the listener of the worker which runs on the same core as the one handling the packets
+    if (cpu_ >= 0 && setsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu_, sizeof(cpu_)) < 0) {
+      LOG(WARNING) << "[worker] Failed to set SO_INCOMING_CPU on the listener: "
+                   << evutil_socket_error_to_string(EVUTIL_SOCKET_ERROR());
+    }
+#endif
+
     if (bind(fd, p->ai_addr, p->ai_addrlen)) {
       return {Status::NotOK, evutil_socket_error_to_string(EVUTIL_SOCKET_ERROR())};
     }
@@ -294,6 +352,11 @@ Status Worker::ListenUnixSocket(const std::string &path, int perm, int backlog)
 
 void Worker::Run(std::thread::id tid) {
   tid_ = tid;
+  if (cpu_ >= 0) {
+    if (auto s = util::ThreadSetAffinity(cpu_); !s) {
+      LOG(WARNING) << "[worker] Failed to pin the worker thread to cpu " << cpu_ << ": " << s.Msg();
+    }
+  }
   if (event_base_dispatch(base_) != 0) {
     LOG(ERROR) << "[worker] Failed to run server, err: " << strerror(errno);
   }
@@ -307,10 +370,15 @@ void Worker::Stop() {
   }
 }
 
+redis::Connection *Worker::lookupConnection(int fd) const {
+  if (fd < 0 || static_cast<size_t>(fd) >= conns_.size()) return nullptr;
+  return conns_[fd];
+}
+
 Status Worker::AddConnection(redis::Connection *c) {
   std::unique_lock<std::mutex> lock(conns_mu_);
-  auto iter = conns_.find(c->GetFD());
-  if (iter != conns_.end()) {
+  int fd = c->GetFD();
+  if (lookupConnection(fd)) {
     return {Status::NotOK, "connection was exists"};
   }
 
@@ -320,7 +388,11 @@ Status Worker::AddConnection(redis::Connection *c) {
     return {Status::NotOK, "max number of clients reached"};
   }
 
-  conns_.insert(std::pair<int, redis::Connection *>(c->GetFD(), c));
+  if (static_cast<size_t>(fd) >= conns_.size()) {
+    conns_.resize(std::max(static_cast<size_t>(fd) + 1, conns_.size() * 2), nullptr);
+  }
+  conns_[fd] = c;
+  num_conns_++;
   uint64_t id = svr->GetClientID();
   c->SetID(id);
 
@@ -331,14 +403,14 @@ redis::Connection *Worker::removeConnection(int fd) {
   redis::Connection *conn = nullptr;
 
   std::unique_lock<std::mutex> lock(conns_mu_);
-  auto iter = conns_.find(fd);
-  if (iter != conns_.end()) {
-    conn = iter->second;
-    conns_.erase(iter);
+  if (auto c = lookupConnection(fd)) {
+    conn = c;
+    conns_[fd] = nullptr;
+    num_conns_--;
     svr->DecrClientNum();
   }
 
-  iter = monitor_conns_.find(fd);
+  auto iter = monitor_conns_.find(fd);
   if (iter != monitor_conns_.end()) {
     conn = iter->second;
     monitor_conns_.erase(iter);
@@ -376,17 +448,17 @@ void Worker::FreeConnection(redis::Connection *conn) {
 
 void Worker::FreeConnectionByID(int fd, uint64_t id) {
   std::unique_lock<std::mutex> lock(conns_mu_);
-  auto iter = conns_.find(fd);
-  if (iter != conns_.end() && iter->second->GetID() == id) {
+  if (auto conn = lookupConnection(fd); conn && conn->GetID() == id) {
     if (rate_limit_group_ != nullptr) {
-      bufferevent_remove_from_rate_limit_group(iter->second->GetBufferEvent());
+      bufferevent_remove_from_rate_limit_group(conn->GetBufferEvent());
     }
-    delete iter->second;
-    conns_.erase(iter);
+    delete conn;
+    conns_[fd] = nullptr;
+    num_conns_--;
     svr->DecrClientNum();
   }
 
-  iter = monitor_conns_.find(fd);
+  auto iter = monitor_conns_.find(fd);
   if (iter != monitor_conns_.end() && iter->second->GetID() == id) {
     delete iter->second;
     monitor_conns_.erase(iter);
@@ -397,9 +469,8 @@ void Worker::FreeConnectionByID(int fd, uint64_t id) {
 
 Status Worker::EnableWriteEvent(int fd) {
   std::unique_lock<std::mutex> lock(conns_mu_);
-  auto iter = conns_.find(fd);
-  if (iter != conns_.end()) {
-    auto bev = iter->second->GetBufferEvent();
+  if (auto conn = lookupConnection(fd)) {
+    auto bev = conn->GetBufferEvent();
     bufferevent_enable(bev, EV_WRITE);
     return Status::OK();
   }
@@ -409,20 +480,52 @@ Status Worker::EnableWriteEvent(int fd) {
 
 Status Worker::Reply(int fd, const std::string &reply) {
   std::unique_lock<std::mutex> lock(conns_mu_);
-  auto iter = conns_.find(fd);
-  if (iter != conns_.end()) {
-    iter->second->SetLastInteraction();
-    redis::Reply(iter->second->Output(), reply);
+  if (auto conn = lookupConnection(fd)) {
+    conn->SetLastInteraction();
+    conn->Reply(reply);
+    return Status::OK();
+  }
+
+  return {Status::NotOK, "connection doesn't exist"};
+}
+
+Status Worker::Push(int fd, const std::string &resp2_msg, const std::string &resp3_msg) {
+  std::unique_lock<std::mutex> lock(conns_mu_);
+  if (auto conn = lookupConnection(fd)) {
+    conn->SetLastInteraction();
+    conn->Reply(conn->GetProtocolVersion() == redis::RESP::v3 ? resp3_msg : resp2_msg);
+    return Status::OK();
+  }
+
+  return {Status::NotOK, "connection doesn't exist"};
+}
+
+Status Worker::Push(int fd, uint64_t id, const std::string &resp2_msg, const std::string &resp3_msg) {
+  std::unique_lock<std::mutex> lock(conns_mu_);
+  if (auto conn = lookupConnection(fd); conn && conn->GetID() == id) {
+    const auto &msg = conn->GetProtocolVersion() == redis::RESP::v3 ? resp3_msg : resp2_msg;
+    if (!msg.empty()) conn->Reply(msg);
     return Status::OK();
   }
 
   return {Status::NotOK, "connection doesn't exist"};
 }
 
+int Worker::LookupClientFD(uint64_t id) {
+  std::unique_lock<std::mutex> lock(conns_mu_);
+  for (const auto &conn : conns_) {
+    if (conn && conn->GetID() == id) return conn->GetFD();
+  }
+  return -1;
+}
+
 void Worker::BecomeMonitorConn(redis::Connection *conn) {
   {
     std::lock_guard<std::mutex> guard(conns_mu_);
-    conns_.erase(conn->GetFD());
+    if (lookupConnection(conn->GetFD())) {
+      conns_[conn->GetFD()] = nullptr;
+      num_conns_--;
+    }
     monitor_conns_[conn->GetFD()] = conn;
   }
   svr->IncrMonitorClientNum();
@@ -454,9 +557,8 @@ std::string Worker::GetClientsStr() {
   std::unique_lock<std::mutex> lock(conns_mu_);
 
   std::string output;
-  for (const auto &iter : conns_) {
-    redis::Connection *conn = iter.second;
-    output.append(conn->ToString());
+  for (const auto &conn : conns_) {
+    if (conn) output.append(conn->ToString());
   }
 
   return output;
@@ -466,8 +568,8 @@ void Worker::KillClient(redis::Connection *self, uint64_t id, const std::string
                         int64_t *killed) {
   std::lock_guard<std::mutex> guard(conns_mu_);
 
-  for (const auto &iter : conns_) {
-    redis::Connection *conn = iter.second;
+  for (const auto &conn : conns_) {
+    if (!conn) continue;
     if (skipme && self == conn) continue;
 
     // no need to kill the client again if the kCloseAfterReply flag is set
@@ -489,26 +591,36 @@ void Worker::KillClient(redis::Connection *self, uint64_t id, const std::string
   }
 }
 
+void Worker::CheckOutputBufferLimits() {
+  std::lock_guard<std::mutex> guard(conns_mu_);
+  for (auto conn : conns_) {
+    if (conn) conn->CheckOutputBufferLimits();
+  }
+}
+
 void Worker::KickoutIdleClients(int timeout) {
   std::vector<std::pair<int, uint64_t>> to_be_killed_conns;
 
   {
     std::lock_guard<std::mutex> guard(conns_mu_);
-    if (conns_.empty()) {
+    if (num_conns_ == 0) {
       return;
     }
 
-    int iterations = std::min(static_cast<int>(conns_.size()), 50);
-    auto iter = conns_.upper_bound(last_iter_conn_fd_);
-    while (iterations--) {
-      if (iter == conns_.end()) iter = conns_.begin();
-      if (static_cast<int>(iter->second->GetIdleTime()) >= timeout) {
-        to_be_killed_conns.emplace_back(iter->first, iter->second->GetID());
+    // check at most 50 connections per run, starting after the last checked fd
+    int iterations = std::min(static_cast<int>(num_conns_), 50);
+    size_t fd = last_iter_conn_fd_;
+    for (size_t scanned = 0; iterations > 0 && scanned < conns_.size(); scanned++) {
+      fd = (fd + 1) % conns_.size();
+      auto conn = conns_[fd];
+      if (!conn) continue;
+
+      iterations--;
+      if (static_cast<int>(conn->GetIdleTime()) >= timeout) {
+        to_be_killed_conns.emplace_back(static_cast<int>(fd), conn->GetID());
       }
-      iter++;
     }
-    iter--;
-    last_iter_conn_fd_ = iter->first;
+    last_iter_conn_fd_ = static_cast<int>(fd);
   }
 
   for (const auto &conn : to_be_killed_conns) {
@@ -43,7 +43,8 @@ class Server;
 
 class Worker {
  public:
-  Worker(Server *svr, Config *config);
+  // cpu is the core which the worker is pinned to, or -1 if the worker isn't pinned
+  Worker(Server *svr, Config *config, int cpu = -1);
   ~Worker();
   Worker(const Worker &) = delete;
   Worker(Worker &&) = delete;
@@ -58,6 +59,13 @@ class Worker {
   Status AddConnection(redis::Connection *c);
   Status EnableWriteEvent(int fd);
   Status Reply(int fd, const std::string &reply);
+  // the push messages (e.g. pubsub messages) are shaped differently for the RESP2 and RESP3
+  // connections, so both are built by the caller and picked by the protocol of the connection
+  Status Push(int fd, const std::string &resp2_msg, const std::string &resp3_msg);
+  // push only if it's still the client with the id, since the fd may be reused,
+  // an empty message means the connection with that protocol can't receive it
+  Status Push(int fd, uint64_t id, const std::string &resp2_msg, const std::string &resp3_msg);
+  int LookupClientFD(uint64_t id);
   void BecomeMonitorConn(redis::Connection *conn);
   void FeedMonitorConns(redis::Connection *conn, const std::vector<std::string> &tokens);
 
@@ -65,32 +73,45 @@ class Worker {
   void KillClient(redis::Connection *self, uint64_t id, const std::string &addr, uint64_t type, bool skipme,
                   int64_t *killed);
   void KickoutIdleClients(int timeout);
+  void CheckOutputBufferLimits();
 
   Status ListenUnixSocket(const std::string &path, int perm, int backlog);
 
   lua_State *Lua() { return lua_; }
+  // Load the compiled script into the Lua state of the worker, it runs in the worker thread
+  void PrewarmScript(const std::string &sha);
   Server *svr;
 
  private:
+  static event_base *newEventBase(const Config *config);
+  void setupBufferevent(bufferevent *bev);
   Status listenTCP(const std::string &host, uint32_t port, int backlog);
   static void newTCPConnection(evconnlistener *listener, evutil_socket_t fd, sockaddr *address, int socklen, void *ctx);
   static void newUnixSocketConnection(evconnlistener *listener, evutil_socket_t fd, sockaddr *address, int socklen,
                                       void *ctx);
   static void timerCb(int, int16_t events, void *ctx);
+  static void prewarmScriptsCb(int, int16_t events, void *ctx);
   redis::Connection *removeConnection(int fd);
+  redis::Connection *lookupConnection(int fd) const;
 
   event_base *base_;
   event *timer_;
   std::thread::id tid_;
   std::vector<evconnlistener *> listen_events_;
+  int cpu_;
   std::mutex conns_mu_;
-  std::map<int, redis::Connection *> conns_;
+  // the normal connections indexed by fd, the slot of an unused fd is nullptr
+  std::vector<redis::Connection *> conns_;
+  size_t num_conns_ = 0;
   std::map<int, redis::Connection *> monitor_conns_;
   int last_iter_conn_fd_ = 0;  // fd of last processed connection in previous cron
 
   struct bufferevent_rate_limit_group *rate_limit_group_ = nullptr;
   struct ev_token_bucket_cfg *rate_limit_group_cfg_ = nullptr;
   lua_State *lua_;
+  event *prewarm_event_;
+  std::mutex prewarm_mu_;
+  std::vector<std::string> prewarm_scripts_;
 };
 
 class WorkerThread {
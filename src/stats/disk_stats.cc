@@ -34,8 +34,10 @@ rocksdb::Status Disk::GetApproximateSizes(const Metadata &metadata, const Slice
                                           rocksdb::ColumnFamilyHandle *column_family, uint64_t *key_size,
                                           Slice subkeyleft, Slice subkeyright) {
   std::string prefix_key, next_version_prefix_key;
-  InternalKey(ns_key, subkeyleft, metadata.version, storage_->IsSlotIdEncoded()).Encode(&prefix_key);
-  InternalKey(ns_key, subkeyright, metadata.version + 1, storage_->IsSlotIdEncoded()).Encode(&next_version_prefix_key);
+  InternalKey(ns_key, subkeyleft, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&prefix_key);
+  InternalKey(ns_key, subkeyright, metadata.version + 1, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&next_version_prefix_key);
   auto key_range = rocksdb::Range(prefix_key, next_version_prefix_key);
   uint64_t tmp_size = 0;
   rocksdb::Status s = storage_->GetDB()->GetApproximateSizes(option_, column_family, &key_range, 1, &tmp_size);
@@ -80,14 +82,14 @@ rocksdb::Status Disk::GetHashSize(const Slice &ns_key, uint64_t *key_size) {
   HashMetadata metadata(false);
   rocksdb::Status s = Database::GetMetadata(kRedisHash, ns_key, &metadata);
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
-  return GetApproximateSizes(metadata, ns_key, storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), key_size);
+  return GetApproximateSizes(metadata, ns_key, subkey_cf_handle_, key_size);
 }
 
 rocksdb::Status Disk::GetSetSize(const Slice &ns_key, uint64_t *key_size) {
   SetMetadata metadata(false);
   rocksdb::Status s = Database::GetMetadata(kRedisSet, ns_key, &metadata);
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
-  return GetApproximateSizes(metadata, ns_key, storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), key_size);
+  return GetApproximateSizes(metadata, ns_key, subkey_cf_handle_, key_size);
 }
 
 rocksdb::Status Disk::GetListSize(const Slice &ns_key, uint64_t *key_size) {
@@ -96,7 +98,7 @@ rocksdb::Status Disk::GetListSize(const Slice &ns_key, uint64_t *key_size) {
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
   std::string buf;
   PutFixed64(&buf, metadata.head);
-  return GetApproximateSizes(metadata, ns_key, storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), key_size, buf);
+  return GetApproximateSizes(metadata, ns_key, subkey_cf_handle_, key_size, buf);
 }
 
 rocksdb::Status Disk::GetZsetSize(const Slice &ns_key, uint64_t *key_size) {
@@ -105,18 +107,17 @@ rocksdb::Status Disk::GetZsetSize(const Slice &ns_key, uint64_t *key_size) {
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
   std::string score_bytes;
   PutDouble(&score_bytes, kMinScore);
-  s = GetApproximateSizes(metadata, ns_key, storage_->GetCFHandle(engine::kZSetScoreColumnFamilyName), key_size,
-                          score_bytes, score_bytes);
+  auto score_cf_handle = storage_->GetCFHandle(engine::kZSetScoreColumnFamilyName, namespace_);
+  s = GetApproximateSizes(metadata, ns_key, score_cf_handle, key_size, score_bytes, score_bytes);
   if (!s.ok()) return s;
-  return GetApproximateSizes(metadata, ns_key, storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), key_size);
+  return GetApproximateSizes(metadata, ns_key, subkey_cf_handle_, key_size);
 }
 
 rocksdb::Status Disk::GetBitmapSize(const Slice &ns_key, uint64_t *key_size) {
   BitmapMetadata metadata(false);
   rocksdb::Status s = Database::GetMetadata(kRedisBitmap, ns_key, &metadata);
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
-  return GetApproximateSizes(metadata, ns_key, storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), key_size,
-                             std::to_string(0), std::to_string(0));
+  return GetApproximateSizes(metadata, ns_key, subkey_cf_handle_, key_size, std::to_string(0), std::to_string(0));
 }
 
 rocksdb::Status Disk::GetSortedintSize(const Slice &ns_key, uint64_t *key_size) {
@@ -125,15 +126,15 @@ rocksdb::Status Disk::GetSortedintSize(const Slice &ns_key, uint64_t *key_size)
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
   std::string start_buf;
   PutFixed64(&start_buf, 0);
-  return GetApproximateSizes(metadata, ns_key, storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), key_size,
-                             start_buf, start_buf);
+  return GetApproximateSizes(metadata, ns_key, subkey_cf_handle_, key_size, start_buf, start_buf);
 }
 
 rocksdb::Status Disk::GetStreamSize(const Slice &ns_key, uint64_t *key_size) {
   StreamMetadata metadata(false);
   rocksdb::Status s = Database::GetMetadata(kRedisStream, ns_key, &metadata);
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
-  return GetApproximateSizes(metadata, ns_key, storage_->GetCFHandle(engine::kStreamColumnFamilyName), key_size);
+  auto stream_cf_handle = storage_->GetCFHandle(engine::kStreamColumnFamilyName, namespace_);
+  return GetApproximateSizes(metadata, ns_key, stream_cf_handle, key_size);
 }
 
 }  // namespace redis
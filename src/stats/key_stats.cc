@@ -0,0 +1,134 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "key_stats.h"
+
+void HotKeys::Add(const std::string &ns, const std::string &key) {
+  if (capacity_ == 0) return;
+
+  std::lock_guard<std::mutex> guard(mu_);
+  KeyID id{ns, key};
+  auto iter = counters_.find(id);
+  if (iter != counters_.end()) {
+    auto &[count, error] = iter->second;
+    ordered_.erase({count, id});
+    ordered_.emplace(++count, std::move(id));
+    return;
+  }
+
+  uint64_t min_count = 0;
+  if (counters_.size() >= capacity_) {
+    // replace the key with the minimum count
+    auto min_iter = ordered_.begin();
+    min_count = min_iter->first;
+    counters_.erase(min_iter->second);
+    ordered_.erase(min_iter);
+  }
+  counters_.emplace(id, std::make_pair(min_count + 1, min_count));
+  ordered_.emplace(min_count + 1, std::move(id));
+}
+
+std::vector<HotKey> HotKeys::GetTop(const std::string &ns, size_t count) {
+  std::lock_guard<std::mutex> guard(mu_);
+  std::vector<HotKey> hot_keys;
+  for (auto iter = ordered_.rbegin(); iter != ordered_.rend() && hot_keys.size() < count; ++iter) {
+    const auto &id = iter->second;
+    if (id.first != ns) continue;
+
+    hot_keys.emplace_back(HotKey{id.first, id.second, iter->first, counters_[id].second});
+  }
+  return hot_keys;
+}
+
+void HotKeys::Decay() {
+  std::lock_guard<std::mutex> guard(mu_);
+  ordered_.clear();
+  for (auto iter = counters_.begin(); iter != counters_.end();) {
+    auto &[count, error] = iter->second;
+    count /= 2;
+    error /= 2;
+    if (count == 0) {
+      iter = counters_.erase(iter);
+      continue;
+    }
+    ordered_.emplace(count, iter->first);
+    ++iter;
+  }
+}
+
+void HotKeys::Reset() {
+  std::lock_guard<std::mutex> guard(mu_);
+  counters_.clear();
+  ordered_.clear();
+}
+
+size_t HotKeys::Size() {
+  std::lock_guard<std::mutex> guard(mu_);
+  return counters_.size();
+}
+
+void BigKeys::Update(const std::string &ns, const std::string &key, const std::string &type, uint64_t size) {
+  if (capacity_ == 0) return;
+
+  std::lock_guard<std::mutex> guard(mu_);
+  KeyID id{ns, key};
+  if (auto iter = keys_.find(id); iter != keys_.end()) {
+    remove(iter);
+  } else if (keys_.size() >= capacity_) {
+    // the key is too small to be remembered
+    if (size <= ordered_.begin()->first) return;
+    remove(keys_.find(ordered_.begin()->second));
+  }
+  keys_.emplace(id, std::make_pair(type, size));
+  ordered_.emplace(size, std::move(id));
+}
+
+void BigKeys::Remove(const std::string &ns, const std::string &key) {
+  std::lock_guard<std::mutex> guard(mu_);
+  if (auto iter = keys_.find({ns, key}); iter != keys_.end()) remove(iter);
+}
+
+std::vector<BigKey> BigKeys::GetTop(const std::string &ns, size_t count) {
+  std::lock_guard<std::mutex> guard(mu_);
+  std::vector<BigKey> big_keys;
+  for (auto iter = ordered_.rbegin(); iter != ordered_.rend() && big_keys.size() < count; ++iter) {
+    const auto &id = iter->second;
+    if (id.first != ns) continue;
+
+    big_keys.emplace_back(BigKey{id.first, id.second, keys_[id].first, iter->first});
+  }
+  return big_keys;
+}
+
+void BigKeys::Reset() {
+  std::lock_guard<std::mutex> guard(mu_);
+  keys_.clear();
+  ordered_.clear();
+}
+
+size_t BigKeys::Size() {
+  std::lock_guard<std::mutex> guard(mu_);
+  return keys_.size();
+}
+
+void BigKeys::remove(std::map<KeyID, std::pair<std::string, uint64_t>>::iterator iter) {
+  ordered_.erase({iter->second.second, iter->first});
+  keys_.erase(iter);
+}
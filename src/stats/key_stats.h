@@ -0,0 +1,94 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+struct HotKey {
+  std::string ns;
+  std::string key;
+  // the estimated count is never less than the actual count, and it may be
+  // overestimated by at most the error
+  uint64_t count;
+  uint64_t error;
+};
+
+// HotKeys finds the most frequently accessed keys with the Space-Saving algorithm, only
+// the capacity of keys are monitored. If a new key comes when it's full, it takes over the
+// key with the minimum count, and inherits the count as the error. The counts are halved
+// while decaying, so the keys which were hot long time ago would fade out.
+class HotKeys {
+ public:
+  explicit HotKeys(size_t capacity) : capacity_(capacity) {}
+
+  void Add(const std::string &ns, const std::string &key);
+  std::vector<HotKey> GetTop(const std::string &ns, size_t count);
+  void Decay();
+  void Reset();
+  size_t Size();
+
+ private:
+  using KeyID = std::pair<std::string, std::string>;
+
+  std::mutex mu_;
+  size_t capacity_;
+  // the counter and error of the monitored keys, and the keys ordered by the counter
+  std::map<KeyID, std::pair<uint64_t, uint64_t>> counters_;
+  std::set<std::pair<uint64_t, KeyID>> ordered_;
+};
+
+struct BigKey {
+  std::string ns;
+  std::string key;
+  std::string type;
+  // the number of elements, or the number of bytes for strings
+  uint64_t size;
+};
+
+// BigKeys remembers the capacity of biggest keys, which are updated with the sizes seen while
+// writing them, and are removed once they were found to be deleted.
+class BigKeys {
+ public:
+  explicit BigKeys(size_t capacity) : capacity_(capacity) {}
+
+  void Update(const std::string &ns, const std::string &key, const std::string &type, uint64_t size);
+  void Remove(const std::string &ns, const std::string &key);
+  std::vector<BigKey> GetTop(const std::string &ns, size_t count);
+  void Reset();
+  size_t Size();
+
+ private:
+  using KeyID = std::pair<std::string, std::string>;
+
+  std::mutex mu_;
+  size_t capacity_;
+  std::map<KeyID, std::pair<std::string, uint64_t>> keys_;
+  std::set<std::pair<uint64_t, KeyID>> ordered_;
+
+  void remove(std::map<KeyID, std::pair<std::string, uint64_t>>::iterator iter);
+};
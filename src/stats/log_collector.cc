@@ -21,6 +21,7 @@
 #include "log_collector.h"
 
 #include <algorithm>
+#include <utility>
 
 #include "server/redis_reply.h"
 #include "time_util.h"
@@ -52,56 +53,115 @@ LogCollector<T>::~LogCollector() {
   Reset();
 }
 
+template <class T>
+size_t LogCollector<T>::shardIndex() {
+  // the threads are assigned to the shards in turn, so the workers wouldn't share the shard
+  // unless the number of the threads is larger than the number of shards
+  static std::atomic<size_t> next_index = 0;
+  thread_local size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % kShards;
+  return index;
+}
+
+template <class T>
+void LogCollector<T>::Shard::Resize(size_t capacity) {
+  std::vector<std::unique_ptr<T>> new_ring(capacity);
+  size_t new_size = std::min(size, capacity);
+  // keep the newest entries, the oldest one is put at the beginning
+  for (size_t i = 0; i < new_size; i++) {
+    new_ring[new_size - 1 - i] = std::move(Newest(i));
+  }
+  ring = std::move(new_ring);
+  head = capacity > 0 ? new_size % capacity : 0;
+  size = new_size;
+}
+
 template <class T>
 ssize_t LogCollector<T>::Size() {
-  std::lock_guard<std::mutex> guard(mu_);
-  ssize_t n = entries_.size();
-  return n;
+  size_t n = 0;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.mu);
+    n += shard.size;
+  }
+
+  int64_t max_entries = max_entries_.load(std::memory_order_relaxed);
+  if (max_entries > 0) n = std::min(n, static_cast<size_t>(max_entries));
+  return static_cast<ssize_t>(n);
 }
 
 template <class T>
 void LogCollector<T>::Reset() {
-  std::lock_guard<std::mutex> guard(mu_);
-  while (!entries_.empty()) {
-    entries_.pop_front();
+  for (auto &shard : shards_) {
+    std::vector<std::unique_ptr<T>> entries;
+    {
+      std::lock_guard<std::mutex> guard(shard.mu);
+      entries.swap(shard.ring);
+      shard.ring.resize(entries.size());
+      shard.head = 0;
+      shard.size = 0;
+    }
+    // the entries are released outside the lock
   }
 }
 
 template <class T>
 void LogCollector<T>::SetMaxEntries(int64_t max_entries) {
-  std::lock_guard<std::mutex> guard(mu_);
-  while (max_entries > 0 && static_cast<int64_t>(entries_.size()) > max_entries) {
-    entries_.pop_back();
+  max_entries_.store(max_entries, std::memory_order_relaxed);
+  if (max_entries <= 0) return;
+
+  // the rings would grow while pushing entries, only shrink the larger ones here
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.mu);
+    if (shard.ring.size() > static_cast<size_t>(max_entries)) shard.Resize(max_entries);
   }
-  max_entries_ = max_entries;
 }
 
 template <class T>
 void LogCollector<T>::PushEntry(std::unique_ptr<T> &&entry) {
-  std::lock_guard<std::mutex> guard(mu_);
-  entry->id = ++id_;
+  entry->id = id_.fetch_add(1, std::memory_order_relaxed) + 1;
   entry->time = util::GetTimeStamp();
-  if (max_entries_ > 0 && !entries_.empty() && entries_.size() >= static_cast<size_t>(max_entries_)) {
-    entries_.pop_back();
+
+  auto &shard = shards_[shardIndex()];
+  std::unique_ptr<T> evicted;
+  {
+    std::lock_guard<std::mutex> guard(shard.mu);
+    int64_t max_entries = max_entries_.load(std::memory_order_relaxed);
+    size_t limit = max_entries > 0 ? static_cast<size_t>(max_entries) : SIZE_MAX;
+    if (shard.size == shard.ring.size() && shard.ring.size() < limit) {
+      // the ring is doubled until it reaches the limit, then the oldest entry would be overwritten
+      shard.Resize(std::min(std::max(shard.ring.size() * 2, kInitialCapacity), limit));
+    }
+
+    evicted = std::exchange(shard.ring[shard.head], std::move(entry));
+    shard.head = (shard.head + 1) % shard.ring.size();
+    shard.size = std::min(shard.size + 1, shard.ring.size());
   }
-  entries_.push_front(std::move(entry));
+  // the evicted entry is released outside the lock
 }
 
 template <class T>
 std::string LogCollector<T>::GetLatestEntries(int64_t cnt) {
-  size_t n = 0;
-  std::string output;
+  int64_t max_entries = max_entries_.load(std::memory_order_relaxed);
+  if (cnt <= 0 || (max_entries > 0 && cnt > max_entries)) cnt = max_entries;
 
-  std::lock_guard<std::mutex> guard(mu_);
-  if (cnt > 0) {
-    n = std::min(entries_.size(), static_cast<size_t>(cnt));
-  } else {
-    n = entries_.size();
+  // each shard contributes at most cnt of its newest entries, and the newest
+  // ones of them are picked by the id which is increasing with the push order
+  std::vector<std::pair<uint64_t, std::string>> entries;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.mu);
+    size_t n = cnt > 0 ? std::min(shard.size, static_cast<size_t>(cnt)) : shard.size;
+    for (size_t i = 0; i < n; i++) {
+      const auto &entry = shard.Newest(i);
+      entries.emplace_back(entry->id, entry->ToRedisString());
+    }
   }
-  output.append(redis::MultiLen(n));
-  for (const auto &entry : entries_) {
-    output.append(entry->ToRedisString());
-    if (--n == 0) break;
+
+  std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+  if (cnt > 0 && entries.size() > static_cast<size_t>(cnt)) entries.resize(cnt);
+
+  std::string output;
+  output.append(redis::MultiLen(entries.size()));
+  for (const auto &entry : entries) {
+    output.append(entry.second);
   }
   return output;
 }
@@ -22,8 +22,9 @@
 
 #include <time.h>
 
+#include <array>
+#include <atomic>
 #include <cstdint>
-#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -52,6 +53,15 @@ class PerfEntry {
   std::string ToRedisString() const;
 };
 
+// LogCollector keeps the latest max entries, the entries are spread over the shards by the
+// pushing thread, so that the workers rarely contend for the same lock even if the latency
+// spikes and all of them are pushing entries at the same time. Each shard is a ring buffer
+// which grows up to the max entries and is reused after that, and the shards are merged by
+// the entry id while getting the latest entries.
+//
+// NOTE: every shard may keep up to the max entries, so the memory use is bounded by
+// kShards * max entries rather than the max entries when many workers push entries,
+// while only the latest max entries are reported.
 template <class T>
 class LogCollector {
  public:
@@ -66,8 +76,24 @@ class LogCollector {
   std::string GetLatestEntries(int64_t cnt);
 
  private:
-  std::mutex mu_;
-  uint64_t id_ = 0;
-  int64_t max_entries_ = 128;
-  std::deque<std::unique_ptr<T>> entries_;
+  static constexpr size_t kShards = 16;
+  static constexpr size_t kInitialCapacity = 16;
+
+  struct Shard {
+    std::mutex mu;
+    // the next entry would be put at the head, and the newest entry is at head - 1
+    std::vector<std::unique_ptr<T>> ring;
+    size_t head = 0;
+    size_t size = 0;
+
+    void Resize(size_t capacity);
+    std::unique_ptr<T> &Newest(size_t i) { return ring[(head + ring.size() - 1 - i) % ring.size()]; }
+  };
+
+  std::atomic<uint64_t> id_ = 0;
+  // zero means there's no limit
+  std::atomic<int64_t> max_entries_ = 128;
+  std::array<Shard, kShards> shards_;
+
+  static size_t shardIndex();
 };
@@ -25,6 +25,11 @@
 #include "fmt/format.h"
 #include "time_util.h"
 
+const char *PerfStatsMetricNames[PERF_METRIC_COUNT] = {"block_cache_hit", "block_read",   "block_read_bytes",
+                                                       "bloom_useful",    "memtable_hit", "seek",
+                                                       "next",            "key_skipped",  "delete_skipped",
+                                                       "read_bytes"};
+
 Stats::Stats() {
   for (int i = 0; i < STATS_METRIC_COUNT; i++) {
     InstMetric im;
@@ -82,13 +87,30 @@ int64_t Stats::GetMemoryRSS() {
 }
 #endif
 
-void Stats::IncrCalls(const std::string &command_name) {
+void Stats::IncrCalls(int command_id) {
   total_calls.fetch_add(1, std::memory_order_relaxed);
-  commands_stats[command_name].calls.fetch_add(1, std::memory_order_relaxed);
+  commands_stats[command_id].calls.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Stats::IncrLatency(uint64_t latency, int command_id) {
+  commands_stats[command_id].latency.fetch_add(latency, std::memory_order_relaxed);
+}
+
+void Stats::IncrPerfStats(const std::array<uint64_t, PERF_METRIC_COUNT> &metrics, int command_id) {
+  auto &cmd_stat = commands_stats[command_id];
+  cmd_stat.perf_samples.fetch_add(1, std::memory_order_relaxed);
+  for (int i = 0; i < PERF_METRIC_COUNT; i++) {
+    if (metrics[i] > 0) cmd_stat.perf_metrics[i].fetch_add(metrics[i], std::memory_order_relaxed);
+  }
 }
 
-void Stats::IncrLatency(uint64_t latency, const std::string &command_name) {
-  commands_stats[command_name].latency.fetch_add(latency, std::memory_order_relaxed);
+void Stats::ResetPerfStats() {
+  for (auto &cmd_stat : commands_stats) {
+    cmd_stat.perf_samples.store(0, std::memory_order_relaxed);
+    for (auto &metric : cmd_stat.perf_metrics) {
+      metric.store(0, std::memory_order_relaxed);
+    }
+  }
 }
 
 void Stats::TrackInstantaneousMetric(int metric, uint64_t current_reading) {
@@ -22,6 +22,7 @@
 
 #include <unistd.h>
 
+#include <array>
 #include <atomic>
 #include <map>
 #include <string>
@@ -42,9 +43,29 @@ enum StatsMetricFlags {
 
 const int STATS_METRIC_SAMPLES = 16;  // Number of samples per metric
 
+// The metrics are taken from the rocksdb perf and iostats context of the profiled commands
+enum PerfStatsMetric {
+  PERF_METRIC_BLOCK_CACHE_HIT = 0,  // Number of block cache hits
+  PERF_METRIC_BLOCK_READ,           // Number of blocks read from the disk
+  PERF_METRIC_BLOCK_READ_BYTES,     // Bytes of blocks read from the disk
+  PERF_METRIC_BLOOM_USEFUL,         // Number of sst reads avoided by the bloom filter
+  PERF_METRIC_MEMTABLE_HIT,         // Number of gets served by the memtable
+  PERF_METRIC_SEEK,                 // Number of iterator seeks
+  PERF_METRIC_NEXT,                 // Number of iterator next and prev
+  PERF_METRIC_KEY_SKIPPED,          // Number of internal keys skipped by iterators
+  PERF_METRIC_DELETE_SKIPPED,       // Number of tombstones skipped by iterators
+  PERF_METRIC_READ_BYTES,           // Bytes read from the files
+  PERF_METRIC_COUNT
+};
+
+extern const char *PerfStatsMetricNames[PERF_METRIC_COUNT];
+
 struct CommandStat {
-  std::atomic<uint64_t> calls;
-  std::atomic<uint64_t> latency;
+  std::atomic<uint64_t> calls = {0};
+  std::atomic<uint64_t> latency = {0};
+  // aggregated from the profiled samples only, see profiling-sample-ratio
+  std::atomic<uint64_t> perf_samples = {0};
+  std::array<std::atomic<uint64_t>, PERF_METRIC_COUNT> perf_metrics = {};
 };
 
 struct InstMetric {
@@ -64,16 +85,24 @@ class Stats {
   std::atomic<uint64_t> fullsync_counter = {0};
   std::atomic<uint64_t> psync_err_counter = {0};
   std::atomic<uint64_t> psync_ok_counter = {0};
-  std::map<std::string, CommandStat> commands_stats;
+  std::atomic<uint64_t> output_buffer_limit_disconnections = {0};
+  // indexed by the command id, it's sized once before serving to prevent concurrent insert
+  std::vector<CommandStat> commands_stats;
 
   Stats();
-  void IncrCalls(const std::string &command_name);
-  void IncrLatency(uint64_t latency, const std::string &command_name);
+  void InitCommandStats(size_t num_commands) { commands_stats = std::vector<CommandStat>(num_commands); }
+  void IncrCalls(int command_id);
+  void IncrLatency(uint64_t latency, int command_id);
+  void IncrPerfStats(const std::array<uint64_t, PERF_METRIC_COUNT> &metrics, int command_id);
+  void ResetPerfStats();
   void IncrInbondBytes(uint64_t bytes) { in_bytes.fetch_add(bytes, std::memory_order_relaxed); }
   void IncrOutbondBytes(uint64_t bytes) { out_bytes.fetch_add(bytes, std::memory_order_relaxed); }
   void IncrFullSyncCounter() { fullsync_counter.fetch_add(1, std::memory_order_relaxed); }
   void IncrPSyncErrCounter() { psync_err_counter.fetch_add(1, std::memory_order_relaxed); }
   void IncrPSyncOKCounter() { psync_ok_counter.fetch_add(1, std::memory_order_relaxed); }
+  void IncrOutputBufferLimitDisconnections() {
+    output_buffer_limit_disconnections.fetch_add(1, std::memory_order_relaxed);
+  }
   static int64_t GetMemoryRSS();
   void TrackInstantaneousMetric(int metric, uint64_t current_reading);
   uint64_t GetInstantaneousMetric(int metric);
@@ -0,0 +1,128 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "auto_tuner.h"
+
+#include <algorithm>
+
+AutoTuner::Settings AutoTuner::configured(const Bounds &bounds) {
+  Settings settings;
+  if (bounds.total_block_cache > 0) {
+    settings.metadata_block_cache = bounds.metadata_block_cache;
+    settings.subkey_block_cache = bounds.total_block_cache - bounds.metadata_block_cache;
+  }
+  settings.write_buffer = bounds.min_write_buffer;
+  settings.background_jobs = bounds.min_background_jobs;
+  return settings;
+}
+
+AutoTuner::Settings AutoTuner::Tune(const Signals &signals, const Bounds &bounds) {
+  std::lock_guard<std::mutex> guard(mu_);
+  if (!initialized_) {
+    // the first round only takes the baseline of the cumulative counters
+    initialized_ = true;
+    settings_ = configured(bounds);
+    last_signals_ = signals;
+    return settings_;
+  }
+
+  // the bounds may be changed by the config since the last round
+  auto max_write_buffer = std::max(bounds.max_write_buffer, bounds.min_write_buffer);
+  auto max_background_jobs = std::max(bounds.max_background_jobs, bounds.min_background_jobs);
+  settings_.write_buffer = std::clamp(settings_.write_buffer, bounds.min_write_buffer, max_write_buffer);
+  settings_.background_jobs = std::clamp(settings_.background_jobs, bounds.min_background_jobs, max_background_jobs);
+
+  bool stalled = signals.write_stalls > last_signals_.write_stalls;
+  bool compaction_pressure =
+      (signals.pending_compaction_bytes_limit > 0 &&
+       signals.pending_compaction_bytes * 2 >= signals.pending_compaction_bytes_limit) ||
+      (signals.l0_slowdown_trigger > 0 && signals.l0_files * 2 >= signals.l0_slowdown_trigger);
+  bool memtable_pressure =
+      signals.max_write_buffer_number > 1 && signals.immutable_memtables + 1 >= signals.max_write_buffer_number;
+
+  // the stalls are caused by either too many memtables or the compactions falling behind, raise
+  // the background jobs if the compactions can't keep up, and enlarge the write buffer if the
+  // memtables can't be flushed in time
+  if (stalled || compaction_pressure) {
+    settings_.background_jobs = std::min(settings_.background_jobs + 1, max_background_jobs);
+  }
+  if (memtable_pressure || (stalled && !compaction_pressure)) {
+    settings_.write_buffer = std::min(settings_.write_buffer * 2, max_write_buffer);
+  }
+
+  if (stalled || compaction_pressure || memtable_pressure) {
+    calm_rounds_ = 0;
+  } else if (++calm_rounds_ >= kCalmRounds) {
+    calm_rounds_ = 0;
+    settings_.background_jobs = std::max(settings_.background_jobs - 1, bounds.min_background_jobs);
+    settings_.write_buffer = std::max(settings_.write_buffer / 2, bounds.min_write_buffer);
+  }
+
+  tuneBlockCache(signals, bounds);
+  last_signals_ = signals;
+  return settings_;
+}
+
+void AutoTuner::tuneBlockCache(const Signals &signals, const Bounds &bounds) {
+  if (bounds.total_block_cache == 0) {
+    settings_.metadata_block_cache = settings_.subkey_block_cache = 0;
+    return;
+  }
+
+  // each block cache keeps at least half of its configured capacity
+  size_t min_metadata = bounds.metadata_block_cache / 2;
+  size_t min_subkey = (bounds.total_block_cache - bounds.metadata_block_cache) / 2;
+  size_t metadata = settings_.metadata_block_cache;
+  if (settings_.metadata_block_cache + settings_.subkey_block_cache != bounds.total_block_cache) {
+    metadata = bounds.metadata_block_cache;
+  }
+
+  uint64_t hits = signals.block_cache_hits - last_signals_.block_cache_hits;
+  uint64_t misses = signals.block_cache_misses - last_signals_.block_cache_misses;
+  // move the capacity only if the caches miss a lot, from the cache which isn't full to
+  // the one which is full and is likely to evict the blocks which would be read again
+  if (hits + misses >= kMinCacheLookups && misses * 10 >= hits + misses) {
+    size_t subkey = bounds.total_block_cache - metadata;
+    size_t step = bounds.total_block_cache / 16;
+    bool metadata_full = signals.metadata_cache_usage * 20 >= metadata * 19;
+    bool subkey_full = signals.subkey_cache_usage * 20 >= subkey * 19;
+    if (metadata_full && !subkey_full) {
+      metadata += std::min(step, subkey - std::min(subkey, min_subkey));
+    } else if (subkey_full && !metadata_full) {
+      metadata -= std::min(step, metadata - std::min(metadata, min_metadata));
+    }
+  }
+
+  settings_.metadata_block_cache = metadata;
+  settings_.subkey_block_cache = bounds.total_block_cache - metadata;
+}
+
+AutoTuner::Settings AutoTuner::GetSettings() {
+  std::lock_guard<std::mutex> guard(mu_);
+  return settings_;
+}
+
+AutoTuner::Settings AutoTuner::Reset(const Bounds &bounds) {
+  std::lock_guard<std::mutex> guard(mu_);
+  initialized_ = false;
+  calm_rounds_ = 0;
+  settings_ = configured(bounds);
+  return settings_;
+}
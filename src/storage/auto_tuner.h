@@ -0,0 +1,98 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// AutoTuner decides the block cache split, the write buffer size and the number of background
+// compactions from the signals sampled periodically, it only makes the decisions and the storage
+// applies them to RocksDB. The settings are raised as soon as the pressure was seen, and are only
+// lowered back towards the configured values after it's calm for a while, to avoid flapping
+// between the read-heavy and write-heavy phases.
+class AutoTuner {
+ public:
+  // Signals are sampled from RocksDB before each tuning, the counters are cumulative
+  struct Signals {
+    uint64_t block_cache_hits = 0;
+    uint64_t block_cache_misses = 0;
+    uint64_t write_stalls = 0;
+    size_t metadata_cache_usage = 0;
+    size_t subkey_cache_usage = 0;
+    uint64_t pending_compaction_bytes = 0;
+    uint64_t pending_compaction_bytes_limit = 0;
+    uint64_t l0_files = 0;
+    uint64_t l0_slowdown_trigger = 0;
+    uint64_t immutable_memtables = 0;
+    uint64_t max_write_buffer_number = 0;
+  };
+
+  // Bounds are taken from the config, the configured values are used as the minimums
+  struct Bounds {
+    // zero if the metadata and subkey block cache are shared
+    size_t total_block_cache = 0;
+    size_t metadata_block_cache = 0;
+    size_t min_write_buffer = 0;
+    size_t max_write_buffer = 0;
+    int min_background_jobs = 0;
+    int max_background_jobs = 0;
+  };
+
+  struct Settings {
+    size_t metadata_block_cache = 0;
+    size_t subkey_block_cache = 0;
+    size_t write_buffer = 0;
+    int background_jobs = 0;
+
+    bool operator==(const Settings &that) const {
+      return metadata_block_cache == that.metadata_block_cache && subkey_block_cache == that.subkey_block_cache &&
+             write_buffer == that.write_buffer && background_jobs == that.background_jobs;
+    }
+    bool operator!=(const Settings &that) const { return !(*this == that); }
+  };
+
+  // the rounds without pressure before the settings are lowered
+  static constexpr int kCalmRounds = 10;
+  // the minimal number of block cache lookups in a round to move the cache capacity
+  static constexpr uint64_t kMinCacheLookups = 1000;
+
+  void RecordWriteStall() { write_stalls_.fetch_add(1, std::memory_order_relaxed); }
+  uint64_t GetWriteStalls() const { return write_stalls_.load(std::memory_order_relaxed); }
+
+  Settings Tune(const Signals &signals, const Bounds &bounds);
+  Settings GetSettings();
+  // Reset forgets the tuned settings and returns the configured ones
+  Settings Reset(const Bounds &bounds);
+
+ private:
+  std::atomic<uint64_t> write_stalls_ = 0;
+
+  std::mutex mu_;
+  bool initialized_ = false;
+  Settings settings_;
+  Signals last_signals_;
+  int calm_rounds_ = 0;
+
+  static Settings configured(const Bounds &bounds);
+  void tuneBlockCache(const Signals &signals, const Bounds &bounds);
+};
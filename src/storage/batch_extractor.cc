@@ -44,14 +44,15 @@ void WriteBatchExtractor::LogData(const rocksdb::Slice &blob) {
 }
 
 rocksdb::Status WriteBatchExtractor::PutCF(uint32_t column_family_id, const Slice &key, const Slice &value) {
-  if (column_family_id == kColumnFamilyIDZSetScore) {
+  auto cf_id = sharedCFID(column_family_id);
+  if (cf_id == kColumnFamilyIDZSetScore) {
     return rocksdb::Status::OK();
   }
 
   std::string ns, user_key;
   std::vector<std::string> command_args;
 
-  if (column_family_id == kColumnFamilyIDMetadata) {
+  if (cf_id == kColumnFamilyIDMetadata) {
     ExtractNamespaceKey(key, &ns, &user_key, is_slot_id_encoded_);
     if (slot_id_ >= 0 && static_cast<uint16_t>(slot_id_) != GetSlotIdFromKey(user_key)) {
       return rocksdb::Status::OK();
@@ -108,9 +109,11 @@ rocksdb::Status WriteBatchExtractor::PutCF(uint32_t column_family_id, const Slic
     return rocksdb::Status::OK();
   }
 
-  if (column_family_id == kColumnFamilyIDDefault) {
+  if (cf_id == kColumnFamilyIDDefault) {
     InternalKey ikey(key, is_slot_id_encoded_);
-    user_key = ikey.GetKey().ToString();
+    if (!getUserKey(column_family_id, ikey, &user_key)) {
+      return rocksdb::Status::OK();
+    }
     if (slot_id_ >= 0 && static_cast<uint16_t>(slot_id_) != GetSlotIdFromKey(user_key)) {
       return rocksdb::Status::OK();
     }
@@ -247,7 +250,7 @@ rocksdb::Status WriteBatchExtractor::PutCF(uint32_t column_family_id, const Slic
       default:
         break;
     }
-  } else if (column_family_id == kColumnFamilyIDStream) {
+  } else if (cf_id == kColumnFamilyIDStream) {
     auto s = ExtractStreamAddCommand(is_slot_id_encoded_, key, value, &command_args);
     if (!s.IsOK()) {
       LOG(ERROR) << "Failed to parse write_batch in PutCF. Type=Stream: " << s.Msg();
@@ -263,14 +266,15 @@ rocksdb::Status WriteBatchExtractor::PutCF(uint32_t column_family_id, const Slic
 }
 
 rocksdb::Status WriteBatchExtractor::DeleteCF(uint32_t column_family_id, const Slice &key) {
-  if (column_family_id == kColumnFamilyIDZSetScore) {
+  auto cf_id = sharedCFID(column_family_id);
+  if (cf_id == kColumnFamilyIDZSetScore) {
     return rocksdb::Status::OK();
   }
 
   std::vector<std::string> command_args;
   std::string ns;
 
-  if (column_family_id == kColumnFamilyIDMetadata) {
+  if (cf_id == kColumnFamilyIDMetadata) {
     std::string user_key;
     ExtractNamespaceKey(key, &ns, &user_key, is_slot_id_encoded_);
 
@@ -279,9 +283,12 @@ rocksdb::Status WriteBatchExtractor::DeleteCF(uint32_t column_family_id, const S
     }
 
     command_args = {"DEL", user_key};
-  } else if (column_family_id == kColumnFamilyIDDefault) {
+  } else if (cf_id == kColumnFamilyIDDefault) {
     InternalKey ikey(key, is_slot_id_encoded_);
-    std::string user_key = ikey.GetKey().ToString();
+    std::string user_key;
+    if (!getUserKey(column_family_id, ikey, &user_key)) {
+      return rocksdb::Status::OK();
+    }
     if (slot_id_ >= 0 && static_cast<uint16_t>(slot_id_) != GetSlotIdFromKey(user_key)) {
       return rocksdb::Status::OK();
     }
@@ -371,7 +378,7 @@ rocksdb::Status WriteBatchExtractor::DeleteCF(uint32_t column_family_id, const S
       default:
         break;
     }
-  } else if (column_family_id == kColumnFamilyIDStream) {
+  } else if (cf_id == kColumnFamilyIDStream) {
     InternalKey ikey(key, is_slot_id_encoded_);
     Slice encoded_id = ikey.GetSubKey();
     redis::StreamEntryID entry_id;
@@ -393,6 +400,34 @@ rocksdb::Status WriteBatchExtractor::DeleteRangeCF(uint32_t column_family_id, co
   return rocksdb::Status::OK();
 }
 
+ColumnFamilyID WriteBatchExtractor::sharedCFID(uint32_t column_family_id) {
+  // the column families of the isolated namespaces take the place of the shared ones
+  return storage_ ? storage_->GetSharedCFID(column_family_id) : static_cast<ColumnFamilyID>(column_family_id);
+}
+
+bool WriteBatchExtractor::getUserKey(uint32_t column_family_id, const InternalKey &ikey, std::string *user_key) {
+  if (!ikey.IsKeyIdEncoded()) {
+    *user_key = ikey.GetKey().ToString();
+    return true;
+  }
+  // the anchors are written together with the metadata, so they don't need to be extracted
+  if (ikey.IsKeyIdAnchor() || !storage_) return false;
+
+  // the anchor lives in the subkey column family of the same namespace
+  auto cf_handle = storage_->GetSiblingCFHandle(column_family_id, engine::kSubkeyColumnFamilyName);
+  if (!cf_handle) return false;
+
+  std::string anchor_key;
+  ikey.EncodeKeyIdAnchor(&anchor_key);
+  auto s = storage_->Get(rocksdb::ReadOptions(), cf_handle, anchor_key, user_key);
+  if (!s.ok()) {
+    // the anchor was recycled after the key was deleted, so the following commands would remove it anyway
+    if (!s.IsNotFound()) LOG(WARNING) << "[batch_extractor] Failed to get the key id anchor: " << s.ToString();
+    return false;
+  }
+  return true;
+}
+
 Status WriteBatchExtractor::ExtractStreamAddCommand(bool is_slot_id_encoded, const Slice &subkey, const Slice &value,
                                                     std::vector<std::string> *command_args) {
   InternalKey ikey(subkey, is_slot_id_encoded);
@@ -32,8 +32,10 @@
 // An extractor to extract update from raw write batch
 class WriteBatchExtractor : public rocksdb::WriteBatch::Handler {
  public:
-  explicit WriteBatchExtractor(bool is_slot_id_encoded, int16_t slot_id = -1, bool to_redis = false)
-      : is_slot_id_encoded_(is_slot_id_encoded), slot_id_(slot_id), to_redis_(to_redis) {}
+  // the storage is used to find the user keys of the key id encoded subkeys, they're skipped without it
+  explicit WriteBatchExtractor(bool is_slot_id_encoded, int16_t slot_id = -1, bool to_redis = false,
+                               engine::Storage *storage = nullptr)
+      : is_slot_id_encoded_(is_slot_id_encoded), slot_id_(slot_id), to_redis_(to_redis), storage_(storage) {}
 
   void LogData(const rocksdb::Slice &blob) override;
   rocksdb::Status PutCF(uint32_t column_family_id, const Slice &key, const Slice &value) override;
@@ -51,4 +53,8 @@ class WriteBatchExtractor : public rocksdb::WriteBatch::Handler {
   bool is_slot_id_encoded_ = false;
   int slot_id_;
   bool to_redis_;
+  engine::Storage *storage_;
+
+  ColumnFamilyID sharedCFID(uint32_t column_family_id);
+  bool getUserKey(uint32_t column_family_id, const InternalKey &ikey, std::string *user_key);
 };
@@ -53,39 +53,146 @@ Status SubKeyFilter::GetMetadata(const InternalKey &ikey, Metadata *metadata) co
   std::string metadata_key;
 
   auto db = stor_->GetDB();
-  const auto cf_handles = stor_->GetCFHandles();
   // storage close the would delete the column family handler and DB
-  if (!db || cf_handles->size() < 2) return {Status::NotOK, "storage is closed"};
-  ComposeNamespaceKey(ikey.GetNamespace(), ikey.GetKey(), &metadata_key, stor_->IsSlotIdEncoded());
-
-  if (cached_key_.empty() || metadata_key != cached_key_) {
-    std::string bytes;
-    rocksdb::Status s = db->Get(rocksdb::ReadOptions(), (*cf_handles)[1], metadata_key, &bytes);
-    cached_key_ = std::move(metadata_key);
-    if (s.ok()) {
-      cached_metadata_ = std::move(bytes);
-    } else if (s.IsNotFound()) {
-      // metadata was deleted(perhaps compaction or manual)
-      // clear the metadata
-      cached_metadata_.clear();
-      return {Status::NotFound, "metadata is not found"};
-    } else {
-      cached_key_.clear();
-      cached_metadata_.clear();
+  if (!db) return {Status::NotOK, "storage is closed"};
+  if (!subkey_cf_handle_ || !metadata_cf_handle_) {
+    // the subkeys of the isolated namespace refer to the metadata in the column families of the namespace
+    subkey_cf_handle_ = stor_->GetSiblingCFHandle(column_family_id_, kSubkeyColumnFamilyName);
+    metadata_cf_handle_ = stor_->GetSiblingCFHandle(column_family_id_, kMetadataColumnFamilyName);
+    if (!subkey_cf_handle_ || !metadata_cf_handle_) return {Status::NotOK, "storage is closed"};
+  }
+  if (ikey.IsKeyIdEncoded()) {
+    // the user key of the key id encoded subkey is stored in the anchor, the anchor itself
+    // is also resolved in this way, but it's kept until the subkeys were recycled
+    std::string anchor_key;
+    ikey.EncodeKeyIdAnchor(&anchor_key);
+    if (cached_anchor_key_.empty() || anchor_key != cached_anchor_key_) {
+      std::string user_key;
+      rocksdb::Status s = db->Get(rocksdb::ReadOptions(), subkey_cf_handle_, anchor_key, &user_key);
+      if (s.IsNotFound()) {
+        // the anchor is only recycled after all the subkeys of the key id were recycled
+        return {Status::NotFound, "key id anchor is not found"};
+      }
+      if (!s.ok()) return {Status::NotOK, "fetch key id anchor error: " + s.ToString()};
+      cached_anchor_key_ = std::move(anchor_key);
+      cached_user_key_ = std::move(user_key);
+    }
+    ComposeNamespaceKey(ikey.GetNamespace(), cached_user_key_, &metadata_key, stor_->IsSlotIdEncoded());
+  } else {
+    ComposeNamespaceKey(ikey.GetNamespace(), ikey.GetKey(), &metadata_key, stor_->IsSlotIdEncoded());
+  }
+
+  std::string bytes;
+  auto s = lookupMetadata(db, metadata_key, &bytes);
+  if (!s.IsOK()) return s;
+  // metadata was deleted(perhaps compaction or manual)
+  if (bytes.empty()) return {Status::NotFound, "metadata is not found"};
+
+  rocksdb::Status decode_s = metadata->Decode(bytes);
+  if (!decode_s.ok()) return {Status::NotOK, "decode error: " + decode_s.ToString()};
+  return Status::OK();
+}
+
+Status SubKeyFilter::lookupMetadata(rocksdb::DB *db, const std::string &metadata_key, std::string *value) const {
+  if (auto iter = cached_metadata_.find(metadata_key); iter != cached_metadata_.end()) {
+    lru_.splice(lru_.begin(), lru_, iter->second);
+    *value = iter->second->value;
+    stats_.metadata_cache_hits++;
+    return Status::OK();
+  }
+
+  if (inPrefetched(metadata_key)) {
+    prefetched_hits_++;
+    stats_.metadata_cache_hits++;
+  } else if (shouldPrefetch()) {
+    auto s = prefetchMetadata(db, metadata_key);
+    if (!s.IsOK()) return s;
+  } else {
+    stats_.metadata_gets++;
+    rocksdb::Status s = db->Get(rocksdb::ReadOptions(), metadata_cf_handle_, metadata_key, value);
+    if (s.IsNotFound()) {
+      value->clear();
+    } else if (!s.ok()) {
       return {Status::NotOK, "fetch error: " + s.ToString()};
     }
+    cacheMetadata(metadata_key, *value);
+    return Status::OK();
   }
-  // the metadata was not found
-  if (cached_metadata_.empty()) return {Status::NotFound, "metadata is not found"};
-  // the metadata is cached
-  rocksdb::Status s = metadata->Decode(cached_metadata_);
-  if (!s.ok()) {
-    cached_key_.clear();
-    return {Status::NotOK, "decode error: " + s.ToString()};
+
+  auto iter = prefetched_.find(metadata_key);
+  *value = iter != prefetched_.end() ? iter->second : std::string();
+  cacheMetadata(metadata_key, *value);
+  return Status::OK();
+}
+
+bool SubKeyFilter::inPrefetched(const std::string &metadata_key) const {
+  if (prefetched_begin_.empty() || metadata_key < prefetched_begin_) return false;
+  return prefetched_end_.empty() || metadata_key <= prefetched_end_;
+}
+
+bool SubKeyFilter::shouldPrefetch() const {
+  if (useless_prefetches_ < kMaxUselessPrefetches) return true;
+  // the keys are too sparse to be prefetched, try again after a while
+  if (++backoff_gets_ < kPrefetchBackoff) return false;
+  backoff_gets_ = 0;
+  useless_prefetches_ = 0;
+  return true;
+}
+
+Status SubKeyFilter::prefetchMetadata(rocksdb::DB *db, const std::string &metadata_key) const {
+  if (!metadata_iter_ || num_prefetches_ % kIteratorRecreateInterval == 0) {
+    metadata_iter_.reset(db->NewIterator(rocksdb::ReadOptions(), metadata_cf_handle_));
+  }
+  // the last prefetching was useless if none of the keys except the missed one were looked up
+  if (!prefetched_begin_.empty()) {
+    useless_prefetches_ = prefetched_hits_ > 0 ? 0 : useless_prefetches_ + 1;
   }
+  num_prefetches_++;
+  stats_.metadata_prefetches++;
+  prefetched_hits_ = 0;
+  prefetched_.clear();
+  prefetched_begin_.clear();
+  prefetched_end_.clear();
+
+  metadata_iter_->Seek(metadata_key);
+  for (size_t i = 0; i < kPrefetchMetadata && metadata_iter_->Valid(); i++, metadata_iter_->Next()) {
+    prefetched_.emplace(metadata_iter_->key().ToString(), metadata_iter_->value().ToString());
+  }
+  if (auto s = metadata_iter_->status(); !s.ok()) {
+    prefetched_.clear();
+    metadata_iter_.reset();
+    return {Status::NotOK, "prefetch error: " + s.ToString()};
+  }
+
+  prefetched_begin_ = metadata_key;
+  if (metadata_iter_->Valid()) prefetched_end_ = prefetched_.rbegin()->first;
   return Status::OK();
 }
 
+void SubKeyFilter::cacheMetadata(const std::string &metadata_key, const std::string &value) const {
+  lru_.emplace_front(CachedMetadata{metadata_key, value});
+  cached_metadata_[lru_.front().key] = lru_.begin();
+  if (lru_.size() > kMaxCachedMetadata) {
+    cached_metadata_.erase(lru_.back().key);
+    lru_.pop_back();
+  }
+}
+
+bool SubKeyFilter::recordDecision(bool dropped) const {
+  if (dropped) stats_.dropped_subkeys++;
+  if (++stats_.subkeys % kStatsFlushInterval == 0) flushStats();
+  return dropped;
+}
+
+void SubKeyFilter::flushStats() const {
+  auto filter_stats = stor_->GetSubKeyFilterStats();
+  filter_stats->metadata_gets.fetch_add(stats_.metadata_gets, std::memory_order_relaxed);
+  filter_stats->metadata_prefetches.fetch_add(stats_.metadata_prefetches, std::memory_order_relaxed);
+  filter_stats->metadata_cache_hits.fetch_add(stats_.metadata_cache_hits, std::memory_order_relaxed);
+  filter_stats->dropped_subkeys.fetch_add(stats_.dropped_subkeys, std::memory_order_relaxed);
+  stats_ = LocalStats{stats_.subkeys};
+}
+
 bool SubKeyFilter::IsMetadataExpired(const InternalKey &ikey, const Metadata &metadata) {
   // lazy delete to avoid race condition between command Expire and subkey Compaction
   // Related issue:https://github.com/apache/incubator-kvrocks/issues/1298
@@ -97,45 +204,108 @@ bool SubKeyFilter::IsMetadataExpired(const InternalKey &ikey, const Metadata &me
          || metadata.ExpireAt(lazy_expired_ts) || ikey.GetVersion() != metadata.version;
 }
 
+bool SubKeyFilter::isUnlinked(const Slice &key, const InternalKey &ikey) const {
+  // the subkeys of the collections which are waiting in the deletion log can be dropped without
+  // looking up the metadata, since the deleted version would never come back
+  Slice prefix(key.data(), key.size() - ikey.GetSubKey().size());
+  auto deletion_log = stor_->GetDeletionLog();
+  if (!deletion_log->Contains(prefix)) return false;
+
+  deletion_log->IncrFilterHits();
+  return true;
+}
+
+bool SubKeyFilter::hasKeyIdSubKeys(const InternalKey &anchor) const {
+  // the subkeys share the prefix of the anchor except the marker, see EncodeKeyIdAnchor
+  std::string prefix;
+  anchor.EncodeKeyIdAnchor(&prefix);
+  EncodeFixed32(prefix.data() + prefix.size() - sizeof(uint32_t) - sizeof(uint64_t), kKeyIdSubKeyMarker);
+
+  auto db = stor_->GetDB();
+  if (!db) return true;
+  rocksdb::ReadOptions read_options;
+  read_options.fill_cache = false;
+  for (const auto &name : {kSubkeyColumnFamilyName, kZSetScoreColumnFamilyName}) {
+    auto cf_handle = stor_->GetSiblingCFHandle(column_family_id_, name);
+    if (!cf_handle) return true;
+    std::unique_ptr<rocksdb::Iterator> iter(db->NewIterator(read_options, cf_handle));
+    iter->Seek(prefix);
+    // keep the anchor if it's unknown whether the subkeys were left
+    if (!iter->status().ok() || (iter->Valid() && iter->key().starts_with(prefix))) return true;
+  }
+  return false;
+}
+
+bool SubKeyFilter::isRecyclableAnchor(const InternalKey &ikey) const {
+  Metadata metadata(kRedisNone, false);
+  Status s = GetMetadata(ikey, &metadata);
+  if (!s.IsOK() && !s.Is<Status::NotFound>()) {
+    LOG(ERROR) << "[compact_filter/subkey] Failed to get metadata of the key id anchor"
+               << ", namespace: " << ikey.GetNamespace().ToString() << ", err: " << s.Msg();
+    return false;
+  }
+  if (s.IsOK() && !IsMetadataExpired(ikey, metadata)) return false;
+  // the subkeys may be still alive in the files which were not compacted yet, they would resolve
+  // to the anchor of the new key which took the same key id if the anchor was recycled before them
+  return !hasKeyIdSubKeys(ikey);
+}
+
 rocksdb::CompactionFilter::Decision SubKeyFilter::FilterBlobByKey(int level, const Slice &key, std::string *new_value,
                                                                   std::string *skip_until) const {
   InternalKey ikey(key, stor_->IsSlotIdEncoded());
+  if (ikey.IsKeyIdAnchor()) {
+    bool result = recordDecision(isRecyclableAnchor(ikey));
+    return result ? rocksdb::CompactionFilter::Decision::kRemove : rocksdb::CompactionFilter::Decision::kKeep;
+  }
+  if (isUnlinked(key, ikey)) {
+    recordDecision(true);
+    return rocksdb::CompactionFilter::Decision::kRemove;
+  }
   Metadata metadata(kRedisNone, false);
   Status s = GetMetadata(ikey, &metadata);
   if (s.Is<Status::NotFound>()) {
+    recordDecision(true);
     return rocksdb::CompactionFilter::Decision::kRemove;
   }
   if (!s.IsOK()) {
     LOG(ERROR) << "[compact_filter/subkey] Failed to get metadata"
                << ", namespace: " << ikey.GetNamespace().ToString() << ", key: " << ikey.GetKey().ToString()
                << ", err: " << s.Msg();
+    recordDecision(false);
     return rocksdb::CompactionFilter::Decision::kKeep;
   }
-  // bitmap will be checked in Filter
+  // bitmap will be checked in Filter, and the decision is recorded there
   if (metadata.Type() == kRedisBitmap) {
     return rocksdb::CompactionFilter::Decision::kUndetermined;
   }
 
-  bool result = IsMetadataExpired(ikey, metadata);
+  bool result = recordDecision(IsMetadataExpired(ikey, metadata));
   return result ? rocksdb::CompactionFilter::Decision::kRemove : rocksdb::CompactionFilter::Decision::kKeep;
 }
 
 bool SubKeyFilter::Filter(int level, const Slice &key, const Slice &value, std::string *new_value,
                           bool *modified) const {
   InternalKey ikey(key, stor_->IsSlotIdEncoded());
+  if (ikey.IsKeyIdAnchor()) {
+    return recordDecision(isRecyclableAnchor(ikey));
+  }
+  if (isUnlinked(key, ikey)) {
+    return recordDecision(true);
+  }
   Metadata metadata(kRedisNone, false);
   Status s = GetMetadata(ikey, &metadata);
   if (s.Is<Status::NotFound>()) {
-    return true;
+    return recordDecision(true);
   }
   if (!s.IsOK()) {
     LOG(ERROR) << "[compact_filter/subkey] Failed to get metadata"
                << ", namespace: " << ikey.GetNamespace().ToString() << ", key: " << ikey.GetKey().ToString()
                << ", err: " << s.Msg();
-    return false;
+    return recordDecision(false);
   }
 
-  return IsMetadataExpired(ikey, metadata) || (metadata.Type() == kRedisBitmap && redis::Bitmap::IsEmptySegment(value));
+  return recordDecision(IsMetadataExpired(ikey, metadata) ||
+                        (metadata.Type() == kRedisBitmap && redis::Bitmap::IsEmptySegment(value)));
 }
 
 }  // namespace engine
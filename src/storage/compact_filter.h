@@ -23,8 +23,12 @@
 #include <rocksdb/compaction_filter.h>
 #include <rocksdb/db.h>
 
+#include <list>
+#include <map>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "redis_metadata.h"
@@ -57,7 +61,10 @@ class MetadataFilterFactory : public rocksdb::CompactionFilterFactory {
 
 class SubKeyFilter : public rocksdb::CompactionFilter {
  public:
-  explicit SubKeyFilter(Storage *storage) : stor_(storage) {}
+  // the column family id tells which namespace the subkeys belong to if it's isolated
+  explicit SubKeyFilter(Storage *storage, uint32_t column_family_id = kColumnFamilyIDDefault)
+      : stor_(storage), column_family_id_(column_family_id) {}
+  ~SubKeyFilter() override { flushStats(); }
 
   const char *Name() const override { return "SubkeyFilter"; }
   Status GetMetadata(const InternalKey &ikey, Metadata *metadata) const;
@@ -67,9 +74,65 @@ class SubKeyFilter : public rocksdb::CompactionFilter {
   bool Filter(int level, const Slice &key, const Slice &value, std::string *new_value, bool *modified) const override;
 
  protected:
-  mutable std::string cached_key_;
-  mutable std::string cached_metadata_;
+  // the metadata of the recently seen keys are cached during the compaction, since the subkeys
+  // of different keys may be interleaved, e.g. the key id encoded subkeys are ordered by version
+  static constexpr size_t kMaxCachedMetadata = 1024;
+  // the metadata following the missed key are read ahead by a single seek, since the subkeys of
+  // the keys with the same length are in the same order as their metadata
+  static constexpr size_t kPrefetchMetadata = 16;
+  // the point lookups are used for a while if the prefetched metadata were useless for many times
+  static constexpr int kMaxUselessPrefetches = 4;
+  static constexpr int kPrefetchBackoff = 256;
+  // the iterator pins the memtables and files, it's recreated periodically to release the old ones
+  static constexpr uint64_t kIteratorRecreateInterval = 256;
+  static constexpr uint64_t kStatsFlushInterval = 1024;
+
+  struct CachedMetadata {
+    std::string key;
+    // empty if the metadata is not found
+    std::string value;
+  };
+
+  struct LocalStats {
+    uint64_t subkeys = 0;
+    uint64_t metadata_gets = 0;
+    uint64_t metadata_prefetches = 0;
+    uint64_t metadata_cache_hits = 0;
+    uint64_t dropped_subkeys = 0;
+  };
+
+  // the most recently used metadata is at the front
+  mutable std::list<CachedMetadata> lru_;
+  mutable std::unordered_map<std::string_view, std::list<CachedMetadata>::iterator> cached_metadata_;
+  // the metadata keys in [prefetched_begin_, prefetched_end_] are read ahead, the keys which are
+  // not in prefetched_ were not found. prefetched_end_ is empty if it's read to the end.
+  mutable std::map<std::string, std::string> prefetched_;
+  mutable std::string prefetched_begin_;
+  mutable std::string prefetched_end_;
+  mutable uint64_t prefetched_hits_ = 0;
+  mutable int useless_prefetches_ = 0;
+  mutable int backoff_gets_ = 0;
+  mutable uint64_t num_prefetches_ = 0;
+  mutable std::unique_ptr<rocksdb::Iterator> metadata_iter_;
+  // the anchor and user key of the last key id encoded subkey
+  mutable std::string cached_anchor_key_;
+  mutable std::string cached_user_key_;
+  mutable LocalStats stats_;
   engine::Storage *stor_;
+  uint32_t column_family_id_;
+  mutable rocksdb::ColumnFamilyHandle *subkey_cf_handle_ = nullptr;
+  mutable rocksdb::ColumnFamilyHandle *metadata_cf_handle_ = nullptr;
+
+  bool isUnlinked(const Slice &key, const InternalKey &ikey) const;
+  bool hasKeyIdSubKeys(const InternalKey &anchor) const;
+  bool isRecyclableAnchor(const InternalKey &ikey) const;
+  Status lookupMetadata(rocksdb::DB *db, const std::string &metadata_key, std::string *value) const;
+  bool inPrefetched(const std::string &metadata_key) const;
+  bool shouldPrefetch() const;
+  Status prefetchMetadata(rocksdb::DB *db, const std::string &metadata_key) const;
+  void cacheMetadata(const std::string &metadata_key, const std::string &value) const;
+  bool recordDecision(bool dropped) const;
+  void flushStats() const;
 };
 
 class SubKeyFilterFactory : public rocksdb::CompactionFilterFactory {
@@ -79,7 +142,7 @@ class SubKeyFilterFactory : public rocksdb::CompactionFilterFactory {
   const char *Name() const override { return "SubKeyFilterFactory"; }
   std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
       const rocksdb::CompactionFilter::Context &context) override {
-    return std::unique_ptr<rocksdb::CompactionFilter>(new SubKeyFilter(stor_));
+    return std::unique_ptr<rocksdb::CompactionFilter>(new SubKeyFilter(stor_, context.column_family_id));
   }
 
  private:
@@ -92,7 +155,7 @@ class PropagateFilter : public rocksdb::CompactionFilter {
   bool Filter(int level, const Slice &key, const Slice &value, std::string *new_value, bool *modified) const override {
     // We propagate Lua commands which don't store data,
     // just in order to implement updating Lua state.
-    return key == engine::kPropagateScriptCommand;
+    return key == engine::kPropagateScriptCommand || key == engine::kPropagateNamespaceCommand;
   }
 };
 
@@ -22,7 +22,13 @@
 
 #include <glog/logging.h>
 
-#include "parse_util.h"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <map>
+#include <set>
+
+#include "string_util.h"
 #include "storage.h"
 #include "time_util.h"
 
@@ -38,101 +44,147 @@ void CompactionChecker::CompactPropagateAndPubSubFiles() {
   }
 }
 
-void CompactionChecker::PickCompactionFiles(const std::string &cf_name) {
+Status CompactionChecker::loadTombstoneStats(const std::string &cf_name) {
+  auto tombstone_stats = storage_->GetTombstoneStats();
+  if (tombstone_stats->IsLoaded(cf_name)) return Status::OK();
+
+  // Only the files which were created before the DB was opened need to be loaded,
+  // the stats of the new files are updated by the table file events.
   rocksdb::TablePropertiesCollection props;
   rocksdb::ColumnFamilyHandle *cf = storage_->GetCFHandle(cf_name);
   auto s = storage_->GetDB()->GetPropertiesOfAllTables(cf, &props);
-  if (!s.ok()) {
-    LOG(WARNING) << "[compaction checker] Failed to get table properties, " << s.ToString();
+  if (!s.ok()) return {Status::NotOK, s.ToString()};
+
+  std::map<std::string, TombstoneStats::FileStats> files;
+  for (const auto &[file_path, file_props] : props) {
+    auto file_stats = TombstoneStats::Parse(cf_name, *file_props);
+    if (!file_stats) continue;
+
+    if (file_stats->creation_time == 0) {
+      // Fallback to the file Modification time to prevent repeatedly compacting the same file,
+      // file_creation_time is 0 which means the unknown condition in rocksdb
+      s = rocksdb::Env::Default()->GetFileModificationTime(file_path, &file_stats->creation_time);
+      if (!s.ok()) {
+        LOG(INFO) << "[compaction checker] Failed to get the file creation time: " << file_path
+                  << ", err: " << s.ToString();
+        continue;
+      }
+    }
+    rocksdb::Env::Default()->GetFileSize(file_path, &file_stats->file_size);
+    files.emplace(TombstoneStats::FileName(file_path), std::move(*file_stats));
+  }
+  tombstone_stats->LoadColumnFamily(cf_name, std::move(files));
+  return Status::OK();
+}
+
+void CompactionChecker::PickCompactionFiles(const std::string &cf_name) {
+  auto s = loadTombstoneStats(cf_name);
+  if (!s.IsOK()) {
+    LOG(WARNING) << "[compaction checker] Failed to get table properties, " << s.Msg();
     return;
   }
+
+  // Drop the stats of the files whose deletion events may be missed while loading
+  std::vector<rocksdb::LiveFileMetaData> live_files_meta;
+  storage_->GetDB()->GetLiveFilesMetaData(&live_files_meta);
+  std::set<std::string> live_files;
+  for (const auto &meta : live_files_meta) {
+    if (meta.column_family_name == cf_name) live_files.insert(TombstoneStats::FileName(meta.name));
+  }
+  auto tombstone_stats = storage_->GetTombstoneStats();
+  tombstone_stats->RetainFiles(cf_name, live_files);
+
+  auto files = tombstone_stats->GetFiles(cf_name);
   // The main goal of compaction was reclaimed the disk space and removed
   // the tombstone. It seems that compaction checker was unnecessary here when
   // the live files was too few, Hard code to 1 here.
-  if (props.size() <= 1) return;
+  if (files.size() <= 1) return;
 
-  size_t max_files_to_compact = 1;
-  if (props.size() / 360 > max_files_to_compact) {
-    max_files_to_compact = props.size() / 360;
-  }
+  size_t max_files_to_compact = std::max<size_t>(1, files.size() / 360);
   int64_t now = util::GetTimeStamp();
 
   auto force_compact_file_age = storage_->GetConfig()->force_compact_file_age;
   auto force_compact_min_ratio =
-      static_cast<double>(storage_->GetConfig()->force_compact_file_min_deleted_percentage / 100);
-
-  std::string best_filename;
-  double best_delete_ratio = 0;
-  int64_t total_keys = 0, deleted_keys = 0;
-  rocksdb::Slice start_key, stop_key, best_start_key, best_stop_key;
-  for (const auto &iter : props) {
-    if (max_files_to_compact == 0) return;
+      static_cast<double>(storage_->GetConfig()->force_compact_file_min_deleted_percentage) / 100;
 
-    uint64_t file_creation_time = iter.second->file_creation_time;
-    if (file_creation_time == 0) {
-      // Fallback to the file Modification time to prevent repeatedly compacting the same file,
-      // file_creation_time is 0 which means the unknown condition in rocksdb
-      s = rocksdb::Env::Default()->GetFileModificationTime(iter.first, &file_creation_time);
-      if (!s.ok()) {
-        LOG(INFO) << "[compaction checker] Failed to get the file creation time: " << iter.first
-                  << ", err: " << s.ToString();
-        continue;
-      }
+  // The files picked by the force compact policy go first, and the others
+  // are ranked by the bytes which would be reclaimed.
+  using FileEntry = std::pair<std::string, TombstoneStats::FileStats>;
+  std::vector<const FileEntry *> forced_files, candidate_files;
+  for (const auto &file : files) {
+    const auto &file_stats = file.second;
+    double delete_ratio = file_stats.DeleteRatio();
+    if (file_stats.creation_time < static_cast<uint64_t>(now - force_compact_file_age) &&
+        delete_ratio >= force_compact_min_ratio) {
+      forced_files.push_back(&file);
+      continue;
     }
+    // don't compact the SST created in 1 hour
+    if (file_stats.creation_time > static_cast<uint64_t>(now - 3600)) continue;
+    if (delete_ratio > 0.1) candidate_files.push_back(&file);
+  }
+  auto by_reclaimable_bytes = [](const FileEntry *a, const FileEntry *b) {
+    return a->second.ReclaimableBytes() > b->second.ReclaimableBytes();
+  };
+  std::sort(forced_files.begin(), forced_files.end(), by_reclaimable_bytes);
+  std::sort(candidate_files.begin(), candidate_files.end(), by_reclaimable_bytes);
+  forced_files.insert(forced_files.end(), candidate_files.begin(), candidate_files.end());
+  if (forced_files.size() > max_files_to_compact) forced_files.resize(max_files_to_compact);
 
-    for (const auto &property_iter : iter.second->user_collected_properties) {
-      if (property_iter.first == "total_keys") {
-        auto parse_result = ParseInt<int>(property_iter.second, 10);
-        if (!parse_result) {
-          LOG(ERROR) << "[compaction checker] Parse total_keys error: " << parse_result.Msg();
-          continue;
-        }
-        total_keys = *parse_result;
-      }
-      if (property_iter.first == "deleted_keys") {
-        auto parse_result = ParseInt<int>(property_iter.second, 10);
-        if (!parse_result) {
-          LOG(ERROR) << "[compaction checker] Parse deleted_keys error: " << parse_result.Msg();
-          continue;
-        }
-        deleted_keys = *parse_result;
-      }
-      if (property_iter.first == "start_key") {
-        start_key = property_iter.second;
-      }
-      if (property_iter.first == "stop_key") {
-        stop_key = property_iter.second;
-      }
-    }
+  std::vector<CompactionRange> ranges;
+  for (const auto *file : forced_files) {
+    const auto &file_stats = file->second;
+    LOG(INFO) << "[compaction checker] Going to compact the key in file: " << file->first
+              << ", delete ratio: " << file_stats.DeleteRatio()
+              << ", reclaimable bytes: " << file_stats.ReclaimableBytes();
+    ranges.push_back({file_stats.start_key, file_stats.stop_key, file_stats.ReclaimableBytes()});
+  }
+  compactRanges(cf_name, MergeRanges(std::move(ranges)));
+}
 
-    if (start_key.empty() || stop_key.empty()) continue;
-    double delete_ratio = static_cast<double>(deleted_keys) / static_cast<double>(total_keys);
+std::vector<CompactionChecker::CompactionRange> CompactionChecker::MergeRanges(std::vector<CompactionRange> ranges) {
+  std::sort(ranges.begin(), ranges.end(),
+            [](const CompactionRange &a, const CompactionRange &b) { return a.start_key < b.start_key; });
 
-    // pick the file according to force compact policy
-    if (file_creation_time < static_cast<uint64_t>(now - force_compact_file_age) &&
-        delete_ratio >= force_compact_min_ratio) {
-      LOG(INFO) << "[compaction checker] Going to compact the key in file (force compact policy): " << iter.first;
-      auto s = storage_->Compact(&start_key, &stop_key);
-      LOG(INFO) << "[compaction checker] Compact the key in file (force compact policy): " << iter.first
-                << " finished, result: " << s.ToString();
-      max_files_to_compact--;
+  std::vector<CompactionRange> merged;
+  for (auto &range : ranges) {
+    if (!merged.empty() && range.start_key <= merged.back().stop_key) {
+      merged.back().stop_key = std::max(merged.back().stop_key, range.stop_key);
+      merged.back().reclaimable_bytes += range.reclaimable_bytes;
       continue;
     }
+    merged.push_back(std::move(range));
+  }
 
-    // don't compact the SST created in 1 hour
-    if (file_creation_time > static_cast<uint64_t>(now - 3600)) continue;
-
-    // pick the file which has highest delete ratio
-    if (total_keys != 0 && delete_ratio > best_delete_ratio) {
-      best_delete_ratio = delete_ratio;
-      best_filename = iter.first;
-      best_start_key = std::move(start_key);
-      best_stop_key = std::move(stop_key);
-    }
+  // Compact the range which would reclaim the most bytes first
+  std::sort(merged.begin(), merged.end(), [](const CompactionRange &a, const CompactionRange &b) {
+    return a.reclaimable_bytes > b.reclaimable_bytes;
+  });
+  return merged;
+}
+
+void CompactionChecker::compactRanges(const std::string &cf_name, const std::vector<CompactionRange> &ranges) {
+  // The manual compactions are exclusive and move the files to the lowest level by default, which
+  // would serialize the compactions of the disjoint ranges, so they're disabled here.
+  rocksdb::CompactRangeOptions compact_opts;
+  compact_opts.exclusive_manual_compaction = false;
+  compact_opts.change_level = false;
+  auto cf_handle = storage_->GetCFHandle(cf_name);
+
+  size_t concurrency = std::min<size_t>(storage_->GetConfig()->compaction_checker_concurrency, ranges.size());
+  std::atomic<size_t> next_range = 0;
+  std::vector<std::future<void>> results;
+  for (size_t i = 0; i < concurrency; i++) {
+    results.emplace_back(std::async(std::launch::async, [this, &ranges, &next_range, &compact_opts, cf_handle] {
+      for (size_t idx = next_range++; idx < ranges.size(); idx = next_range++) {
+        rocksdb::Slice start_key(ranges[idx].start_key), stop_key(ranges[idx].stop_key);
+        auto s = storage_->GetDB()->CompactRange(compact_opts, cf_handle, &start_key, &stop_key);
+        LOG(INFO) << "[compaction checker] Compact the key range [" << util::StringToHex(ranges[idx].start_key) << ", "
+                  << util::StringToHex(ranges[idx].stop_key) << "] finished, result: " << s.ToString();
+      }
+    }));
   }
-  if (best_delete_ratio > 0.1 && !best_start_key.empty() && !best_stop_key.empty()) {
-    LOG(INFO) << "[compaction checker] Going to compact the key in file: " << best_filename
-              << ", delete ratio: " << best_delete_ratio;
-    storage_->Compact(&best_start_key, &best_stop_key);
+  for (auto &result : results) {
+    result.wait();
   }
 }
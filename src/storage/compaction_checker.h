@@ -28,11 +28,24 @@
 
 class CompactionChecker {
  public:
+  // The key range [start_key, stop_key] to compact, and the estimated bytes reclaimed by compacting it
+  struct CompactionRange {
+    std::string start_key;
+    std::string stop_key;
+    uint64_t reclaimable_bytes;
+  };
+
   explicit CompactionChecker(engine::Storage *storage) : storage_(storage) {}
   ~CompactionChecker() = default;
   void PickCompactionFiles(const std::string &cf_name);
   void CompactPropagateAndPubSubFiles();
 
+  // Merge the overlapped ranges, since compacting them concurrently would conflict with each other
+  static std::vector<CompactionRange> MergeRanges(std::vector<CompactionRange> ranges);
+
  private:
   engine::Storage *storage_ = nullptr;
+
+  Status loadTombstoneStats(const std::string &cf_name);
+  void compactRanges(const std::string &cf_name, const std::vector<CompactionRange> &ranges);
 };
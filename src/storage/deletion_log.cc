@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "deletion_log.h"
+
+#include <mutex>
+
+#include "encoding.h"
+
+std::string DeletionLog::EncodeKey(uint64_t timestamp, const rocksdb::Slice &prefix) {
+  std::string log_key;
+  log_key.reserve(sizeof(timestamp) + prefix.size());
+  PutFixed64(&log_key, timestamp);
+  log_key.append(prefix.data(), prefix.size());
+  return log_key;
+}
+
+rocksdb::Slice DeletionLog::SubKeyPrefix(const rocksdb::Slice &log_key) {
+  if (log_key.size() <= sizeof(uint64_t)) return {};
+  return {log_key.data() + sizeof(uint64_t), log_key.size() - sizeof(uint64_t)};
+}
+
+bool DeletionLog::Contains(const rocksdb::Slice &prefix) {
+  if (pending_.load(std::memory_order_relaxed) == 0) return false;
+
+  std::shared_lock<std::shared_mutex> lock(mu_);
+  return prefixes_.find(prefix.ToString()) != prefixes_.end();
+}
+
+void DeletionLog::Add(const rocksdb::Slice &prefix) {
+  std::unique_lock<std::shared_mutex> lock(mu_);
+  prefixes_.emplace(prefix.ToString());
+  pending_.store(prefixes_.size(), std::memory_order_relaxed);
+}
+
+void DeletionLog::Remove(const rocksdb::Slice &prefix) {
+  std::unique_lock<std::shared_mutex> lock(mu_);
+  prefixes_.erase(prefix.ToString());
+  pending_.store(prefixes_.size(), std::memory_order_relaxed);
+}
+
+void DeletionLog::Clear() {
+  std::unique_lock<std::shared_mutex> lock(mu_);
+  prefixes_.clear();
+  pending_.store(0, std::memory_order_relaxed);
+}
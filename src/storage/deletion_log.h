@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <rocksdb/slice.h>
+
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_set>
+
+// DeletionLog tracks the subkeys of the deleted collections which are waiting to be reclaimed.
+// UNLINK writes an entry into the deletion log column family together with the deletion of the
+// metadata, and the reaper removes the subkeys of the deleted version by range deletions in the
+// background, instead of leaving them to the compaction filter which has to look up the metadata
+// for each of them. The pending subkey prefixes are also kept in memory, so the compaction filter
+// could drop their subkeys without any lookup before they're reaped.
+//
+// The log key is <8-byte deletion time in microseconds><subkey prefix>, so the entries are reaped
+// in the order of the deletions. The value is the flags of the deleted metadata.
+class DeletionLog {
+ public:
+  // the small collections are left to the compaction filter since the range deletions aren't free
+  static constexpr uint64_t kMinSubKeys = 64;
+
+  DeletionLog() = default;
+  DeletionLog(const DeletionLog &) = delete;
+  DeletionLog &operator=(const DeletionLog &) = delete;
+
+  static std::string EncodeKey(uint64_t timestamp, const rocksdb::Slice &prefix);
+  // SubKeyPrefix returns the subkey prefix of the log key, it's empty if the log key is malformed
+  static rocksdb::Slice SubKeyPrefix(const rocksdb::Slice &log_key);
+
+  bool Contains(const rocksdb::Slice &prefix);
+  void Add(const rocksdb::Slice &prefix);
+  void Remove(const rocksdb::Slice &prefix);
+  void Clear();
+
+  void IncrReclaimed(uint64_t n) { reclaimed_.fetch_add(n, std::memory_order_relaxed); }
+  void IncrFilterHits() { filter_hits_.fetch_add(1, std::memory_order_relaxed); }
+  size_t GetPending() const { return pending_.load(std::memory_order_relaxed); }
+  uint64_t GetReclaimed() const { return reclaimed_.load(std::memory_order_relaxed); }
+  uint64_t GetFilterHits() const { return filter_hits_.load(std::memory_order_relaxed); }
+
+ private:
+  std::shared_mutex mu_;
+  std::unordered_set<std::string> prefixes_;
+  std::atomic<size_t> pending_ = 0;
+  std::atomic<uint64_t> reclaimed_ = 0;
+  std::atomic<uint64_t> filter_hits_ = 0;
+};
@@ -22,8 +22,11 @@
 
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "time_util.h"
+
 std::string FileCreatedReason2String(const rocksdb::TableFileCreationReason reason) {
   std::vector<std::string> file_created_reason = {"flush", "compaction", "recovery", "misc"};
   if (static_cast<size_t>(reason) < file_created_reason.size()) {
@@ -124,6 +127,7 @@ void EventListener::OnBackgroundError(rocksdb::BackgroundErrorReason reason, roc
 }
 
 void EventListener::OnTableFileDeleted(const rocksdb::TableFileDeletionInfo &info) {
+  storage_->GetTombstoneStats()->RemoveFile(info.file_path);
   LOG(INFO) << "[event_listener/table_file_deleted] db: " << info.db_name << ", sst file: " << info.file_path
             << ", status: " << info.status.ToString();
 }
@@ -132,10 +136,20 @@ void EventListener::OnStallConditionsChanged(const rocksdb::WriteStallInfo &info
   LOG(WARNING) << "[event_listener/stall_cond_changed] column family: " << info.cf_name
                << " write stall condition was changed, from " << StallConditionType2String(info.condition.prev)
                << " to " << StallConditionType2String(info.condition.cur);
+  if (info.condition.cur != rocksdb::WriteStallCondition::kNormal) {
+    storage_->GetAutoTuner()->RecordWriteStall();
+  }
 }
 
 void EventListener::OnTableFileCreated(const rocksdb::TableFileCreationInfo &info) {
   LOG(INFO) << "[event_listener/table_file_created] column family: " << info.cf_name
             << ", file path: " << info.file_path << ", file size: " << info.file_size << ", job id: " << info.job_id
             << ", reason: " << FileCreatedReason2String(info.reason) << ", status: " << info.status.ToString();
+  if (!info.status.ok()) return;
+
+  if (auto stats = TombstoneStats::Parse(info.cf_name, info.table_properties)) {
+    stats->file_size = info.file_size;
+    if (stats->creation_time == 0) stats->creation_time = util::GetTimeStamp();
+    storage_->GetTombstoneStats()->AddFile(info.file_path, std::move(*stats));
+  }
 }
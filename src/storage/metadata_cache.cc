@@ -0,0 +1,171 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "metadata_cache.h"
+
+#include <algorithm>
+#include <functional>
+
+void FrequencySketch::Reset(size_t width) {
+  size_t power_of_two = 1;
+  while (power_of_two < width) power_of_two <<= 1;
+  counters_.assign(power_of_two * kDepth, 0);
+  width_mask_ = power_of_two - 1;
+  sample_size_ = power_of_two * 10;
+  additions_ = 0;
+}
+
+size_t FrequencySketch::index(uint64_t hash, int row) const {
+  static constexpr std::array<uint64_t, kDepth> seeds = {0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+                                                        0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL};
+  uint64_t h = (hash + seeds[row]) * seeds[row];
+  h ^= h >> 32;
+  return static_cast<size_t>(row) * (width_mask_ + 1) + (h & width_mask_);
+}
+
+void FrequencySketch::Increment(uint64_t hash) {
+  bool added = false;
+  for (int i = 0; i < kDepth; i++) {
+    auto &counter = counters_[index(hash, i)];
+    if (counter < kMaxCount) {
+      counter++;
+      added = true;
+    }
+  }
+  if (added && ++additions_ >= sample_size_) age();
+}
+
+uint8_t FrequencySketch::Frequency(uint64_t hash) const {
+  uint8_t frequency = kMaxCount;
+  for (int i = 0; i < kDepth; i++) {
+    frequency = std::min(frequency, counters_[index(hash, i)]);
+  }
+  return frequency;
+}
+
+void FrequencySketch::age() {
+  for (auto &counter : counters_) counter >>= 1;
+  additions_ /= 2;
+}
+
+uint64_t MetadataCache::hash(const rocksdb::Slice &key) {
+  return std::hash<std::string_view>{}(std::string_view{key.data(), key.size()});
+}
+
+bool MetadataCache::Lookup(const rocksdb::Slice &key, std::string *value, uint64_t *epoch) {
+  if (!Enabled()) return false;
+
+  uint64_t h = hash(key);
+  auto &shard = getShard(h);
+  std::lock_guard<std::mutex> guard(shard.mu);
+  shard.sketch.Increment(h);
+  auto iter = shard.entries.find(std::string_view{key.data(), key.size()});
+  if (iter == shard.entries.end()) {
+    *epoch = shard.epoch;
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  shard.lru.splice(shard.lru.begin(), shard.lru, iter->second);
+  value->assign(iter->second->value);
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void MetadataCache::Insert(const rocksdb::Slice &key, const rocksdb::Slice &value, uint64_t epoch) {
+  size_t capacity = shardCapacity();
+  size_t entry_charge = key.size() + value.size() + kEntryOverhead;
+  if (value.size() > kMaxValueSize || entry_charge > capacity) return;
+
+  uint64_t h = hash(key);
+  auto &shard = getShard(h);
+  std::lock_guard<std::mutex> guard(shard.mu);
+  // the key may be modified after the value was read
+  if (epoch != shard.epoch) return;
+
+  auto iter = shard.entries.find(std::string_view{key.data(), key.size()});
+  if (iter != shard.entries.end()) {
+    // the key was inserted by another reader with the same value
+    shard.lru.splice(shard.lru.begin(), shard.lru, iter->second);
+    return;
+  }
+
+  if (shard.usage + entry_charge > capacity && !shard.lru.empty()) {
+    // TinyLFU admission: the new key should be hotter than the key it would evict
+    if (shard.sketch.Frequency(h) <= shard.sketch.Frequency(hash(shard.lru.back().key))) {
+      rejects_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    evict(&shard, capacity - entry_charge);
+  }
+
+  shard.lru.emplace_front(Entry{key.ToString(), value.ToString()});
+  shard.entries.emplace(shard.lru.front().key, shard.lru.begin());
+  shard.usage += entry_charge;
+  usage_.fetch_add(entry_charge, std::memory_order_relaxed);
+}
+
+void MetadataCache::Invalidate(const rocksdb::Slice &key) {
+  if (!Enabled()) return;
+
+  auto &shard = getShard(hash(key));
+  std::lock_guard<std::mutex> guard(shard.mu);
+  shard.epoch++;
+  auto iter = shard.entries.find(std::string_view{key.data(), key.size()});
+  if (iter == shard.entries.end()) return;
+
+  size_t entry_charge = charge(*iter->second);
+  shard.lru.erase(iter->second);
+  shard.entries.erase(iter);
+  shard.usage -= entry_charge;
+  usage_.fetch_sub(entry_charge, std::memory_order_relaxed);
+}
+
+void MetadataCache::Clear() {
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.mu);
+    shard.epoch++;
+    evict(&shard, 0);
+  }
+}
+
+void MetadataCache::SetCapacity(size_t capacity) {
+  capacity_.store(capacity, std::memory_order_relaxed);
+  size_t sketch_width = std::max<size_t>(capacity / kShards / kAverageEntrySize, 64);
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.mu);
+    // the readers which missed the key before the capacity was changed shouldn't insert it,
+    // the invalidations may have been skipped while the cache was disabled
+    shard.epoch++;
+    evict(&shard, capacity / kShards);
+    shard.sketch.Reset(capacity > 0 ? sketch_width : 0);
+  }
+}
+
+void MetadataCache::evict(Shard *shard, size_t capacity) {
+  while (shard->usage > capacity && !shard->lru.empty()) {
+    auto &entry = shard->lru.back();
+    size_t entry_charge = charge(entry);
+    shard->entries.erase(entry.key);
+    shard->lru.pop_back();
+    shard->usage -= entry_charge;
+    usage_.fetch_sub(entry_charge, std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,124 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <rocksdb/slice.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// FrequencySketch is a count-min sketch with saturating counters, it estimates how often
+// the keys were accessed recently for the TinyLFU admission. All counters are halved after
+// the sample size of accesses were recorded, so the keys which are no longer hot would fade.
+class FrequencySketch {
+ public:
+  explicit FrequencySketch(size_t width = 0) { Reset(width); }
+
+  void Reset(size_t width);
+  void Increment(uint64_t hash);
+  uint8_t Frequency(uint64_t hash) const;
+
+ private:
+  static constexpr int kDepth = 4;
+  static constexpr uint8_t kMaxCount = 15;
+
+  std::vector<uint8_t> counters_;
+  size_t width_mask_ = 0;
+  size_t sample_size_ = 0;
+  size_t additions_ = 0;
+
+  size_t index(uint64_t hash, int row) const;
+  void age();
+};
+
+// MetadataCache caches the raw values of the metadata column family, i.e. the metadata of
+// the complex types and the small strings, in front of RocksDB for the hot keys. It's split
+// into shards by the hash of key and each shard has its own LRU list and frequency sketch.
+// A new key is only admitted if it's accessed more often than the LRU victim, so a scan over
+// the cold keys won't flush the hot keys out of the cache.
+//
+// The writers must invalidate the keys after the writes, and the readers must pass the epoch
+// got from the missed Lookup to Insert, so the value read from DB won't be cached if the key
+// may have been modified concurrently. The epoch is never 0, so 0 could be used if the
+// key wasn't looked up.
+class MetadataCache {
+ public:
+  explicit MetadataCache(size_t capacity) { SetCapacity(capacity); }
+
+  MetadataCache(const MetadataCache &) = delete;
+  MetadataCache &operator=(const MetadataCache &) = delete;
+
+  bool Enabled() const { return capacity_.load(std::memory_order_relaxed) > 0; }
+  bool Lookup(const rocksdb::Slice &key, std::string *value, uint64_t *epoch);
+  void Insert(const rocksdb::Slice &key, const rocksdb::Slice &value, uint64_t epoch);
+  void Invalidate(const rocksdb::Slice &key);
+  void Clear();
+
+  void SetCapacity(size_t capacity);
+  size_t GetCapacity() const { return capacity_.load(std::memory_order_relaxed); }
+  size_t GetUsage() const { return usage_.load(std::memory_order_relaxed); }
+  uint64_t GetHits() const { return hits_.load(std::memory_order_relaxed); }
+  uint64_t GetMisses() const { return misses_.load(std::memory_order_relaxed); }
+  uint64_t GetRejects() const { return rejects_.load(std::memory_order_relaxed); }
+
+  static constexpr size_t kMaxValueSize = 4096;
+
+ private:
+  static constexpr size_t kShards = 16;
+  static constexpr size_t kEntryOverhead = 64;
+  static constexpr size_t kAverageEntrySize = 128;
+
+  struct Entry {
+    std::string key;
+    std::string value;
+  };
+
+  struct Shard {
+    std::mutex mu;
+    // the most recently used entry is at the front
+    std::list<Entry> lru;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> entries;
+    size_t usage = 0;
+    // epoch is increased while invalidating any key of the shard
+    uint64_t epoch = 0;
+    FrequencySketch sketch;
+  };
+
+  std::atomic<size_t> capacity_ = 0;
+  std::atomic<size_t> usage_ = 0;
+  std::atomic<uint64_t> hits_ = 0;
+  std::atomic<uint64_t> misses_ = 0;
+  std::atomic<uint64_t> rejects_ = 0;
+  std::array<Shard, kShards> shards_;
+
+  static uint64_t hash(const rocksdb::Slice &key);
+  static size_t charge(const Entry &entry) { return entry.key.size() + entry.value.size() + kEntryOverhead; }
+  Shard &getShard(uint64_t hash) { return shards_[hash % kShards]; }
+  size_t shardCapacity() const { return capacity_.load(std::memory_order_relaxed) / kShards; }
+  void evict(Shard *shard, size_t capacity);
+};
@@ -0,0 +1,50 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "prefix_extractor.h"
+
+#include "encoding.h"
+#include "redis_metadata.h"
+
+size_t SubKeyPrefixExtractor::prefixSize(const rocksdb::Slice &key) const {
+  if (key.empty()) return 0;
+
+  size_t size = 1 + static_cast<uint8_t>(key[0]);
+  if (slot_id_encoded_) size += 2;
+  if (key.size() < size + 4) return 0;
+
+  uint32_t key_size = DecodeFixed32(key.data() + size);
+  size += 4;
+  if (key_size != kKeyIdSubKeyMarker && key_size != kKeyIdAnchorMarker) {
+    size += key_size;
+  }
+  size += 8;  // version
+  return key.size() < size ? 0 : size;
+}
+
+rocksdb::Slice SubKeyPrefixExtractor::Transform(const rocksdb::Slice &key) const {
+  return {key.data(), prefixSize(key)};
+}
+
+bool SubKeyPrefixExtractor::InDomain(const rocksdb::Slice &key) const { return prefixSize(key) > 0; }
+
+std::shared_ptr<const rocksdb::SliceTransform> NewSubKeyPrefixExtractor(bool slot_id_encoded) {
+  return std::make_shared<SubKeyPrefixExtractor>(slot_id_encoded);
+}
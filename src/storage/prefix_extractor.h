@@ -0,0 +1,46 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <rocksdb/slice_transform.h>
+
+#include <memory>
+
+// SubKeyPrefixExtractor extracts the [namespace][slot id][user key][version] prefix from the
+// subkeys, which is shared by all subkeys of the same key, so the prefix bloom filters can
+// skip the files and memtables without any subkey of the key while iterating the subkeys.
+// The subkeys encoded with the key id are supported as well, see InternalKey.
+class SubKeyPrefixExtractor : public rocksdb::SliceTransform {
+ public:
+  explicit SubKeyPrefixExtractor(bool slot_id_encoded) : slot_id_encoded_(slot_id_encoded) {}
+
+  const char *Name() const override { return "kvrocks.SubKeyPrefixExtractor"; }
+  rocksdb::Slice Transform(const rocksdb::Slice &key) const override;
+  bool InDomain(const rocksdb::Slice &key) const override;
+
+ private:
+  bool slot_id_encoded_;
+
+  // returns 0 if the key is too short to contain the prefix
+  size_t prefixSize(const rocksdb::Slice &key) const;
+};
+
+std::shared_ptr<const rocksdb::SliceTransform> NewSubKeyPrefixExtractor(bool slot_id_encoded);
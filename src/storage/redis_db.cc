@@ -35,10 +35,21 @@
 namespace redis {
 
 Database::Database(engine::Storage *storage, std::string ns) : storage_(storage), namespace_(std::move(ns)) {
-  metadata_cf_handle_ = storage->GetCFHandle("metadata");
+  metadata_cf_handle_ = storage->GetCFHandle(engine::kMetadataColumnFamilyName, namespace_);
+  subkey_cf_handle_ = storage->GetCFHandle(engine::kSubkeyColumnFamilyName, namespace_);
 }
 
 rocksdb::Status Database::GetMetadata(RedisType type, const Slice &ns_key, Metadata *metadata) {
+  auto s = getMetadata(type, ns_key, metadata);
+  if (s.IsNotFound()) {
+    // the key may be created with the version of the given metadata
+    auto alloc_s = AllocateKeyId(ns_key, metadata);
+    if (!alloc_s.ok()) return alloc_s;
+  }
+  return s;
+}
+
+rocksdb::Status Database::getMetadata(RedisType type, const Slice &ns_key, Metadata *metadata) {
   std::string old_metadata;
   metadata->Encode(&old_metadata);
   std::string bytes;
@@ -59,14 +70,37 @@ rocksdb::Status Database::GetMetadata(RedisType type, const Slice &ns_key, Metad
     metadata->Decode(old_metadata);
     return rocksdb::Status::NotFound("no elements");
   }
+  metadata->is_new = false;
   return s;
 }
 
+void Database::PutKeyIdAnchor(rocksdb::WriteBatchBase *batch, const Slice &ns_key, const Metadata &metadata) {
+  if (!metadata.is_new || !metadata.IsKeyIdEncoded()) return;
+
+  InternalKey ikey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), true);
+  std::string anchor;
+  ikey.EncodeKeyIdAnchor(&anchor);
+  batch->Put(subkey_cf_handle_, anchor, ikey.GetKey());
+}
+
+rocksdb::Status Database::AllocateKeyId(const Slice &ns_key, Metadata *metadata) {
+  if (!metadata->is_new || !metadata->IsKeyIdEncoded()) return rocksdb::Status::OK();
+
+  std::string anchor, user_key;
+  while (true) {
+    InternalKey(ns_key, "", metadata->version, storage_->IsSlotIdEncoded(), true).EncodeKeyIdAnchor(&anchor);
+    auto s = storage_->Get(rocksdb::ReadOptions(), subkey_cf_handle_, anchor, &user_key);
+    if (s.IsNotFound()) return rocksdb::Status::OK();
+    if (!s.ok()) return s;
+    // the key id is taken while its anchor is alive, the anchor is only recycled by the
+    // compaction filter after all the subkeys of the key id were recycled
+    metadata->RenewVersion();
+  }
+}
+
 rocksdb::Status Database::GetRawMetadata(const Slice &ns_key, std::string *bytes) {
-  LatestSnapShot ss(storage_);
-  rocksdb::ReadOptions read_options;
-  read_options.snapshot = ss.GetSnapShot();
-  return storage_->Get(read_options, metadata_cf_handle_, ns_key, bytes);
+  // a single point lookup reads the latest value, there's no need to take the snapshot
+  return storage_->GetRawMetadata(rocksdb::ReadOptions(), metadata_cf_handle_, ns_key, bytes);
 }
 
 rocksdb::Status Database::GetRawMetadataByUserKey(const Slice &user_key, std::string *bytes) {
@@ -107,7 +141,7 @@ rocksdb::Status Database::Expire(const Slice &user_key, uint64_t timestamp) {
   return s;
 }
 
-rocksdb::Status Database::Del(const Slice &user_key) {
+rocksdb::Status Database::Del(const Slice &user_key, bool lazy) {
   std::string ns_key;
   AppendNamespacePrefix(user_key, &ns_key);
 
@@ -120,7 +154,21 @@ rocksdb::Status Database::Del(const Slice &user_key) {
   if (metadata.Expired()) {
     return rocksdb::Status::NotFound(kErrMsgKeyExpired);
   }
-  return storage_->Delete(storage_->DefaultWriteOptions(), metadata_cf_handle_, ns_key);
+  if (!lazy || metadata.Type() == kRedisString || metadata.size < DeletionLog::kMinSubKeys) {
+    return storage_->Delete(storage_->DefaultWriteOptions(), metadata_cf_handle_, ns_key);
+  }
+
+  // the subkeys of the deleted version would be reclaimed by the reaper in background
+  std::string prefix;
+  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&prefix);
+  auto batch = storage_->GetWriteBatchBase();
+  batch->Put(storage_->GetCFHandle(engine::kDeletionLogColumnFamilyName),
+             DeletionLog::EncodeKey(util::GetTimeStampUS(), prefix), std::string(1, static_cast<char>(metadata.flags)));
+  batch->Delete(metadata_cf_handle_, ns_key);
+  s = storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
+  // the pending batch of the transaction may be discarded, the reaper would take care of it after it's committed
+  if (s.ok() && !storage_->IsTxnMode()) storage_->GetDeletionLog()->Add(prefix);
+  return s;
 }
 
 rocksdb::Status Database::Exists(const std::vector<Slice> &keys, int *ret) {
@@ -343,6 +391,16 @@ rocksdb::Status Database::RandomKey(const std::string &cursor, std::string *key)
 }
 
 rocksdb::Status Database::FlushDB() {
+  // all keys in the column families of the isolated namespace belong to it, so the subkeys
+  // can be removed at once instead of being recycled by the compaction filter
+  if (storage_->IsNamespaceIsolated(namespace_)) {
+    for (const auto &[_, name] : engine::kNamespaceColumnFamilies) {
+      auto s = deleteAllInColumnFamily(storage_->GetCFHandle(name, namespace_));
+      if (!s.ok()) return s;
+    }
+    return rocksdb::Status::OK();
+  }
+
   std::string prefix, begin_key, end_key;
   ComposeNamespaceKey(namespace_, "", &prefix, false);
   auto s = FindKeyRangeWithPrefix(prefix, std::string(), &begin_key, &end_key);
@@ -358,11 +416,29 @@ rocksdb::Status Database::FlushDB() {
 }
 
 rocksdb::Status Database::FlushAll() {
+  auto s = deleteAllInColumnFamily(storage_->GetCFHandle(engine::kMetadataColumnFamilyName));
+  if (!s.ok()) return s;
+  // all the collections are gone, there's nothing left to be reclaimed
+  s = deleteAllInColumnFamily(storage_->GetCFHandle(engine::kDeletionLogColumnFamilyName));
+  if (!s.ok()) return s;
+  storage_->GetDeletionLog()->Clear();
+
+  for (const auto &iter : storage_->GetNamespaceColumnFamilies()) {
+    for (auto cf_handle : iter.second.handles) {
+      if (!cf_handle) continue;
+      s = deleteAllInColumnFamily(cf_handle);
+      if (!s.ok()) return s;
+    }
+  }
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status Database::deleteAllInColumnFamily(rocksdb::ColumnFamilyHandle *cf_handle) {
   LatestSnapShot ss(storage_);
   rocksdb::ReadOptions read_options;
   read_options.snapshot = ss.GetSnapShot();
   storage_->SetReadOptions(read_options);
-  auto iter = util::UniqueIterator(storage_, read_options, metadata_cf_handle_);
+  auto iter = util::UniqueIterator(storage_, read_options, cf_handle);
   iter->SeekToFirst();
   if (!iter->Valid()) {
     return rocksdb::Status::OK();
@@ -373,7 +449,7 @@ rocksdb::Status Database::FlushAll() {
     return rocksdb::Status::OK();
   }
   auto last_key = iter->key().ToString();
-  auto s = storage_->DeleteRange(first_key, last_key);
+  auto s = storage_->DeleteRange(cf_handle, first_key, last_key);
   if (!s.ok()) {
     return s;
   }
@@ -475,6 +551,8 @@ rocksdb::Status Database::FindKeyRangeWithPrefix(const std::string &prefix, cons
   LatestSnapShot ss(storage_);
   rocksdb::ReadOptions read_options;
   read_options.snapshot = ss.GetSnapShot();
+  // the range may cross the prefixes of the subkey column families
+  read_options.total_order_seek = true;
   storage_->SetReadOptions(read_options);
   auto iter = util::UniqueIterator(storage_, read_options, cf_handle);
   iter->Seek(prefix);
@@ -577,18 +655,22 @@ rocksdb::Status SubKeyScanner::Scan(RedisType type, const Slice &user_key, const
   LatestSnapShot ss(storage_);
   rocksdb::ReadOptions read_options;
   read_options.snapshot = ss.GetSnapShot();
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = util::UniqueIterator(storage_, read_options, subkey_cf_handle_);
   std::string match_prefix_key;
   if (!subkey_prefix.empty()) {
-    InternalKey(ns_key, subkey_prefix, metadata.version, storage_->IsSlotIdEncoded()).Encode(&match_prefix_key);
+    InternalKey(ns_key, subkey_prefix, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&match_prefix_key);
   } else {
-    InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode(&match_prefix_key);
+    InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&match_prefix_key);
   }
 
   std::string start_key;
   if (!cursor.empty()) {
-    InternalKey(ns_key, cursor, metadata.version, storage_->IsSlotIdEncoded()).Encode(&start_key);
+    InternalKey(ns_key, cursor, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&start_key);
   } else {
     start_key = match_prefix_key;
   }
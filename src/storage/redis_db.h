@@ -38,7 +38,8 @@ class Database {
   rocksdb::Status GetRawMetadata(const Slice &ns_key, std::string *bytes);
   rocksdb::Status GetRawMetadataByUserKey(const Slice &user_key, std::string *bytes);
   rocksdb::Status Expire(const Slice &user_key, uint64_t timestamp);
-  rocksdb::Status Del(const Slice &user_key);
+  // the subkeys of the big collections are reclaimed in background if it's lazy, see DeletionLog
+  rocksdb::Status Del(const Slice &user_key, bool lazy = false);
   rocksdb::Status Exists(const std::vector<Slice> &keys, int *ret);
   rocksdb::Status TTL(const Slice &user_key, int64_t *ttl);
   rocksdb::Status Type(const Slice &user_key, RedisType *type);
@@ -58,8 +59,20 @@ class Database {
                                   int count);
 
  protected:
+  // PutKeyIdAnchor should be called while writing the metadata of complex types, the
+  // anchor is only written if the key is created and its subkeys are key id encoded
+  void PutKeyIdAnchor(rocksdb::WriteBatchBase *batch, const Slice &ns_key, const Metadata &metadata);
+  // AllocateKeyId renews the version of the key which would be created until its key id isn't taken,
+  // the versions may be duplicated after failover or the clock went backward. It's called by
+  // GetMetadata if the key isn't found, so only the writes which create the key without reading the
+  // metadata should call it.
+  rocksdb::Status AllocateKeyId(const Slice &ns_key, Metadata *metadata);
+  rocksdb::Status deleteAllInColumnFamily(rocksdb::ColumnFamilyHandle *cf_handle);
+  rocksdb::Status getMetadata(RedisType type, const Slice &ns_key, Metadata *metadata);
+
   engine::Storage *storage_;
   rocksdb::ColumnFamilyHandle *metadata_cf_handle_;
+  rocksdb::ColumnFamilyHandle *subkey_cf_handle_;
   std::string namespace_;
 
   friend class LatestSnapShot;
@@ -49,14 +49,19 @@ InternalKey::InternalKey(Slice input, bool slot_id_encoded) : slot_id_encoded_(s
     GetFixed16(&input, &slotid_);
   }
   GetFixed32(&input, &key_size);
-  key_ = Slice(input.data(), key_size);
-  input.remove_prefix(key_size);
+  if (key_size == kKeyIdSubKeyMarker || key_size == kKeyIdAnchorMarker) {
+    key_id_encoded_ = true;
+    key_id_anchor_ = key_size == kKeyIdAnchorMarker;
+  } else {
+    key_ = Slice(input.data(), key_size);
+    input.remove_prefix(key_size);
+  }
   GetFixed64(&input, &version_);
   sub_key_ = Slice(input.data(), input.size());
 }
 
-InternalKey::InternalKey(Slice ns_key, Slice sub_key, uint64_t version, bool slot_id_encoded)
-    : slot_id_encoded_(slot_id_encoded) {
+InternalKey::InternalKey(Slice ns_key, Slice sub_key, uint64_t version, bool slot_id_encoded, bool key_id_encoded)
+    : slot_id_encoded_(slot_id_encoded), key_id_encoded_(key_id_encoded) {
   uint8_t namespace_size = 0;
   GetFixed8(&ns_key, &namespace_size);
   namespace_ = Slice(ns_key.data(), namespace_size);
@@ -80,7 +85,8 @@ uint64_t InternalKey::GetVersion() const { return version_; }
 void InternalKey::Encode(std::string *out) {
   out->clear();
   size_t pos = 0;
-  size_t total = 1 + namespace_.size() + 4 + key_.size() + 8 + sub_key_.size();
+  size_t key_size = key_id_encoded_ ? 0 : key_.size();
+  size_t total = 1 + namespace_.size() + 4 + key_size + 8 + sub_key_.size();
   if (slot_id_encoded_) {
     total += 2;
   }
@@ -94,16 +100,31 @@ void InternalKey::Encode(std::string *out) {
     EncodeFixed16(buf + pos, slotid_);
     pos += 2;
   }
-  EncodeFixed32(buf + pos, static_cast<uint32_t>(key_.size()));
+  if (key_id_encoded_) {
+    EncodeFixed32(buf + pos, key_id_anchor_ ? kKeyIdAnchorMarker : kKeyIdSubKeyMarker);
+  } else {
+    EncodeFixed32(buf + pos, static_cast<uint32_t>(key_.size()));
+  }
   pos += 4;
-  memcpy(buf + pos, key_.data(), key_.size());
-  pos += key_.size();
+  memcpy(buf + pos, key_.data(), key_size);
+  pos += key_size;
   EncodeFixed64(buf + pos, version_);
   pos += 8;
   memcpy(buf + pos, sub_key_.data(), sub_key_.size());
   // pos += sub_key_.size();
 }
 
+void InternalKey::EncodeKeyIdAnchor(std::string *out) const {
+  out->clear();
+  PutFixed8(out, static_cast<uint8_t>(namespace_.size()));
+  out->append(namespace_.data(), namespace_.size());
+  if (slot_id_encoded_) {
+    PutFixed16(out, slotid_);
+  }
+  PutFixed32(out, kKeyIdAnchorMarker);
+  PutFixed64(out, version_);
+}
+
 bool InternalKey::operator==(const InternalKey &that) const {
   if (key_ != that.key_) return false;
   if (sub_key_ != that.sub_key_) return false;
@@ -147,11 +168,17 @@ void ComposeSlotKeyPrefix(const Slice &ns, int slotid, std::string *output) {
   PutFixed16(output, static_cast<uint16_t>(slotid));
 }
 
-Metadata::Metadata(RedisType type, bool generate_version, bool use_64bit_common_field)
+Metadata::Metadata(RedisType type, bool generate_version, bool use_64bit_common_field, bool use_key_id_encoding)
     : flags((use_64bit_common_field ? METADATA_64BIT_ENCODING_MASK : 0) | (METADATA_TYPE_MASK & type)),
       expire(0),
       version(generate_version ? generateVersion() : 0),
-      size(0) {}
+      size(0),
+      is_new(generate_version) {
+  bool key_id_supported = type == kRedisHash || type == kRedisSet || type == kRedisZSet || type == kRedisList;
+  if (use_key_id_encoding && key_id_supported) {
+    flags |= METADATA_KEY_ID_ENCODING_MASK;
+  }
+}
 
 rocksdb::Status Metadata::Decode(const std::string &bytes) {
   Slice input(bytes);
@@ -195,6 +222,8 @@ uint64_t Metadata::generateVersion() {
   return (timestamp << VersionCounterBits) + (counter % (1 << VersionCounterBits));
 }
 
+void Metadata::RenewVersion() { version = generateVersion(); }
+
 bool Metadata::operator==(const Metadata &that) const {
   if (flags != that.flags) return false;
   if (expire != that.expire) return false;
@@ -238,6 +267,8 @@ uint64_t Metadata::ExpireMsToS(uint64_t ms) {
 
 bool Metadata::Is64BitEncoded() const { return flags & METADATA_64BIT_ENCODING_MASK; }
 
+bool Metadata::IsKeyIdEncoded() const { return flags & METADATA_KEY_ID_ENCODING_MASK; }
+
 size_t Metadata::CommonEncodedSize() const { return Is64BitEncoded() ? 8 : 4; }
 
 bool Metadata::GetFixedCommon(rocksdb::Slice *input, uint64_t *value) const {
@@ -37,6 +37,14 @@ constexpr bool USE_64BIT_COMMON_FIELD_DEFAULT =
 #endif
     ;
 
+constexpr bool USE_KEY_ID_ENCODING_DEFAULT =
+#ifdef ENABLE_KEY_ID_ENCODING
+    true
+#else
+    false
+#endif
+    ;
+
 enum RedisType {
   kRedisNone,
   kRedisString,
@@ -83,17 +91,31 @@ void ExtractNamespaceKey(Slice ns_key, std::string *ns, std::string *key, bool s
 void ComposeNamespaceKey(const Slice &ns, const Slice &key, std::string *ns_key, bool slot_id_encoded);
 void ComposeSlotKeyPrefix(const Slice &ns, int slotid, std::string *output);
 
+// The subkeys of the key id encoded keys don't repeat the user key, they're encoded as
+// [ns][slot id][kKeyIdSubKeyMarker][key id][sub key], and the version of the key is used
+// as the key id. The markers are in place of the user key size, which can't be that large.
+// An anchor [ns][slot id][kKeyIdAnchorMarker][key id] => user key is written while the key
+// is created, so the user key can be found from the subkeys, e.g. in the compaction filter.
+constexpr uint32_t kKeyIdSubKeyMarker = UINT32_MAX;
+constexpr uint32_t kKeyIdAnchorMarker = UINT32_MAX - 1;
+
 class InternalKey {
  public:
-  explicit InternalKey(Slice ns_key, Slice sub_key, uint64_t version, bool slot_id_encoded);
+  explicit InternalKey(Slice ns_key, Slice sub_key, uint64_t version, bool slot_id_encoded,
+                       bool key_id_encoded = false);
   explicit InternalKey(Slice input, bool slot_id_encoded);
   ~InternalKey() = default;
 
   Slice GetNamespace() const;
+  // the key is empty if it's decoded from a key id encoded subkey, see EncodeKeyIdAnchor
   Slice GetKey() const;
   Slice GetSubKey() const;
   uint64_t GetVersion() const;
+  bool IsKeyIdEncoded() const { return key_id_encoded_; }
+  bool IsKeyIdAnchor() const { return key_id_anchor_; }
   void Encode(std::string *out);
+  // the anchor key whose value is the user key of a key id encoded subkey
+  void EncodeKeyIdAnchor(std::string *out) const;
   bool operator==(const InternalKey &that) const;
 
  private:
@@ -103,17 +125,22 @@ class InternalKey {
   uint64_t version_;
   uint16_t slotid_;
   bool slot_id_encoded_;
+  bool key_id_encoded_ = false;
+  bool key_id_anchor_ = false;
 };
 
 constexpr uint8_t METADATA_64BIT_ENCODING_MASK = 0x80;
+constexpr uint8_t METADATA_KEY_ID_ENCODING_MASK = 0x40;
 constexpr uint8_t METADATA_TYPE_MASK = 0x0f;
 
 class Metadata {
  public:
   // metadata flags
-  // <(1-bit) 64bit-common-field-indicator> 0 0 0 <(4-bit) redis-type>
+  // <(1-bit) 64bit-common-field-indicator> <(1-bit) key-id-indicator> 0 0 <(4-bit) redis-type>
   // 64bit-common-field-indicator: make `expire` and `size` 64bit instead of 32bit
   // NOTE: `expire` is stored in milliseconds for 64bit, seconds for 32bit
+  // key-id-indicator: the subkeys are prefixed by the key id instead of the user key,
+  // it's only set for hash, set, zset and list
   // redis-type: RedisType for the key-value
   uint8_t flags;
 
@@ -126,15 +153,23 @@ class Metadata {
   // element size of the key-value
   uint64_t size;
 
+  // whether the key would be created by the current write, it's not encoded and
+  // would be reset after the metadata of existing key was got
+  bool is_new;
+
   explicit Metadata(RedisType type, bool generate_version = true,
-                    bool use_64bit_common_field = USE_64BIT_COMMON_FIELD_DEFAULT);
+                    bool use_64bit_common_field = USE_64BIT_COMMON_FIELD_DEFAULT,
+                    bool use_key_id_encoding = USE_KEY_ID_ENCODING_DEFAULT);
   static void InitVersionCounter();
+  // RenewVersion generates another version for the key which isn't created yet
+  void RenewVersion();
 
   static size_t GetOffsetAfterExpire(uint8_t flags);
   static size_t GetOffsetAfterSize(uint8_t flags);
   static uint64_t ExpireMsToS(uint64_t ms);
 
   bool Is64BitEncoded() const;
+  bool IsKeyIdEncoded() const;
   bool GetFixedCommon(rocksdb::Slice *input, uint64_t *value) const;
   bool GetExpire(rocksdb::Slice *input);
   void PutFixedCommon(std::string *dst, uint64_t value) const;
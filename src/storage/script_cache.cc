@@ -0,0 +1,75 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "script_cache.h"
+
+#include <iterator>
+#include <utility>
+
+namespace lua {
+
+void ScriptCache::Put(const std::string &sha, std::string bytecode) {
+  std::lock_guard<std::mutex> guard(mu_);
+  if (scripts_.count(sha) > 0) return;
+
+  bytes_ += bytecode.size();
+  order_.emplace_back(sha);
+  scripts_.emplace(sha, Entry{std::make_shared<const std::string>(std::move(bytecode)), std::prev(order_.end())});
+
+  // always keep the latest script even if it's larger than the limit
+  while (bytes_ > max_bytes_ && order_.size() > 1) {
+    auto iter = scripts_.find(order_.front());
+    bytes_ -= iter->second.bytecode->size();
+    scripts_.erase(iter);
+    order_.pop_front();
+  }
+}
+
+std::shared_ptr<const std::string> ScriptCache::Get(const std::string &sha) {
+  std::lock_guard<std::mutex> guard(mu_);
+  auto iter = scripts_.find(sha);
+  if (iter == scripts_.end()) return nullptr;
+  return iter->second.bytecode;
+}
+
+bool ScriptCache::Exists(const std::string &sha) {
+  std::lock_guard<std::mutex> guard(mu_);
+  return scripts_.count(sha) > 0;
+}
+
+void ScriptCache::Clear() {
+  std::lock_guard<std::mutex> guard(mu_);
+  scripts_.clear();
+  order_.clear();
+  bytes_ = 0;
+  version_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+size_t ScriptCache::Size() {
+  std::lock_guard<std::mutex> guard(mu_);
+  return scripts_.size();
+}
+
+size_t ScriptCache::Bytes() {
+  std::lock_guard<std::mutex> guard(mu_);
+  return bytes_;
+}
+
+}  // namespace lua
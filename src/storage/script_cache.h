@@ -0,0 +1,64 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace lua {
+
+// ScriptCache keeps the compiled bytecode of scripts shared by all Lua states, so that
+// a state which doesn't define a script yet can load it without reading the body from
+// the storage and compiling it again. The version is bumped whenever the cache is
+// cleared (e.g. SCRIPT FLUSH), and a state which has seen an older version must drop
+// the functions it defined before.
+class ScriptCache {
+ public:
+  explicit ScriptCache(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+  void Put(const std::string &sha, std::string bytecode);
+  std::shared_ptr<const std::string> Get(const std::string &sha);
+  bool Exists(const std::string &sha);
+  void Clear();
+
+  uint64_t Version() const { return version_.load(std::memory_order_acquire); }
+  size_t Size();
+  size_t Bytes();
+
+ private:
+  std::mutex mu_;
+  size_t max_bytes_;
+  size_t bytes_ = 0;
+  std::atomic<uint64_t> version_ = 1;
+  // the oldest script is evicted first when the cache grows over max_bytes_
+  std::list<std::string> order_;
+  struct Entry {
+    std::shared_ptr<const std::string> bytecode;
+    std::list<std::string>::iterator order_iter;
+  };
+  std::unordered_map<std::string, Entry> scripts_;
+};
+
+}  // namespace lua
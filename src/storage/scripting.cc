@@ -26,6 +26,8 @@
 #include <math.h>
 
 #include <cctype>
+#include <charconv>
+#include <cmath>
 #include <string>
 
 #include "commands/commander.h"
@@ -66,16 +68,24 @@ void DestroyState(lua_State *lua) {
 }
 
 void LoadFuncs(lua_State *lua, bool read_only) {
+  /* The command lookup cache shared by redis.call and redis.pcall,
+   * it maps the command name as written in the script to its attributes. */
+  lua_newtable(lua);
+
   lua_newtable(lua);
 
   /* redis.call */
   lua_pushstring(lua, "call");
-  lua_pushcfunction(lua, RedisCallCommand);
+  lua_pushvalue(lua, -3);
+  lua_pushboolean(lua, read_only);
+  lua_pushcclosure(lua, RedisCallCommand, 2);
   lua_settable(lua, -3);
 
   /* redis.pcall */
   lua_pushstring(lua, "pcall");
-  lua_pushcfunction(lua, RedisPCallCommand);
+  lua_pushvalue(lua, -3);
+  lua_pushboolean(lua, read_only);
+  lua_pushcclosure(lua, RedisPCallCommand, 2);
   lua_settable(lua, -3);
 
   /* redis.log and log levels. */
@@ -118,6 +128,7 @@ void LoadFuncs(lua_State *lua, bool read_only) {
   lua_settable(lua, -3);
 
   lua_setglobal(lua, "redis");
+  lua_pop(lua, 1);
 
   /* Replace math.random and math.randomseed with our implementations. */
   lua_getglobal(lua, "math");
@@ -222,6 +233,8 @@ Status EvalGenericCommand(redis::Connection *conn, const std::string &body_or_sh
     }
   }
 
+  SyncScriptCacheVersion(srv, lua);
+
   /* Push the pcall error handler function on the stack. */
   lua_getglobal(lua, "__redis__err__handler");
 
@@ -229,19 +242,24 @@ Status EvalGenericCommand(redis::Connection *conn, const std::string &body_or_sh
   lua_getglobal(lua, funcname);
   if (lua_isnil(lua, -1)) {
     lua_pop(lua, 1); /* remove the nil from the stack */
-    std::string body;
-    if (evalsha) {
-      auto s = srv->ScriptGet(funcname + 2, &body);
-      if (!s.IsOK()) {
-        lua_pop(lua, 1); /* remove the error handler from the stack. */
-        return {Status::NotOK, "NOSCRIPT No matching script. Please use EVAL"};
-      }
-    } else {
-      body = body_or_sha;
-    }
 
+    /* Load the compiled function from the shared script cache first,
+     * and only fall back to compile the body if it's not there */
     std::string sha = funcname + 2;
-    auto s = CreateFunction(srv, body, &sha, lua, false);
+    auto s = LoadFunctionFromCache(srv, lua, sha);
+    if (s.Is<Status::NotFound>()) {
+      std::string body;
+      if (evalsha) {
+        s = srv->ScriptGet(sha, &body);
+        if (!s.IsOK()) {
+          lua_pop(lua, 1); /* remove the error handler from the stack. */
+          return {Status::NotOK, "NOSCRIPT No matching script. Please use EVAL"};
+        }
+      } else {
+        body = body_or_sha;
+      }
+      s = CreateFunction(srv, body, &sha, lua, false);
+    }
     if (!s.IsOK()) {
       lua_pop(lua, 1); /* remove the error handler from the stack. */
       return s;
@@ -292,13 +310,45 @@ int RedisCallCommand(lua_State *lua) { return RedisGenericCommand(lua, 1); }
 
 int RedisPCallCommand(lua_State *lua) { return RedisGenericCommand(lua, 0); }
 
+// Integral numbers are by far the most common numeric arguments of redis.call(),
+// so format them directly instead of going through "%.17g", the output is the same
+static std::string FormatNumberArg(lua_Number num) {
+  if (std::fabs(num) < 1e17 && std::trunc(num) == num && !(num == 0 && std::signbit(num))) {
+    return fmt::format_int(static_cast<int64_t>(num)).str();
+  }
+  return fmt::format("{:.17g}", static_cast<double>(num));
+}
+
+// LookupCommand resolves the command name through the lookup cache of the current
+// Lua state (the first upvalue of redis.call/redis.pcall), so that scripts calling
+// the same commands over and over don't pay for the case-insensitive map lookup.
+// Only string names are cached, since they are interned by Lua and cheap to hash.
+static const redis::CommandAttributes *LookupCommand(lua_State *lua, const std::string &name) {
+  bool cacheable = lua_type(lua, 1) == LUA_TSTRING;
+  if (cacheable) {
+    lua_pushvalue(lua, 1);
+    lua_rawget(lua, lua_upvalueindex(1));
+    auto attributes = static_cast<const redis::CommandAttributes *>(lua_touserdata(lua, -1));
+    lua_pop(lua, 1);
+    if (attributes) return attributes;
+  }
+
+  auto commands = redis::GetCommands();
+  auto iter = commands->find(name);
+  if (iter == commands->end()) return nullptr;
+
+  if (cacheable) {
+    lua_pushvalue(lua, 1);
+    lua_pushlightuserdata(lua, const_cast<redis::CommandAttributes *>(iter->second));
+    lua_rawset(lua, lua_upvalueindex(1));
+  }
+  return iter->second;
+}
+
 // TODO: we do not want to repeat same logic as Connection::ExecuteCommands,
 // so the function need to be refactored
 int RedisGenericCommand(lua_State *lua, int raise_error) {
-  lua_getglobal(lua, "redis");
-  lua_getfield(lua, -1, "read_only");
-  int read_only = lua_toboolean(lua, -1);
-  lua_pop(lua, 2);
+  int read_only = lua_toboolean(lua, lua_upvalueindex(2));
 
   int argc = lua_gettop(lua);
   if (argc == 0) {
@@ -307,10 +357,10 @@ int RedisGenericCommand(lua_State *lua, int raise_error) {
   }
 
   std::vector<std::string> args;
+  args.reserve(argc);
   for (int j = 1; j <= argc; j++) {
     if (lua_type(lua, j) == LUA_TNUMBER) {
-      lua_Number num = lua_tonumber(lua, j);
-      args.emplace_back(fmt::format("{:.17g}", static_cast<double>(num)));
+      args.emplace_back(FormatNumberArg(lua_tonumber(lua, j)));
     } else {
       size_t obj_len = 0;
       const char *obj_s = lua_tolstring(lua, j, &obj_len);
@@ -322,14 +372,12 @@ int RedisGenericCommand(lua_State *lua, int raise_error) {
     }
   }
 
-  auto commands = redis::GetCommands();
-  auto cmd_iter = commands->find(util::ToLower(args[0]));
-  if (cmd_iter == commands->end()) {
+  auto redis_cmd = LookupCommand(lua, args[0]);
+  if (!redis_cmd) {
     PushError(lua, "Unknown Redis command called from Lua script");
     return raise_error ? RaiseError(lua) : 1;
   }
 
-  auto redis_cmd = cmd_iter->second;
   if (read_only && !(redis_cmd->flags & redis::kCmdReadOnly)) {
     PushError(lua, "Write commands are not allowed from read-only scripts");
     return raise_error ? RaiseError(lua) : 1;
@@ -350,7 +398,7 @@ int RedisGenericCommand(lua_State *lua, int raise_error) {
     return raise_error ? RaiseError(lua) : 1;
   }
 
-  std::string cmd_name = util::ToLower(args[0]);
+  const std::string &cmd_name = attributes->name;
   Server *srv = GetServer();
   Config *config = srv->GetConfig();
 
@@ -382,16 +430,19 @@ int RedisGenericCommand(lua_State *lua, int raise_error) {
     return raise_error ? RaiseError(lua) : 1;
   }
 
-  srv->stats.IncrCalls(cmd_name);
+  srv->stats.IncrCalls(attributes->id);
   auto start = std::chrono::high_resolution_clock::now();
   bool is_profiling = conn->IsProfilingEnabled(cmd_name);
   std::string output;
-  s = cmd->Execute(GetServer(), srv->GetCurrentConnection(), &output);
+  // the scripts parse the replies in RESP2 no matter which protocol the caller is using
+  conn->SetInScriptCall(true);
+  s = cmd->Execute(GetServer(), conn, &output);
+  conn->SetInScriptCall(false);
   auto end = std::chrono::high_resolution_clock::now();
   uint64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-  if (is_profiling) conn->RecordProfilingSampleIfNeed(cmd_name, duration);
+  if (is_profiling) conn->RecordProfilingSampleIfNeed(cmd_name, attributes->id, duration);
   srv->SlowlogPushEntryIfNeeded(&args, duration);
-  srv->stats.IncrLatency(static_cast<uint64_t>(duration), cmd_name);
+  srv->stats.IncrLatency(static_cast<uint64_t>(duration), attributes->id);
   srv->FeedMonitorConns(conn, args);
   if (!s) {
     PushError(lua, s.Msg().data());
@@ -546,6 +597,15 @@ void SHA1Hex(char *digest, const char *script, size_t len) {
  * error string.
  */
 
+// Parse the integer header of a reply in place, e.g. ":1\r\n" or "$5\r\n",
+// and return the position of the terminating CRLF.
+static const char *ParseProtocolInteger(const char *reply, int64_t *value) {
+  const char *p = strchr(reply + 1, '\r');
+  *value = 0;
+  std::from_chars(reply + 1, p, *value);
+  return p;
+}
+
 const char *RedisProtocolToLuaType(lua_State *lua, const char *reply) {
   const char *p = reply;
 
@@ -585,15 +645,15 @@ const char *RedisProtocolToLuaType(lua_State *lua, const char *reply) {
 }
 
 const char *RedisProtocolToLuaTypeInt(lua_State *lua, const char *reply) {
-  const char *p = strchr(reply + 1, '\r');
-  auto value = ParseInt<int64_t>(std::string(reply + 1, p - reply - 1), 10).ValueOr(0);
+  int64_t value = 0;
+  const char *p = ParseProtocolInteger(reply, &value);
   lua_pushnumber(lua, static_cast<lua_Number>(value));
   return p + 2;
 }
 
 const char *RedisProtocolToLuaTypeBulk(lua_State *lua, const char *reply) {
-  const char *p = strchr(reply + 1, '\r');
-  auto bulklen = ParseInt<int64_t>(std::string(reply + 1, p - reply - 1), 10).ValueOr(0);
+  int64_t bulklen = 0;
+  const char *p = ParseProtocolInteger(reply, &bulklen);
 
   if (bulklen == -1) {
     lua_pushboolean(lua, 0);
@@ -625,8 +685,8 @@ const char *RedisProtocolToLuaTypeError(lua_State *lua, const char *reply) {
 }
 
 const char *RedisProtocolToLuaTypeAggregate(lua_State *lua, const char *reply, int atype) {
-  const char *p = strchr(reply + 1, '\r');
-  int64_t mbulklen = ParseInt<int64_t>(std::string(reply + 1, p - reply - 1), 10).ValueOr(0);
+  int64_t mbulklen = 0;
+  const char *p = ParseProtocolInteger(reply, &mbulklen);
   int j = 0;
 
   p += 2;
@@ -635,6 +695,18 @@ const char *RedisProtocolToLuaTypeAggregate(lua_State *lua, const char *reply, i
     return p;
   }
   lua_newtable(lua);
+  if (atype == '%') {
+    // a map of N pairs carries 2N elements, it's converted into {map = {key = value, ...}} as Redis does
+    lua_pushstring(lua, "map");
+    lua_newtable(lua);
+    for (j = 0; j < mbulklen; j++) {
+      p = RedisProtocolToLuaType(lua, p);
+      p = RedisProtocolToLuaType(lua, p);
+      lua_settable(lua, -3);
+    }
+    lua_settable(lua, -3);
+    return p;
+  }
   for (j = 0; j < mbulklen; j++) {
     lua_pushnumber(lua, j + 1);
     p = RedisProtocolToLuaType(lua, p);
@@ -870,6 +942,11 @@ int RedisMathRandomSeed(lua_State *lua) {
  *
  * If 'c' is not NULL, on error the client is informed with an appropriate
  * error describing the nature of the problem and the Lua interpreter error. */
+static int WriteBytecode(lua_State *lua, const void *p, size_t sz, void *ud) {
+  static_cast<std::string *>(ud)->append(static_cast<const char *>(p), sz);
+  return 0;
+}
+
 Status CreateFunction(Server *srv, const std::string &body, std::string *sha, lua_State *lua, bool need_to_store) {
   char funcname[2 + 40 + 1] = REDIS_LUA_FUNC_SHA_PREFIX;
 
@@ -880,15 +957,84 @@ Status CreateFunction(Server *srv, const std::string &body, std::string *sha, lu
     std::copy(sha->begin(), sha->end(), funcname + 2);
   }
 
+  // precompiled chunks are only loaded from the script cache, never from users
+  if (!body.empty() && body[0] == LUA_SIGNATURE[0]) {
+    return {Status::NotOK, "Error while compiling new script: binary chunks are not allowed"};
+  }
+
+  SyncScriptCacheVersion(srv, lua);
   if (luaL_loadbuffer(lua, body.c_str(), body.size(), "@user_script")) {
     std::string err_msg = lua_tostring(lua, -1);
     lua_pop(lua, 1);
     return {Status::NotOK, "Error while compiling new script: " + err_msg};
   }
+
+  // share the compiled function with other Lua states, so they needn't compile it again
+  std::string bytecode;
+  if (lua_dump(lua, WriteBytecode, &bytecode) == 0) {
+    srv->GetScriptCache()->Put(*sha, std::move(bytecode));
+  }
   lua_setglobal(lua, funcname);
 
   // would store lua function into propagate column family and propagate those scripts to slaves
   return need_to_store ? srv->ScriptSet(*sha, body) : Status::OK();
 }
 
+Status LoadFunctionFromCache(Server *srv, lua_State *lua, const std::string &sha) {
+  auto bytecode = srv->GetScriptCache()->Get(sha);
+  if (!bytecode) {
+    return {Status::NotFound};
+  }
+
+  if (luaL_loadbuffer(lua, bytecode->data(), bytecode->size(), "@user_script")) {
+    std::string err_msg = lua_tostring(lua, -1);
+    lua_pop(lua, 1);
+    return {Status::NotOK, "Error while loading cached script: " + err_msg};
+  }
+  lua_setglobal(lua, (REDIS_LUA_FUNC_SHA_PREFIX + sha).c_str());
+  return Status::OK();
+}
+
+Status PrewarmFunction(Server *srv, lua_State *lua, const std::string &sha) {
+  SyncScriptCacheVersion(srv, lua);
+
+  lua_getglobal(lua, (REDIS_LUA_FUNC_SHA_PREFIX + sha).c_str());
+  bool defined = !lua_isnil(lua, -1);
+  lua_pop(lua, 1);
+  if (defined) return Status::OK();
+
+  return LoadFunctionFromCache(srv, lua, sha);
+}
+
+void SyncScriptCacheVersion(Server *srv, lua_State *lua) {
+  auto version = static_cast<lua_Number>(srv->GetScriptCache()->Version());
+
+  lua_getfield(lua, LUA_REGISTRYINDEX, "__script_cache_version");
+  bool synced = lua_tonumber(lua, -1) == version;
+  lua_pop(lua, 1);
+  if (synced) return;
+
+  // the scripts were flushed, drop the functions defined before
+  std::vector<std::string> funcs;
+  lua_pushnil(lua);
+  while (lua_next(lua, LUA_GLOBALSINDEX)) {
+    lua_pop(lua, 1); /* remove the value, keep the key for the next iteration */
+    if (lua_type(lua, -1) != LUA_TSTRING) continue;
+
+    size_t len = 0;
+    const char *key = lua_tolstring(lua, -1, &len);
+    if (util::HasPrefix({key, len}, REDIS_LUA_FUNC_SHA_PREFIX)) {
+      funcs.emplace_back(key, len);
+    }
+  }
+  for (const auto &func : funcs) {
+    lua_pushlstring(lua, func.data(), func.size());
+    lua_pushnil(lua);
+    lua_rawset(lua, LUA_GLOBALSINDEX);
+  }
+
+  lua_pushnumber(lua, version);
+  lua_setfield(lua, LUA_REGISTRYINDEX, "__script_cache_version");
+}
+
 }  // namespace lua
@@ -48,6 +48,12 @@ int RedisErrorReplyCommand(lua_State *lua);
 int RedisLogCommand(lua_State *lua);
 
 Status CreateFunction(Server *srv, const std::string &body, std::string *sha, lua_State *lua, bool need_to_store);
+// Define the function of the script from the shared bytecode cache, returns NotFound if it's not cached
+Status LoadFunctionFromCache(Server *srv, lua_State *lua, const std::string &sha);
+// Make sure the function of the script is defined if it's cached, it's a no-op if already defined
+Status PrewarmFunction(Server *srv, lua_State *lua, const std::string &sha);
+// Drop the functions of the Lua state if the script cache was cleared since they were defined
+void SyncScriptCacheVersion(Server *srv, lua_State *lua);
 
 Status EvalGenericCommand(redis::Connection *conn, const std::string &body_or_sha, const std::vector<std::string> &keys,
                           const std::vector<std::string> &argv, bool evalsha, std::string *output,
@@ -40,6 +40,9 @@
 #include "event_listener.h"
 #include "event_util.h"
 #include "fd_util.h"
+#include "io_util.h"
+#include "parse_util.h"
+#include "prefix_extractor.h"
 #include "redis_db.h"
 #include "redis_metadata.h"
 #include "rocksdb_crc32c.h"
@@ -55,8 +58,29 @@ const int64_t kIORateLimitMaxMb = 1024000;
 
 using rocksdb::Slice;
 
+static ColumnFamilyID ColumnFamilyIDOf(const std::string &name) {
+  if (name == kMetadataColumnFamilyName) {
+    return kColumnFamilyIDMetadata;
+  } else if (name == kZSetScoreColumnFamilyName) {
+    return kColumnFamilyIDZSetScore;
+  } else if (name == kPubSubColumnFamilyName) {
+    return kColumnFamilyIDPubSub;
+  } else if (name == kPropagateColumnFamilyName) {
+    return kColumnFamilyIDPropagate;
+  } else if (name == kStreamColumnFamilyName) {
+    return kColumnFamilyIDStream;
+  } else if (name == kDeletionLogColumnFamilyName) {
+    return kColumnFamilyIDDeletionLog;
+  }
+  return kColumnFamilyIDDefault;
+}
+
 Storage::Storage(Config *config)
-    : backup_creating_time_(util::GetTimeStamp()), env_(rocksdb::Env::Default()), config_(config), lock_mgr_(16) {
+    : backup_creating_time_(util::GetTimeStamp()),
+      env_(rocksdb::Env::Default()),
+      config_(config),
+      lock_mgr_(16),
+      metadata_cache_(static_cast<size_t>(config->metadata_cache_size) * MiB) {
   Metadata::InitVersionCounter();
   SetWriteOptions(config->rocks_db.write_options);
 }
@@ -74,6 +98,19 @@ void Storage::CloseDB() {
   db_->SyncWAL();
   rocksdb::CancelAllBackgroundWork(db_, true);
   for (auto handle : cf_handles_) db_->DestroyColumnFamilyHandle(handle);
+  {
+    std::unique_lock<std::shared_mutex> lock(ns_cf_mu_);
+    for (const auto &iter : ns_cfs_) {
+      for (auto handle : iter.second.handles) {
+        if (handle) db_->DestroyColumnFamilyHandle(handle);
+      }
+    }
+    for (auto handle : dropped_cf_handles_) db_->DestroyColumnFamilyHandle(handle);
+    ns_cfs_.clear();
+    ns_cf_ids_.clear();
+    dropped_cf_handles_.clear();
+    num_isolated_namespaces_ = 0;
+  }
   delete db_;
   db_ = nullptr;
 }
@@ -180,6 +217,15 @@ Status Storage::SetOptionForAllColumnFamilies(const std::string &key, const std:
     auto s = db_->SetOptions(cf_handle, {{key, value}});
     if (!s.ok()) return {Status::NotOK, s.ToString()};
   }
+  // the isolated namespaces keep their own write buffer size if it's configured
+  if (key == "write_buffer_size" && config_->namespace_write_buffer_size > 0) return Status::OK();
+  for (const auto &iter : GetNamespaceColumnFamilies()) {
+    for (auto cf_handle : iter.second.handles) {
+      if (!cf_handle) continue;
+      auto s = db_->SetOptions(cf_handle, {{key, value}});
+      if (!s.ok()) return {Status::NotOK, s.ToString()};
+    }
+  }
   return Status::OK();
 }
 
@@ -234,6 +280,9 @@ Status Storage::CreateColumnFamilies(const rocksdb::Options &options) {
 Status Storage::Open(bool read_only) {
   auto guard = WriteLockGuard();
   db_closing_ = false;
+  // The file numbers may be reused by the reopened DB, e.g. restoring from the checkpoint
+  tombstone_stats_.Clear();
+  metadata_cache_.Clear();
 
   bool cache_index_and_filter_blocks = config_->rocks_db.cache_index_and_filter_blocks;
   size_t metadata_block_cache_size = config_->rocks_db.metadata_block_cache_size * MiB;
@@ -249,10 +298,15 @@ Status Storage::Open(bool read_only) {
     size_t shared_block_cache_size = metadata_block_cache_size + subkey_block_cache_size;
     shared_block_cache = rocksdb::NewLRUCache(shared_block_cache_size, -1, false, 0.75);
   }
+  metadata_block_cache_ =
+      shared_block_cache ? shared_block_cache : rocksdb::NewLRUCache(metadata_block_cache_size, -1, false, 0.75);
+  subkey_block_cache_ =
+      shared_block_cache ? shared_block_cache : rocksdb::NewLRUCache(subkey_block_cache_size, -1, false, 0.75);
+  // the tuned settings are applied to the old DB, start over with the configured options
+  auto_tuner_.Reset(autoTuneBounds());
 
   rocksdb::BlockBasedTableOptions metadata_table_opts = InitTableOptions();
-  metadata_table_opts.block_cache =
-      shared_block_cache ? shared_block_cache : rocksdb::NewLRUCache(metadata_block_cache_size, -1, false, 0.75);
+  metadata_table_opts.block_cache = metadata_block_cache_;
   metadata_table_opts.pin_l0_filter_and_index_blocks_in_cache = true;
   metadata_table_opts.cache_index_and_filter_blocks = cache_index_and_filter_blocks;
   metadata_table_opts.cache_index_and_filter_blocks_with_high_priority = true;
@@ -269,8 +323,7 @@ Status Storage::Open(bool read_only) {
   SetBlobDB(&metadata_opts);
 
   rocksdb::BlockBasedTableOptions subkey_table_opts = InitTableOptions();
-  subkey_table_opts.block_cache =
-      shared_block_cache ? shared_block_cache : rocksdb::NewLRUCache(subkey_block_cache_size, -1, false, 0.75);
+  subkey_table_opts.block_cache = subkey_block_cache_;
   subkey_table_opts.pin_l0_filter_and_index_blocks_in_cache = true;
   subkey_table_opts.cache_index_and_filter_blocks = cache_index_and_filter_blocks;
   subkey_table_opts.cache_index_and_filter_blocks_with_high_priority = true;
@@ -278,6 +331,10 @@ Status Storage::Open(bool read_only) {
   subkey_opts.table_factory.reset(rocksdb::NewBlockBasedTableFactory(subkey_table_opts));
   subkey_opts.compaction_filter_factory = std::make_shared<SubKeyFilterFactory>(this);
   subkey_opts.disable_auto_compactions = config_->rocks_db.disable_auto_compactions;
+  // Enable prefix bloom filter in both sst and memtable, the subkeys of the same key share the prefix,
+  // so the iterations on the key without any subkey in the files or memtable can be skipped
+  subkey_opts.prefix_extractor = NewSubKeyPrefixExtractor(IsSlotIdEncoded());
+  subkey_opts.memtable_prefix_bloom_size_ratio = 0.1;
   subkey_opts.table_properties_collector_factories.emplace_back(
       NewCompactOnExpiredTableCollectorFactory(kSubkeyColumnFamilyName, 0.3));
   SetBlobDB(&subkey_opts);
@@ -296,6 +353,11 @@ Status Storage::Open(bool read_only) {
   propagate_opts.disable_auto_compactions = config_->rocks_db.disable_auto_compactions;
   SetBlobDB(&propagate_opts);
 
+  rocksdb::BlockBasedTableOptions deletion_log_table_opts = InitTableOptions();
+  rocksdb::ColumnFamilyOptions deletion_log_opts(options);
+  deletion_log_opts.table_factory.reset(rocksdb::NewBlockBasedTableFactory(deletion_log_table_opts));
+  deletion_log_opts.disable_auto_compactions = config_->rocks_db.disable_auto_compactions;
+
   std::vector<rocksdb::ColumnFamilyDescriptor> column_families;
   // Caution: don't change the order of column family, or the handle will be mismatched
   column_families.emplace_back(rocksdb::kDefaultColumnFamilyName, subkey_opts);
@@ -304,16 +366,32 @@ Status Storage::Open(bool read_only) {
   column_families.emplace_back(kPubSubColumnFamilyName, pubsub_opts);
   column_families.emplace_back(kPropagateColumnFamilyName, propagate_opts);
   column_families.emplace_back(kStreamColumnFamilyName, subkey_opts);
+  column_families.emplace_back(kDeletionLogColumnFamilyName, deletion_log_opts);
 
   std::vector<std::string> old_column_families;
   auto s = rocksdb::DB::ListColumnFamilies(options, config_->db_dir, &old_column_families);
   if (!s.ok()) return {Status::NotOK, s.ToString()};
 
+  // The column families of the isolated namespaces follow the shared ones, they're opened
+  // no matter whether the namespace-column-families is enabled, or the DB can't be opened.
+  std::map<std::string, std::shared_ptr<rocksdb::Cache>> ns_block_caches;
+  for (const auto &name : old_column_families) {
+    auto pos = name.find(kNamespaceColumnFamilySeparator);
+    if (pos == std::string::npos) continue;
+
+    auto ns = name.substr(pos + 1);
+    if (ns_block_caches.find(ns) == ns_block_caches.end()) ns_block_caches[ns] = newNamespaceBlockCache();
+    bool is_metadata = ColumnFamilyIDOf(name.substr(0, pos)) == kColumnFamilyIDMetadata;
+    const auto &shared_opts = is_metadata ? metadata_opts : subkey_opts;
+    column_families.emplace_back(name, namespaceCFOptions(shared_opts, ns_block_caches[ns]));
+  }
+
+  std::vector<rocksdb::ColumnFamilyHandle *> cf_handles;
   auto start = std::chrono::high_resolution_clock::now();
   if (read_only) {
-    s = rocksdb::DB::OpenForReadOnly(options, config_->db_dir, column_families, &cf_handles_, &db_);
+    s = rocksdb::DB::OpenForReadOnly(options, config_->db_dir, column_families, &cf_handles, &db_);
   } else {
-    s = rocksdb::DB::Open(options, config_->db_dir, column_families, &cf_handles_, &db_);
+    s = rocksdb::DB::Open(options, config_->db_dir, column_families, &cf_handles, &db_);
   }
   auto end = std::chrono::high_resolution_clock::now();
   int64_t duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
@@ -322,6 +400,27 @@ Status Storage::Open(bool read_only) {
     return {Status::DBOpenErr, s.ToString()};
   }
 
+  cf_handles_.assign(cf_handles.begin(), cf_handles.begin() + kColumnFamilyIDDeletionLog + 1);
+  {
+    std::unique_lock<std::shared_mutex> lock(ns_cf_mu_);
+    for (size_t i = kColumnFamilyIDDeletionLog + 1; i < cf_handles.size(); i++) {
+      const auto &name = cf_handles[i]->GetName();
+      auto pos = name.find(kNamespaceColumnFamilySeparator);
+      auto ns = name.substr(pos + 1);
+      ns_cfs_[ns].block_cache = ns_block_caches[ns];
+      addNamespaceCFHandle(ns, ColumnFamilyIDOf(name.substr(0, pos)), cf_handles[i]);
+    }
+  }
+
+  // the collections which were unlinked before restarting are still waiting to be reclaimed
+  deletion_log_.Clear();
+  std::unique_ptr<rocksdb::Iterator> iter(
+      db_->NewIterator(rocksdb::ReadOptions(), cf_handles_[kColumnFamilyIDDeletionLog]));
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    auto prefix = DeletionLog::SubKeyPrefix(iter->key());
+    if (!prefix.empty()) deletion_log_.Add(prefix);
+  }
+
   LOG(INFO) << "[storage] Success to load the data from disk: " << duration << " ms";
   return Status::OK();
 }
@@ -534,6 +633,25 @@ rocksdb::Iterator *Storage::NewIterator(const rocksdb::ReadOptions &options,
   return iter;
 }
 
+rocksdb::Status Storage::GetRawMetadata(const rocksdb::ReadOptions &options, rocksdb::ColumnFamilyHandle *cf_handle,
+                                        const rocksdb::Slice &ns_key, std::string *value) {
+  // the metadata may be modified in the pending write batch of the transaction
+  if (is_txn_mode_ || !metadata_cache_.Enabled()) {
+    return Get(options, cf_handle, ns_key, value);
+  }
+
+  uint64_t epoch = 0;
+  if (metadata_cache_.Lookup(ns_key, value, &epoch)) {
+    return rocksdb::Status::OK();
+  }
+  // the value read from an old snapshot may be stale even if the key wasn't invalidated after the lookup
+  rocksdb::ReadOptions read_options = options;
+  read_options.snapshot = nullptr;
+  auto s = db_->Get(read_options, cf_handle, ns_key, value);
+  if (s.ok()) metadata_cache_.Insert(ns_key, *value, epoch);
+  return s;
+}
+
 void Storage::MultiGet(const rocksdb::ReadOptions &options, rocksdb::ColumnFamilyHandle *column_family,
                        const size_t num_keys, const rocksdb::Slice *keys, rocksdb::PinnableSlice *values,
                        rocksdb::Status *statuses) {
@@ -562,7 +680,152 @@ rocksdb::Status Storage::writeToDB(const rocksdb::WriteOptions &options, rocksdb
     updates->PutLogData(ServerLogData(kReplIdLog, replid_).Encode());
   }
 
-  return db_->Write(options, updates);
+  auto s = db_->Write(options, updates);
+  if (s.ok()) {
+    invalidateMetadataCache(updates);
+    recordWrittenMetadata(updates);
+    notifyWALNewData();
+  }
+  return s;
+}
+
+thread_local WrittenMetadataRecorder *WrittenMetadataRecorder::current_ = nullptr;
+
+void Storage::recordWrittenMetadata(rocksdb::WriteBatch *batch) {
+  auto recorder = WrittenMetadataRecorder::Current();
+  if (!recorder) return;
+
+  class WrittenMetadataHandler : public rocksdb::WriteBatch::Handler {
+   public:
+    WrittenMetadataHandler(Storage *storage, WrittenMetadataRecorder *recorder)
+        : storage_(storage), recorder_(recorder) {}
+    rocksdb::Status PutCF(uint32_t column_family_id, const Slice &key, const Slice &value) override {
+      if (storage_->GetSharedCFID(column_family_id) == kColumnFamilyIDMetadata) {
+        recorder_->Record(key.ToString(), value.ToString());
+      }
+      return rocksdb::Status::OK();
+    }
+    rocksdb::Status DeleteCF(uint32_t column_family_id, const rocksdb::Slice &key) override {
+      if (storage_->GetSharedCFID(column_family_id) == kColumnFamilyIDMetadata) {
+        recorder_->Record(key.ToString(), std::nullopt);
+      }
+      return rocksdb::Status::OK();
+    }
+
+   private:
+    Storage *storage_;
+    WrittenMetadataRecorder *recorder_;
+  };
+
+  WrittenMetadataHandler handler(this, recorder);
+  auto s = batch->Iterate(&handler);
+  if (!s.ok()) {
+    LOG(WARNING) << "[storage] Failed to record the written metadata, err: " << s.ToString();
+  }
+}
+
+void Storage::invalidateMetadataCache(rocksdb::WriteBatch *batch) {
+  if (!metadata_cache_.Enabled()) return;
+
+  // The metadata keys are invalidated after the batch was written, so the readers which missed them
+  // before would see the epochs were changed and give up caching the stale values
+  class MetadataCacheInvalidator : public rocksdb::WriteBatch::Handler {
+   public:
+    MetadataCacheInvalidator(Storage *storage, MetadataCache *cache) : storage_(storage), cache_(cache) {}
+    rocksdb::Status PutCF(uint32_t column_family_id, const Slice &key, const Slice &value) override {
+      return invalidate(column_family_id, key);
+    }
+    rocksdb::Status MergeCF(uint32_t column_family_id, const Slice &key, const Slice &value) override {
+      return invalidate(column_family_id, key);
+    }
+    rocksdb::Status DeleteCF(uint32_t column_family_id, const rocksdb::Slice &key) override {
+      return invalidate(column_family_id, key);
+    }
+    rocksdb::Status SingleDeleteCF(uint32_t column_family_id, const rocksdb::Slice &key) override {
+      return invalidate(column_family_id, key);
+    }
+    rocksdb::Status DeleteRangeCF(uint32_t column_family_id, const rocksdb::Slice &begin_key,
+                                  const rocksdb::Slice &end_key) override {
+      if (storage_->GetSharedCFID(column_family_id) == kColumnFamilyIDMetadata) cache_->Clear();
+      return rocksdb::Status::OK();
+    }
+
+   private:
+    Storage *storage_;
+    MetadataCache *cache_;
+
+    rocksdb::Status invalidate(uint32_t column_family_id, const rocksdb::Slice &key) {
+      if (storage_->GetSharedCFID(column_family_id) == kColumnFamilyIDMetadata) cache_->Invalidate(key);
+      return rocksdb::Status::OK();
+    }
+  };
+
+  MetadataCacheInvalidator invalidator(this, &metadata_cache_);
+  auto s = batch->Iterate(&invalidator);
+  if (!s.ok()) {
+    LOG(WARNING) << "[storage] Failed to invalidate the metadata cache, err: " << s.ToString();
+    metadata_cache_.Clear();
+  }
+}
+
+void Storage::applyDeletionLog(rocksdb::WriteBatch *batch) {
+  // The replicas keep the pending prefixes in sync with the replicated deletion log, or they would be
+  // only loaded while opening the DB and never removed. They're still tracked after the promotion then.
+  class DeletionLogApplier : public rocksdb::WriteBatch::Handler {
+   public:
+    explicit DeletionLogApplier(DeletionLog *log) : log_(log) {}
+    rocksdb::Status PutCF(uint32_t column_family_id, const Slice &key, const Slice &value) override {
+      if (column_family_id != kColumnFamilyIDDeletionLog) return rocksdb::Status::OK();
+
+      auto prefix = DeletionLog::SubKeyPrefix(key);
+      if (!prefix.empty()) log_->Add(prefix);
+      return rocksdb::Status::OK();
+    }
+    rocksdb::Status DeleteCF(uint32_t column_family_id, const rocksdb::Slice &key) override {
+      if (column_family_id != kColumnFamilyIDDeletionLog) return rocksdb::Status::OK();
+
+      auto prefix = DeletionLog::SubKeyPrefix(key);
+      if (!prefix.empty()) {
+        log_->Remove(prefix);
+        log_->IncrReclaimed(1);
+      }
+      return rocksdb::Status::OK();
+    }
+    rocksdb::Status DeleteRangeCF(uint32_t column_family_id, const rocksdb::Slice &begin_key,
+                                  const rocksdb::Slice &end_key) override {
+      // the whole deletion log is only removed by FLUSHALL
+      if (column_family_id == kColumnFamilyIDDeletionLog) log_->Clear();
+      return rocksdb::Status::OK();
+    }
+
+   private:
+    DeletionLog *log_;
+  };
+
+  DeletionLogApplier applier(&deletion_log_);
+  auto s = batch->Iterate(&applier);
+  if (!s.ok()) {
+    LOG(WARNING) << "[storage] Failed to apply the deletion log, err: " << s.ToString();
+  }
+}
+
+void Storage::notifyWALNewData() {
+  // Fast path: nobody is waiting for the new data, so avoid touching the mutex
+  if (wal_new_data_waiters_.load() == 0) return;
+
+  // Acquire the mutex to make sure the waiter is either not checking the sequence yet
+  // or already blocked in wait, so that the notification won't be lost.
+  { std::lock_guard<std::mutex> lg(wal_new_data_mu_); }
+  wal_new_data_cv_.notify_all();
+}
+
+bool Storage::WaitForWALNewData(rocksdb::SequenceNumber seq, std::chrono::milliseconds timeout) {
+  wal_new_data_waiters_.fetch_add(1);
+  std::unique_lock<std::mutex> lock(wal_new_data_mu_);
+  bool has_new_data = wal_new_data_cv_.wait_for(lock, timeout, [this, seq] { return WALHasNewData(seq); });
+  lock.unlock();
+  wal_new_data_waiters_.fetch_sub(1);
+  return has_new_data;
 }
 
 rocksdb::Status Storage::Delete(const rocksdb::WriteOptions &options, rocksdb::ColumnFamilyHandle *cf_handle,
@@ -573,8 +836,12 @@ rocksdb::Status Storage::Delete(const rocksdb::WriteOptions &options, rocksdb::C
 }
 
 rocksdb::Status Storage::DeleteRange(const std::string &first_key, const std::string &last_key) {
+  return DeleteRange(GetCFHandle(kMetadataColumnFamilyName), first_key, last_key);
+}
+
+rocksdb::Status Storage::DeleteRange(rocksdb::ColumnFamilyHandle *cf_handle, const std::string &first_key,
+                                     const std::string &last_key) {
   auto batch = GetWriteBatchBase();
-  rocksdb::ColumnFamilyHandle *cf_handle = GetCFHandle(kMetadataColumnFamilyName);
   auto s = batch->DeleteRange(cf_handle, first_key, last_key);
   if (!s.ok()) {
     return s;
@@ -588,6 +855,57 @@ rocksdb::Status Storage::DeleteRange(const std::string &first_key, const std::st
   return Write(write_opts_, batch->GetWriteBatch());
 }
 
+StatusOr<size_t> Storage::ReclaimDeletedSubKeys(size_t max_entries) {
+  auto log_cf_handle = cf_handles_[kColumnFamilyIDDeletionLog];
+  std::unique_ptr<rocksdb::Iterator> iter(db_->NewIterator(rocksdb::ReadOptions(), log_cf_handle));
+
+  // the batch is written directly since the reaper shouldn't join the running transaction
+  rocksdb::WriteBatch batch;
+  std::vector<std::string> prefixes;
+  size_t num_entries = 0;
+  for (iter->SeekToFirst(); iter->Valid() && num_entries < max_entries; iter->Next(), num_entries++) {
+    // only the entries which were read are removed, the entry which was written with an earlier
+    // timestamp after the iterator was created would be reaped next time
+    batch.Delete(log_cf_handle, iter->key());
+    auto prefix = DeletionLog::SubKeyPrefix(iter->key());
+    if (prefix.empty() || iter->value().empty()) continue;
+
+    // the subkeys of the deleted version are in [prefix, prefix with the next version)
+    InternalKey ikey(prefix, IsSlotIdEncoded());
+    std::string end_key = prefix.ToString();
+    EncodeFixed64(end_key.data() + end_key.size() - sizeof(uint64_t), ikey.GetVersion() + 1);
+
+    auto ns = ikey.GetNamespace().ToString();
+    auto type = static_cast<RedisType>(static_cast<uint8_t>(iter->value()[0]) & METADATA_TYPE_MASK);
+    auto subkey_cf_handle = GetCFHandle(kSubkeyColumnFamilyName, ns);
+    if (type == kRedisStream) {
+      batch.DeleteRange(GetCFHandle(kStreamColumnFamilyName, ns), prefix, end_key);
+    } else {
+      batch.DeleteRange(subkey_cf_handle, prefix, end_key);
+    }
+    if (type == kRedisZSet) {
+      batch.DeleteRange(GetCFHandle(kZSetScoreColumnFamilyName, ns), prefix, end_key);
+    }
+    if (ikey.IsKeyIdEncoded()) {
+      std::string anchor_key;
+      ikey.EncodeKeyIdAnchor(&anchor_key);
+      batch.Delete(subkey_cf_handle, anchor_key);
+    }
+    prefixes.emplace_back(prefix.ToString());
+  }
+  if (!iter->status().ok()) return {Status::NotOK, iter->status().ToString()};
+  if (num_entries == 0) return 0;
+
+  auto s = writeToDB(write_opts_, &batch);
+  if (!s.ok()) return {Status::NotOK, s.ToString()};
+
+  for (const auto &prefix : prefixes) {
+    deletion_log_.Remove(prefix);
+  }
+  deletion_log_.IncrReclaimed(prefixes.size());
+  return num_entries;
+}
+
 rocksdb::Status Storage::FlushScripts(const rocksdb::WriteOptions &options, rocksdb::ColumnFamilyHandle *cf_handle) {
   std::string begin_key = kLuaFunctionPrefix, end_key = begin_key;
   // we need to increase one here since the DeleteRange api
@@ -613,23 +931,153 @@ Status Storage::ReplicaApplyWriteBatch(std::string &&raw_batch) {
   if (!s.ok()) {
     return {Status::NotOK, s.ToString()};
   }
+  invalidateMetadataCache(&batch);
+  applyDeletionLog(&batch);
+  // Wake up the feeders of the chained replicas
+  notifyWALNewData();
 
   return Status::OK();
 }
 
 rocksdb::ColumnFamilyHandle *Storage::GetCFHandle(const std::string &name) {
-  if (name == kMetadataColumnFamilyName) {
-    return cf_handles_[1];
-  } else if (name == kZSetScoreColumnFamilyName) {
-    return cf_handles_[2];
-  } else if (name == kPubSubColumnFamilyName) {
-    return cf_handles_[3];
-  } else if (name == kPropagateColumnFamilyName) {
-    return cf_handles_[4];
-  } else if (name == kStreamColumnFamilyName) {
-    return cf_handles_[5];
+  return cf_handles_[ColumnFamilyIDOf(name)];
+}
+
+rocksdb::ColumnFamilyHandle *Storage::GetCFHandle(const std::string &name, const std::string &ns) {
+  // fast path: no namespace is isolated
+  if (num_isolated_namespaces_.load(std::memory_order_relaxed) > 0) {
+    std::shared_lock<std::shared_mutex> lock(ns_cf_mu_);
+    auto iter = ns_cfs_.find(ns);
+    if (iter != ns_cfs_.end() && iter->second.handles[ColumnFamilyIDOf(name)]) {
+      return iter->second.handles[ColumnFamilyIDOf(name)];
+    }
+  }
+  return GetCFHandle(name);
+}
+
+rocksdb::ColumnFamilyHandle *Storage::GetSiblingCFHandle(uint32_t column_family_id, const std::string &name) {
+  if (column_family_id <= kColumnFamilyIDStream) {
+    return cf_handles_.size() > kColumnFamilyIDDeletionLog ? GetCFHandle(name) : nullptr;
+  }
+
+  std::shared_lock<std::shared_mutex> lock(ns_cf_mu_);
+  auto iter = ns_cf_ids_.find(column_family_id);
+  if (iter == ns_cf_ids_.end()) return nullptr;
+  auto ns_iter = ns_cfs_.find(iter->second.first);
+  return ns_iter != ns_cfs_.end() ? ns_iter->second.handles[ColumnFamilyIDOf(name)] : nullptr;
+}
+
+ColumnFamilyID Storage::GetSharedCFID(uint32_t column_family_id) {
+  if (column_family_id <= kColumnFamilyIDDeletionLog) return static_cast<ColumnFamilyID>(column_family_id);
+
+  std::shared_lock<std::shared_mutex> lock(ns_cf_mu_);
+  auto iter = ns_cf_ids_.find(column_family_id);
+  // the column family of the dropped namespace is taken as a subkey column family
+  return iter != ns_cf_ids_.end() ? iter->second.second : kColumnFamilyIDDefault;
+}
+
+std::shared_ptr<rocksdb::Cache> Storage::newNamespaceBlockCache() {
+  if (config_->namespace_block_cache_size <= 0) return nullptr;
+  return rocksdb::NewLRUCache(static_cast<size_t>(config_->namespace_block_cache_size) * MiB, -1, false, 0.75);
+}
+
+rocksdb::ColumnFamilyOptions Storage::namespaceCFOptions(const rocksdb::ColumnFamilyOptions &shared_options,
+                                                         const std::shared_ptr<rocksdb::Cache> &block_cache) {
+  rocksdb::ColumnFamilyOptions cf_options = shared_options;
+  if (block_cache) {
+    auto table_opts = *shared_options.table_factory->GetOptions<rocksdb::BlockBasedTableOptions>();
+    table_opts.block_cache = block_cache;
+    cf_options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_opts));
+  }
+  if (config_->namespace_write_buffer_size > 0) {
+    cf_options.write_buffer_size = static_cast<size_t>(config_->namespace_write_buffer_size) * MiB;
+  }
+  return cf_options;
+}
+
+// addNamespaceCFHandle should be called with the ns_cf_mu_ locked
+void Storage::addNamespaceCFHandle(const std::string &ns, ColumnFamilyID id, rocksdb::ColumnFamilyHandle *handle) {
+  ns_cfs_[ns].handles[id] = handle;
+  ns_cf_ids_[handle->GetID()] = {ns, id};
+  num_isolated_namespaces_ = ns_cfs_.size();
+}
+
+Status Storage::CreateNamespaceColumnFamilies(const std::string &ns, std::vector<uint32_t> *cf_ids) {
+  auto guard = ReadLockGuard();
+  if (db_closing_) return {Status::NotOK, "DB is closing"};
+
+  std::unique_lock<std::shared_mutex> lock(ns_cf_mu_);
+  if (ns_cfs_.find(ns) != ns_cfs_.end()) return {Status::NotOK, "the namespace was already isolated"};
+
+  // the options which were changed at runtime are inherited from the shared column families
+  auto block_cache = newNamespaceBlockCache();
+  std::vector<rocksdb::ColumnFamilyDescriptor> column_families;
+  for (const auto &[id, name] : kNamespaceColumnFamilies) {
+    rocksdb::ColumnFamilyOptions shared_options = db_->GetOptions(cf_handles_[id]);
+    column_families.emplace_back(std::string(name) + kNamespaceColumnFamilySeparator + ns,
+                                 namespaceCFOptions(shared_options, block_cache));
+  }
+
+  std::vector<rocksdb::ColumnFamilyHandle *> handles;
+  auto s = db_->CreateColumnFamilies(column_families, &handles);
+  if (!s.ok()) {
+    // the column families may be partially created
+    for (auto handle : handles) {
+      db_->DropColumnFamily(handle);
+      db_->DestroyColumnFamilyHandle(handle);
+    }
+    return {Status::NotOK, s.ToString()};
+  }
+
+  cf_ids->clear();
+  ns_cfs_[ns].block_cache = block_cache;
+  for (size_t i = 0; i < handles.size(); i++) {
+    addNamespaceCFHandle(ns, kNamespaceColumnFamilies[i].first, handles[i]);
+    cf_ids->emplace_back(handles[i]->GetID());
+  }
+  // the cached metadata may be read from the shared column families before
+  metadata_cache_.Clear();
+  LOG(INFO) << "[storage] Created the column families of the namespace: " << ns;
+  return Status::OK();
+}
+
+Status Storage::DropNamespaceColumnFamilies(const std::string &ns) {
+  auto guard = ReadLockGuard();
+  if (db_closing_) return {Status::NotOK, "DB is closing"};
+
+  std::unique_lock<std::shared_mutex> lock(ns_cf_mu_);
+  auto iter = ns_cfs_.find(ns);
+  if (iter == ns_cfs_.end()) return {Status::NotFound, "the namespace is not isolated"};
+
+  std::vector<rocksdb::ColumnFamilyHandle *> handles;
+  for (auto handle : iter->second.handles) {
+    if (handle) handles.emplace_back(handle);
+  }
+  auto s = db_->DropColumnFamilies(handles);
+  if (!s.ok()) return {Status::NotOK, s.ToString()};
+
+  // the running commands may still hold the handles, so they're destroyed after the DB was closed
+  for (auto handle : handles) {
+    ns_cf_ids_.erase(handle->GetID());
+    dropped_cf_handles_.emplace_back(handle);
   }
-  return cf_handles_[0];
+  ns_cfs_.erase(iter);
+  num_isolated_namespaces_ = ns_cfs_.size();
+  metadata_cache_.Clear();
+  LOG(INFO) << "[storage] Dropped the column families of the namespace: " << ns;
+  return Status::OK();
+}
+
+bool Storage::IsNamespaceIsolated(const std::string &ns) {
+  if (num_isolated_namespaces_.load(std::memory_order_relaxed) == 0) return false;
+
+  std::shared_lock<std::shared_mutex> lock(ns_cf_mu_);
+  return ns_cfs_.find(ns) != ns_cfs_.end();
+}
+
+std::map<std::string, NamespaceColumnFamilies> Storage::GetNamespaceColumnFamilies() {
+  std::shared_lock<std::shared_mutex> lock(ns_cf_mu_);
+  return ns_cfs_;
 }
 
 rocksdb::Status Storage::Compact(const Slice *begin, const Slice *end) {
@@ -639,6 +1087,13 @@ rocksdb::Status Storage::Compact(const Slice *begin, const Slice *end) {
     rocksdb::Status s = db_->CompactRange(compact_opts, cf_handle, begin, end);
     if (!s.ok()) return s;
   }
+  for (const auto &iter : GetNamespaceColumnFamilies()) {
+    for (auto cf_handle : iter.second.handles) {
+      if (!cf_handle) continue;
+      rocksdb::Status s = db_->CompactRange(compact_opts, cf_handle, begin, end);
+      if (!s.ok()) return s;
+    }
+  }
   return rocksdb::Status::OK();
 }
 
@@ -655,11 +1110,8 @@ uint64_t Storage::GetTotalSize(const std::string &ns) {
   rocksdb::DB::SizeApproximationFlags include_both =
       rocksdb::DB::SizeApproximationFlags::INCLUDE_FILES | rocksdb::DB::SizeApproximationFlags::INCLUDE_MEMTABLES;
 
-  for (auto cf_handle : cf_handles_) {
-    if (cf_handle == GetCFHandle(kPubSubColumnFamilyName) || cf_handle == GetCFHandle(kPropagateColumnFamilyName)) {
-      continue;
-    }
-
+  for (const auto &[_, name] : kNamespaceColumnFamilies) {
+    auto cf_handle = GetCFHandle(name, ns);
     auto s = db.FindKeyRangeWithPrefix(prefix, std::string(), &begin_key, &end_key, cf_handle);
     if (!s.ok()) continue;
 
@@ -697,6 +1149,82 @@ void Storage::SetIORateLimit(int64_t max_io_mb) {
   rate_limiter_->SetBytesPerSecond(max_io_mb * static_cast<int64_t>(MiB));
 }
 
+AutoTuner::Bounds Storage::autoTuneBounds() {
+  AutoTuner::Bounds bounds;
+  if (!config_->rocks_db.share_metadata_and_subkey_block_cache) {
+    bounds.metadata_block_cache = config_->rocks_db.metadata_block_cache_size * MiB;
+    bounds.total_block_cache = bounds.metadata_block_cache + config_->rocks_db.subkey_block_cache_size * MiB;
+  }
+  bounds.min_write_buffer = config_->rocks_db.write_buffer_size * MiB;
+  bounds.max_write_buffer = config_->auto_tune_max_write_buffer_size * MiB;
+  // max_background_jobs only takes effect if max_background_compactions is -1
+  bounds.min_background_jobs = config_->rocks_db.max_background_compactions >= 0
+                                   ? config_->rocks_db.max_background_compactions
+                                   : config_->rocks_db.max_background_jobs;
+  bounds.max_background_jobs = config_->auto_tune_max_background_jobs;
+  return bounds;
+}
+
+Status Storage::AutoTune() {
+  AutoTuner::Signals signals;
+  auto stats = db_->GetDBOptions().statistics;
+  signals.block_cache_hits = stats->getTickerCount(rocksdb::Tickers::BLOCK_CACHE_HIT);
+  signals.block_cache_misses = stats->getTickerCount(rocksdb::Tickers::BLOCK_CACHE_MISS);
+  signals.write_stalls = auto_tuner_.GetWriteStalls();
+  signals.metadata_cache_usage = metadata_block_cache_->GetUsage();
+  signals.subkey_cache_usage = subkey_block_cache_->GetUsage();
+  signals.l0_slowdown_trigger = config_->rocks_db.level0_slowdown_writes_trigger;
+  signals.max_write_buffer_number = config_->rocks_db.max_write_buffer_number;
+  // the column families share the background jobs, so the busiest one is taken
+  for (const auto &cf_handle : cf_handles_) {
+    uint64_t value = 0;
+    db_->GetIntProperty(cf_handle, rocksdb::DB::Properties::kEstimatePendingCompactionBytes, &value);
+    signals.pending_compaction_bytes = std::max(signals.pending_compaction_bytes, value);
+    db_->GetIntProperty(cf_handle, rocksdb::DB::Properties::kNumImmutableMemTable, &value);
+    signals.immutable_memtables = std::max(signals.immutable_memtables, value);
+
+    rocksdb::ColumnFamilyMetaData meta;
+    db_->GetColumnFamilyMetaData(cf_handle, &meta);
+    if (!meta.levels.empty()) {
+      signals.l0_files = std::max<uint64_t>(signals.l0_files, meta.levels[0].files.size());
+    }
+  }
+  signals.pending_compaction_bytes_limit = db_->GetOptions().soft_pending_compaction_bytes_limit;
+
+  auto old_settings = auto_tuner_.GetSettings();
+  auto settings = auto_tuner_.Tune(signals, autoTuneBounds());
+  return applyAutoTuneSettings(old_settings, settings);
+}
+
+Status Storage::ResetAutoTune() {
+  auto old_settings = auto_tuner_.GetSettings();
+  auto settings = auto_tuner_.Reset(autoTuneBounds());
+  return applyAutoTuneSettings(old_settings, settings);
+}
+
+Status Storage::applyAutoTuneSettings(const AutoTuner::Settings &old_settings, const AutoTuner::Settings &settings) {
+  if (settings == old_settings) return Status::OK();
+
+  LOG(INFO) << "[storage] Auto tune the metadata block cache: " << settings.metadata_block_cache
+            << ", subkey block cache: " << settings.subkey_block_cache << ", write buffer: " << settings.write_buffer
+            << ", background jobs: " << settings.background_jobs;
+  if (settings.metadata_block_cache > 0 && metadata_block_cache_ != subkey_block_cache_) {
+    metadata_block_cache_->SetCapacity(settings.metadata_block_cache);
+    subkey_block_cache_->SetCapacity(settings.subkey_block_cache);
+  }
+  if (settings.write_buffer != old_settings.write_buffer) {
+    auto s = SetOptionForAllColumnFamilies("write_buffer_size", std::to_string(settings.write_buffer));
+    if (!s.IsOK()) return s;
+  }
+  if (settings.background_jobs != old_settings.background_jobs) {
+    std::string key =
+        config_->rocks_db.max_background_compactions >= 0 ? "max_background_compactions" : "max_background_jobs";
+    auto s = SetDBOption(key, std::to_string(settings.background_jobs));
+    if (!s.IsOK()) return s;
+  }
+  return Status::OK();
+}
+
 rocksdb::DB *Storage::GetDB() { return db_; }
 
 Status Storage::BeginTxn() {
@@ -921,6 +1449,12 @@ Status Storage::ReplDataManager::CleanInvalidFiles(Storage *storage, const std::
     files.push_back(file);
   }
 
+  // Keep the tmp files of the valid files, so the interrupted fetching could resume from them
+  for (size_t i = 0, n = valid_files.size(); i < n; i++) {
+    valid_files.push_back(valid_files[i] + ".tmp");
+    valid_files.push_back(valid_files[i] + ".tmp.progress");
+  }
+
   // Find invalid files
   std::sort(files.begin(), files.end());
   std::sort(valid_files.begin(), valid_files.end());
@@ -1061,9 +1595,101 @@ Status Storage::ReplDataManager::SwapTmpFile(Storage *storage, const std::string
     return {Status::NotOK, fmt::format("unable to rename '{}' to '{}'. Error: {}", tmp_file, orig_file, s.ToString())};
   }
 
+  // The progress file is useless after the tmp file was complete
+  std::string progress_file = tmp_file + ".progress";
+  if (storage->env_->FileExists(progress_file).ok()) {
+    storage->env_->DeleteFile(progress_file);
+  }
   return Status::OK();
 }
 
+int Storage::ReplDataManager::OpenTmpFile(Storage *storage, const std::string &dir, const std::string &repl_file) {
+  std::string tmp_file = dir + "/" + repl_file + ".tmp";
+
+  // Create directory if missing
+  auto abs_dir = tmp_file.substr(0, tmp_file.rfind('/'));
+  if (!MkdirRecursively(storage->env_, abs_dir).IsOK()) {
+    return NullFD;
+  }
+
+  // Don't truncate the tmp file, the chunks of it may be fetched by the previous full sync
+  auto rv = open(tmp_file.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+  if (rv < 0) {
+    LOG(ERROR) << "[storage] Failed to open tmp file '" << tmp_file << "': " << strerror(errno);
+  }
+  return rv;
+}
+
+// The progress file consists of lines, the first line is "<file size> <chunk size>",
+// and each of the following lines is "<offset> <length> <crc>" of a fetched chunk.
+StatusOr<Storage::ReplDataManager::TmpFileProgress> Storage::ReplDataManager::LoadTmpFileProgress(
+    Storage *storage, const std::string &dir, const std::string &repl_file) {
+  std::string tmp_file = dir + "/" + repl_file + ".tmp";
+  std::string progress_file = tmp_file + ".progress";
+  if (!storage->env_->FileExists(tmp_file).ok() || !storage->env_->FileExists(progress_file).ok()) {
+    return {Status::NotFound};
+  }
+
+  std::string content;
+  auto s = rocksdb::ReadFileToString(storage->env_, progress_file, &content);
+  if (!s.ok()) return {Status::NotOK, s.ToString()};
+
+  auto lines = util::Split(content, "\n");
+  if (lines.empty()) return {Status::NotOK, "empty progress file"};
+
+  TmpFileProgress progress;
+  auto header = util::Split(lines[0], " ");
+  if (header.size() != 2) return {Status::NotOK, "invalid progress header"};
+  progress.file_size = GET_OR_RET(ParseInt<uint64_t>(header[0], 10));
+  progress.chunk_size = GET_OR_RET(ParseInt<uint64_t>(header[1], 10));
+
+  std::unique_ptr<rocksdb::RandomAccessFile> file;
+  s = storage->env_->NewRandomAccessFile(tmp_file, &file, rocksdb::EnvOptions());
+  if (!s.ok()) return {Status::NotOK, s.ToString()};
+
+  // Verify the chunks since they may be torn by the crash, only the intact chunks are kept
+  std::string buffer;
+  for (size_t i = 1; i < lines.size(); i++) {
+    auto fields = util::Split(lines[i], " ");
+    if (fields.size() != 3) continue;
+    auto offset = ParseInt<uint64_t>(fields[0], 10);
+    auto length = ParseInt<uint64_t>(fields[1], 10);
+    auto crc = ParseInt<uint32_t>(fields[2], 10);
+    if (!offset || !length || !crc || *offset + *length > progress.file_size) continue;
+
+    buffer.resize(*length);
+    Slice slice;
+    s = file->Read(*offset, *length, &slice, buffer.data());
+    if (!s.ok() || slice.size() != *length) continue;
+    if (rocksdb::crc32c::Extend(0, slice.data(), slice.size()) != *crc) continue;
+    progress.chunks.push_back({*offset, *length, *crc});
+  }
+  return progress;
+}
+
+Status Storage::ReplDataManager::InitTmpFileProgress(Storage *storage, const std::string &dir,
+                                                     const std::string &repl_file, uint64_t file_size,
+                                                     uint64_t chunk_size) {
+  std::string progress_file = dir + "/" + repl_file + ".tmp.progress";
+  auto fd = UniqueFD(open(progress_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+  if (!fd) return Status::FromErrno("open progress file");
+  return util::Write(*fd, fmt::format("{} {}\n", file_size, chunk_size));
+}
+
+Status Storage::ReplDataManager::AppendTmpFileProgress(Storage *storage, const std::string &dir,
+                                                       const std::string &repl_file, const ChunkInfo &chunk) {
+  std::string progress_file = dir + "/" + repl_file + ".tmp.progress";
+  auto fd = UniqueFD(open(progress_file.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC));
+  if (!fd) return Status::FromErrno("open progress file");
+  return util::Write(*fd, fmt::format("{} {} {}\n", chunk.offset, chunk.length, chunk.crc));
+}
+
+void Storage::ReplDataManager::RemoveTmpFile(Storage *storage, const std::string &dir, const std::string &repl_file) {
+  std::string tmp_file = dir + "/" + repl_file + ".tmp";
+  storage->env_->DeleteFile(tmp_file);
+  storage->env_->DeleteFile(tmp_file + ".progress");
+}
+
 bool Storage::ReplDataManager::FileExists(Storage *storage, const std::string &dir, const std::string &repl_file,
                                           uint32_t crc) {
   if (storage->IsClosing()) return false;
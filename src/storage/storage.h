@@ -27,18 +27,28 @@
 #include <rocksdb/utilities/backup_engine.h>
 #include <rocksdb/utilities/write_batch_with_index.h>
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <cinttypes>
+#include <condition_variable>
+#include <map>
 #include <memory>
+#include <optional>
 #include <shared_mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "auto_tuner.h"
 #include "config/config.h"
+#include "deletion_log.h"
 #include "lock_manager.h"
+#include "metadata_cache.h"
 #include "observer_or_unique.h"
 #include "status.h"
+#include "tombstone_stats.h"
 
 const int kReplIdLength = 16;
 
@@ -49,6 +59,7 @@ enum ColumnFamilyID {
   kColumnFamilyIDPubSub,
   kColumnFamilyIDPropagate,
   kColumnFamilyIDStream,
+  kColumnFamilyIDDeletionLog,
 };
 
 namespace engine {
@@ -59,11 +70,65 @@ constexpr const char *kMetadataColumnFamilyName = "metadata";
 constexpr const char *kSubkeyColumnFamilyName = "default";
 constexpr const char *kPropagateColumnFamilyName = "propagate";
 constexpr const char *kStreamColumnFamilyName = "stream";
+constexpr const char *kDeletionLogColumnFamilyName = "deletion_log";
+
+// The column families of an isolated namespace are named as "<column family>@<namespace>"
+constexpr const char kNamespaceColumnFamilySeparator = '@';
+// the data column families which are isolated for each namespace
+constexpr std::array<std::pair<ColumnFamilyID, const char *>, 4> kNamespaceColumnFamilies = {{
+    {kColumnFamilyIDDefault, kSubkeyColumnFamilyName},
+    {kColumnFamilyIDMetadata, kMetadataColumnFamilyName},
+    {kColumnFamilyIDZSetScore, kZSetScoreColumnFamilyName},
+    {kColumnFamilyIDStream, kStreamColumnFamilyName},
+}};
 
 constexpr const char *kPropagateScriptCommand = "script";
+constexpr const char *kPropagateNamespaceCommand = "namespace";
 
 constexpr const char *kLuaFunctionPrefix = "lua_f_";
 
+// NamespaceColumnFamilies are the column families of a namespace which is isolated from the others,
+// only the data column families are isolated while the pubsub and propagate ones are always shared.
+struct NamespaceColumnFamilies {
+  // indexed by the ColumnFamilyID of the shared column family, nullptr if it's not isolated
+  std::array<rocksdb::ColumnFamilyHandle *, kColumnFamilyIDStream + 1> handles{};
+  // nullptr if the namespace shares the block caches with the other namespaces
+  std::shared_ptr<rocksdb::Cache> block_cache;
+};
+
+// SubKeyFilterStats are accumulated by the compaction filters of the subkey column families
+struct SubKeyFilterStats {
+  // the point lookups and the prefetching seeks on the metadata column family
+  std::atomic<uint64_t> metadata_gets = 0;
+  std::atomic<uint64_t> metadata_prefetches = 0;
+  std::atomic<uint64_t> metadata_cache_hits = 0;
+  std::atomic<uint64_t> dropped_subkeys = 0;
+};
+
+// WrittenMetadataRecorder records the metadata written by the current thread while it's alive,
+// so the written keys could be inspected without reading their metadata again
+class WrittenMetadataRecorder {
+ public:
+  WrittenMetadataRecorder() : prev_(current_) { current_ = this; }
+  ~WrittenMetadataRecorder() { current_ = prev_; }
+  WrittenMetadataRecorder(const WrittenMetadataRecorder &) = delete;
+  WrittenMetadataRecorder &operator=(const WrittenMetadataRecorder &) = delete;
+
+  static WrittenMetadataRecorder *Current() { return current_; }
+  // the value is nullopt if the metadata was deleted
+  void Record(std::string ns_key, std::optional<std::string> value) { metadata_[std::move(ns_key)] = std::move(value); }
+  // returns nullptr if the metadata of the key wasn't written
+  const std::optional<std::string> *Find(const std::string &ns_key) const {
+    auto iter = metadata_.find(ns_key);
+    return iter != metadata_.end() ? &iter->second : nullptr;
+  }
+
+ private:
+  static thread_local WrittenMetadataRecorder *current_;
+  WrittenMetadataRecorder *prev_;
+  std::map<std::string, std::optional<std::string>> metadata_;
+};
+
 class Storage {
  public:
   explicit Storage(Config *config);
@@ -92,6 +157,10 @@ class Storage {
   rocksdb::Status Get(const rocksdb::ReadOptions &options, const rocksdb::Slice &key, std::string *value);
   rocksdb::Status Get(const rocksdb::ReadOptions &options, rocksdb::ColumnFamilyHandle *column_family,
                       const rocksdb::Slice &key, std::string *value);
+  // GetRawMetadata reads the raw value from the metadata column family, it's served by the metadata
+  // cache if possible. The snapshot in options is ignored while the cache is enabled.
+  rocksdb::Status GetRawMetadata(const rocksdb::ReadOptions &options, rocksdb::ColumnFamilyHandle *cf_handle,
+                                 const rocksdb::Slice &ns_key, std::string *value);
   void MultiGet(const rocksdb::ReadOptions &options, rocksdb::ColumnFamilyHandle *column_family, size_t num_keys,
                 const rocksdb::Slice *keys, rocksdb::PinnableSlice *values, rocksdb::Status *statuses);
   rocksdb::Iterator *NewIterator(const rocksdb::ReadOptions &options, rocksdb::ColumnFamilyHandle *column_family);
@@ -102,8 +171,11 @@ class Storage {
   rocksdb::Status Delete(const rocksdb::WriteOptions &options, rocksdb::ColumnFamilyHandle *cf_handle,
                          const rocksdb::Slice &key);
   rocksdb::Status DeleteRange(const std::string &first_key, const std::string &last_key);
+  rocksdb::Status DeleteRange(rocksdb::ColumnFamilyHandle *cf_handle, const std::string &first_key,
+                              const std::string &last_key);
   rocksdb::Status FlushScripts(const rocksdb::WriteOptions &options, rocksdb::ColumnFamilyHandle *cf_handle);
   bool WALHasNewData(rocksdb::SequenceNumber seq) { return seq <= LatestSeqNumber(); }
+  bool WaitForWALNewData(rocksdb::SequenceNumber seq, std::chrono::milliseconds timeout);
   Status InWALBoundary(rocksdb::SequenceNumber seq);
   Status WriteToPropagateCF(const std::string &key, const std::string &value);
 
@@ -112,12 +184,32 @@ class Storage {
   bool IsClosing() const { return db_closing_; }
   std::string GetName() { return config_->db_name; }
   rocksdb::ColumnFamilyHandle *GetCFHandle(const std::string &name);
+  // GetCFHandle returns the column family of the namespace if it's isolated, or the shared one
+  rocksdb::ColumnFamilyHandle *GetCFHandle(const std::string &name, const std::string &ns);
+  // GetSiblingCFHandle returns the column family which belongs to the same namespace as the column family id,
+  // it's nullptr if the column families are not opened yet
+  rocksdb::ColumnFamilyHandle *GetSiblingCFHandle(uint32_t column_family_id, const std::string &name);
+  // GetSharedCFID returns the id of the shared column family which the column family takes the place of
+  ColumnFamilyID GetSharedCFID(uint32_t column_family_id);
   std::vector<rocksdb::ColumnFamilyHandle *> *GetCFHandles() { return &cf_handles_; }
+  Status CreateNamespaceColumnFamilies(const std::string &ns, std::vector<uint32_t> *cf_ids);
+  Status DropNamespaceColumnFamilies(const std::string &ns);
+  bool IsNamespaceIsolated(const std::string &ns);
+  std::map<std::string, NamespaceColumnFamilies> GetNamespaceColumnFamilies();
   LockManager *GetLockManager() { return &lock_mgr_; }
+  MetadataCache *GetMetadataCache() { return &metadata_cache_; }
+  DeletionLog *GetDeletionLog() { return &deletion_log_; }
+  SubKeyFilterStats *GetSubKeyFilterStats() { return &subkey_filter_stats_; }
+  // ReclaimDeletedSubKeys removes the subkeys of at most max_entries collections in the deletion log
+  // by range deletions, the number of the consumed entries is returned
+  StatusOr<size_t> ReclaimDeletedSubKeys(size_t max_entries);
   void PurgeOldBackups(uint32_t num_backups_to_keep, uint32_t backup_max_keep_hours);
   uint64_t GetTotalSize(const std::string &ns = kDefaultNamespace);
   void CheckDBSizeLimit();
   void SetIORateLimit(int64_t max_io_mb);
+  AutoTuner *GetAutoTuner() { return &auto_tuner_; }
+  Status AutoTune();
+  Status ResetAutoTune();
 
   std::shared_lock<std::shared_mutex> ReadLockGuard();
   std::unique_lock<std::shared_mutex> WriteLockGuard();
@@ -126,11 +218,13 @@ class Storage {
   void IncrFlushCount(uint64_t n) { flush_count_.fetch_add(n); }
   uint64_t GetCompactionCount() { return compaction_count_; }
   void IncrCompactionCount(uint64_t n) { compaction_count_.fetch_add(n); }
+  TombstoneStats *GetTombstoneStats() { return &tombstone_stats_; }
   bool IsSlotIdEncoded() { return config_->slot_id_encoded; }
   const Config *GetConfig() { return config_; }
 
   Status BeginTxn();
   Status CommitTxn();
+  bool IsTxnMode() const { return is_txn_mode_; }
   ObserverOrUniquePtr<rocksdb::WriteBatchBase> GetWriteBatchBase();
 
   Storage(const Storage &) = delete;
@@ -163,6 +257,27 @@ class Storage {
                                                              const std::string &repl_file);
     static Status SwapTmpFile(Storage *storage, const std::string &dir, const std::string &repl_file);
     static bool FileExists(Storage *storage, const std::string &dir, const std::string &repl_file, uint32_t crc);
+
+    // The chunks of a tmp file which were fetched by ranged requests, it's persisted
+    // along with the tmp file, so that an interrupted full sync can resume from them.
+    struct ChunkInfo {
+      uint64_t offset;
+      uint64_t length;
+      uint32_t crc;
+    };
+    struct TmpFileProgress {
+      uint64_t file_size = 0;
+      uint64_t chunk_size = 0;
+      std::vector<ChunkInfo> chunks;
+    };
+    static int OpenTmpFile(Storage *storage, const std::string &dir, const std::string &repl_file);
+    static StatusOr<TmpFileProgress> LoadTmpFileProgress(Storage *storage, const std::string &dir,
+                                                         const std::string &repl_file);
+    static Status InitTmpFileProgress(Storage *storage, const std::string &dir, const std::string &repl_file,
+                                      uint64_t file_size, uint64_t chunk_size);
+    static Status AppendTmpFileProgress(Storage *storage, const std::string &dir, const std::string &repl_file,
+                                        const ChunkInfo &chunk);
+    static void RemoveTmpFile(Storage *storage, const std::string &dir, const std::string &repl_file);
   };
 
   bool ExistCheckpoint();
@@ -189,16 +304,37 @@ class Storage {
   std::mutex checkpoint_mu_;
   Config *config_ = nullptr;
   std::vector<rocksdb::ColumnFamilyHandle *> cf_handles_;
+  // the column families of the isolated namespaces, the handles of the dropped ones are kept until
+  // the DB was closed since the running commands may still hold them
+  std::shared_mutex ns_cf_mu_;
+  std::map<std::string, NamespaceColumnFamilies> ns_cfs_;
+  std::unordered_map<uint32_t, std::pair<std::string, ColumnFamilyID>> ns_cf_ids_;
+  std::vector<rocksdb::ColumnFamilyHandle *> dropped_cf_handles_;
+  std::atomic<size_t> num_isolated_namespaces_ = 0;
   LockManager lock_mgr_;
+  MetadataCache metadata_cache_;
+  DeletionLog deletion_log_;
+  SubKeyFilterStats subkey_filter_stats_;
   bool db_size_limit_reached_ = false;
   std::atomic<uint64_t> flush_count_{0};
   std::atomic<uint64_t> compaction_count_{0};
+  TombstoneStats tombstone_stats_;
+  // the same cache if the metadata and subkey block cache are shared
+  std::shared_ptr<rocksdb::Cache> metadata_block_cache_;
+  std::shared_ptr<rocksdb::Cache> subkey_block_cache_;
+  AutoTuner auto_tuner_;
 
   std::shared_mutex db_rw_lock_;
   bool db_closing_ = true;
 
   std::atomic<bool> db_in_retryable_io_error_{false};
 
+  // wal_new_data_cv_ is used to wake up the replication feeders as soon as
+  // new sequences were committed, instead of polling the latest sequence.
+  std::mutex wal_new_data_mu_;
+  std::condition_variable wal_new_data_cv_;
+  std::atomic<int> wal_new_data_waiters_ = 0;
+
   std::atomic<bool> is_txn_mode_ = false;
   // txn_write_batch_ is used as the global write batch for the transaction mode,
   // all writes will be grouped in this write batch when entering the transaction mode,
@@ -211,6 +347,16 @@ class Storage {
   rocksdb::WriteOptions write_opts_ = rocksdb::WriteOptions();
 
   rocksdb::Status writeToDB(const rocksdb::WriteOptions &options, rocksdb::WriteBatch *updates);
+  void notifyWALNewData();
+  void invalidateMetadataCache(rocksdb::WriteBatch *batch);
+  void applyDeletionLog(rocksdb::WriteBatch *batch);
+  void recordWrittenMetadata(rocksdb::WriteBatch *batch);
+  AutoTuner::Bounds autoTuneBounds();
+  std::shared_ptr<rocksdb::Cache> newNamespaceBlockCache();
+  rocksdb::ColumnFamilyOptions namespaceCFOptions(const rocksdb::ColumnFamilyOptions &shared_options,
+                                                  const std::shared_ptr<rocksdb::Cache> &block_cache);
+  void addNamespaceCFHandle(const std::string &ns, ColumnFamilyID id, rocksdb::ColumnFamilyHandle *handle);
+  Status applyAutoTuneSettings(const AutoTuner::Settings &old_settings, const AutoTuner::Settings &settings);
 };
 
 }  // namespace engine
@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "tombstone_stats.h"
+
+#include <algorithm>
+
+#include "parse_util.h"
+
+double TombstoneStats::FileStats::DeleteRatio() const {
+  if (total_keys == 0) return 0;
+  return static_cast<double>(deleted_keys) / static_cast<double>(total_keys);
+}
+
+uint64_t TombstoneStats::FileStats::ReclaimableBytes() const {
+  return static_cast<uint64_t>(static_cast<double>(file_size) * std::min(DeleteRatio(), 1.0));
+}
+
+std::optional<TombstoneStats::FileStats> TombstoneStats::Parse(const std::string &cf_name,
+                                                               const rocksdb::TableProperties &props) {
+  FileStats stats;
+  stats.cf_name = cf_name;
+  stats.file_size = props.data_size + props.index_size + props.filter_size;
+  stats.creation_time = props.file_creation_time;
+
+  const auto &user_props = props.user_collected_properties;
+  for (const auto &[name, value] : user_props) {
+    if (name == "total_keys") {
+      stats.total_keys = ParseInt<uint64_t>(value, 10).ValueOr(0);
+    } else if (name == "deleted_keys") {
+      stats.deleted_keys = ParseInt<uint64_t>(value, 10).ValueOr(0);
+    } else if (name == "start_key") {
+      stats.start_key = value;
+    } else if (name == "stop_key") {
+      stats.stop_key = value;
+    }
+  }
+  // The file wasn't collected by CompactOnExpiredCollector
+  if (stats.start_key.empty() || stats.stop_key.empty()) return std::nullopt;
+  return stats;
+}
+
+std::string TombstoneStats::FileName(const std::string &file_path) {
+  auto pos = file_path.rfind('/');
+  return pos == std::string::npos ? file_path : file_path.substr(pos + 1);
+}
+
+void TombstoneStats::AddFile(const std::string &file_path, FileStats stats) {
+  std::lock_guard<std::mutex> guard(mu_);
+  files_[FileName(file_path)] = std::move(stats);
+}
+
+void TombstoneStats::RemoveFile(const std::string &file_path) {
+  std::lock_guard<std::mutex> guard(mu_);
+  files_.erase(FileName(file_path));
+}
+
+void TombstoneStats::LoadColumnFamily(const std::string &cf_name, std::map<std::string, FileStats> files) {
+  std::lock_guard<std::mutex> guard(mu_);
+  // The files created by the events are newer than the loaded ones, don't override them
+  files_.merge(files);
+  loaded_cfs_.insert(cf_name);
+}
+
+bool TombstoneStats::IsLoaded(const std::string &cf_name) {
+  std::lock_guard<std::mutex> guard(mu_);
+  return loaded_cfs_.count(cf_name) > 0;
+}
+
+void TombstoneStats::RetainFiles(const std::string &cf_name, const std::set<std::string> &live_files) {
+  std::lock_guard<std::mutex> guard(mu_);
+  for (auto iter = files_.begin(); iter != files_.end();) {
+    if (iter->second.cf_name == cf_name && live_files.count(iter->first) == 0) {
+      iter = files_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+std::vector<std::pair<std::string, TombstoneStats::FileStats>> TombstoneStats::GetFiles(const std::string &cf_name) {
+  std::lock_guard<std::mutex> guard(mu_);
+  std::vector<std::pair<std::string, FileStats>> files;
+  for (const auto &[name, stats] : files_) {
+    if (stats.cf_name == cf_name) files.emplace_back(name, stats);
+  }
+  return files;
+}
+
+void TombstoneStats::Clear() {
+  std::lock_guard<std::mutex> guard(mu_);
+  files_.clear();
+  loaded_cfs_.clear();
+}
@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#pragma once
+
+#include <rocksdb/table_properties.h>
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// TombstoneStats keeps the estimate of deleted and expired keys of the live SST files,
+// which is collected by CompactOnExpiredCollector. It's updated by the table file events,
+// so the compaction checker needn't read the properties of all tables on every run.
+class TombstoneStats {
+ public:
+  struct FileStats {
+    std::string cf_name;
+    std::string start_key;
+    std::string stop_key;
+    uint64_t file_size = 0;
+    uint64_t creation_time = 0;
+    uint64_t total_keys = 0;
+    uint64_t deleted_keys = 0;
+
+    double DeleteRatio() const;
+    // The estimated bytes which would be reclaimed by compacting the file
+    uint64_t ReclaimableBytes() const;
+  };
+
+  static std::optional<FileStats> Parse(const std::string &cf_name, const rocksdb::TableProperties &props);
+  static std::string FileName(const std::string &file_path);
+
+  void AddFile(const std::string &file_path, FileStats stats);
+  void RemoveFile(const std::string &file_path);
+  // Load the stats of the files which were created before the DB was opened
+  void LoadColumnFamily(const std::string &cf_name, std::map<std::string, FileStats> files);
+  bool IsLoaded(const std::string &cf_name);
+  // Remove the files which are not live anymore, the deletion events may be missed while loading
+  void RetainFiles(const std::string &cf_name, const std::set<std::string> &live_files);
+  std::vector<std::pair<std::string, FileStats>> GetFiles(const std::string &cf_name);
+  void Clear();
+
+ private:
+  std::mutex mu_;
+  std::set<std::string> loaded_cfs_;
+  // file name => stats
+  std::map<std::string, FileStats> files_;
+};
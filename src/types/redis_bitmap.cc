@@ -80,8 +80,9 @@ rocksdb::Status Bitmap::GetBit(const Slice &user_key, uint32_t offset, bool *bit
   read_options.snapshot = ss.GetSnapShot();
   uint32_t index = (offset / kBitmapSegmentBits) * kBitmapSegmentBytes;
   std::string sub_key, value;
-  InternalKey(ns_key, std::to_string(index), metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-  s = storage_->Get(read_options, sub_key, &value);
+  InternalKey(ns_key, std::to_string(index), metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&sub_key);
+  s = storage_->Get(read_options, subkey_cf_handle_, sub_key, &value);
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
   uint32_t byte_index = (offset / 8) % kBitmapSegmentBytes;
   if ((byte_index < value.size() && (value[byte_index] & (1 << (offset % 8))))) {
@@ -107,14 +108,15 @@ rocksdb::Status Bitmap::GetString(const Slice &user_key, const uint32_t max_btos
 
   std::string fragment, prefix_key;
   fragment.reserve(kBitmapSegmentBytes * 2);
-  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode(&prefix_key);
+  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&prefix_key);
 
   rocksdb::ReadOptions read_options;
   LatestSnapShot ss(storage_);
   read_options.snapshot = ss.GetSnapShot();
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
 
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = util::UniqueIterator(storage_, read_options, subkey_cf_handle_);
   for (iter->Seek(prefix_key); iter->Valid() && iter->key().starts_with(prefix_key); iter->Next()) {
     InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
     auto parse_result = ParseInt<uint32_t>(ikey.GetSubKey().ToString(), 10);
@@ -178,9 +180,10 @@ rocksdb::Status Bitmap::SetBit(const Slice &user_key, uint32_t offset, bool new_
 
   std::string sub_key, value;
   uint32_t index = (offset / kBitmapSegmentBits) * kBitmapSegmentBytes;
-  InternalKey(ns_key, std::to_string(index), metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
+  InternalKey(ns_key, std::to_string(index), metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&sub_key);
   if (s.ok()) {
-    s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value);
+    s = storage_->Get(rocksdb::ReadOptions(), subkey_cf_handle_, sub_key, &value);
     if (!s.ok() && !s.IsNotFound()) return s;
   }
   uint32_t byte_index = (offset / 8) % kBitmapSegmentBytes;
@@ -207,7 +210,7 @@ rocksdb::Status Bitmap::SetBit(const Slice &user_key, uint32_t offset, bool new_
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisBitmap, {std::to_string(kRedisCmdSetBit), std::to_string(offset)});
   batch->PutLogData(log_data.Encode());
-  batch->Put(sub_key, value);
+  batch->Put(subkey_cf_handle_, sub_key, value);
   if (metadata.size != bitmap_size) {
     metadata.size = bitmap_size;
     std::string bytes;
@@ -247,9 +250,10 @@ rocksdb::Status Bitmap::BitCount(const Slice &user_key, int64_t start, int64_t s
   // Don't use multi get to prevent large range query, and take too much memory
   std::string sub_key, value;
   for (uint32_t i = start_index; i <= stop_index; i++) {
-    InternalKey(ns_key, std::to_string(i * kBitmapSegmentBytes), metadata.version, storage_->IsSlotIdEncoded())
+    InternalKey(ns_key, std::to_string(i * kBitmapSegmentBytes), metadata.version, storage_->IsSlotIdEncoded(),
+                metadata.IsKeyIdEncoded())
         .Encode(&sub_key);
-    s = storage_->Get(read_options, sub_key, &value);
+    s = storage_->Get(read_options, subkey_cf_handle_, sub_key, &value);
     if (!s.ok() && !s.IsNotFound()) return s;
     if (s.IsNotFound()) continue;
     size_t j = 0;
@@ -304,9 +308,10 @@ rocksdb::Status Bitmap::BitPos(const Slice &user_key, bool bit, int64_t start, i
   // Don't use multi get to prevent large range query, and take too much memory
   std::string sub_key, value;
   for (uint32_t i = start_index; i <= stop_index; i++) {
-    InternalKey(ns_key, std::to_string(i * kBitmapSegmentBytes), metadata.version, storage_->IsSlotIdEncoded())
+    InternalKey(ns_key, std::to_string(i * kBitmapSegmentBytes), metadata.version, storage_->IsSlotIdEncoded(),
+                metadata.IsKeyIdEncoded())
         .Encode(&sub_key);
-    s = storage_->Get(read_options, sub_key, &value);
+    s = storage_->Get(read_options, subkey_cf_handle_, sub_key, &value);
     if (!s.ok() && !s.IsNotFound()) return s;
     if (s.IsNotFound()) {
       if (!bit) {
@@ -388,9 +393,9 @@ rocksdb::Status Bitmap::BitOp(BitOpFlags op_flag, const std::string &op_name, co
     for (uint64_t frag_index = 0; frag_index <= stop_index; frag_index++) {
       for (const auto &meta_pair : meta_pairs) {
         InternalKey(meta_pair.first, std::to_string(frag_index * kBitmapSegmentBytes), meta_pair.second.version,
-                    storage_->IsSlotIdEncoded())
+                    storage_->IsSlotIdEncoded(), meta_pair.second.IsKeyIdEncoded())
             .Encode(&sub_key);
-        auto s = storage_->Get(read_options, sub_key, &fragment);
+        auto s = storage_->Get(read_options, subkey_cf_handle_, sub_key, &fragment);
         if (!s.ok() && !s.IsNotFound()) {
           return s;
         }
@@ -507,9 +512,9 @@ rocksdb::Status Bitmap::BitOp(BitOpFlags op_flag, const std::string &op_name, co
           }
         }
         InternalKey(ns_key, std::to_string(frag_index * kBitmapSegmentBytes), res_metadata.version,
-                    storage_->IsSlotIdEncoded())
+                    storage_->IsSlotIdEncoded(), res_metadata.IsKeyIdEncoded())
             .Encode(&sub_key);
-        batch->Put(sub_key, Slice(reinterpret_cast<char *>(frag_res.get()), frag_maxlen));
+        batch->Put(subkey_cf_handle_, sub_key, Slice(reinterpret_cast<char *>(frag_res.get()), frag_maxlen));
       }
 
       frag_maxlen = 0;
@@ -58,8 +58,8 @@ rocksdb::Status Hash::Get(const Slice &user_key, const Slice &field, std::string
   rocksdb::ReadOptions read_options;
   read_options.snapshot = ss.GetSnapShot();
   std::string sub_key;
-  InternalKey(ns_key, field, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-  return storage_->Get(read_options, sub_key, value);
+  InternalKey(ns_key, field, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&sub_key);
+  return storage_->Get(read_options, subkey_cf_handle_, sub_key, value);
 }
 
 rocksdb::Status Hash::IncrBy(const Slice &user_key, const Slice &field, int64_t increment, int64_t *ret) {
@@ -75,10 +75,10 @@ rocksdb::Status Hash::IncrBy(const Slice &user_key, const Slice &field, int64_t
   if (!s.ok() && !s.IsNotFound()) return s;
 
   std::string sub_key;
-  InternalKey(ns_key, field, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
+  InternalKey(ns_key, field, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&sub_key);
   if (s.ok()) {
     std::string value_bytes;
-    s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value_bytes);
+    s = storage_->Get(rocksdb::ReadOptions(), subkey_cf_handle_, sub_key, &value_bytes);
     if (!s.ok() && !s.IsNotFound()) return s;
     if (s.ok()) {
       auto parse_result = ParseInt<int64_t>(value_bytes, 10);
@@ -101,12 +101,13 @@ rocksdb::Status Hash::IncrBy(const Slice &user_key, const Slice &field, int64_t
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisHash);
   batch->PutLogData(log_data.Encode());
-  batch->Put(sub_key, std::to_string(*ret));
+  batch->Put(subkey_cf_handle_, sub_key, std::to_string(*ret));
   if (!exists) {
     metadata.size += 1;
     std::string bytes;
     metadata.Encode(&bytes);
     batch->Put(metadata_cf_handle_, ns_key, bytes);
+    PutKeyIdAnchor(batch.Get(), ns_key, metadata);
   }
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
@@ -124,10 +125,10 @@ rocksdb::Status Hash::IncrByFloat(const Slice &user_key, const Slice &field, dou
   if (!s.ok() && !s.IsNotFound()) return s;
 
   std::string sub_key;
-  InternalKey(ns_key, field, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
+  InternalKey(ns_key, field, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&sub_key);
   if (s.ok()) {
     std::string value_bytes;
-    s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value_bytes);
+    s = storage_->Get(rocksdb::ReadOptions(), subkey_cf_handle_, sub_key, &value_bytes);
     if (!s.ok() && !s.IsNotFound()) return s;
     if (s.ok()) {
       auto value_stat = ParseFloat(value_bytes);
@@ -147,12 +148,13 @@ rocksdb::Status Hash::IncrByFloat(const Slice &user_key, const Slice &field, dou
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisHash);
   batch->PutLogData(log_data.Encode());
-  batch->Put(sub_key, std::to_string(*ret));
+  batch->Put(subkey_cf_handle_, sub_key, std::to_string(*ret));
   if (!exists) {
     metadata.size += 1;
     std::string bytes;
     metadata.Encode(&bytes);
     batch->Put(metadata_cf_handle_, ns_key, bytes);
+    PutKeyIdAnchor(batch.Get(), ns_key, metadata);
   }
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
@@ -177,9 +179,10 @@ rocksdb::Status Hash::MGet(const Slice &user_key, const std::vector<Slice> &fiel
 
   std::string sub_key, value;
   for (const auto &field : fields) {
-    InternalKey(ns_key, field, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
+    InternalKey(ns_key, field, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&sub_key);
     value.clear();
-    s = storage_->Get(read_options, sub_key, &value);
+    s = storage_->Get(read_options, subkey_cf_handle_, sub_key, &value);
     if (!s.ok() && !s.IsNotFound()) return s;
 
     values->emplace_back(value);
@@ -207,11 +210,12 @@ rocksdb::Status Hash::Delete(const Slice &user_key, const std::vector<Slice> &fi
 
   std::string sub_key, value;
   for (const auto &field : fields) {
-    InternalKey(ns_key, field, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-    s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value);
+    InternalKey(ns_key, field, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&sub_key);
+    s = storage_->Get(rocksdb::ReadOptions(), subkey_cf_handle_, sub_key, &value);
     if (s.ok()) {
       *ret += 1;
-      batch->Delete(sub_key);
+      batch->Delete(subkey_cf_handle_, sub_key);
     }
   }
   if (*ret == 0) {
@@ -221,6 +225,7 @@ rocksdb::Status Hash::Delete(const Slice &user_key, const std::vector<Slice> &fi
   std::string bytes;
   metadata.Encode(&bytes);
   batch->Put(metadata_cf_handle_, ns_key, bytes);
+  PutKeyIdAnchor(batch.Get(), ns_key, metadata);
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
 
@@ -243,11 +248,12 @@ rocksdb::Status Hash::MSet(const Slice &user_key, const std::vector<FieldValue>
     bool exists = false;
 
     std::string sub_key;
-    InternalKey(ns_key, fv.field, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
+    InternalKey(ns_key, fv.field, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&sub_key);
 
     if (metadata.size > 0) {
       std::string field_value;
-      s = storage_->Get(rocksdb::ReadOptions(), sub_key, &field_value);
+      s = storage_->Get(rocksdb::ReadOptions(), subkey_cf_handle_, sub_key, &field_value);
       if (!s.ok() && !s.IsNotFound()) return s;
 
       if (s.ok()) {
@@ -259,7 +265,7 @@ rocksdb::Status Hash::MSet(const Slice &user_key, const std::vector<FieldValue>
 
     if (!exists) added++;
 
-    batch->Put(sub_key, fv.value);
+    batch->Put(subkey_cf_handle_, sub_key, fv.value);
   }
 
   if (added > 0) {
@@ -268,6 +274,7 @@ rocksdb::Status Hash::MSet(const Slice &user_key, const std::vector<FieldValue>
     std::string bytes;
     metadata.Encode(&bytes);
     batch->Put(metadata_cf_handle_, ns_key, bytes);
+    PutKeyIdAnchor(batch.Get(), ns_key, metadata);
   }
 
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
@@ -287,9 +294,11 @@ rocksdb::Status Hash::RangeByLex(const Slice &user_key, const CommonRangeLexSpec
 
   std::string start_member = spec.reversed ? spec.max : spec.min;
   std::string start_key, prefix_key, next_version_prefix_key;
-  InternalKey(ns_key, start_member, metadata.version, storage_->IsSlotIdEncoded()).Encode(&start_key);
-  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode(&prefix_key);
-  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode(&next_version_prefix_key);
+  InternalKey(ns_key, start_member, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&start_key);
+  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&prefix_key);
+  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&next_version_prefix_key);
   rocksdb::ReadOptions read_options;
   LatestSnapShot ss(storage_);
   read_options.snapshot = ss.GetSnapShot();
@@ -297,9 +306,11 @@ rocksdb::Status Hash::RangeByLex(const Slice &user_key, const CommonRangeLexSpec
   read_options.iterate_upper_bound = &upper_bound;
   rocksdb::Slice lower_bound(prefix_key);
   read_options.iterate_lower_bound = &lower_bound;
+  // prefix_same_as_start isn't set, SeekToLast would seek to the upper bound which is the
+  // prefix of the next version, the bounds are enough to keep the iterator within the key
   storage_->SetReadOptions(read_options);
 
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = util::UniqueIterator(storage_, read_options, subkey_cf_handle_);
   if (!spec.reversed) {
     iter->Seek(start_key);
   } else {
@@ -344,17 +355,19 @@ rocksdb::Status Hash::GetAll(const Slice &user_key, std::vector<FieldValue> *fie
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
 
   std::string prefix_key, next_version_prefix_key;
-  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode(&prefix_key);
-  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode(&next_version_prefix_key);
+  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&prefix_key);
+  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&next_version_prefix_key);
 
   rocksdb::ReadOptions read_options;
   LatestSnapShot ss(storage_);
   read_options.snapshot = ss.GetSnapShot();
   rocksdb::Slice upper_bound(next_version_prefix_key);
   read_options.iterate_upper_bound = &upper_bound;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
 
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = util::UniqueIterator(storage_, read_options, subkey_cf_handle_);
   for (iter->Seek(prefix_key); iter->Valid() && iter->key().starts_with(prefix_key); iter->Next()) {
     if (type == HashFetchType::kOnlyKey) {
       InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
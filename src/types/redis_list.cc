@@ -71,8 +71,9 @@ rocksdb::Status List::push(const Slice &user_key, const std::vector<Slice> &elem
   for (const auto &elem : elems) {
     std::string index_buf, sub_key;
     PutFixed64(&index_buf, index);
-    InternalKey(ns_key, index_buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-    batch->Put(sub_key, elem);
+    InternalKey(ns_key, index_buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&sub_key);
+    batch->Put(subkey_cf_handle_, sub_key, elem);
     left ? --index : ++index;
   }
   if (left) {
@@ -84,6 +85,7 @@ rocksdb::Status List::push(const Slice &user_key, const std::vector<Slice> &elem
   metadata.size += elems.size();
   metadata.Encode(&bytes);
   batch->Put(metadata_cf_handle_, ns_key, bytes);
+  PutKeyIdAnchor(batch.Get(), ns_key, metadata);
   *ret = static_cast<int>(metadata.size);
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
@@ -121,16 +123,16 @@ rocksdb::Status List::PopMulti(const rocksdb::Slice &user_key, bool left, uint32
     std::string buf;
     PutFixed64(&buf, index);
     std::string sub_key;
-    InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
+    InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&sub_key);
     std::string elem;
-    s = storage_->Get(rocksdb::ReadOptions(), sub_key, &elem);
+    s = storage_->Get(rocksdb::ReadOptions(), subkey_cf_handle_, sub_key, &elem);
     if (!s.ok()) {
       // FIXME: should be always exists??
       return s;
     }
 
     elems->push_back(elem);
-    batch->Delete(sub_key);
+    batch->Delete(subkey_cf_handle_, sub_key);
     metadata.size -= 1;
     left ? ++metadata.head : --metadata.tail;
     --count;
@@ -142,6 +144,7 @@ rocksdb::Status List::PopMulti(const rocksdb::Slice &user_key, bool left, uint32
     std::string bytes;
     metadata.Encode(&bytes);
     batch->Put(metadata_cf_handle_, ns_key, bytes);
+    PutKeyIdAnchor(batch.Get(), ns_key, metadata);
   }
 
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
@@ -180,9 +183,10 @@ rocksdb::Status List::Rem(const Slice &user_key, int count, const Slice &elem, i
   uint64_t index = count >= 0 ? metadata.head : metadata.tail - 1;
   std::string buf, start_key, prefix, next_version_prefix;
   PutFixed64(&buf, index);
-  InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&start_key);
-  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode(&prefix);
-  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode(&next_version_prefix);
+  InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&start_key);
+  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&prefix);
+  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&next_version_prefix);
 
   bool reversed = count < 0;
   std::vector<uint64_t> to_delete_indexes;
@@ -193,9 +197,10 @@ rocksdb::Status List::Rem(const Slice &user_key, int count, const Slice &elem, i
   read_options.iterate_upper_bound = &upper_bound;
   rocksdb::Slice lower_bound(prefix);
   read_options.iterate_lower_bound = &lower_bound;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
 
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = util::UniqueIterator(storage_, read_options, subkey_cf_handle_);
   for (iter->Seek(start_key); iter->Valid() && iter->key().starts_with(prefix);
        !reversed ? iter->Next() : iter->Prev()) {
     if (iter->value() == elem) {
@@ -225,15 +230,17 @@ rocksdb::Status List::Rem(const Slice &user_key, int count, const Slice &elem, i
     reversed = left_part_len <= right_part_len;
     buf.clear();
     PutFixed64(&buf, reversed ? max_to_delete_index : min_to_delete_index);
-    InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&start_key);
+    InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&start_key);
     size_t processed = 0;
     for (iter->Seek(start_key); iter->Valid() && iter->key().starts_with(prefix);
          !reversed ? iter->Next() : iter->Prev()) {
       if (iter->value() != elem || processed >= to_delete_indexes.size()) {
         buf.clear();
         PutFixed64(&buf, reversed ? max_to_delete_index-- : min_to_delete_index++);
-        InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&to_update_key);
-        batch->Put(to_update_key, iter->value());
+        InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+            .Encode(&to_update_key);
+        batch->Put(subkey_cf_handle_, to_update_key, iter->value());
       } else {
         processed++;
       }
@@ -242,8 +249,9 @@ rocksdb::Status List::Rem(const Slice &user_key, int count, const Slice &elem, i
     for (uint64_t idx = 0; idx < to_delete_indexes.size(); ++idx) {
       buf.clear();
       PutFixed64(&buf, reversed ? (metadata.head + idx) : (metadata.tail - 1 - idx));
-      InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&to_delete_key);
-      batch->Delete(to_delete_key);
+      InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+          .Encode(&to_delete_key);
+      batch->Delete(subkey_cf_handle_, to_delete_key);
     }
     if (reversed) {
       metadata.head += to_delete_indexes.size();
@@ -254,6 +262,7 @@ rocksdb::Status List::Rem(const Slice &user_key, int count, const Slice &elem, i
     std::string bytes;
     metadata.Encode(&bytes);
     batch->Put(metadata_cf_handle_, ns_key, bytes);
+    PutKeyIdAnchor(batch.Get(), ns_key, metadata);
   }
 
   *ret = static_cast<int>(to_delete_indexes.size());
@@ -273,18 +282,20 @@ rocksdb::Status List::Insert(const Slice &user_key, const Slice &pivot, const Sl
   std::string buf, start_key, prefix, next_version_prefix;
   uint64_t pivot_index = metadata.head - 1;
   PutFixed64(&buf, metadata.head);
-  InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&start_key);
-  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode(&prefix);
-  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode(&next_version_prefix);
+  InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&start_key);
+  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&prefix);
+  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&next_version_prefix);
 
   rocksdb::ReadOptions read_options;
   LatestSnapShot ss(storage_);
   read_options.snapshot = ss.GetSnapShot();
   rocksdb::Slice upper_bound(next_version_prefix);
   read_options.iterate_upper_bound = &upper_bound;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
 
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = util::UniqueIterator(storage_, read_options, subkey_cf_handle_);
   for (iter->Seek(start_key); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
     if (iter->value() == pivot) {
       InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
@@ -317,13 +328,15 @@ rocksdb::Status List::Insert(const Slice &user_key, const Slice &pivot, const Sl
   for (; iter->Valid() && iter->key().starts_with(prefix); !reversed ? iter->Next() : iter->Prev()) {
     buf.clear();
     PutFixed64(&buf, reversed ? --pivot_index : ++pivot_index);
-    InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&to_update_key);
-    batch->Put(to_update_key, iter->value());
+    InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&to_update_key);
+    batch->Put(subkey_cf_handle_, to_update_key, iter->value());
   }
   buf.clear();
   PutFixed64(&buf, new_elem_index);
-  InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&to_update_key);
-  batch->Put(to_update_key, elem);
+  InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&to_update_key);
+  batch->Put(subkey_cf_handle_, to_update_key, elem);
 
   if (reversed) {
     metadata.head--;
@@ -334,6 +347,7 @@ rocksdb::Status List::Insert(const Slice &user_key, const Slice &pivot, const Sl
   std::string bytes;
   metadata.Encode(&bytes);
   batch->Put(metadata_cf_handle_, ns_key, bytes);
+  PutKeyIdAnchor(batch.Get(), ns_key, metadata);
 
   *ret = static_cast<int>(metadata.size);
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
@@ -357,8 +371,8 @@ rocksdb::Status List::Index(const Slice &user_key, int index, std::string *elem)
   std::string buf;
   PutFixed64(&buf, metadata.head + index);
   std::string sub_key;
-  InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-  return storage_->Get(read_options, sub_key, elem);
+  InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&sub_key);
+  return storage_->Get(read_options, subkey_cf_handle_, sub_key, elem);
 }
 
 // The offset can also be negative, -1 is the last element, -2 the penultimate
@@ -383,18 +397,20 @@ rocksdb::Status List::Range(const Slice &user_key, int start, int stop, std::vec
   std::string buf;
   PutFixed64(&buf, metadata.head + start);
   std::string start_key, prefix, next_version_prefix;
-  InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&start_key);
-  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode(&prefix);
-  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode(&next_version_prefix);
+  InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&start_key);
+  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&prefix);
+  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&next_version_prefix);
 
   rocksdb::ReadOptions read_options;
   LatestSnapShot ss(storage_);
   read_options.snapshot = ss.GetSnapShot();
   rocksdb::Slice upper_bound(next_version_prefix);
   read_options.iterate_upper_bound = &upper_bound;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
 
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = util::UniqueIterator(storage_, read_options, subkey_cf_handle_);
   for (iter->Seek(start_key); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
     InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
     Slice sub_key = ikey.GetSubKey();
@@ -422,8 +438,8 @@ rocksdb::Status List::Set(const Slice &user_key, int index, Slice elem) {
 
   std::string buf, value, sub_key;
   PutFixed64(&buf, metadata.head + index);
-  InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-  s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value);
+  InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&sub_key);
+  s = storage_->Get(rocksdb::ReadOptions(), subkey_cf_handle_, sub_key, &value);
   if (!s.ok()) {
     return s;
   }
@@ -432,7 +448,7 @@ rocksdb::Status List::Set(const Slice &user_key, int index, Slice elem) {
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisList, {std::to_string(kRedisCmdLSet), std::to_string(index)});
   batch->PutLogData(log_data.Encode());
-  batch->Put(sub_key, elem);
+  batch->Put(subkey_cf_handle_, sub_key, elem);
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
 
@@ -479,8 +495,9 @@ rocksdb::Status List::lmoveOnSingleList(const rocksdb::Slice &src, bool src_left
   std::string curr_index_buf;
   PutFixed64(&curr_index_buf, curr_index);
   std::string curr_sub_key;
-  InternalKey(ns_key, curr_index_buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&curr_sub_key);
-  s = storage_->Get(rocksdb::ReadOptions(), curr_sub_key, elem);
+  InternalKey(ns_key, curr_index_buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&curr_sub_key);
+  s = storage_->Get(rocksdb::ReadOptions(), subkey_cf_handle_, curr_sub_key, elem);
   if (!s.ok()) {
     return s;
   }
@@ -500,7 +517,7 @@ rocksdb::Status List::lmoveOnSingleList(const rocksdb::Slice &src, bool src_left
                                           src_left ? "left" : "right", dst_left ? "left" : "right"});
   batch->PutLogData(log_data.Encode());
 
-  batch->Delete(curr_sub_key);
+  batch->Delete(subkey_cf_handle_, curr_sub_key);
 
   if (src_left) {
     ++metadata.head;
@@ -514,12 +531,14 @@ rocksdb::Status List::lmoveOnSingleList(const rocksdb::Slice &src, bool src_left
   std::string new_index_buf;
   PutFixed64(&new_index_buf, new_index);
   std::string new_sub_key;
-  InternalKey(ns_key, new_index_buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&new_sub_key);
-  batch->Put(new_sub_key, *elem);
+  InternalKey(ns_key, new_index_buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&new_sub_key);
+  batch->Put(subkey_cf_handle_, new_sub_key, *elem);
 
   std::string bytes;
   metadata.Encode(&bytes);
   batch->Put(metadata_cf_handle_, ns_key, bytes);
+  PutKeyIdAnchor(batch.Get(), ns_key, metadata);
 
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
@@ -539,7 +558,8 @@ rocksdb::Status List::lmoveOnTwoLists(const rocksdb::Slice &src, const rocksdb::
     return s;
   }
 
-  ListMetadata dst_metadata(false);
+  // the version of the destination is generated in case it's created
+  ListMetadata dst_metadata;
   s = GetMetadata(dst_ns_key, &dst_metadata);
   if (!s.ok() && !s.IsNotFound()) {
     return s;
@@ -556,13 +576,14 @@ rocksdb::Status List::lmoveOnTwoLists(const rocksdb::Slice &src, const rocksdb::
   std::string src_buf;
   PutFixed64(&src_buf, src_index);
   std::string src_sub_key;
-  InternalKey(src_ns_key, src_buf, src_metadata.version, storage_->IsSlotIdEncoded()).Encode(&src_sub_key);
-  s = storage_->Get(rocksdb::ReadOptions(), src_sub_key, elem);
+  InternalKey(src_ns_key, src_buf, src_metadata.version, storage_->IsSlotIdEncoded(), src_metadata.IsKeyIdEncoded())
+      .Encode(&src_sub_key);
+  s = storage_->Get(rocksdb::ReadOptions(), subkey_cf_handle_, src_sub_key, elem);
   if (!s.ok()) {
     return s;
   }
 
-  batch->Delete(src_sub_key);
+  batch->Delete(subkey_cf_handle_, src_sub_key);
   if (src_metadata.size == 1) {
     batch->Delete(metadata_cf_handle_, src_ns_key);
   } else {
@@ -571,20 +592,23 @@ rocksdb::Status List::lmoveOnTwoLists(const rocksdb::Slice &src, const rocksdb::
     src_left ? ++src_metadata.head : --src_metadata.tail;
     src_metadata.Encode(&bytes);
     batch->Put(metadata_cf_handle_, src_ns_key, bytes);
+    PutKeyIdAnchor(batch.Get(), src_ns_key, src_metadata);
   }
 
   uint64_t dst_index = dst_left ? dst_metadata.head - 1 : dst_metadata.tail;
   std::string dst_buf;
   PutFixed64(&dst_buf, dst_index);
   std::string dst_sub_key;
-  InternalKey(dst_ns_key, dst_buf, dst_metadata.version, storage_->IsSlotIdEncoded()).Encode(&dst_sub_key);
-  batch->Put(dst_sub_key, *elem);
+  InternalKey(dst_ns_key, dst_buf, dst_metadata.version, storage_->IsSlotIdEncoded(), dst_metadata.IsKeyIdEncoded())
+      .Encode(&dst_sub_key);
+  batch->Put(subkey_cf_handle_, dst_sub_key, *elem);
   dst_left ? --dst_metadata.head : ++dst_metadata.tail;
 
   std::string bytes;
   dst_metadata.size += 1;
   dst_metadata.Encode(&bytes);
   batch->Put(metadata_cf_handle_, dst_ns_key, bytes);
+  PutKeyIdAnchor(batch.Get(), dst_ns_key, dst_metadata);
 
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
@@ -619,8 +643,8 @@ rocksdb::Status List::Trim(const Slice &user_key, int start, int stop) {
     std::string buf;
     PutFixed64(&buf, i);
     std::string sub_key;
-    InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-    batch->Delete(sub_key);
+    InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&sub_key);
+    batch->Delete(subkey_cf_handle_, sub_key);
     metadata.head++;
     trim_cnt++;
   }
@@ -629,8 +653,8 @@ rocksdb::Status List::Trim(const Slice &user_key, int start, int stop) {
     std::string buf;
     PutFixed64(&buf, i);
     std::string sub_key;
-    InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-    batch->Delete(sub_key);
+    InternalKey(ns_key, buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&sub_key);
+    batch->Delete(subkey_cf_handle_, sub_key);
     metadata.tail--;
     trim_cnt++;
   }
@@ -642,6 +666,7 @@ rocksdb::Status List::Trim(const Slice &user_key, int start, int stop) {
   std::string bytes;
   metadata.Encode(&bytes);
   batch->Put(metadata_cf_handle_, ns_key, bytes);
+  PutKeyIdAnchor(batch.Get(), ns_key, metadata);
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
 }  // namespace redis
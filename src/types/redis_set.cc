@@ -38,18 +38,23 @@ rocksdb::Status Set::Overwrite(Slice user_key, const std::vector<std::string> &m
 
   LockGuard guard(storage_->GetLockManager(), ns_key);
   SetMetadata metadata;
+  auto s = AllocateKeyId(ns_key, &metadata);
+  if (!s.ok()) return s;
+
   auto batch = storage_->GetWriteBatchBase();
   WriteBatchLogData log_data(kRedisSet);
   batch->PutLogData(log_data.Encode());
   std::string sub_key;
   for (const auto &member : members) {
-    InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-    batch->Put(sub_key, Slice());
+    InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&sub_key);
+    batch->Put(subkey_cf_handle_, sub_key, Slice());
   }
   metadata.size = static_cast<uint32_t>(members.size());
   std::string bytes;
   metadata.Encode(&bytes);
   batch->Put(metadata_cf_handle_, ns_key, bytes);
+  PutKeyIdAnchor(batch.Get(), ns_key, metadata);
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
 
@@ -70,10 +75,11 @@ rocksdb::Status Set::Add(const Slice &user_key, const std::vector<Slice> &member
   batch->PutLogData(log_data.Encode());
   std::string sub_key;
   for (const auto &member : members) {
-    InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-    s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value);
+    InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&sub_key);
+    s = storage_->Get(rocksdb::ReadOptions(), subkey_cf_handle_, sub_key, &value);
     if (s.ok()) continue;
-    batch->Put(sub_key, Slice());
+    batch->Put(subkey_cf_handle_, sub_key, Slice());
     *ret += 1;
   }
   if (*ret > 0) {
@@ -81,6 +87,7 @@ rocksdb::Status Set::Add(const Slice &user_key, const std::vector<Slice> &member
     std::string bytes;
     metadata.Encode(&bytes);
     batch->Put(metadata_cf_handle_, ns_key, bytes);
+    PutKeyIdAnchor(batch.Get(), ns_key, metadata);
   }
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
@@ -101,10 +108,11 @@ rocksdb::Status Set::Remove(const Slice &user_key, const std::vector<Slice> &mem
   WriteBatchLogData log_data(kRedisSet);
   batch->PutLogData(log_data.Encode());
   for (const auto &member : members) {
-    InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-    s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value);
+    InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&sub_key);
+    s = storage_->Get(rocksdb::ReadOptions(), subkey_cf_handle_, sub_key, &value);
     if (!s.ok()) continue;
-    batch->Delete(sub_key);
+    batch->Delete(subkey_cf_handle_, sub_key);
     *ret += 1;
   }
   if (*ret > 0) {
@@ -113,6 +121,7 @@ rocksdb::Status Set::Remove(const Slice &user_key, const std::vector<Slice> &mem
       std::string bytes;
       metadata.Encode(&bytes);
       batch->Put(metadata_cf_handle_, ns_key, bytes);
+      PutKeyIdAnchor(batch.Get(), ns_key, metadata);
     } else {
       batch->Delete(metadata_cf_handle_, ns_key);
     }
@@ -143,17 +152,19 @@ rocksdb::Status Set::Members(const Slice &user_key, std::vector<std::string> *me
   if (!s.ok()) return s.IsNotFound() ? rocksdb::Status::OK() : s;
 
   std::string prefix, next_version_prefix;
-  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode(&prefix);
-  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode(&next_version_prefix);
+  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&prefix);
+  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&next_version_prefix);
 
   rocksdb::ReadOptions read_options;
   LatestSnapShot ss(storage_);
   read_options.snapshot = ss.GetSnapShot();
   rocksdb::Slice upper_bound(next_version_prefix);
   read_options.iterate_upper_bound = &upper_bound;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
 
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = util::UniqueIterator(storage_, read_options, subkey_cf_handle_);
   for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
     InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
     members->emplace_back(ikey.GetSubKey().ToString());
@@ -184,8 +195,9 @@ rocksdb::Status Set::MIsMember(const Slice &user_key, const std::vector<Slice> &
   read_options.snapshot = ss.GetSnapShot();
   std::string sub_key, value;
   for (const auto &member : members) {
-    InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-    s = storage_->Get(read_options, sub_key, &value);
+    InternalKey(ns_key, member, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&sub_key);
+    s = storage_->Get(read_options, subkey_cf_handle_, sub_key, &value);
     if (!s.ok() && !s.IsNotFound()) return s;
     if (s.IsNotFound()) {
       exists->emplace_back(0);
@@ -216,21 +228,23 @@ rocksdb::Status Set::Take(const Slice &user_key, std::vector<std::string> *membe
   batch->PutLogData(log_data.Encode());
 
   std::string prefix, next_version_prefix;
-  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode(&prefix);
-  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode(&next_version_prefix);
+  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&prefix);
+  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&next_version_prefix);
 
   rocksdb::ReadOptions read_options;
   LatestSnapShot ss(storage_);
   read_options.snapshot = ss.GetSnapShot();
   rocksdb::Slice upper_bound(next_version_prefix);
   read_options.iterate_upper_bound = &upper_bound;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
 
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = util::UniqueIterator(storage_, read_options, subkey_cf_handle_);
   for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
     InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
     members->emplace_back(ikey.GetSubKey().ToString());
-    if (pop) batch->Delete(iter->key());
+    if (pop) batch->Delete(subkey_cf_handle_, iter->key());
     if (++n >= count) break;
   }
   if (pop && n > 0) {
@@ -238,6 +252,7 @@ rocksdb::Status Set::Take(const Slice &user_key, std::vector<std::string> *membe
     std::string bytes;
     metadata.Encode(&bytes);
     batch->Put(metadata_cf_handle_, ns_key, bytes);
+    PutKeyIdAnchor(batch.Get(), ns_key, metadata);
   }
   return storage_->Write(storage_->DefaultWriteOptions(), batch->GetWriteBatch());
 }
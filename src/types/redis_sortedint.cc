@@ -51,10 +51,11 @@ rocksdb::Status Sortedint::Add(const Slice &user_key, const std::vector<uint64_t
   for (const auto id : ids) {
     std::string id_buf;
     PutFixed64(&id_buf, id);
-    InternalKey(ns_key, id_buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-    s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value);
+    InternalKey(ns_key, id_buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&sub_key);
+    s = storage_->Get(rocksdb::ReadOptions(), subkey_cf_handle_, sub_key, &value);
     if (s.ok()) continue;
-    batch->Put(sub_key, Slice());
+    batch->Put(subkey_cf_handle_, sub_key, Slice());
     *ret += 1;
   }
   if (*ret > 0) {
@@ -84,10 +85,11 @@ rocksdb::Status Sortedint::Remove(const Slice &user_key, const std::vector<uint6
   for (const auto id : ids) {
     std::string id_buf;
     PutFixed64(&id_buf, id);
-    InternalKey(ns_key, id_buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-    s = storage_->Get(rocksdb::ReadOptions(), sub_key, &value);
+    InternalKey(ns_key, id_buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&sub_key);
+    s = storage_->Get(rocksdb::ReadOptions(), subkey_cf_handle_, sub_key, &value);
     if (!s.ok()) continue;
-    batch->Delete(sub_key);
+    batch->Delete(subkey_cf_handle_, sub_key);
     *ret += 1;
   }
   if (*ret == 0) return rocksdb::Status::OK();
@@ -127,9 +129,11 @@ rocksdb::Status Sortedint::Range(const Slice &user_key, uint64_t cursor_id, uint
     start_id = std::numeric_limits<uint64_t>::max();
   }
   PutFixed64(&start_buf, start_id);
-  InternalKey(ns_key, start_buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&start_key);
-  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode(&prefix);
-  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode(&next_version_prefix);
+  InternalKey(ns_key, start_buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&start_key);
+  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&prefix);
+  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&next_version_prefix);
 
   rocksdb::ReadOptions read_options;
   LatestSnapShot ss(storage_);
@@ -138,10 +142,11 @@ rocksdb::Status Sortedint::Range(const Slice &user_key, uint64_t cursor_id, uint
   read_options.iterate_upper_bound = &upper_bound;
   rocksdb::Slice lower_bound(prefix);
   read_options.iterate_lower_bound = &lower_bound;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
 
   uint64_t id = 0, pos = 0;
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = util::UniqueIterator(storage_, read_options, subkey_cf_handle_);
   for (!reversed ? iter->Seek(start_key) : iter->SeekForPrev(start_key);
        iter->Valid() && iter->key().starts_with(prefix); !reversed ? iter->Next() : iter->Prev()) {
     InternalKey ikey(iter->key(), storage_->IsSlotIdEncoded());
@@ -168,9 +173,11 @@ rocksdb::Status Sortedint::RangeByValue(const Slice &user_key, SortedintRangeSpe
 
   std::string start_buf, start_key, prefix_key, next_version_prefix_key;
   PutFixed64(&start_buf, spec.reversed ? spec.max : spec.min);
-  InternalKey(ns_key, start_buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&start_key);
-  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode(&prefix_key);
-  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode(&next_version_prefix_key);
+  InternalKey(ns_key, start_buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&start_key);
+  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&prefix_key);
+  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&next_version_prefix_key);
 
   rocksdb::ReadOptions read_options;
   LatestSnapShot ss(storage_);
@@ -179,10 +186,11 @@ rocksdb::Status Sortedint::RangeByValue(const Slice &user_key, SortedintRangeSpe
   read_options.iterate_upper_bound = &upper_bound;
   rocksdb::Slice lower_bound(prefix_key);
   read_options.iterate_lower_bound = &lower_bound;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
 
   int pos = 0;
-  auto iter = util::UniqueIterator(storage_, read_options);
+  auto iter = util::UniqueIterator(storage_, read_options, subkey_cf_handle_);
   if (!spec.reversed) {
     iter->Seek(start_key);
   } else {
@@ -224,8 +232,9 @@ rocksdb::Status Sortedint::MExist(const Slice &user_key, const std::vector<uint6
   for (const auto id : ids) {
     std::string id_buf;
     PutFixed64(&id_buf, id);
-    InternalKey(ns_key, id_buf, metadata.version, storage_->IsSlotIdEncoded()).Encode(&sub_key);
-    s = storage_->Get(read_options, sub_key, &value);
+    InternalKey(ns_key, id_buf, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+        .Encode(&sub_key);
+    s = storage_->Get(read_options, subkey_cf_handle_, sub_key, &value);
     if (!s.ok() && !s.IsNotFound()) return s;
     if (s.IsNotFound()) {
       exists->emplace_back(0);
@@ -82,7 +82,8 @@ std::string Stream::internalKeyFromEntryID(const std::string &ns_key, const Stre
   PutFixed64(&sub_key, id.ms);
   PutFixed64(&sub_key, id.seq);
   std::string entry_key;
-  InternalKey(ns_key, sub_key, metadata.version, storage_->IsSlotIdEncoded()).Encode(&entry_key);
+  InternalKey(ns_key, sub_key, metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&entry_key);
   return entry_key;
 }
 
@@ -238,9 +239,10 @@ rocksdb::Status Stream::DeleteEntries(const rocksdb::Slice &stream_name, const s
   batch->PutLogData(log_data.Encode());
 
   std::string next_version_prefix_key;
-  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode(&next_version_prefix_key);
+  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&next_version_prefix_key);
   std::string prefix_key;
-  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode(&prefix_key);
+  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&prefix_key);
 
   rocksdb::ReadOptions read_options;
   LatestSnapShot ss(storage_);
@@ -249,6 +251,7 @@ rocksdb::Status Stream::DeleteEntries(const rocksdb::Slice &stream_name, const s
   read_options.iterate_upper_bound = &upper_bound;
   rocksdb::Slice lower_bound(prefix_key);
   read_options.iterate_lower_bound = &lower_bound;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
 
   auto iter = util::UniqueIterator(storage_, read_options, stream_cf_handle_);
@@ -347,9 +350,10 @@ rocksdb::Status Stream::Len(const rocksdb::Slice &stream_name, const StreamLenOp
   }
 
   std::string prefix_key;
-  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode(&prefix_key);
+  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&prefix_key);
   std::string next_version_prefix_key;
-  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode(&next_version_prefix_key);
+  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&next_version_prefix_key);
 
   rocksdb::ReadOptions read_options;
   LatestSnapShot ss(storage_);
@@ -358,6 +362,7 @@ rocksdb::Status Stream::Len(const rocksdb::Slice &stream_name, const StreamLenOp
   read_options.iterate_lower_bound = &lower_bound;
   rocksdb::Slice upper_bound(next_version_prefix_key);
   read_options.iterate_upper_bound = &upper_bound;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
 
   auto iter = util::UniqueIterator(storage_, read_options, stream_cf_handle_);
@@ -412,9 +417,10 @@ rocksdb::Status Stream::range(const std::string &ns_key, const StreamMetadata &m
   }
 
   std::string next_version_prefix_key;
-  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded()).Encode(&next_version_prefix_key);
+  InternalKey(ns_key, "", metadata.version + 1, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded())
+      .Encode(&next_version_prefix_key);
   std::string prefix_key;
-  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded()).Encode(&prefix_key);
+  InternalKey(ns_key, "", metadata.version, storage_->IsSlotIdEncoded(), metadata.IsKeyIdEncoded()).Encode(&prefix_key);
 
   rocksdb::ReadOptions read_options;
   LatestSnapShot ss(storage_);
@@ -423,6 +429,7 @@ rocksdb::Status Stream::range(const std::string &ns_key, const StreamMetadata &m
   read_options.iterate_upper_bound = &upper_bound;
   rocksdb::Slice lower_bound(prefix_key);
   read_options.iterate_lower_bound = &lower_bound;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
 
   auto iter = util::UniqueIterator(storage_, read_options, stream_cf_handle_);
@@ -615,9 +622,11 @@ uint64_t Stream::trim(const std::string &ns_key, const StreamTrimOptions &option
   uint64_t ret = 0;
 
   std::string next_version_prefix_key;
-  InternalKey(ns_key, "", metadata->version + 1, storage_->IsSlotIdEncoded()).Encode(&next_version_prefix_key);
+  InternalKey(ns_key, "", metadata->version + 1, storage_->IsSlotIdEncoded(), metadata->IsKeyIdEncoded())
+      .Encode(&next_version_prefix_key);
   std::string prefix_key;
-  InternalKey(ns_key, "", metadata->version, storage_->IsSlotIdEncoded()).Encode(&prefix_key);
+  InternalKey(ns_key, "", metadata->version, storage_->IsSlotIdEncoded(), metadata->IsKeyIdEncoded())
+      .Encode(&prefix_key);
 
   rocksdb::ReadOptions read_options;
   LatestSnapShot ss(storage_);
@@ -626,6 +635,7 @@ uint64_t Stream::trim(const std::string &ns_key, const StreamTrimOptions &option
   read_options.iterate_upper_bound = &upper_bound;
   rocksdb::Slice lower_bound(prefix_key);
   read_options.iterate_lower_bound = &lower_bound;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
 
   auto iter = util::UniqueIterator(storage_, read_options, stream_cf_handle_);
@@ -65,10 +65,7 @@ std::vector<rocksdb::Status> String::getRawValues(const std::vector<Slice> &keys
 rocksdb::Status String::getRawValue(const std::string &ns_key, std::string *raw_value) {
   raw_value->clear();
 
-  rocksdb::ReadOptions read_options;
-  LatestSnapShot ss(storage_);
-  read_options.snapshot = ss.GetSnapShot();
-  rocksdb::Status s = storage_->Get(read_options, metadata_cf_handle_, ns_key, raw_value);
+  rocksdb::Status s = storage_->GetRawMetadata(rocksdb::ReadOptions(), metadata_cf_handle_, ns_key, raw_value);
   if (!s.ok()) return s;
 
   Metadata metadata(kRedisNone, false);
@@ -493,8 +490,7 @@ rocksdb::Status String::CAD(const std::string &user_key, const std::string &valu
   }
 
   if (value == current_value) {
-    auto delete_status = storage_->Delete(storage_->DefaultWriteOptions(),
-                                          storage_->GetCFHandle(engine::kMetadataColumnFamilyName), ns_key);
+    auto delete_status = storage_->Delete(storage_->DefaultWriteOptions(), metadata_cf_handle_, ns_key);
     if (!delete_status.ok()) {
       return delete_status;
     }
@@ -0,0 +1,94 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "storage/redis_metadata.h"
+#include "types/geohash.h"
+
+static void BM_MetadataDecode(benchmark::State &state) {
+  HashMetadata metadata;
+  metadata.expire = 1700000000000;
+  metadata.size = 1024;
+  std::string bytes;
+  metadata.Encode(&bytes);
+
+  for (auto _ : state) {
+    HashMetadata decoded(false);
+    benchmark::DoNotOptimize(decoded.Decode(bytes));
+  }
+}
+BENCHMARK(BM_MetadataDecode);
+
+static void BM_ListMetadataDecode(benchmark::State &state) {
+  ListMetadata metadata;
+  metadata.size = 1024;
+  std::string bytes;
+  metadata.Encode(&bytes);
+
+  for (auto _ : state) {
+    ListMetadata decoded(false);
+    benchmark::DoNotOptimize(decoded.Decode(bytes));
+  }
+}
+BENCHMARK(BM_ListMetadataDecode);
+
+static void BM_InternalKeyEncode(benchmark::State &state) {
+  std::string ns_key;
+  ComposeNamespaceKey("namespace", "user:1000:profile", &ns_key, state.range(0) != 0);
+  std::string sub_key(state.range(1), 'f');
+  InternalKey ikey(ns_key, sub_key, 1700000000000, state.range(0) != 0);
+
+  std::string out;
+  for (auto _ : state) {
+    out.clear();
+    ikey.Encode(&out);
+    benchmark::DoNotOptimize(out.data());
+  }
+}
+// args: whether the slot id is encoded, the size of sub key
+BENCHMARK(BM_InternalKeyEncode)->ArgsProduct({{0, 1}, {8, 128}});
+
+static void BM_InternalKeyDecode(benchmark::State &state) {
+  std::string ns_key;
+  ComposeNamespaceKey("namespace", "user:1000:profile", &ns_key, false);
+  std::string bytes;
+  InternalKey(ns_key, "field", 1700000000000, false).Encode(&bytes);
+
+  for (auto _ : state) {
+    InternalKey ikey(bytes, false);
+    benchmark::DoNotOptimize(ikey.GetSubKey());
+  }
+}
+BENCHMARK(BM_InternalKeyDecode);
+
+static void BM_GeohashEncode(benchmark::State &state) {
+  double longitude = -180, latitude = -85;
+  for (auto _ : state) {
+    GeoHashBits hash;
+    GeohashEncodeWGS84(longitude, latitude, GEO_STEP_MAX, &hash);
+    benchmark::DoNotOptimize(hash);
+    longitude = longitude >= 180 ? -180 : longitude + 0.1;
+    latitude = latitude >= 85 ? -85 : latitude + 0.1;
+  }
+}
+BENCHMARK(BM_GeohashEncode);
@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+#include <glog/logging.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <iostream>
+#include <memory>
+
+#include "bench_base.h"
+
+namespace {
+
+std::unique_ptr<Config> bench_config;
+std::unique_ptr<engine::Storage> bench_storage;
+std::unique_ptr<Server> bench_server;
+
+}  // namespace
+
+Server *GetServer() { return nullptr; }
+
+engine::Storage *BenchEnv::GetStorage() {
+  if (bench_storage) return bench_storage.get();
+
+  auto dir = std::filesystem::temp_directory_path() / ("kvrocks_bench_" + std::to_string(getpid()));
+  bench_config = std::make_unique<Config>();
+  bench_config->db_dir = dir.string();
+  bench_config->backup_dir = (dir / "backup").string();
+  bench_config->rocks_db.compression = rocksdb::CompressionType::kNoCompression;
+  bench_storage = std::make_unique<engine::Storage>(bench_config.get());
+  if (auto s = bench_storage->Open(); !s.IsOK()) {
+    std::cerr << "Failed to open the storage, encounter error: " << s.Msg() << std::endl;
+    std::exit(1);
+  }
+  return bench_storage.get();
+}
+
+Server *BenchEnv::GetServer() {
+  if (!bench_server) bench_server = std::make_unique<Server>(GetStorage(), bench_config.get());
+  return bench_server.get();
+}
+
+void BenchEnv::Destroy() {
+  if (!bench_storage) return;
+
+  bench_server.reset();
+  bench_storage.reset();
+  std::error_code ec;
+  std::filesystem::remove_all(bench_config->db_dir, ec);
+  if (ec) {
+    std::cerr << "Encounter filesystem error: " << ec << std::endl;
+  }
+  bench_config.reset();
+}
+
+int main(int argc, char **argv) {
+  google::InitGoogleLogging(argv[0]);
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  BenchEnv::Destroy();
+  return 0;
+}
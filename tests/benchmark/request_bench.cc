@@ -0,0 +1,51 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+#include <event2/buffer.h>
+
+#include <string>
+
+#include "bench_base.h"
+#include "server/redis_request.h"
+
+static void BM_RequestTokenize(benchmark::State &state) {
+  std::string pipeline;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    pipeline += "*3\r\n$3\r\nSET\r\n$10\r\nkey:000000\r\n$" + std::to_string(state.range(1)) + "\r\n" +
+                std::string(state.range(1), 'v') + "\r\n";
+  }
+
+  redis::Request request(BenchEnv::GetServer());
+  evbuffer *input = evbuffer_new();
+  for (auto _ : state) {
+    evbuffer_add(input, pipeline.data(), pipeline.size());
+    if (auto s = request.Tokenize(input); !s.IsOK()) {
+      state.SkipWithError(s.Msg().c_str());
+      break;
+    }
+    request.GetCommands()->clear();
+  }
+  evbuffer_free(input);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * pipeline.size()));
+}
+// args: the number of pipelined commands, the size of value
+BENCHMARK(BM_RequestTokenize)->ArgsProduct({{1, 16, 128}, {16, 1024}});
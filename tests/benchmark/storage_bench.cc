@@ -0,0 +1,126 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "bench_base.h"
+#include "storage/redis_db.h"
+#include "types/redis_hash.h"
+#include "types/redis_list.h"
+#include "types/redis_string.h"
+#include "types/redis_zset.h"
+
+// the storage benchmarks run against a real RocksDB, so the numbers include
+// the write batch, WAL and memtable costs but not the network and parsing
+
+static void BM_HashSet(benchmark::State &state) {
+  redis::Hash hash_db(BenchEnv::GetStorage(), "bench");
+  std::string key = "bench-hash-" + std::to_string(state.range(0));
+  std::string value(state.range(0), 'v');
+
+  uint64_t i = 0;
+  for (auto _ : state) {
+    int ret = 0;
+    auto s = hash_db.Set(key, "field" + std::to_string(i++), value, &ret);
+    if (!s.ok()) {
+      state.SkipWithError(s.ToString().c_str());
+      break;
+    }
+  }
+  hash_db.Del(key);
+}
+// args: the size of value
+BENCHMARK(BM_HashSet)->Arg(16)->Arg(1024);
+
+static void BM_ZSetAdd(benchmark::State &state) {
+  redis::ZSet zset_db(BenchEnv::GetStorage(), "bench");
+  std::string key = "bench-zset";
+
+  uint64_t i = 0;
+  for (auto _ : state) {
+    std::vector<MemberScore> member_scores{{"member" + std::to_string(i), static_cast<double>(i)}};
+    i++;
+    int ret = 0;
+    auto s = zset_db.Add(key, ZAddFlags(), &member_scores, &ret);
+    if (!s.ok()) {
+      state.SkipWithError(s.ToString().c_str());
+      break;
+    }
+  }
+  zset_db.Del(key);
+}
+BENCHMARK(BM_ZSetAdd);
+
+static void BM_ListRange(benchmark::State &state) {
+  redis::List list_db(BenchEnv::GetStorage(), "bench");
+  std::string key = "bench-list-" + std::to_string(state.range(0));
+
+  std::vector<std::string> elems;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    elems.emplace_back("elem" + std::to_string(i));
+  }
+  std::vector<Slice> elem_slices(elems.begin(), elems.end());
+  int ret = 0;
+  list_db.Del(key);
+  list_db.Push(key, elem_slices, false, &ret);
+
+  for (auto _ : state) {
+    std::vector<std::string> range;
+    auto s = list_db.Range(key, 0, -1, &range);
+    if (!s.ok()) {
+      state.SkipWithError(s.ToString().c_str());
+      break;
+    }
+    benchmark::DoNotOptimize(range);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  list_db.Del(key);
+}
+// args: the number of elements
+BENCHMARK(BM_ListRange)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_Scan(benchmark::State &state) {
+  constexpr int kKeys = 10000;
+  redis::Database db(BenchEnv::GetStorage(), "bench-scan");
+  redis::String string_db(BenchEnv::GetStorage(), "bench-scan");
+  for (int i = 0; i < kKeys; i++) {
+    string_db.Set("key" + std::to_string(i), "value");
+  }
+
+  std::string cursor;
+  for (auto _ : state) {
+    std::vector<std::string> keys;
+    std::string end_cursor;
+    auto s = db.Scan(cursor, state.range(0), "", &keys, &end_cursor);
+    if (!s.ok()) {
+      state.SkipWithError(s.ToString().c_str());
+      break;
+    }
+    // restart from the beginning after all keys were scanned
+    cursor = keys.size() < static_cast<size_t>(state.range(0)) ? "" : end_cursor;
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  db.FlushDB();
+}
+// args: the count of each scan
+BENCHMARK(BM_Scan)->Arg(10)->Arg(1000);
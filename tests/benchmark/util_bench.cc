@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "server/redis_reply.h"
+#include "storage/lock_manager.h"
+#include "string_util.h"
+
+static void BM_StringMatch(benchmark::State &state) {
+  const std::vector<std::pair<std::string, std::string>> cases = {
+      {"user:*", "user:1000:profile"},
+      {"*:profile", "user:1000:profile"},
+      {"user:[0-9]*:prof?le", "user:1000:profile"},
+      {"*a*a*a*a*a*b", "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"},
+  };
+  const auto &[pattern, in] = cases[state.range(0)];
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(util::StringMatch(pattern, in, 0));
+  }
+  state.SetLabel(pattern);
+}
+BENCHMARK(BM_StringMatch)->DenseRange(0, 3);
+
+static void BM_MultiBulkString(benchmark::State &state) {
+  std::vector<std::string> values;
+  values.reserve(state.range(0));
+  for (int64_t i = 0; i < state.range(0); i++) {
+    values.emplace_back("value" + std::to_string(i));
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(redis::MultiBulkString(values));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MultiBulkString)->RangeMultiplier(10)->Range(10, 100000);
+
+static void BM_LockManagerMultiGet(benchmark::State &state) {
+  LockManager lock_mgr(16);
+  std::vector<std::string> keys;
+  keys.reserve(state.range(0));
+  for (int64_t i = 0; i < state.range(0); i++) {
+    keys.emplace_back("key" + std::to_string(i));
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(lock_mgr.MultiGet(keys));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LockManagerMultiGet)->RangeMultiplier(8)->Range(1, 512);
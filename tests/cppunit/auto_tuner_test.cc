@@ -0,0 +1,134 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "storage/auto_tuner.h"
+
+#include <gtest/gtest.h>
+
+static AutoTuner::Bounds NewBounds() {
+  AutoTuner::Bounds bounds;
+  bounds.total_block_cache = 1600;
+  bounds.metadata_block_cache = 800;
+  bounds.min_write_buffer = 64;
+  bounds.max_write_buffer = 256;
+  bounds.min_background_jobs = 2;
+  bounds.max_background_jobs = 4;
+  return bounds;
+}
+
+TEST(AutoTuner, ConfiguredSettings) {
+  AutoTuner tuner;
+  auto bounds = NewBounds();
+  AutoTuner::Signals signals;
+  auto settings = tuner.Tune(signals, bounds);
+  ASSERT_EQ(settings.metadata_block_cache, 800);
+  ASSERT_EQ(settings.subkey_block_cache, 800);
+  ASSERT_EQ(settings.write_buffer, 64);
+  ASSERT_EQ(settings.background_jobs, 2);
+
+  // nothing is changed without pressure
+  for (int i = 0; i < AutoTuner::kCalmRounds * 2; i++) {
+    ASSERT_EQ(tuner.Tune(signals, bounds), settings);
+  }
+}
+
+TEST(AutoTuner, WritePressure) {
+  AutoTuner tuner;
+  auto bounds = NewBounds();
+  AutoTuner::Signals signals;
+  signals.max_write_buffer_number = 4;
+  signals.l0_slowdown_trigger = 20;
+  signals.pending_compaction_bytes_limit = 1000;
+  tuner.Tune(signals, bounds);
+
+  // the compactions fall behind
+  signals.l0_files = 10;
+  auto settings = tuner.Tune(signals, bounds);
+  ASSERT_EQ(settings.background_jobs, 3);
+  ASSERT_EQ(settings.write_buffer, 64);
+  settings = tuner.Tune(signals, bounds);
+  settings = tuner.Tune(signals, bounds);
+  ASSERT_EQ(settings.background_jobs, 4);
+
+  // the memtables can't be flushed in time
+  signals.l0_files = 0;
+  signals.immutable_memtables = 3;
+  settings = tuner.Tune(signals, bounds);
+  ASSERT_EQ(settings.write_buffer, 128);
+  settings = tuner.Tune(signals, bounds);
+  settings = tuner.Tune(signals, bounds);
+  ASSERT_EQ(settings.write_buffer, 256);
+
+  // the settings are lowered step by step after it's calm
+  signals.immutable_memtables = 0;
+  for (int i = 0; i < AutoTuner::kCalmRounds; i++) {
+    settings = tuner.Tune(signals, bounds);
+  }
+  ASSERT_EQ(settings.write_buffer, 128);
+  ASSERT_EQ(settings.background_jobs, 3);
+
+  // the new stalls are counted as the pressure
+  tuner.RecordWriteStall();
+  signals.write_stalls = tuner.GetWriteStalls();
+  settings = tuner.Tune(signals, bounds);
+  ASSERT_EQ(settings.write_buffer, 256);
+  ASSERT_EQ(settings.background_jobs, 4);
+
+  settings = tuner.Reset(bounds);
+  ASSERT_EQ(settings.write_buffer, 64);
+  ASSERT_EQ(settings.background_jobs, 2);
+}
+
+TEST(AutoTuner, BlockCacheSplit) {
+  AutoTuner tuner;
+  auto bounds = NewBounds();
+  AutoTuner::Signals signals;
+  tuner.Tune(signals, bounds);
+
+  // the subkey cache is full and misses a lot, while the metadata cache has the spare capacity
+  signals.subkey_cache_usage = 800;
+  signals.metadata_cache_usage = 100;
+  AutoTuner::Settings settings;
+  for (int i = 0; i < 10; i++) {
+    signals.block_cache_hits += 500;
+    signals.block_cache_misses += 500;
+    settings = tuner.Tune(signals, bounds);
+    signals.subkey_cache_usage = settings.subkey_block_cache;
+  }
+  // the metadata cache keeps at least half of its configured size
+  ASSERT_EQ(settings.metadata_block_cache, 400);
+  ASSERT_EQ(settings.subkey_block_cache, 1200);
+
+  // nothing is moved if the caches rarely miss
+  signals.subkey_cache_usage = 0;
+  signals.metadata_cache_usage = 400;
+  signals.block_cache_hits += 10000;
+  signals.block_cache_misses += 10;
+  ASSERT_EQ(tuner.Tune(signals, bounds).metadata_block_cache, 400);
+
+  // the shared block cache is never split
+  bounds.total_block_cache = 0;
+  settings = tuner.Reset(bounds);
+  ASSERT_EQ(settings.metadata_block_cache, 0);
+  tuner.Tune(signals, bounds);
+  signals.block_cache_hits += 500;
+  signals.block_cache_misses += 500;
+  ASSERT_EQ(tuner.Tune(signals, bounds).metadata_block_cache, 0);
+}
@@ -0,0 +1,126 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "server/client_tracking.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+static std::shared_ptr<TrackingClient> NewTrackingClient(uint64_t id, bool bcast = false) {
+  auto client = std::make_shared<TrackingClient>();
+  client->id = id;
+  client->ns = "ns";
+  client->bcast = bcast;
+  return client;
+}
+
+TEST(ClientTrackingTable, InvalidateKey) {
+  ClientTrackingTable table(0);
+  auto c1 = NewTrackingClient(1);
+  auto c2 = NewTrackingClient(2);
+  table.AddClient(c1);
+  table.AddClient(c2);
+  ASSERT_EQ(table.NumClients(), 2);
+
+  ASSERT_TRUE(table.TrackKey(c1, "ns", "foo").empty());
+  ASSERT_TRUE(table.TrackKey(c2, "ns", "foo").empty());
+  ASSERT_TRUE(table.TrackKey(c1, "ns", "foo").empty());
+  ASSERT_EQ(table.NumKeys(), 1);
+
+  // the same key in another namespace is a different key
+  ASSERT_TRUE(table.InvalidateKey("other", "foo", 3).empty());
+  auto invalidations = table.InvalidateKey("ns", "foo", 3);
+  ASSERT_EQ(invalidations.size(), 2);
+  for (const auto &invalidation : invalidations) {
+    ASSERT_FALSE(invalidation.flush_all);
+    ASSERT_EQ(invalidation.keys, std::vector<std::string>{"foo"});
+  }
+  ASSERT_EQ(table.NumKeys(), 0);
+
+  // the key must be read again to be tracked
+  ASSERT_TRUE(table.InvalidateKey("ns", "foo", 3).empty());
+}
+
+TEST(ClientTrackingTable, NoLoopAndRemovedClient) {
+  ClientTrackingTable table(0);
+  auto c1 = NewTrackingClient(1);
+  auto c2 = NewTrackingClient(2);
+  c1->noloop = true;
+  table.AddClient(c1);
+  table.AddClient(c2);
+
+  ASSERT_TRUE(table.TrackKey(c1, "ns", "foo").empty());
+  ASSERT_TRUE(table.TrackKey(c2, "ns", "foo").empty());
+  table.RemoveClient(c2);
+  ASSERT_EQ(table.NumClients(), 1);
+
+  ASSERT_TRUE(table.InvalidateKey("ns", "foo", 1).empty());
+}
+
+TEST(ClientTrackingTable, Broadcast) {
+  ClientTrackingTable table(0);
+  auto c1 = NewTrackingClient(1, true);
+  c1->prefixes = {"user:", "order:"};
+  auto c2 = NewTrackingClient(2, true);
+  table.AddClient(c1);
+  table.AddClient(c2);
+  ASSERT_EQ(table.NumPrefixes(), 3);
+
+  ASSERT_EQ(table.InvalidateKey("ns", "user:1", 3).size(), 2);
+  ASSERT_EQ(table.InvalidateKey("ns", "item:1", 3).size(), 1);
+  ASSERT_TRUE(table.InvalidateKey("other", "user:1", 3).empty());
+}
+
+TEST(ClientTrackingTable, EvictLeastRecentlyReadKeys) {
+  ClientTrackingTable table(1);
+  auto c1 = NewTrackingClient(1);
+  table.AddClient(c1);
+
+  size_t evicted = 0;
+  for (int i = 0; i < 1000; i++) {
+    evicted += table.TrackKey(c1, "ns", "key" + std::to_string(i)).size();
+  }
+  // at most one key is kept in each shard
+  ASSERT_LE(table.NumKeys(), 16);
+  ASSERT_EQ(table.NumKeys() + evicted, 1000);
+
+  table.SetMaxKeys(0);
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_TRUE(table.TrackKey(c1, "ns", "key" + std::to_string(i)).empty());
+  }
+}
+
+TEST(ClientTrackingTable, InvalidateAll) {
+  ClientTrackingTable table(0);
+  auto c1 = NewTrackingClient(1);
+  auto c2 = NewTrackingClient(2, true);
+  table.AddClient(c1);
+  table.AddClient(c2);
+  ASSERT_TRUE(table.TrackKey(c1, "ns", "foo").empty());
+
+  auto invalidations = table.InvalidateAll();
+  ASSERT_EQ(invalidations.size(), 2);
+  for (const auto &invalidation : invalidations) {
+    ASSERT_TRUE(invalidation.flush_all);
+  }
+  ASSERT_EQ(table.NumKeys(), 0);
+}
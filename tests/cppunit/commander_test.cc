@@ -0,0 +1,50 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "commands/commander.h"
+
+#include <gtest/gtest.h>
+
+#include <set>
+
+TEST(Commander, LookupIsCaseInsensitive) {
+  redis::ResetCommands();
+  auto commands = redis::GetCommands();
+  auto iter = commands->find("get");
+  ASSERT_NE(iter, commands->end());
+  for (const auto &name : {"GET", "Get", "gEt"}) {
+    auto found = commands->find(name);
+    ASSERT_NE(found, commands->end());
+    ASSERT_EQ(found->second, iter->second);
+  }
+  ASSERT_EQ(commands->find("gett"), commands->end());
+  ASSERT_EQ(commands->find("ge"), commands->end());
+}
+
+TEST(Commander, DenseCommandIDs) {
+  int num = redis::GetCommandNum();
+  std::set<int> ids;
+  for (const auto &[name, attributes] : *redis::GetOriginalCommands()) {
+    ASSERT_GE(attributes->id, 0);
+    ASSERT_LT(attributes->id, num);
+    ids.insert(attributes->id);
+  }
+  ASSERT_EQ(ids.size(), redis::GetOriginalCommands()->size());
+}
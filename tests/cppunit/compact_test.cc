@@ -22,6 +22,7 @@
 
 #include <filesystem>
 
+#include "storage/compact_filter.h"
 #include "storage/redis_metadata.h"
 #include "storage/storage.h"
 #include "types/redis_hash.h"
@@ -123,3 +124,84 @@ TEST(Compact, Filter) {
     std::cout << "Encounter filesystem error: " << ec << std::endl;
   }
 }
+
+TEST(Compact, SubKeyFilterStats) {
+  Config config;
+  config.db_dir = "compactstatsdb";
+  config.backup_dir = "compactstatsdb/backup";
+  config.slot_id_encoded = false;
+
+  auto storage = std::make_unique<engine::Storage>(&config);
+  ASSERT_TRUE(storage->Open().IsOK());
+
+  int ret = 0;
+  auto hash = std::make_unique<redis::Hash>(storage.get(), "test_compact");
+  std::vector<FieldValue> field_values = {{"f1", "v1"}, {"f2", "v2"}, {"f3", "v3"}};
+  for (int i = 100; i < 300; i++) {
+    ASSERT_TRUE(hash->MSet("key" + std::to_string(i), field_values, false, &ret).ok());
+  }
+  for (int i = 100; i < 300; i += 2) {
+    ASSERT_TRUE(hash->Del("key" + std::to_string(i)).ok());
+  }
+  ASSERT_TRUE(storage->Compact(nullptr, nullptr).ok());
+
+  auto filter_stats = storage->GetSubKeyFilterStats();
+  ASSERT_GE(filter_stats->dropped_subkeys.load(), 300);
+  // the metadata of the following keys are prefetched by a single seek
+  ASSERT_LT(filter_stats->metadata_gets.load() + filter_stats->metadata_prefetches.load(), 100);
+  ASSERT_GT(filter_stats->metadata_cache_hits.load(), 0);
+
+  std::unique_ptr<rocksdb::Iterator> iter(
+      storage->GetDB()->NewIterator(rocksdb::ReadOptions(), storage->GetCFHandle(engine::kSubkeyColumnFamilyName)));
+  int num_subkeys = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    InternalKey ikey(iter->key(), storage->IsSlotIdEncoded());
+    if (!ikey.IsKeyIdAnchor()) num_subkeys++;
+  }
+  ASSERT_EQ(num_subkeys, 300);
+  iter.reset();
+
+  storage.reset();
+  std::error_code ec;
+  std::filesystem::remove_all(config.db_dir, ec);
+}
+
+TEST(Compact, KeepKeyIdAnchorWithSubKeys) {
+  Config config;
+  config.db_dir = "compactanchordb";
+  config.backup_dir = "compactanchordb/backup";
+  config.slot_id_encoded = false;
+
+  auto storage = std::make_unique<engine::Storage>(&config);
+  ASSERT_TRUE(storage->Open().IsOK());
+
+  // the key is written with key id encoding by hand, and its metadata is deleted
+  // as if the key was deleted while its subkeys are not recycled yet
+  HashMetadata metadata;
+  metadata.flags |= METADATA_KEY_ID_ENCODING_MASK;
+  std::string ns_key;
+  ComposeNamespaceKey("test_compact", "key", &ns_key, false);
+  auto subkey_cf_handle = storage->GetCFHandle(engine::kSubkeyColumnFamilyName);
+  InternalKey anchor_ikey(ns_key, "", metadata.version, false, true);
+  std::string anchor, sub_key;
+  anchor_ikey.EncodeKeyIdAnchor(&anchor);
+  InternalKey(ns_key, "f1", metadata.version, false, true).Encode(&sub_key);
+  rocksdb::WriteBatch batch;
+  batch.Put(subkey_cf_handle, anchor, anchor_ikey.GetKey());
+  batch.Put(subkey_cf_handle, sub_key, "v1");
+  ASSERT_TRUE(storage->Write(storage->DefaultWriteOptions(), &batch).ok());
+
+  engine::SubKeyFilter filter(storage.get());
+  std::string new_value;
+  bool modified = false;
+  // the subkey is dropped since its key was deleted, but the anchor is kept while the subkey is alive
+  ASSERT_TRUE(filter.Filter(0, sub_key, "v1", &new_value, &modified));
+  ASSERT_FALSE(filter.Filter(0, anchor, anchor_ikey.GetKey(), &new_value, &modified));
+
+  ASSERT_TRUE(storage->Delete(storage->DefaultWriteOptions(), subkey_cf_handle, sub_key).ok());
+  ASSERT_TRUE(filter.Filter(0, anchor, anchor_ikey.GetKey(), &new_value, &modified));
+
+  storage.reset();
+  std::error_code ec;
+  std::filesystem::remove_all(config.db_dir, ec);
+}
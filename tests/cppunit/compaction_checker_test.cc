@@ -0,0 +1,85 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "storage/compaction_checker.h"
+
+#include <gtest/gtest.h>
+
+#include "storage/tombstone_stats.h"
+
+TEST(TombstoneStats, ParseTableProperties) {
+  rocksdb::TableProperties props;
+  props.data_size = 1000;
+  props.file_creation_time = 100;
+  ASSERT_FALSE(TombstoneStats::Parse("metadata", props));
+
+  props.user_collected_properties = {
+      {"total_keys", "100"}, {"deleted_keys", "25"}, {"start_key", "a"}, {"stop_key", "z"}};
+  auto stats = TombstoneStats::Parse("metadata", props);
+  ASSERT_TRUE(stats);
+  ASSERT_EQ(stats->cf_name, "metadata");
+  ASSERT_EQ(stats->start_key, "a");
+  ASSERT_EQ(stats->stop_key, "z");
+  ASSERT_EQ(stats->creation_time, 100);
+  ASSERT_DOUBLE_EQ(stats->DeleteRatio(), 0.25);
+  ASSERT_EQ(stats->ReclaimableBytes(), 250);
+}
+
+TEST(TombstoneStats, TrackFiles) {
+  TombstoneStats tombstone_stats;
+  TombstoneStats::FileStats stats;
+  stats.cf_name = "metadata";
+  tombstone_stats.AddFile("/data/db/000001.sst", stats);
+  tombstone_stats.AddFile("/data/db/000002.sst", stats);
+  stats.cf_name = "default";
+  tombstone_stats.AddFile("/data/db/000003.sst", stats);
+  ASSERT_EQ(tombstone_stats.GetFiles("metadata").size(), 2);
+
+  tombstone_stats.RemoveFile("/data/db/000001.sst");
+  auto files = tombstone_stats.GetFiles("metadata");
+  ASSERT_EQ(files.size(), 1);
+  ASSERT_EQ(files[0].first, "000002.sst");
+
+  // The loaded files don't override the ones added by the events
+  ASSERT_FALSE(tombstone_stats.IsLoaded("metadata"));
+  stats.cf_name = "metadata";
+  stats.total_keys = 10;
+  tombstone_stats.LoadColumnFamily("metadata", {{"000002.sst", stats}, {"000004.sst", stats}});
+  ASSERT_TRUE(tombstone_stats.IsLoaded("metadata"));
+  files = tombstone_stats.GetFiles("metadata");
+  ASSERT_EQ(files.size(), 2);
+  ASSERT_EQ(files[0].second.total_keys, 0);
+
+  tombstone_stats.RetainFiles("metadata", {"000004.sst"});
+  files = tombstone_stats.GetFiles("metadata");
+  ASSERT_EQ(files.size(), 1);
+  ASSERT_EQ(files[0].first, "000004.sst");
+  ASSERT_EQ(tombstone_stats.GetFiles("default").size(), 1);
+}
+
+TEST(CompactionChecker, MergeRanges) {
+  auto ranges = CompactionChecker::MergeRanges({{"k", "m", 10}, {"a", "c", 5}, {"b", "e", 20}, {"f", "g", 1}});
+  ASSERT_EQ(ranges.size(), 3);
+  ASSERT_EQ(ranges[0].start_key, "a");
+  ASSERT_EQ(ranges[0].stop_key, "e");
+  ASSERT_EQ(ranges[0].reclaimable_bytes, 25);
+  ASSERT_EQ(ranges[1].start_key, "k");
+  ASSERT_EQ(ranges[2].start_key, "f");
+}
@@ -0,0 +1,75 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "compression_util.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "encoding.h"
+
+TEST(CompressionUtil, CompressAndDecompress) {
+  std::vector<std::string> inputs = {"", "a", "hello world", std::string(1024 * 1024, 'x')};
+  for (auto type : {rocksdb::kLZ4Compression, rocksdb::kZSTD}) {
+    for (const auto &input : inputs) {
+      auto compressed = util::CompressBlock(type, input);
+      ASSERT_TRUE(compressed.IsOK()) << compressed.Msg();
+      auto decompressed = util::DecompressBlock(type, *compressed);
+      ASSERT_TRUE(decompressed.IsOK()) << decompressed.Msg();
+      ASSERT_EQ(input, *decompressed);
+    }
+    auto compressed = util::CompressBlock(type, inputs.back());
+    ASSERT_LT(compressed->size(), inputs.back().size());
+  }
+}
+
+TEST(CompressionUtil, DecompressCorruptedBlock) {
+  for (auto type : {rocksdb::kLZ4Compression, rocksdb::kZSTD}) {
+    auto compressed = util::CompressBlock(type, std::string(1024, 'x'));
+    ASSERT_TRUE(compressed.IsOK());
+    ASSERT_FALSE(util::DecompressBlock(type, compressed->substr(0, 2)).IsOK());
+    ASSERT_FALSE(util::DecompressBlock(type, compressed->substr(0, compressed->size() / 2)).IsOK());
+  }
+  ASSERT_FALSE(util::CompressBlock(rocksdb::kSnappyCompression, "a").IsOK());
+}
+
+TEST(CompressionUtil, DecompressOversizedBlock) {
+  for (auto type : {rocksdb::kLZ4Compression, rocksdb::kZSTD}) {
+    auto compressed = util::CompressBlock(type, std::string(1024, 'x'));
+    ASSERT_TRUE(compressed.IsOK());
+    // the size in the header is forged, it must be rejected before allocating the output
+    std::string forged;
+    PutFixed32(&forged, static_cast<uint32_t>(util::kMaxBlockSize + 1));
+    forged.append(compressed->substr(forged.size()));
+    auto s = util::DecompressBlock(type, forged);
+    ASSERT_FALSE(s.IsOK());
+    ASSERT_NE(s.Msg().find("exceeds the limit"), std::string::npos);
+  }
+}
+
+TEST(CompressionUtil, ParseCompressionType) {
+  ASSERT_EQ(*util::ParseBlockCompressionType("LZ4"), rocksdb::kLZ4Compression);
+  ASSERT_EQ(*util::ParseBlockCompressionType("zstd"), rocksdb::kZSTD);
+  ASSERT_EQ(*util::ParseBlockCompressionType("no"), rocksdb::kNoCompression);
+  ASSERT_FALSE(util::ParseBlockCompressionType("snappy").IsOK());
+  ASSERT_EQ(util::BlockCompressionTypeName(rocksdb::kZSTD), "zstd");
+}
@@ -38,6 +38,9 @@ TEST(Config, GetAndSet) {
   std::map<std::string, std::string> mutable_cases = {
       {"timeout", "1000"},
       {"maxclients", "2000"},
+      {"io-max-single-rw-kb", "64"},
+      {"client-output-buffer-limit", "normal 0 0 0 replica 256mb 64mb 60 pubsub 64mb 16mb 30"},
+      {"tracking-table-max-keys", "1000"},
       {"max-backup-to-keep", "1"},
       {"max-backup-keep-hours", "4000"},
       {"requirepass", "mytest_requirepass"},
@@ -45,14 +48,28 @@ TEST(Config, GetAndSet) {
       {"compact-cron", "1 2 3 4 5"},
       {"bgsave-cron", "5 4 3 2 1"},
       {"max-io-mb", "5000"},
+      {"metadata-cache-size", "256"},
+      {"lazyfree-lazy-user-del", "yes"},
+      {"auto-tune-enabled", "yes"},
+      {"auto-tune-max-write-buffer-size", "512"},
+      {"auto-tune-max-background-jobs", "16"},
+      {"namespace-column-families", "yes"},
+      {"namespace-block-cache-size", "64"},
+      {"namespace-write-buffer-size", "32"},
       {"max-db-size", "6000"},
       {"max-replication-mb", "7000"},
+      {"replication-compression", "zstd"},
+      {"fullsync-fetch-concurrency", "8"},
+      {"fullsync-fetch-chunk-mb", "16"},
+      {"slave-apply-group-size", "16"},
+      {"compaction-checker-concurrency", "4"},
       {"slave-serve-stale-data", "no"},
       {"slave-read-only", "no"},
       {"slave-priority", "101"},
       {"slowlog-log-slower-than", "1234"},
       {"slowlog-max-len", "123"},
       {"profiling-sample-ratio", "50"},
+      {"key-stats-sample-ratio", "10"},
       {"profiling-sample-record-max-len", "1"},
       {"profiling-sample-record-threshold-ms", "50"},
       {"profiling-sample-commands", "get,set"},
@@ -108,6 +125,8 @@ TEST(Config, GetAndSet) {
       {"bind", "0.0.0.0"},
       {"repl-bind", "0.0.0.0"},
       {"workers", "8"},
+      {"io-epoll-changelist", "yes"},
+      {"worker-cpu-affinity", "yes"},
       {"repl-workers", "8"},
       {"tcp-backlog", "500"},
       {"slaveof", "no one"},
@@ -156,6 +175,28 @@ TEST(Config, GetRenameCommand) {
   ASSERT_EQ(values[4], "rename-command");
 }
 
+TEST(Config, ClientOutputBufferLimit) {
+  Config config;
+  ASSERT_TRUE(config.Load(CLIOptions()).IsOK());
+  const auto &limits = config.client_output_buffer_limits;
+  EXPECT_FALSE(limits[kClientOutputBufferNormal].Enabled());
+  EXPECT_EQ(limits[kClientOutputBufferPubsub].hard_limit_bytes, 32 * MiB);
+  EXPECT_EQ(limits[kClientOutputBufferPubsub].soft_limit_bytes, 8 * MiB);
+  EXPECT_EQ(limits[kClientOutputBufferPubsub].soft_limit_seconds, 60);
+
+  ASSERT_TRUE(config.Set(nullptr, "client-output-buffer-limit", "normal 1gb 512m 10").IsOK());
+  EXPECT_EQ(limits[kClientOutputBufferNormal].hard_limit_bytes, GiB);
+  EXPECT_EQ(limits[kClientOutputBufferNormal].soft_limit_bytes, 512 * MiB);
+  EXPECT_EQ(limits[kClientOutputBufferNormal].soft_limit_seconds, 10);
+  // classes which are not mentioned fall back to the defaults
+  EXPECT_EQ(limits[kClientOutputBufferReplica].hard_limit_bytes, 256 * MiB);
+
+  ASSERT_FALSE(config.Set(nullptr, "client-output-buffer-limit", "normal 1gb 512m").IsOK());
+  ASSERT_FALSE(config.Set(nullptr, "client-output-buffer-limit", "unknown 0 0 0").IsOK());
+  ASSERT_FALSE(config.Set(nullptr, "client-output-buffer-limit", "pubsub 1xb 0 0").IsOK());
+  EXPECT_EQ(limits[kClientOutputBufferNormal].hard_limit_bytes, GiB);
+}
+
 TEST(Config, Rewrite) {
   const char *path = "test.conf";
   unlink(path);
@@ -0,0 +1,142 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "storage/deletion_log.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "test_base.h"
+#include "types/redis_hash.h"
+
+TEST(DeletionLog, EncodeKey) {
+  auto log_key = DeletionLog::EncodeKey(1, "prefix");
+  ASSERT_EQ(DeletionLog::SubKeyPrefix(log_key).ToString(), "prefix");
+  // the entries are ordered by the deletion time
+  ASSERT_LT(log_key, DeletionLog::EncodeKey(256, "a"));
+  ASSERT_TRUE(DeletionLog::SubKeyPrefix("short").empty());
+}
+
+TEST(DeletionLog, PendingPrefixes) {
+  DeletionLog deletion_log;
+  ASSERT_FALSE(deletion_log.Contains("p1"));
+  deletion_log.Add("p1");
+  deletion_log.Add("p2");
+  deletion_log.Add("p1");
+  ASSERT_EQ(deletion_log.GetPending(), 2);
+  ASSERT_TRUE(deletion_log.Contains("p1"));
+  ASSERT_FALSE(deletion_log.Contains("p3"));
+
+  deletion_log.Remove("p1");
+  ASSERT_FALSE(deletion_log.Contains("p1"));
+  ASSERT_EQ(deletion_log.GetPending(), 1);
+  deletion_log.Clear();
+  ASSERT_EQ(deletion_log.GetPending(), 0);
+}
+
+class DeletionLogTest : public TestBase {
+ protected:
+  explicit DeletionLogTest() = default;
+  ~DeletionLogTest() override = default;
+
+  void SetUp() override { hash_ = std::make_unique<redis::Hash>(storage_, "deletion_log_ns"); }
+
+  void mset(const std::string &key, int num_fields) {
+    std::vector<FieldValue> field_values;
+    for (int i = 0; i < num_fields; i++) {
+      field_values.emplace_back("field" + std::to_string(i), "value" + std::to_string(i));
+    }
+    int ret = 0;
+    ASSERT_TRUE(hash_->MSet(key, field_values, false, &ret).ok());
+  }
+
+  int countKeys(const std::string &cf_name) {
+    std::unique_ptr<rocksdb::Iterator> iter(
+        storage_->GetDB()->NewIterator(rocksdb::ReadOptions(), storage_->GetCFHandle(cf_name)));
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) count++;
+    return count;
+  }
+
+  std::unique_ptr<redis::Hash> hash_;
+};
+
+TEST_F(DeletionLogTest, ReclaimUnlinkedKeys) {
+  mset("big", 100);
+  mset("small", 10);
+  ASSERT_TRUE(hash_->Del("small", true).ok());
+  ASSERT_TRUE(hash_->Del("big", true).ok());
+  // the small collections are left to the compaction filter
+  ASSERT_EQ(storage_->GetDeletionLog()->GetPending(), 1);
+  ASSERT_EQ(countKeys(engine::kDeletionLogColumnFamilyName), 1);
+
+  // the key which is created again has a new version
+  mset("big", 100);
+  int anchors = USE_KEY_ID_ENCODING_DEFAULT ? 1 : 0;
+  ASSERT_EQ(countKeys(engine::kSubkeyColumnFamilyName), 210 + 3 * anchors);
+
+  auto reclaimed = storage_->ReclaimDeletedSubKeys(128);
+  ASSERT_TRUE(reclaimed.IsOK());
+  ASSERT_EQ(*reclaimed, 1);
+  ASSERT_EQ(countKeys(engine::kSubkeyColumnFamilyName), 110 + 2 * anchors);
+  ASSERT_EQ(countKeys(engine::kDeletionLogColumnFamilyName), 0);
+  ASSERT_EQ(storage_->GetDeletionLog()->GetPending(), 0);
+  ASSERT_EQ(storage_->GetDeletionLog()->GetReclaimed(), 1);
+
+  uint32_t size = 0;
+  ASSERT_TRUE(hash_->Size("big", &size).ok());
+  ASSERT_EQ(size, 100);
+  reclaimed = storage_->ReclaimDeletedSubKeys(128);
+  ASSERT_TRUE(reclaimed.IsOK());
+  ASSERT_EQ(*reclaimed, 0);
+}
+
+TEST_F(DeletionLogTest, PendingAfterRestart) {
+  mset("big", 100);
+  ASSERT_TRUE(hash_->Del("big", true).ok());
+  ASSERT_TRUE(hash_->Del("big", true).IsNotFound());
+
+  storage_->CloseDB();
+  ASSERT_TRUE(storage_->Open().IsOK());
+  ASSERT_EQ(storage_->GetDeletionLog()->GetPending(), 1);
+  auto reclaimed = storage_->ReclaimDeletedSubKeys(128);
+  ASSERT_TRUE(reclaimed.IsOK());
+  ASSERT_EQ(*reclaimed, 1);
+  ASSERT_EQ(countKeys(engine::kSubkeyColumnFamilyName), 0);
+}
+
+TEST_F(DeletionLogTest, ApplyReplicatedLog) {
+  auto log_cf_handle = storage_->GetCFHandle(engine::kDeletionLogColumnFamilyName);
+  auto log_key = DeletionLog::EncodeKey(1, "prefix");
+  rocksdb::WriteBatch batch;
+  batch.Put(log_cf_handle, log_key, std::string(1, kRedisHash));
+  ASSERT_TRUE(storage_->ReplicaApplyWriteBatch(std::string(batch.Data())).IsOK());
+  ASSERT_TRUE(storage_->GetDeletionLog()->Contains("prefix"));
+
+  // the entries reclaimed by master are removed from the replica
+  batch.Clear();
+  batch.Delete(log_cf_handle, log_key);
+  ASSERT_TRUE(storage_->ReplicaApplyWriteBatch(std::string(batch.Data())).IsOK());
+  ASSERT_FALSE(storage_->GetDeletionLog()->Contains("prefix"));
+  ASSERT_EQ(storage_->GetDeletionLog()->GetPending(), 0);
+}
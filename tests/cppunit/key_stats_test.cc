@@ -0,0 +1,144 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "stats/key_stats.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "test_base.h"
+
+TEST(HotKeys, TopKeys) {
+  HotKeys hot_keys(16);
+  for (int i = 0; i < 10; i++) {
+    for (int j = 0; j <= i; j++) {
+      hot_keys.Add("ns", "key" + std::to_string(i));
+    }
+  }
+  hot_keys.Add("other", "key9");
+  ASSERT_EQ(hot_keys.Size(), 11);
+
+  auto top = hot_keys.GetTop("ns", 3);
+  ASSERT_EQ(top.size(), 3);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(top[i].key, "key" + std::to_string(9 - i));
+    ASSERT_EQ(top[i].count, 10 - i);
+    ASSERT_EQ(top[i].error, 0);
+  }
+  ASSERT_EQ(hot_keys.GetTop("other", 10).size(), 1);
+
+  hot_keys.Reset();
+  ASSERT_EQ(hot_keys.Size(), 0);
+  ASSERT_TRUE(hot_keys.GetTop("ns", 10).empty());
+}
+
+TEST(HotKeys, ReplaceMinimumKey) {
+  HotKeys hot_keys(4);
+  for (int i = 0; i < 100; i++) {
+    hot_keys.Add("ns", "hot");
+    hot_keys.Add("ns", "cold" + std::to_string(i));
+  }
+  ASSERT_EQ(hot_keys.Size(), 4);
+
+  auto top = hot_keys.GetTop("ns", 1);
+  ASSERT_EQ(top.size(), 1);
+  ASSERT_EQ(top[0].key, "hot");
+  ASSERT_EQ(top[0].count, 100);
+
+  // the new key inherits the count of the replaced key as the error
+  top = hot_keys.GetTop("ns", 4);
+  ASSERT_EQ(top.back().count, top.back().error + 1);
+}
+
+TEST(HotKeys, Decay) {
+  HotKeys hot_keys(16);
+  for (int i = 0; i < 8; i++) hot_keys.Add("ns", "foo");
+  hot_keys.Add("ns", "bar");
+
+  hot_keys.Decay();
+  auto top = hot_keys.GetTop("ns", 10);
+  ASSERT_EQ(top.size(), 1);
+  ASSERT_EQ(top[0].key, "foo");
+  ASSERT_EQ(top[0].count, 4);
+}
+
+TEST(BigKeys, TopKeys) {
+  BigKeys big_keys(4);
+  for (int i = 0; i < 10; i++) {
+    big_keys.Update("ns", "key" + std::to_string(i), "hash", i * 10);
+  }
+  ASSERT_EQ(big_keys.Size(), 4);
+
+  auto top = big_keys.GetTop("ns", 10);
+  ASSERT_EQ(top.size(), 4);
+  ASSERT_EQ(top[0].key, "key9");
+  ASSERT_EQ(top[0].type, "hash");
+  ASSERT_EQ(top[0].size, 90);
+  ASSERT_EQ(top[3].key, "key6");
+
+  // the smaller keys are not remembered when it's full
+  big_keys.Update("ns", "small", "string", 1);
+  ASSERT_EQ(big_keys.GetTop("ns", 10).back().key, "key6");
+
+  // the size of remembered key could be shrunk
+  big_keys.Update("ns", "key9", "hash", 5);
+  top = big_keys.GetTop("ns", 10);
+  ASSERT_EQ(top[0].key, "key8");
+  ASSERT_EQ(top[3].key, "key9");
+
+  big_keys.Remove("ns", "key8");
+  ASSERT_EQ(big_keys.Size(), 3);
+  ASSERT_TRUE(big_keys.GetTop("other", 10).empty());
+
+  big_keys.Reset();
+  ASSERT_EQ(big_keys.Size(), 0);
+}
+
+class WrittenMetadataTest : public TestBase {};
+
+TEST_F(WrittenMetadataTest, RecordWrittenMetadata) {
+  std::string ns_key;
+  ComposeNamespaceKey("ns", "key", &ns_key, storage_->IsSlotIdEncoded());
+  redis::Hash hash(storage_, "ns");
+  int ret = 0;
+  {
+    engine::WrittenMetadataRecorder recorder;
+    ASSERT_EQ(engine::WrittenMetadataRecorder::Current(), &recorder);
+    ASSERT_TRUE(hash.Set("key", "f1", "v1", &ret).ok());
+    ASSERT_TRUE(hash.Set("key", "f2", "v2", &ret).ok());
+
+    auto bytes = recorder.Find(ns_key);
+    ASSERT_NE(bytes, nullptr);
+    ASSERT_TRUE(bytes->has_value());
+    HashMetadata metadata(false);
+    ASSERT_TRUE(metadata.Decode(**bytes).ok());
+    ASSERT_EQ(metadata.size, 2);
+
+    ASSERT_TRUE(redis::Database(storage_, "ns").Del("key").ok());
+    ASSERT_FALSE(recorder.Find(ns_key)->has_value());
+  }
+  ASSERT_EQ(engine::WrittenMetadataRecorder::Current(), nullptr);
+
+  // nothing is recorded without the recorder
+  ASSERT_TRUE(hash.Set("key", "f1", "v1", &ret).ok());
+  engine::WrittenMetadataRecorder recorder;
+  ASSERT_EQ(recorder.Find(ns_key), nullptr);
+}
@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "kvrocks2redis/parser.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "server/redis_reply.h"
+#include "test_base.h"
+
+class CaptureWriter : public Writer {
+ public:
+  CaptureWriter() : Writer(nullptr) {}
+
+  Status Write(const std::string &ns, const std::vector<std::string> &aofs) override {
+    auto &commands = commands_[ns];
+    commands.insert(commands.end(), aofs.begin(), aofs.end());
+    return Status::OK();
+  }
+  Status FlushDB(const std::string &ns) override { return Status::OK(); }
+
+  const std::vector<std::string> &Commands(const std::string &ns) { return commands_[ns]; }
+
+ private:
+  std::map<std::string, std::vector<std::string>> commands_;
+};
+
+class Kvrocks2RedisParserTest : public TestBase {
+ protected:
+  // the keys are written with key id encoding by hand, so they're covered no matter
+  // whether the key id encoding is enabled by default
+  void putKeyIdEncodedKey(Metadata *metadata, const std::string &user_key,
+                          const std::vector<std::pair<std::string, std::string>> &subkeys) {
+    metadata->flags |= METADATA_KEY_ID_ENCODING_MASK;
+    metadata->size = subkeys.size();
+
+    std::string ns_key;
+    ComposeNamespaceKey(kDefaultNamespace, user_key, &ns_key, false);
+    rocksdb::WriteBatch batch;
+    std::string bytes;
+    metadata->Encode(&bytes);
+    batch.Put(storage_->GetCFHandle(engine::kMetadataColumnFamilyName), ns_key, bytes);
+
+    auto subkey_cf_handle = storage_->GetCFHandle(engine::kSubkeyColumnFamilyName);
+    InternalKey ikey(ns_key, "", metadata->version, false, true);
+    std::string anchor;
+    ikey.EncodeKeyIdAnchor(&anchor);
+    batch.Put(subkey_cf_handle, anchor, ikey.GetKey());
+    for (const auto &[sub_key, value] : subkeys) {
+      std::string encoded_sub_key;
+      InternalKey(ns_key, sub_key, metadata->version, false, true).Encode(&encoded_sub_key);
+      batch.Put(subkey_cf_handle, encoded_sub_key, value);
+    }
+    ASSERT_TRUE(storage_->Write(storage_->DefaultWriteOptions(), &batch).ok());
+  }
+};
+
+TEST_F(Kvrocks2RedisParserTest, FullSyncKeyIdEncodedKeys) {
+  HashMetadata hash_metadata;
+  putKeyIdEncodedKey(&hash_metadata, "hash", {{"f1", "v1"}, {"f2", "v2"}});
+  SetMetadata set_metadata;
+  putKeyIdEncodedKey(&set_metadata, "set", {{"m1", ""}, {"m2", ""}});
+  ZSetMetadata zset_metadata;
+  std::string score;
+  PutDouble(&score, 1.5);
+  putKeyIdEncodedKey(&zset_metadata, "zset", {{"m1", score}});
+  ListMetadata list_metadata;
+  std::string index;
+  PutFixed64(&index, list_metadata.head);
+  list_metadata.tail++;
+  putKeyIdEncodedKey(&list_metadata, "list", {{index, "e1"}});
+
+  CaptureWriter writer;
+  Parser parser(storage_, &writer);
+  ASSERT_TRUE(parser.ParseFullDB().IsOK());
+
+  std::vector<std::string> expected = {
+      redis::Command2RESP({"HSET", "hash", "f1", "v1"}), redis::Command2RESP({"HSET", "hash", "f2", "v2"}),
+      redis::Command2RESP({"RPUSH", "list", "e1"}),      redis::Command2RESP({"SADD", "set", "m1"}),
+      redis::Command2RESP({"SADD", "set", "m2"}),        redis::Command2RESP({"ZADD", "zset", "1.5", "m1"}),
+  };
+  ASSERT_EQ(writer.Commands(kDefaultNamespace), expected);
+}
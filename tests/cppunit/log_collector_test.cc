@@ -22,6 +22,11 @@
 
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
 TEST(LogCollector, PushEntry) {
   LogCollector<PerfEntry> perf_log;
   perf_log.SetMaxEntries(1);
@@ -35,3 +40,66 @@ TEST(LogCollector, PushEntry) {
   perf_log.Reset();
   EXPECT_EQ(perf_log.Size(), 0);
 }
+
+static std::unique_ptr<SlowEntry> NewSlowEntry(const std::string &arg) {
+  auto entry = std::make_unique<SlowEntry>();
+  entry->duration = 1;
+  entry->args = {arg};
+  return entry;
+}
+
+TEST(LogCollector, KeepLatestEntries) {
+  LogCollector<SlowEntry> log;
+  log.SetMaxEntries(10);
+  for (int i = 0; i < 100; i++) {
+    log.PushEntry(NewSlowEntry(std::to_string(i)));
+  }
+  ASSERT_EQ(log.Size(), 10);
+
+  auto entries = log.GetLatestEntries(2);
+  ASSERT_EQ(entries.rfind("*2\r\n", 0), 0);
+  // the newest entry is the first one
+  ASSERT_LT(entries.find("$2\r\n99\r\n"), entries.find("$2\r\n98\r\n"));
+  ASSERT_EQ(entries.find("$2\r\n97\r\n"), std::string::npos);
+
+  log.SetMaxEntries(5);
+  ASSERT_EQ(log.Size(), 5);
+  entries = log.GetLatestEntries(0);
+  ASSERT_EQ(entries.rfind("*5\r\n", 0), 0);
+  ASSERT_NE(entries.find("$2\r\n95\r\n"), std::string::npos);
+  ASSERT_EQ(entries.find("$2\r\n94\r\n"), std::string::npos);
+
+  log.Reset();
+  ASSERT_EQ(log.Size(), 0);
+  ASSERT_EQ(log.GetLatestEntries(10), "*0\r\n");
+}
+
+TEST(LogCollector, Unlimited) {
+  LogCollector<SlowEntry> log;
+  log.SetMaxEntries(0);
+  for (int i = 0; i < 1000; i++) {
+    log.PushEntry(NewSlowEntry(std::to_string(i)));
+  }
+  ASSERT_EQ(log.Size(), 1000);
+  ASSERT_EQ(log.GetLatestEntries(0).rfind("*1000\r\n", 0), 0);
+}
+
+TEST(LogCollector, ConcurrentPush) {
+  LogCollector<SlowEntry> log;
+  log.SetMaxEntries(100);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; i++) {
+    threads.emplace_back([&log, i] {
+      for (int j = 0; j < 1000; j++) {
+        log.PushEntry(NewSlowEntry(std::to_string(i)));
+      }
+    });
+  }
+  for (auto &t : threads) t.join();
+
+  ASSERT_EQ(log.Size(), 100);
+  // the entries are merged from all threads by id, the newest id is the number of pushed entries
+  auto entries = log.GetLatestEntries(1);
+  ASSERT_EQ(entries.rfind("*1\r\n*4\r\n:8000\r\n", 0), 0);
+}
@@ -0,0 +1,118 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "storage/metadata_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+TEST(MetadataCache, LookupAndInvalidate) {
+  MetadataCache cache(1024 * 1024);
+  std::string value;
+  uint64_t epoch = 0;
+  ASSERT_FALSE(cache.Lookup("key", &value, &epoch));
+  cache.Insert("key", "value", epoch);
+  ASSERT_TRUE(cache.Lookup("key", &value, &epoch));
+  ASSERT_EQ(value, "value");
+  ASSERT_EQ(cache.GetHits(), 1);
+  ASSERT_EQ(cache.GetMisses(), 1);
+  ASSERT_GT(cache.GetUsage(), 0);
+
+  cache.Invalidate("key");
+  ASSERT_FALSE(cache.Lookup("key", &value, &epoch));
+  ASSERT_EQ(cache.GetUsage(), 0);
+
+  // the value which was read before the invalidation shouldn't be cached
+  cache.Invalidate("key");
+  cache.Insert("key", "stale", epoch);
+  ASSERT_FALSE(cache.Lookup("key", &value, &epoch));
+
+  cache.Insert("key", "value", epoch);
+  cache.Clear();
+  ASSERT_FALSE(cache.Lookup("key", &value, &epoch));
+  ASSERT_EQ(cache.GetUsage(), 0);
+}
+
+TEST(MetadataCache, Disabled) {
+  MetadataCache cache(0);
+  ASSERT_FALSE(cache.Enabled());
+  std::string value;
+  uint64_t epoch = 0;
+  ASSERT_FALSE(cache.Lookup("key", &value, &epoch));
+  cache.Insert("key", "value", epoch);
+  ASSERT_EQ(cache.GetUsage(), 0);
+  ASSERT_EQ(cache.GetMisses(), 0);
+
+  // the lookup before the cache was enabled shouldn't insert the value
+  cache.SetCapacity(1024 * 1024);
+  cache.Insert("key", "value", epoch);
+  ASSERT_FALSE(cache.Lookup("key", &value, &epoch));
+  cache.Insert("key", "value", epoch);
+  ASSERT_TRUE(cache.Lookup("key", &value, &epoch));
+
+  cache.SetCapacity(0);
+  ASSERT_EQ(cache.GetUsage(), 0);
+  ASSERT_FALSE(cache.Lookup("key", &value, &epoch));
+}
+
+TEST(MetadataCache, LargeValue) {
+  MetadataCache cache(1024 * 1024);
+  std::string value;
+  uint64_t epoch = 0;
+  ASSERT_FALSE(cache.Lookup("key", &value, &epoch));
+  cache.Insert("key", std::string(MetadataCache::kMaxValueSize + 1, 'a'), epoch);
+  ASSERT_FALSE(cache.Lookup("key", &value, &epoch));
+}
+
+TEST(MetadataCache, FrequencyAdmission) {
+  // each shard can only hold a few entries
+  MetadataCache cache(16 * 512);
+  std::string value;
+  uint64_t epoch = 0;
+  for (int round = 0; round < 10; round++) {
+    if (!cache.Lookup("hot", &value, &epoch)) cache.Insert("hot", "value", epoch);
+  }
+  ASSERT_TRUE(cache.Lookup("hot", &value, &epoch));
+
+  // the keys which are only accessed once can't evict the hot key
+  for (int i = 0; i < 1000; i++) {
+    auto key = "cold" + std::to_string(i);
+    if (!cache.Lookup(key, &value, &epoch)) cache.Insert(key, "value", epoch);
+  }
+  ASSERT_TRUE(cache.Lookup("hot", &value, &epoch));
+  ASSERT_GT(cache.GetRejects(), 0);
+  ASSERT_LE(cache.GetUsage(), cache.GetCapacity());
+}
+
+TEST(FrequencySketch, Frequency) {
+  FrequencySketch sketch(64);
+  for (int i = 0; i < 10; i++) sketch.Increment(1);
+  sketch.Increment(2);
+  ASSERT_GE(sketch.Frequency(1), 10);
+  ASSERT_GE(sketch.Frequency(2), 1);
+  ASSERT_GT(sketch.Frequency(1), sketch.Frequency(2));
+
+  // the counters are saturated and halved after the sample size of increments
+  for (int i = 0; i < 100; i++) sketch.Increment(1);
+  ASSERT_LE(sketch.Frequency(1), 15);
+  for (uint64_t i = 3; i < 3000; i++) sketch.Increment(i);
+  ASSERT_LT(sketch.Frequency(1), 15);
+}
@@ -0,0 +1,139 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <memory>
+
+#include "server/redis_reply.h"
+#include "storage/batch_extractor.h"
+#include "storage/redis_db.h"
+#include "storage/storage.h"
+#include "types/redis_hash.h"
+#include "types/redis_zset.h"
+
+class NamespaceColumnFamiliesTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    config_.db_dir = "nscfdb";
+    config_.backup_dir = "nscfdb/backup";
+    config_.slot_id_encoded = false;
+    config_.namespace_block_cache_size = 1;
+    storage_ = std::make_unique<engine::Storage>(&config_);
+    ASSERT_TRUE(storage_->Open().IsOK());
+  }
+
+  void TearDown() override {
+    storage_.reset();
+    std::error_code ec;
+    std::filesystem::remove_all(config_.db_dir, ec);
+  }
+
+  Config config_;
+  std::unique_ptr<engine::Storage> storage_;
+};
+
+TEST_F(NamespaceColumnFamiliesTest, CreateAndDrop) {
+  std::vector<uint32_t> cf_ids;
+  ASSERT_TRUE(storage_->CreateNamespaceColumnFamilies("ns1", &cf_ids).IsOK());
+  ASSERT_EQ(cf_ids.size(), engine::kNamespaceColumnFamilies.size());
+  ASSERT_FALSE(storage_->CreateNamespaceColumnFamilies("ns1", &cf_ids).IsOK());
+  ASSERT_TRUE(storage_->IsNamespaceIsolated("ns1"));
+  ASSERT_FALSE(storage_->IsNamespaceIsolated("ns2"));
+
+  for (const auto &[id, name] : engine::kNamespaceColumnFamilies) {
+    auto cf_handle = storage_->GetCFHandle(name, "ns1");
+    ASSERT_NE(cf_handle, storage_->GetCFHandle(name));
+    ASSERT_EQ(cf_handle->GetName(), std::string(name) + engine::kNamespaceColumnFamilySeparator + "ns1");
+    ASSERT_EQ(storage_->GetSharedCFID(cf_handle->GetID()), id);
+    ASSERT_EQ(storage_->GetSiblingCFHandle(cf_handle->GetID(), engine::kMetadataColumnFamilyName),
+              storage_->GetCFHandle(engine::kMetadataColumnFamilyName, "ns1"));
+    ASSERT_EQ(storage_->GetCFHandle(name, "ns2"), storage_->GetCFHandle(name));
+  }
+  // the pubsub and propagate column families are always shared
+  ASSERT_EQ(storage_->GetCFHandle(engine::kPubSubColumnFamilyName, "ns1"),
+            storage_->GetCFHandle(engine::kPubSubColumnFamilyName));
+
+  ASSERT_TRUE(storage_->DropNamespaceColumnFamilies("ns1").IsOK());
+  ASSERT_FALSE(storage_->IsNamespaceIsolated("ns1"));
+  ASSERT_TRUE(storage_->DropNamespaceColumnFamilies("ns1").Is<Status::NotFound>());
+  ASSERT_TRUE(storage_->CreateNamespaceColumnFamilies("ns1", &cf_ids).IsOK());
+}
+
+TEST_F(NamespaceColumnFamiliesTest, IsolatedData) {
+  std::vector<uint32_t> cf_ids;
+  ASSERT_TRUE(storage_->CreateNamespaceColumnFamilies("ns1", &cf_ids).IsOK());
+
+  int ret = 0;
+  redis::Hash hash1(storage_.get(), "ns1"), hash2(storage_.get(), "ns2");
+  ASSERT_TRUE(hash1.Set("key", "field", "v1", &ret).ok());
+  ASSERT_TRUE(hash2.Set("key", "field", "v2", &ret).ok());
+  std::vector<MemberScore> member_scores = {MemberScore{"m1", 1.0}};
+  redis::ZSet zset1(storage_.get(), "ns1");
+  ASSERT_TRUE(zset1.Add("zkey", ZAddFlags::Default(), &member_scores, &ret).ok());
+
+  auto count_keys = [this](rocksdb::ColumnFamilyHandle *cf_handle) {
+    std::unique_ptr<rocksdb::Iterator> iter(storage_->GetDB()->NewIterator(rocksdb::ReadOptions(), cf_handle));
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) count++;
+    return count;
+  };
+  ASSERT_EQ(count_keys(storage_->GetCFHandle(engine::kMetadataColumnFamilyName, "ns1")), 2);
+  ASSERT_EQ(count_keys(storage_->GetCFHandle(engine::kZSetScoreColumnFamilyName, "ns1")), 1);
+  ASSERT_EQ(count_keys(storage_->GetCFHandle(engine::kMetadataColumnFamilyName)), 1);
+  ASSERT_EQ(count_keys(storage_->GetCFHandle(engine::kZSetScoreColumnFamilyName)), 0);
+
+  // the column families are opened again after restarting
+  storage_->CloseDB();
+  ASSERT_TRUE(storage_->Open().IsOK());
+  ASSERT_TRUE(storage_->IsNamespaceIsolated("ns1"));
+  std::string value;
+  ASSERT_TRUE(redis::Hash(storage_.get(), "ns1").Get("key", "field", &value).ok());
+  ASSERT_EQ(value, "v1");
+
+  redis::Database db1(storage_.get(), "ns1");
+  ASSERT_TRUE(db1.FlushDB().ok());
+  ASSERT_EQ(count_keys(storage_->GetCFHandle(engine::kSubkeyColumnFamilyName, "ns1")), 0);
+  ASSERT_TRUE(redis::Hash(storage_.get(), "ns2").Get("key", "field", &value).ok());
+  ASSERT_EQ(value, "v2");
+
+  ASSERT_TRUE(redis::Hash(storage_.get(), "ns1").Set("key", "field", "v1", &ret).ok());
+  ASSERT_TRUE(storage_->DropNamespaceColumnFamilies("ns1").IsOK());
+  ASSERT_TRUE(redis::Hash(storage_.get(), "ns1").Get("key", "field", &value).IsNotFound());
+  ASSERT_TRUE(redis::Hash(storage_.get(), "ns2").Get("key", "field", &value).ok());
+}
+
+TEST_F(NamespaceColumnFamiliesTest, ExtractIsolatedWriteBatch) {
+  std::vector<uint32_t> cf_ids;
+  ASSERT_TRUE(storage_->CreateNamespaceColumnFamilies("ns1", &cf_ids).IsOK());
+  int ret = 0;
+  ASSERT_TRUE(redis::Hash(storage_.get(), "ns1").Set("key", "field", "v1", &ret).ok());
+
+  std::unique_ptr<rocksdb::TransactionLogIterator> iter;
+  ASSERT_TRUE(storage_->GetWALIter(0, &iter).IsOK());
+  WriteBatchExtractor extractor(false, -1, true, storage_.get());
+  for (; iter->Valid(); iter->Next()) {
+    auto batch = iter->GetBatch();
+    ASSERT_TRUE(batch.writeBatchPtr->Iterate(&extractor).ok());
+  }
+  std::vector<std::string> expected = {redis::Command2RESP({"HSET", "key", "field", "v1"})};
+  ASSERT_EQ((*extractor.GetRESPCommands())["ns1"], expected);
+}
@@ -0,0 +1,65 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "storage/prefix_extractor.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "storage/redis_metadata.h"
+
+TEST(SubKeyPrefixExtractor, Transform) {
+  for (bool slot_id_encoded : {false, true}) {
+    SubKeyPrefixExtractor extractor(slot_id_encoded);
+    std::string ns_key, prefix, sub_key1, sub_key2, other_version_key;
+    ComposeNamespaceKey("ns", "key", &ns_key, slot_id_encoded);
+    InternalKey(ns_key, "", 1, slot_id_encoded).Encode(&prefix);
+    InternalKey(ns_key, "field1", 1, slot_id_encoded).Encode(&sub_key1);
+    InternalKey(ns_key, "field2", 1, slot_id_encoded).Encode(&sub_key2);
+    InternalKey(ns_key, "field1", 2, slot_id_encoded).Encode(&other_version_key);
+
+    ASSERT_TRUE(extractor.InDomain(prefix));
+    ASSERT_TRUE(extractor.InDomain(sub_key1));
+    ASSERT_EQ(extractor.Transform(prefix), prefix);
+    ASSERT_EQ(extractor.Transform(sub_key1), prefix);
+    ASSERT_EQ(extractor.Transform(sub_key2), prefix);
+    ASSERT_NE(extractor.Transform(other_version_key), prefix);
+
+    // the keys which are too short to contain the version are out of the domain
+    ASSERT_FALSE(extractor.InDomain(""));
+    ASSERT_FALSE(extractor.InDomain(ns_key));
+    ASSERT_FALSE(extractor.InDomain(prefix.substr(0, prefix.size() - 1)));
+  }
+}
+
+TEST(SubKeyPrefixExtractor, KeyIdEncoded) {
+  SubKeyPrefixExtractor extractor(false);
+  std::string ns_key, prefix, sub_key, anchor;
+  ComposeNamespaceKey("ns", "key", &ns_key, false);
+  InternalKey(ns_key, "", 1, false, true).Encode(&prefix);
+  InternalKey ikey(ns_key, "field", 1, false, true);
+  ikey.Encode(&sub_key);
+  ikey.EncodeKeyIdAnchor(&anchor);
+
+  ASSERT_EQ(extractor.Transform(sub_key), prefix);
+  ASSERT_TRUE(extractor.InDomain(anchor));
+  ASSERT_EQ(extractor.Transform(anchor).size(), anchor.size());
+}
@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+#include "storage/script_cache.h"
+
+#include <gtest/gtest.h>
+
+TEST(ScriptCache, PutAndGet) {
+  lua::ScriptCache cache(1024);
+  ASSERT_EQ(cache.Get("a"), nullptr);
+  ASSERT_FALSE(cache.Exists("a"));
+
+  cache.Put("a", "bytecode-a");
+  ASSERT_TRUE(cache.Exists("a"));
+  ASSERT_EQ(*cache.Get("a"), "bytecode-a");
+
+  // the first bytecode of the same script is kept
+  cache.Put("a", "another-bytecode");
+  ASSERT_EQ(*cache.Get("a"), "bytecode-a");
+  ASSERT_EQ(cache.Size(), 1);
+  ASSERT_EQ(cache.Bytes(), 10);
+}
+
+TEST(ScriptCache, EvictOldest) {
+  lua::ScriptCache cache(10);
+  cache.Put("a", std::string(4, 'a'));
+  cache.Put("b", std::string(4, 'b'));
+  auto a = cache.Get("a");
+  cache.Put("c", std::string(4, 'c'));
+  ASSERT_FALSE(cache.Exists("a"));
+  ASSERT_TRUE(cache.Exists("b"));
+  ASSERT_TRUE(cache.Exists("c"));
+  ASSERT_EQ(cache.Bytes(), 8);
+  // the evicted bytecode is still valid for the holder
+  ASSERT_EQ(*a, "aaaa");
+
+  // the latest script is always kept
+  cache.Put("d", std::string(32, 'd'));
+  ASSERT_EQ(cache.Size(), 1);
+  ASSERT_TRUE(cache.Exists("d"));
+}
+
+TEST(ScriptCache, ClearBumpsVersion) {
+  lua::ScriptCache cache(1024);
+  cache.Put("a", "bytecode-a");
+  auto version = cache.Version();
+  cache.Clear();
+  ASSERT_GT(cache.Version(), version);
+  ASSERT_FALSE(cache.Exists("a"));
+  ASSERT_EQ(cache.Size(), 0);
+  ASSERT_EQ(cache.Bytes(), 0);
+}
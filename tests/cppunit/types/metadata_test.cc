@@ -45,6 +45,57 @@ TEST(InternalKey, EncodeAndDecode) {
   EXPECT_EQ(ikey, ikey1);
 }
 
+TEST(InternalKey, KeyIdEncodeAndDecode) {
+  Slice key = "test-metadata-key";
+  Slice sub_key = "test-metadata-sub-key";
+  Slice ns = "namespace";
+  uint64_t version = 12;
+  std::string ns_key, plain_bytes, bytes;
+
+  ComposeNamespaceKey(ns, key, &ns_key, true);
+  InternalKey(ns_key, sub_key, version, true).Encode(&plain_bytes);
+  InternalKey ikey(ns_key, sub_key, version, true, true);
+  ikey.Encode(&bytes);
+  ASSERT_EQ(bytes.size() + key.size(), plain_bytes.size());
+
+  InternalKey ikey1(bytes, true);
+  ASSERT_TRUE(ikey1.IsKeyIdEncoded());
+  ASSERT_FALSE(ikey1.IsKeyIdAnchor());
+  ASSERT_EQ(ikey1.GetNamespace(), ns);
+  ASSERT_TRUE(ikey1.GetKey().empty());
+  ASSERT_EQ(ikey1.GetSubKey(), sub_key);
+  ASSERT_EQ(ikey1.GetVersion(), version);
+
+  // the subkeys and the anchor of the same key share the same anchor key
+  std::string anchor, anchor1, anchor2;
+  ikey.EncodeKeyIdAnchor(&anchor);
+  ikey1.EncodeKeyIdAnchor(&anchor1);
+  ASSERT_EQ(anchor, anchor1);
+  InternalKey anchor_ikey(anchor, true);
+  ASSERT_TRUE(anchor_ikey.IsKeyIdEncoded());
+  ASSERT_TRUE(anchor_ikey.IsKeyIdAnchor());
+  ASSERT_TRUE(anchor_ikey.GetSubKey().empty());
+  ASSERT_EQ(anchor_ikey.GetVersion(), version);
+  anchor_ikey.EncodeKeyIdAnchor(&anchor2);
+  ASSERT_EQ(anchor, anchor2);
+}
+
+TEST(Metadata, KeyIdEncoding) {
+  Metadata hash_md(kRedisHash, true, USE_64BIT_COMMON_FIELD_DEFAULT, true);
+  ASSERT_TRUE(hash_md.IsKeyIdEncoded());
+  ASSERT_TRUE(hash_md.is_new);
+  std::string bytes;
+  hash_md.Encode(&bytes);
+  Metadata hash_md1(kRedisNone, false);
+  hash_md1.Decode(bytes);
+  ASSERT_TRUE(hash_md1.IsKeyIdEncoded());
+  ASSERT_EQ(hash_md1.Type(), kRedisHash);
+
+  // only the types with the subkeys prefixed by the key id would be marked
+  Metadata bitmap_md(kRedisBitmap, true, USE_64BIT_COMMON_FIELD_DEFAULT, true);
+  ASSERT_FALSE(bitmap_md.IsKeyIdEncoded());
+}
+
 TEST(Metadata, EncodeAndDeocde) {
   std::string string_bytes;
   Metadata string_md(kRedisString);
@@ -100,6 +151,32 @@ TEST_F(RedisTypeTest, GetMetadata) {
   EXPECT_TRUE(s.ok());
 }
 
+TEST_F(RedisTypeTest, AllocateKeyId) {
+  std::string ns_key;
+  redis_->AppendNamespacePrefix(key_, &ns_key);
+  Metadata metadata(kRedisHash, true, USE_64BIT_COMMON_FIELD_DEFAULT, true);
+  uint64_t taken_version = metadata.version;
+
+  // the key id was taken by another key, e.g. it was created by the old master
+  std::string anchor;
+  InternalKey(ns_key, "", taken_version, storage_->IsSlotIdEncoded(), true).EncodeKeyIdAnchor(&anchor);
+  rocksdb::WriteBatch batch;
+  batch.Put(storage_->GetCFHandle(engine::kSubkeyColumnFamilyName), anchor, "other-key");
+  ASSERT_TRUE(storage_->Write(storage_->DefaultWriteOptions(), &batch).ok());
+
+  auto s = redis_->GetMetadata(kRedisHash, ns_key, &metadata);
+  ASSERT_TRUE(s.IsNotFound());
+  ASSERT_TRUE(metadata.is_new);
+  ASSERT_NE(metadata.version, taken_version);
+
+  // the version isn't renewed if the subkeys aren't prefixed by the key id
+  Metadata plain_metadata(kRedisHash, true, USE_64BIT_COMMON_FIELD_DEFAULT, false);
+  plain_metadata.version = taken_version;
+  s = redis_->GetMetadata(kRedisHash, ns_key, &plain_metadata);
+  ASSERT_TRUE(s.IsNotFound());
+  ASSERT_EQ(plain_metadata.version, taken_version);
+}
+
 TEST_F(RedisTypeTest, Expire) {
   int ret = 0;
   std::vector<FieldValue> fvs;
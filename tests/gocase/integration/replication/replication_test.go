@@ -422,3 +422,141 @@ func TestReplicationAnnounceIP(t *testing.T) {
 		require.Equal(t, "1234", slave0port)
 	})
 }
+
+func TestReplicationWithCompression(t *testing.T) {
+	for _, compression := range []string{"lz4", "zstd"} {
+		t.Run(fmt.Sprintf("Replicate with %s compression", compression), func(t *testing.T) {
+			master := util.StartServer(t, map[string]string{})
+			defer master.Close()
+			masterClient := master.NewClient()
+			defer func() { require.NoError(t, masterClient.Close()) }()
+			util.Populate(t, masterClient, "", 100, 10)
+
+			slave := util.StartServer(t, map[string]string{"replication-compression": compression})
+			defer slave.Close()
+			slaveClient := slave.NewClient()
+			defer func() { require.NoError(t, slaveClient.Close()) }()
+
+			ctx := context.Background()
+			util.SlaveOf(t, slaveClient, master)
+			util.WaitForSync(t, slaveClient)
+			require.Equal(t, masterClient.DBSize(ctx).Val(), slaveClient.DBSize(ctx).Val())
+
+			for i := 0; i < 100; i++ {
+				require.NoError(t, masterClient.Set(ctx, fmt.Sprintf("key-%d", i), strings.Repeat("v", i*10), 0).Err())
+			}
+			require.NoError(t, masterClient.HSet(ctx, "myhash", "a", 1, "b", 2).Err())
+			require.Eventually(t, func() bool {
+				return slaveClient.HGet(ctx, "myhash", "b").Val() == "2"
+			}, 50*time.Second, 100*time.Millisecond)
+			for i := 0; i < 100; i++ {
+				require.Equal(t, strings.Repeat("v", i*10), slaveClient.Get(ctx, fmt.Sprintf("key-%d", i)).Val())
+			}
+		})
+	}
+}
+
+func TestReplicationFetchFileInChunks(t *testing.T) {
+	for _, compression := range []string{"no", "zstd"} {
+		t.Run(fmt.Sprintf("Fetch files in chunks with %s compression", compression), func(t *testing.T) {
+			master := util.StartServer(t, map[string]string{})
+			defer master.Close()
+			masterClient := master.NewClient()
+			defer func() { require.NoError(t, masterClient.Close()) }()
+
+			// Make the data files span multiple 1MB chunks
+			ctx := context.Background()
+			for i := 0; i < 256; i++ {
+				value := strings.Repeat(fmt.Sprintf("%d", i%10), 16*1024)
+				require.NoError(t, masterClient.Set(ctx, fmt.Sprintf("key-%d", i), value, 0).Err())
+			}
+
+			slave := util.StartServer(t, map[string]string{
+				"fullsync-fetch-concurrency": "3",
+				"fullsync-fetch-chunk-mb":    "1",
+				"replication-compression":    compression,
+			})
+			defer slave.Close()
+			slaveClient := slave.NewClient()
+			defer func() { require.NoError(t, slaveClient.Close()) }()
+
+			util.SlaveOf(t, slaveClient, master)
+			util.WaitForSync(t, slaveClient)
+			require.Equal(t, masterClient.DBSize(ctx).Val(), slaveClient.DBSize(ctx).Val())
+			for i := 0; i < 256; i++ {
+				value := strings.Repeat(fmt.Sprintf("%d", i%10), 16*1024)
+				require.Equal(t, value, slaveClient.Get(ctx, fmt.Sprintf("key-%d", i)).Val())
+			}
+		})
+	}
+}
+
+func TestReplicationApplyGroupBatches(t *testing.T) {
+	master := util.StartServer(t, map[string]string{})
+	defer master.Close()
+	masterClient := master.NewClient()
+	defer func() { require.NoError(t, masterClient.Close()) }()
+
+	slave := util.StartServer(t, map[string]string{"slave-apply-group-size": "16"})
+	defer slave.Close()
+	slaveClient := slave.NewClient()
+	defer func() { require.NoError(t, slaveClient.Close()) }()
+
+	ctx := context.Background()
+	util.SlaveOf(t, slaveClient, master)
+	util.WaitForSync(t, slaveClient)
+
+	pipe := masterClient.Pipeline()
+	for i := 0; i < 1000; i++ {
+		pipe.Set(ctx, fmt.Sprintf("key-%d", i), i, 0)
+	}
+	pipe.Publish(ctx, "channel", "msg")
+	_, err := pipe.Exec(ctx)
+	require.NoError(t, err)
+
+	util.WaitForOffsetSync(t, masterClient, slaveClient)
+	require.Equal(t, masterClient.DBSize(ctx).Val(), slaveClient.DBSize(ctx).Val())
+	for i := 0; i < 1000; i++ {
+		require.Equal(t, fmt.Sprintf("%d", i), slaveClient.Get(ctx, fmt.Sprintf("key-%d", i)).Val())
+	}
+}
+
+func TestReplicationNamespaceColumnFamilies(t *testing.T) {
+	master := util.StartServer(t, map[string]string{
+		"namespace-column-families": "yes",
+		"requirepass":               "foobared",
+	})
+	defer master.Close()
+	masterClient := master.NewClientWithOption(&redis.Options{Password: "foobared"})
+	defer func() { require.NoError(t, masterClient.Close()) }()
+
+	replica := util.StartServer(t, map[string]string{
+		"namespace-column-families": "yes",
+		"requirepass":               "foobared",
+		"masterauth":                "foobared",
+	})
+	defer replica.Close()
+	replicaClient := replica.NewClientWithOption(&redis.Options{Password: "foobared"})
+	defer func() { require.NoError(t, replicaClient.Close()) }()
+	util.SlaveOf(t, replicaClient, master)
+	util.WaitForSync(t, replicaClient)
+
+	t.Run("Write to the new namespace right after adding it", func(t *testing.T) {
+		ctx := context.Background()
+		for i := 0; i < 10; i++ {
+			ns, token := fmt.Sprintf("ns%d", i), fmt.Sprintf("token%d", i)
+			require.NoError(t, masterClient.Do(ctx, "NAMESPACE", "ADD", ns, token).Err())
+			nsClient := master.NewClientWithOption(&redis.Options{Password: token})
+			require.NoError(t, nsClient.Set(ctx, "key", ns, 0).Err())
+			require.NoError(t, nsClient.Close())
+		}
+
+		// the replica would stop applying the writes if the column families were missing
+		require.NoError(t, masterClient.Set(ctx, "last", "done", 0).Err())
+		require.Eventually(t, func() bool {
+			return replicaClient.Get(ctx, "last").Val() == "done"
+		}, 10*time.Second, 100*time.Millisecond)
+		util.WaitForOffsetSync(t, masterClient, replicaClient)
+		require.Equal(t, "up", util.FindInfoEntry(replicaClient, "master_link_status"))
+	})
+}
@@ -21,9 +21,11 @@ package hello
 
 import (
 	"context"
+	"fmt"
 	"testing"
 
 	"github.com/apache/incubator-kvrocks/tests/gocase/util"
+	"github.com/go-redis/redis/v9"
 	"github.com/stretchr/testify/require"
 )
 
@@ -48,10 +50,92 @@ func TestHello(t *testing.T) {
 	})
 
 	t.Run("hello with protocol 3", func(t *testing.T) {
-		r := rdb.Do(ctx, "HELLO", "3")
-		rList := r.Val().([]interface{})
-		require.EqualValues(t, rList[2], "proto")
-		require.EqualValues(t, rList[3], 2)
+		c := srv.NewTCPClient()
+		defer func() { require.NoError(t, c.Close()) }()
+		require.NoError(t, c.WriteArgs("HELLO", "3"))
+		c.MustRead(t, "%3")
+		mustReadBulkString(t, c, "server")
+		mustReadBulkString(t, c, "redis")
+		mustReadBulkString(t, c, "proto")
+		c.MustRead(t, ":3")
+
+		// the protocol is kept if the version isn't specified
+		require.NoError(t, c.WriteArgs("HELLO"))
+		c.MustRead(t, "%3")
+		mustReadBulkString(t, c, "server")
+		mustReadBulkString(t, c, "redis")
+		mustReadBulkString(t, c, "proto")
+		c.MustRead(t, ":3")
+	})
+
+	t.Run("RESP3 replies after hello 3", func(t *testing.T) {
+		require.NoError(t, rdb.Del(ctx, "hash", "set", "zset").Err())
+		require.NoError(t, rdb.HSet(ctx, "hash", "k", "v").Err())
+		require.NoError(t, rdb.SAdd(ctx, "set", "m").Err())
+		require.NoError(t, rdb.ZAdd(ctx, "zset", redis.Z{Score: 1.5, Member: "m"}).Err())
+
+		c := srv.NewTCPClient()
+		defer func() { require.NoError(t, c.Close()) }()
+		require.NoError(t, c.WriteArgs("HELLO", "3"))
+		c.MustRead(t, "%3")
+		// skip the server, proto and mode pairs
+		for i := 0; i < 11; i++ {
+			_, err := c.ReadLine()
+			require.NoError(t, err)
+		}
+
+		require.NoError(t, c.WriteArgs("HGETALL", "hash"))
+		c.MustRead(t, "%1")
+		mustReadBulkString(t, c, "k")
+		mustReadBulkString(t, c, "v")
+		require.NoError(t, c.WriteArgs("SMEMBERS", "set"))
+		c.MustRead(t, "~1")
+		mustReadBulkString(t, c, "m")
+		require.NoError(t, c.WriteArgs("ZSCORE", "zset", "m"))
+		c.MustRead(t, ",1.5")
+		require.NoError(t, c.WriteArgs("ZSCORE", "zset", "no-member"))
+		c.MustRead(t, "_")
+		require.NoError(t, c.WriteArgs("ZRANGE", "zset", "0", "-1", "WITHSCORES"))
+		c.MustRead(t, "*1")
+		c.MustRead(t, "*2")
+		mustReadBulkString(t, c, "m")
+		c.MustRead(t, ",1.5")
+
+		require.NoError(t, c.WriteArgs("SUBSCRIBE", "chan"))
+		c.MustRead(t, ">3")
+		mustReadBulkString(t, c, "subscribe")
+		mustReadBulkString(t, c, "chan")
+		c.MustRead(t, ":1")
+		require.NoError(t, rdb.Publish(ctx, "chan", "hi").Err())
+		c.MustRead(t, ">3")
+		mustReadBulkString(t, c, "message")
+		mustReadBulkString(t, c, "chan")
+		mustReadBulkString(t, c, "hi")
+	})
+
+	t.Run("scripts get RESP2 replies after hello 3", func(t *testing.T) {
+		require.NoError(t, rdb.Del(ctx, "hash", "zset").Err())
+		require.NoError(t, rdb.HSet(ctx, "hash", "k", "v").Err())
+		require.NoError(t, rdb.ZAdd(ctx, "zset", redis.Z{Score: 1.5, Member: "m"}).Err())
+
+		c := srv.NewTCPClient()
+		defer func() { require.NoError(t, c.Close()) }()
+		require.NoError(t, c.WriteArgs("HELLO", "3"))
+		c.MustRead(t, "%3")
+		for i := 0; i < 11; i++ {
+			_, err := c.ReadLine()
+			require.NoError(t, err)
+		}
+
+		require.NoError(t, c.WriteArgs("EVAL", "return redis.call('hgetall',KEYS[1])", "1", "hash"))
+		c.MustRead(t, "*2")
+		mustReadBulkString(t, c, "k")
+		mustReadBulkString(t, c, "v")
+		require.NoError(t, c.WriteArgs("EVAL", "return redis.call('zscore',KEYS[1],'m')", "1", "zset"))
+		mustReadBulkString(t, c, "1.5")
+		// the following commands are parsed correctly
+		require.NoError(t, c.WriteArgs("EVAL", "return redis.call('hget',KEYS[1],'k')", "1", "hash"))
+		mustReadBulkString(t, c, "v")
 	})
 
 	t.Run("hello with wrong protocol", func(t *testing.T) {
@@ -115,3 +199,8 @@ func TestHelloWithAuth(t *testing.T) {
 		require.EqualValues(t, r.Val(), "kvrocks")
 	})
 }
+
+func mustReadBulkString(t testing.TB, c *util.TCPClient, s string) {
+	c.MustRead(t, fmt.Sprintf("$%d", len(s)))
+	c.MustRead(t, s)
+}
@@ -20,6 +20,7 @@
 package limits
 
 import (
+	"context"
 	"strings"
 	"testing"
 
@@ -58,3 +59,34 @@ func TestNetworkLimits(t *testing.T) {
 		require.Fail(t, "maxclients doesn't work refusing connections")
 	})
 }
+
+func TestClientOutputBufferLimits(t *testing.T) {
+	srv := util.StartServer(t, map[string]string{
+		"client-output-buffer-limit": "pubsub 256k 0 0",
+	})
+	defer srv.Close()
+
+	ctx := context.Background()
+	rdb := srv.NewClient()
+	defer func() { require.NoError(t, rdb.Close()) }()
+
+	t.Run("disconnect the subscriber which doesn't read its messages", func(t *testing.T) {
+		c := srv.NewTCPClient()
+		defer func() { require.NoError(t, c.Close()) }()
+		require.NoError(t, c.WriteArgs("SUBSCRIBE", "slow-channel"))
+		c.MustRead(t, "*3")
+		c.MustRead(t, "$9")
+		c.MustRead(t, "subscribe")
+
+		payload := strings.Repeat("x", 64*1024)
+		disconnected := false
+		for i := 0; i < 4096; i++ {
+			if rdb.Publish(ctx, "slow-channel", payload).Val() == 0 {
+				disconnected = true
+				break
+			}
+		}
+		require.True(t, disconnected)
+		require.Contains(t, rdb.Info(ctx, "stats").Val(), "client_output_buffer_limit_disconnections:1")
+	})
+}
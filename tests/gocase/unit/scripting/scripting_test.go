@@ -216,6 +216,27 @@ return {type(foo),foo == false}
 		require.ErrorContains(t, r.Err(), "against a key")
 	})
 
+	t.Run("EVAL - Lua number arguments -> Redis string conversion", func(t *testing.T) {
+		r := rdb.Eval(ctx, `
+redis.call('rpush',KEYS[1],0,-7,123456789012,1e16,1e17,1.5,-0.25)
+return redis.call('lrange',KEYS[1],0,-1)
+`, []string{"numargs"})
+		require.NoError(t, r.Err())
+		require.Equal(t, []interface{}{"0", "-7", "123456789012", "10000000000000000", "1e+17", "1.5", "-0.25"}, r.Val())
+	})
+
+	t.Run("EVAL - Command names are case insensitive across repeated calls", func(t *testing.T) {
+		r := rdb.Eval(ctx, `
+for i = 1, 10 do
+  redis.call('SET',KEYS[1],i)
+  redis.call('set',KEYS[1],redis.call('Get',KEYS[1]) + 1)
+end
+return {redis.call('GET',KEYS[1]), redis.pcall('NoSuchCommand')['err']}
+`, []string{"casekey"})
+		require.NoError(t, r.Err())
+		require.Equal(t, []interface{}{"11", "Unknown Redis command called from Lua script"}, r.Val())
+	})
+
 	t.Run("EVAL - JSON numeric decoding", func(t *testing.T) {
 		r := rdb.Eval(ctx, `
 return
@@ -466,6 +487,23 @@ math.randomseed(ARGV[1]); return tostring(math.random())
 		require.Equal(t, "bar", r.Val())
 	})
 
+	t.Run("EVALSHA_RO - scripts are dropped from all workers after SCRIPT FLUSH", func(t *testing.T) {
+		sha := rdb.ScriptLoad(ctx, "return 'prewarmed'").Val()
+		for i := 0; i < 8; i++ {
+			r := rdb.Do(ctx, "EVALSHA_RO", sha, "0")
+			require.NoError(t, r.Err())
+			require.Equal(t, "prewarmed", r.Val())
+		}
+		require.NoError(t, rdb.ScriptFlush(ctx).Err())
+		for i := 0; i < 8; i++ {
+			require.ErrorContains(t, rdb.Do(ctx, "EVALSHA_RO", sha, "0").Err(), "NOSCRIPT")
+		}
+	})
+
+	t.Run("SCRIPT LOAD - binary chunks are not allowed", func(t *testing.T) {
+		require.ErrorContains(t, rdb.ScriptLoad(ctx, "\x1bLua").Err(), "binary chunks are not allowed")
+	})
+
 	t.Run("EVAL_RO - cannot run write commands", func(t *testing.T) {
 		require.NoError(t, rdb.Set(ctx, "foo", "bar", 0).Err())
 		r := rdb.Do(ctx, "EVAL_RO", `redis.call('del', KEYS[1]);`, "1", "foo")
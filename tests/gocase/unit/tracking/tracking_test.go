@@ -0,0 +1,163 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+package tracking
+
+import (
+	"context"
+	"fmt"
+	"strconv"
+	"strings"
+	"testing"
+	"time"
+
+	"github.com/apache/incubator-kvrocks/tests/gocase/util"
+	"github.com/stretchr/testify/require"
+)
+
+func mustReadLines(t *testing.T, c *util.TCPClient, lines []string) {
+	for _, line := range lines {
+		c.MustRead(t, line)
+	}
+}
+
+func readInvalidation(t *testing.T, c *util.TCPClient, keys ...string) {
+	mustReadLines(t, c, []string{"*3", "$7", "message", "$20", "__redis__:invalidate"})
+	c.MustRead(t, fmt.Sprintf("*%d", len(keys)))
+	for _, key := range keys {
+		mustReadLines(t, c, []string{fmt.Sprintf("$%d", len(key)), key})
+	}
+}
+
+func TestClientTracking(t *testing.T) {
+	srv := util.StartServer(t, map[string]string{})
+	defer srv.Close()
+
+	ctx := context.Background()
+	rdb := srv.NewClient()
+	defer func() { require.NoError(t, rdb.Close()) }()
+
+	redirect := srv.NewTCPClient()
+	defer func() { require.NoError(t, redirect.Close()) }()
+	require.NoError(t, redirect.WriteArgs("CLIENT", "ID"))
+	line, err := redirect.ReadLine()
+	require.NoError(t, err)
+	redirectID := strings.TrimPrefix(line, ":")
+	require.NoError(t, redirect.WriteArgs("SUBSCRIBE", "__redis__:invalidate"))
+	mustReadLines(t, redirect, []string{"*3", "$9", "subscribe", "$20", "__redis__:invalidate", ":1"})
+
+	t.Run("Tracking requires REDIRECT in RESP2", func(t *testing.T) {
+		c := srv.NewTCPClient()
+		defer func() { require.NoError(t, c.Close()) }()
+		require.NoError(t, c.WriteArgs("CLIENT", "TRACKING", "ON"))
+		c.MustMatch(t, ".*REDIRECT.*")
+		require.NoError(t, c.WriteArgs("CLIENT", "TRACKING", "ON", "REDIRECT", "123456789"))
+		c.MustMatch(t, ".*does not exist.*")
+		require.NoError(t, c.WriteArgs("CLIENT", "TRACKING", "ON", "PREFIX", "foo", "REDIRECT", redirectID))
+		c.MustMatch(t, ".*BCAST.*")
+		require.NoError(t, c.WriteArgs("CLIENT", "GETREDIR"))
+		c.MustRead(t, ":-1")
+	})
+
+	t.Run("Invalidate the keys read by the tracking client", func(t *testing.T) {
+		c := srv.NewTCPClient()
+		defer func() { require.NoError(t, c.Close()) }()
+		require.NoError(t, c.WriteArgs("CLIENT", "TRACKING", "ON", "REDIRECT", redirectID))
+		c.MustRead(t, "+OK")
+		require.NoError(t, c.WriteArgs("CLIENT", "GETREDIR"))
+		c.MustRead(t, ":"+redirectID)
+
+		require.NoError(t, c.WriteArgs("MGET", "tracking-a", "tracking-b"))
+		mustReadLines(t, c, []string{"*2", "$-1", "$-1"})
+
+		require.NoError(t, rdb.Set(ctx, "tracking-a", "1", 0).Err())
+		readInvalidation(t, redirect, "tracking-a")
+		// the key isn't tracked anymore until it's read again
+		require.NoError(t, rdb.Set(ctx, "tracking-a", "2", 0).Err())
+		require.NoError(t, rdb.Del(ctx, "tracking-b").Err())
+		readInvalidation(t, redirect, "tracking-b")
+
+		require.NoError(t, c.WriteArgs("CLIENT", "TRACKING", "OFF"))
+		c.MustRead(t, "+OK")
+	})
+
+	t.Run("Broadcast the modified keys matching the prefixes", func(t *testing.T) {
+		c := srv.NewTCPClient()
+		defer func() { require.NoError(t, c.Close()) }()
+		require.NoError(t, c.WriteArgs("CLIENT", "TRACKING", "ON", "BCAST", "PREFIX", "user:", "REDIRECT", redirectID))
+		c.MustRead(t, "+OK")
+
+		require.NoError(t, rdb.Set(ctx, "order:1", "1", 0).Err())
+		require.NoError(t, rdb.Set(ctx, "user:1", "1", 0).Err())
+		readInvalidation(t, redirect, "user:1")
+		require.Contains(t, rdb.Info(ctx, "stats").Val(), "tracking_total_prefixes:1")
+	})
+
+	t.Run("Invalidate the keys popped by the blocked clients", func(t *testing.T) {
+		c := srv.NewTCPClient()
+		defer func() { require.NoError(t, c.Close()) }()
+		require.NoError(t, c.WriteArgs("CLIENT", "TRACKING", "ON", "BCAST", "PREFIX", "blocking:", "REDIRECT", redirectID))
+		c.MustRead(t, "+OK")
+
+		blocked := srv.NewTCPClient()
+		defer func() { require.NoError(t, blocked.Close()) }()
+		require.NoError(t, blocked.WriteArgs("BLPOP", "blocking:list", "0"))
+		require.Eventually(t, func() bool {
+			cnt, _ := strconv.Atoi(util.FindInfoEntry(rdb, "blocked_clients"))
+			return cnt > 0
+		}, 5*time.Second, 100*time.Millisecond)
+
+		require.NoError(t, rdb.RPush(ctx, "blocking:list", "a").Err())
+		mustReadLines(t, blocked, []string{"*2", "$13", "blocking:list", "$1", "a"})
+		// both the push and the pop of the blocked client modified the key
+		readInvalidation(t, redirect, "blocking:list")
+		readInvalidation(t, redirect, "blocking:list")
+	})
+
+	t.Run("Flush all the keys after FLUSHDB", func(t *testing.T) {
+		c := srv.NewTCPClient()
+		defer func() { require.NoError(t, c.Close()) }()
+		require.NoError(t, c.WriteArgs("CLIENT", "TRACKING", "ON", "REDIRECT", redirectID))
+		c.MustRead(t, "+OK")
+
+		require.NoError(t, rdb.FlushDB(ctx).Err())
+		mustReadLines(t, redirect, []string{"*3", "$7", "message", "$20", "__redis__:invalidate", "$-1"})
+	})
+	t.Run("RESP3 clients receive the invalidation messages as push", func(t *testing.T) {
+		c := srv.NewTCPClient()
+		defer func() { require.NoError(t, c.Close()) }()
+		require.NoError(t, c.WriteArgs("HELLO", "3"))
+		c.MustRead(t, "%3")
+		// skip the server, proto and mode pairs
+		for i := 0; i < 11; i++ {
+			_, err := c.ReadLine()
+			require.NoError(t, err)
+		}
+
+		require.NoError(t, c.WriteArgs("CLIENT", "TRACKING", "ON"))
+		c.MustRead(t, "+OK")
+		require.NoError(t, c.WriteArgs("CLIENT", "GETREDIR"))
+		c.MustRead(t, ":0")
+
+		require.NoError(t, c.WriteArgs("GET", "tracking-resp3"))
+		c.MustRead(t, "$-1")
+		require.NoError(t, rdb.Set(ctx, "tracking-resp3", "1", 0).Err())
+		mustReadLines(t, c, []string{">2", "$10", "invalidate", "*1", "$14", "tracking-resp3"})
+	})
+}
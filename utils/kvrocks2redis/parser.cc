@@ -86,14 +86,16 @@ Status Parser::parseComplexKV(const Slice &ns_key, const Metadata &metadata) {
   std::string ns, user_key;
   ExtractNamespaceKey(ns_key, &ns, &user_key, slot_id_encoded_);
   std::string prefix_key;
-  InternalKey(ns_key, "", metadata.version, slot_id_encoded_).Encode(&prefix_key);
+  InternalKey(ns_key, "", metadata.version, slot_id_encoded_, metadata.IsKeyIdEncoded()).Encode(&prefix_key);
   std::string next_version_prefix_key;
-  InternalKey(ns_key, "", metadata.version + 1, slot_id_encoded_).Encode(&next_version_prefix_key);
+  InternalKey(ns_key, "", metadata.version + 1, slot_id_encoded_, metadata.IsKeyIdEncoded())
+      .Encode(&next_version_prefix_key);
 
   rocksdb::ReadOptions read_options;
   read_options.snapshot = latest_snapshot_->GetSnapShot();
   rocksdb::Slice upper_bound(next_version_prefix_key);
   read_options.iterate_upper_bound = &upper_bound;
+  read_options.prefix_same_as_start = true;
   storage_->SetReadOptions(read_options);
 
   std::string output;
@@ -170,7 +172,7 @@ Status Parser::parseBitmapSegment(const Slice &ns, const Slice &user_key, int in
 
 Status Parser::ParseWriteBatch(const std::string &batch_string) {
   rocksdb::WriteBatch write_batch(batch_string);
-  WriteBatchExtractor write_batch_extractor(slot_id_encoded_, -1, true);
+  WriteBatchExtractor write_batch_extractor(slot_id_encoded_, -1, true, storage_);
 
   auto db_status = write_batch.Iterate(&write_batch_extractor);
   if (!db_status.ok())
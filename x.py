@@ -91,8 +91,8 @@ def check_version(current: str, required: Tuple[int, int, int], prog_name: Optio
     return semver
 
 
-def build(dir: str, jobs: Optional[int], ghproxy: bool, ninja: bool, unittest: bool, compiler: str, cmake_path: str, D: List[str],
-          skip_build: bool) -> None:
+def build(dir: str, jobs: Optional[int], ghproxy: bool, ninja: bool, unittest: bool, benchmark: bool, compiler: str,
+          cmake_path: str, D: List[str], skip_build: bool) -> None:
     basedir = Path(__file__).parent.absolute()
 
     find_command("autoconf", msg="autoconf is required to build jemalloc")
@@ -115,6 +115,8 @@ def build(dir: str, jobs: Optional[int], ghproxy: bool, ninja: bool, unittest: b
         cmake_options += ["-DCMAKE_C_COMPILER=gcc", "-DCMAKE_CXX_COMPILER=g++"]
     elif compiler == 'clang':
         cmake_options += ["-DCMAKE_C_COMPILER=clang", "-DCMAKE_CXX_COMPILER=clang++"]
+    if benchmark:
+        cmake_options.append("-DENABLE_BENCHMARK=ON")
     if D:
         cmake_options += [f"-D{o}" for o in D]
     run(cmake, str(basedir), *cmake_options, verbose=True, cwd=dir)
@@ -125,6 +127,8 @@ def build(dir: str, jobs: Optional[int], ghproxy: bool, ninja: bool, unittest: b
     target = ["kvrocks", "kvrocks2redis"]
     if unittest:
         target.append("unittest")
+    if benchmark:
+        target.append("kvrocks_bench")
 
     options = ["--build", "."]
     if jobs is not None:
@@ -248,6 +252,15 @@ def test_cpp(dir: str, rest: List[str]) -> None:
     run(str(unittest), *rest, cwd=str(basedir), verbose=True)
 
 
+def bench(dir: str, out: str, rest: List[str]) -> None:
+    basedir = Path(dir).absolute()
+    kvrocks_bench = basedir / 'kvrocks_bench'
+
+    # the json output can be diffed by the compare.py in google benchmark tools
+    args = [f'--benchmark_out={Path(out).absolute()}', '--benchmark_out_format=json', *rest]
+    run(str(kvrocks_bench), *args, cwd=str(basedir), verbose=True)
+
+
 def test_go(dir: str, cli_path: str, rest: List[str]) -> None:
     go = find_command('go', msg='go is required for testing')
     find_command(cli_path, msg='redis-cli is required for testing')
@@ -331,6 +344,7 @@ if __name__ == '__main__':
                               help='use https://ghproxy.com to fetch dependencies')
     parser_build.add_argument('--ninja', default=False, action='store_true', help='use Ninja to build kvrocks')
     parser_build.add_argument('--unittest', default=False, action='store_true', help='build unittest target')
+    parser_build.add_argument('--benchmark', default=False, action='store_true', help='build kvrocks_bench target')
     parser_build.add_argument('--compiler', default='auto', choices=('auto', 'gcc', 'clang'),
                               help="compiler used to build kvrocks")
     parser_build.add_argument('--cmake-path', default='cmake', help="path of cmake binary used to build kvrocks")
@@ -386,6 +400,18 @@ if __name__ == '__main__':
     parser_test_go.add_argument('rest', nargs=REMAINDER, help="the rest of arguments to forward to go test")
     parser_test_go.set_defaults(func=test_go)
 
+    parser_bench = subparsers.add_parser(
+        'bench',
+        description="Run the micro benchmarks of a specific kvrocks build",
+        help="Run the micro benchmarks of a specific kvrocks build",
+        formatter_class=ArgumentDefaultsHelpFormatter,
+    )
+    parser_bench.add_argument('dir', metavar='BUILD_DIR', nargs='?', default='build',
+                              help="directory including kvrocks build files")
+    parser_bench.add_argument('--out', default='kvrocks_bench.json', help="path of the json output")
+    parser_bench.add_argument('rest', nargs=REMAINDER, help="the rest of arguments to forward to kvrocks_bench")
+    parser_bench.set_defaults(func=bench)
+
     args = parser.parse_args()
 
     arg_dict = dict(vars(args))